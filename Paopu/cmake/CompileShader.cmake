@@ -0,0 +1,79 @@
+########## -Shaders- ###############
+#
+# Included by Paopu/CMakeLists.txt for `paopu_add_shader`, and run with
+# `cmake -P` by the build step that compiles a single shader:
+#
+#   cmake -DCOMPILER=<glslc|glslangValidator> -DSOURCE=<glsl> -DOUTPUT=<spv>
+#         -DDEFINES=<NAME|NAME...> -P CompileShader.cmake
+#
+# Next to every SPIR-V file goes `<spv>.sha256`, a hash of the source and
+# defines it was built from. Without a compiler configure compares the
+# committed SPIR-V against it, so stale shaders fail configure instead of
+# being loaded by the renderer.
+
+# Hash of `source` and `defines`. Line endings are normalized so a checkout
+# with CRLF endings doesn't look stale.
+function(paopu_get_shader_hash out source defines)
+	file(READ "${source}" contents)
+	string(REPLACE "\r\n" "\n" contents "${contents}")
+	string(SHA256 hash "${contents}|${defines}")
+	set(${out} ${hash} PARENT_SCOPE)
+endfunction()
+
+# Compiles `src/Renderer/Shaders/<source>` to `src/Renderer/Shaders/SPVs/<output>`
+# with each extra argument defined, or checks the committed output is up to
+# date when no compiler was found. Appends to PAOPU_SHADER_OUTPUTS and
+# PAOPU_STALE_SHADERS in the caller's scope.
+function(paopu_add_shader source output)
+	set(source_path "${PAOPU_SHADER_DIR}/${source}")
+	set(output_path "${PAOPU_SHADER_DIR}/SPVs/${output}")
+	string(REPLACE ";" "|" defines "${ARGN}")
+
+	if(PAOPU_SHADER_COMPILER)
+		add_custom_command(
+			OUTPUT "${output_path}"
+			BYPRODUCTS "${output_path}.sha256"
+			COMMAND ${CMAKE_COMMAND} "-DCOMPILER=${PAOPU_SHADER_COMPILER}" "-DSOURCE=${source_path}"
+				"-DOUTPUT=${output_path}" "-DDEFINES=${defines}" -P "${PAOPU_SHADER_SCRIPT}"
+			DEPENDS "${source_path}" "${PAOPU_SHADER_SCRIPT}"
+			COMMENT "Compiling ${output}"
+			VERBATIM
+		)
+		set(PAOPU_SHADER_OUTPUTS ${PAOPU_SHADER_OUTPUTS} "${output_path}" PARENT_SCOPE)
+		return()
+	endif()
+
+	paopu_get_shader_hash(expected "${source_path}" "${defines}")
+	set(recorded "")
+	if(EXISTS "${output_path}" AND EXISTS "${output_path}.sha256")
+		file(READ "${output_path}.sha256" recorded)
+		string(STRIP "${recorded}" recorded)
+	endif()
+	if(NOT recorded STREQUAL expected)
+		set(PAOPU_STALE_SHADERS ${PAOPU_STALE_SHADERS} "${output}" PARENT_SCOPE)
+	endif()
+endfunction()
+
+if(NOT CMAKE_SCRIPT_MODE_FILE)
+	return()
+endif()
+
+# Build step, see paopu_add_shader
+string(REPLACE "|" ";" define_list "${DEFINES}")
+set(arguments "")
+get_filename_component(compiler_name "${COMPILER}" NAME_WE)
+if(compiler_name STREQUAL "glslangValidator")
+	list(APPEND arguments -V)
+endif()
+foreach(define ${define_list})
+	list(APPEND arguments "-D${define}")
+endforeach()
+
+execute_process(COMMAND "${COMPILER}" ${arguments} "${SOURCE}" -o "${OUTPUT}" RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	file(REMOVE "${OUTPUT}" "${OUTPUT}.sha256")
+	message(FATAL_ERROR "Compiling ${SOURCE} failed")
+endif()
+
+paopu_get_shader_hash(hash "${SOURCE}" "${DEFINES}")
+file(WRITE "${OUTPUT}.sha256" "${hash}\n")
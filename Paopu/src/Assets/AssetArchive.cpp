@@ -0,0 +1,275 @@
+#include "AssetArchive.h"
+#include "Lz4.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef PAO_PLATFORM_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Paopu {
+
+    AssetArchive::~AssetArchive() {
+        close();
+    }
+
+    void AssetArchive::open(const std::string& path) {
+        close();
+
+    #ifdef PAO_PLATFORM_WINDOWS
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("[Assets][Archive]: Failed to open " + path + "!");
+        }
+        file_handle = file;
+
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(AssetArchiveHeader))) {
+            close();
+            throw std::runtime_error("[Assets][Archive]: " + path + " is too small to be an archive!");
+        }
+
+        mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping_handle != nullptr ? MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if(view == nullptr) {
+            close();
+            throw std::runtime_error("[Assets][Archive]: Failed to map " + path + "!");
+        }
+        mapping = static_cast<const uint8_t*>(view);
+        mapping_size = static_cast<size_t>(size.QuadPart);
+    #else
+        int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(file < 0) {
+            throw std::runtime_error("[Assets][Archive]: Failed to open " + path + "!");
+        }
+
+        struct stat info;
+        if(fstat(file, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(AssetArchiveHeader))) {
+            ::close(file);
+            throw std::runtime_error("[Assets][Archive]: " + path + " is too small to be an archive!");
+        }
+
+        // The mapping keeps the file alive, the descriptor isn't needed after this
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if(view == MAP_FAILED) {
+            throw std::runtime_error("[Assets][Archive]: Failed to map " + path + "!");
+        }
+        mapping = static_cast<const uint8_t*>(view);
+        mapping_size = static_cast<size_t>(info.st_size);
+    #endif
+
+        AssetArchiveHeader header;
+        memcpy(&header, mapping, sizeof(header));
+
+        bool valid = memcmp(header.magic, k_asset_archive_magic, sizeof(header.magic)) == 0
+            && header.version == k_asset_archive_version
+            && header.file_size == mapping_size
+            && header.table_offset % alignof(AssetArchiveEntry) == 0
+            && header.table_offset <= mapping_size
+            && header.entry_count <= (mapping_size - header.table_offset) / sizeof(AssetArchiveEntry);
+
+        if(valid) {
+            entries = reinterpret_cast<const AssetArchiveEntry*>(mapping + header.table_offset);
+            entry_count = header.entry_count;
+
+            // Checked once here so lookups can trust the table
+            for(uint32_t i = 0; i < entry_count && valid; i++) {
+                const AssetArchiveEntry& entry = entries[i];
+                valid = (i == 0 || entries[i - 1].id < entry.id)
+                    && entry.offset <= mapping_size
+                    && entry.stored_size <= mapping_size - entry.offset
+                    && (entry.compression == AssetCompression::Lz4 || (entry.compression == AssetCompression::None && entry.size == entry.stored_size));
+            }
+        }
+
+        if(!valid) {
+            close();
+            throw std::runtime_error("[Assets][Archive]: " + path + " is not a valid archive!");
+        }
+        this->path = path;
+    }
+
+    void AssetArchive::close() {
+    #ifdef PAO_PLATFORM_WINDOWS
+        if(mapping != nullptr) UnmapViewOfFile(mapping);
+        if(mapping_handle != nullptr) CloseHandle(mapping_handle);
+        if(file_handle != nullptr) CloseHandle(file_handle);
+        mapping_handle = nullptr;
+        file_handle = nullptr;
+    #else
+        if(mapping != nullptr) munmap(const_cast<uint8_t*>(mapping), mapping_size);
+    #endif
+
+        path.clear();
+        mapping = nullptr;
+        mapping_size = 0;
+        entries = nullptr;
+        entry_count = 0;
+    }
+
+    const AssetArchiveEntry* AssetArchive::find(AssetId id) const {
+        const AssetArchiveEntry* end = entries + entry_count;
+        const AssetArchiveEntry* entry = std::lower_bound(entries, end, id,
+            [](const AssetArchiveEntry& entry, AssetId id) { return entry.id < id; });
+
+        return entry != end && entry->id == id ? entry : nullptr;
+    }
+
+    AssetView AssetArchive::get_view(AssetId id) const {
+        const AssetArchiveEntry* entry = find(id);
+        if(entry == nullptr || entry->compression != AssetCompression::None) {
+            return {};
+        }
+        return {get_stored(*entry), static_cast<size_t>(entry->size)};
+    }
+
+    AssetView AssetArchive::load(AssetId id, std::pmr::vector<uint8_t>& buffer) const {
+        const AssetArchiveEntry* entry = find(id);
+        if(entry == nullptr) return {};
+
+        if(entry->compression == AssetCompression::None) {
+            return {get_stored(*entry), static_cast<size_t>(entry->size)};
+        }
+
+        buffer.resize(static_cast<size_t>(entry->size));
+        if(!read(*entry, buffer.data())) return {};
+        return {buffer.data(), buffer.size()};
+    }
+
+    bool AssetArchive::read(const AssetArchiveEntry& entry, void* dst) const {
+        const uint8_t* stored = get_stored(entry);
+
+        switch(entry.compression) {
+            case AssetCompression::None:
+                memcpy(dst, stored, static_cast<size_t>(entry.size));
+                return true;
+            case AssetCompression::Lz4:
+                return lz4_decompress(stored, static_cast<size_t>(entry.stored_size), static_cast<uint8_t*>(dst), static_cast<size_t>(entry.size));
+        }
+        return false;
+    }
+
+    void AssetArchive::prefetch(const AssetArchiveEntry& entry) const {
+        if(entry.stored_size == 0) return;
+
+    #ifdef PAO_PLATFORM_WINDOWS
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>(get_stored(entry));
+        range.NumberOfBytes = static_cast<SIZE_T>(entry.stored_size);
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    #else
+        // madvise wants a page aligned start
+        uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t begin = reinterpret_cast<uintptr_t>(get_stored(entry)) & ~(page_size - 1);
+        uintptr_t end = reinterpret_cast<uintptr_t>(get_stored(entry)) + entry.stored_size;
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+    #endif
+    }
+
+    // --------------------------------------------------------------------
+    //                            - Writer -
+    // --------------------------------------------------------------------
+
+    void AssetArchiveWriter::add(const std::string& name, const void* data, size_t size, bool compress) {
+        assets.emplace_back();
+        PendingAsset& asset = assets.back();
+        asset.name = name;
+        asset.entry = {};
+        asset.entry.id = hash_asset_name(name.c_str());
+        asset.entry.size = size;
+        asset.entry.compression = AssetCompression::None;
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        if(compress && size > 0) {
+            asset.data.resize(lz4_compress_bound(size));
+            size_t compressed_size = lz4_compress(bytes, size, asset.data.data(), asset.data.size());
+
+            if(compressed_size > 0 && compressed_size < size) {
+                asset.data.resize(compressed_size);
+                asset.entry.compression = AssetCompression::Lz4;
+            }
+        }
+
+        if(asset.entry.compression == AssetCompression::None) {
+            asset.data.assign(bytes, bytes + size);
+        }
+        asset.entry.stored_size = asset.data.size();
+    }
+
+    bool AssetArchiveWriter::add_file(const std::string& name, const std::string& path, bool compress) {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if(!file.is_open()) return false;
+
+        std::vector<char> contents(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(contents.data(), contents.size());
+        if(!file) return false;
+
+        add(name, contents.data(), contents.size(), compress);
+        return true;
+    }
+
+    static inline uint64_t align_offset(uint64_t offset, uint64_t alignment) {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    void AssetArchiveWriter::write(const std::string& path) {
+        std::sort(assets.begin(), assets.end(), [](const PendingAsset& a, const PendingAsset& b) { return a.entry.id < b.entry.id; });
+
+        for(size_t i = 1; i < assets.size(); i++) {
+            if(assets[i - 1].entry.id == assets[i].entry.id) {
+                throw std::runtime_error("[Assets][Archive]: " + assets[i - 1].name + " and " + assets[i].name + " have the same id!");
+            }
+        }
+
+        AssetArchiveHeader header;
+        memcpy(header.magic, k_asset_archive_magic, sizeof(header.magic));
+        header.version = k_asset_archive_version;
+        header.entry_count = static_cast<uint32_t>(assets.size());
+        header.table_offset = sizeof(AssetArchiveHeader);
+
+        uint64_t offset = header.table_offset + sizeof(AssetArchiveEntry) * assets.size();
+        for(PendingAsset& asset : assets) {
+            offset = align_offset(offset, k_asset_blob_alignment);
+            asset.entry.offset = offset;
+            offset += asset.entry.stored_size;
+        }
+        header.file_size = offset;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if(!file.is_open()) {
+            throw std::runtime_error("[Assets][Archive]: Failed to open " + path + " for writing!");
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for(const PendingAsset& asset : assets) {
+            file.write(reinterpret_cast<const char*>(&asset.entry), sizeof(asset.entry));
+        }
+
+        static const char k_padding[k_asset_blob_alignment] = {};
+        uint64_t written = header.table_offset + sizeof(AssetArchiveEntry) * assets.size();
+        for(const PendingAsset& asset : assets) {
+            file.write(k_padding, static_cast<std::streamsize>(asset.entry.offset - written));
+            file.write(reinterpret_cast<const char*>(asset.data.data()), static_cast<std::streamsize>(asset.data.size()));
+            written = asset.entry.offset + asset.entry.stored_size;
+        }
+
+        if(!file) {
+            throw std::runtime_error("[Assets][Archive]: Failed to write " + path + "!");
+        }
+    }
+
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace Paopu {
+
+    using AssetId = uint64_t;
+
+    /// FNV-1a of the asset's path inside the archive, e.g. "Shaders/SpriteShader.vert.spv"
+    ///
+    ///
+    constexpr AssetId hash_asset_name(const char* name) {
+        AssetId hash = 14695981039346656037ull;
+        for(; *name != '\0'; name++) {
+            hash = (hash ^ static_cast<uint8_t>(*name)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    enum class AssetCompression : uint32_t {
+        None = 0,
+        Lz4 = 1
+    };
+
+    // --------------------------------------------------------------------
+    //                          - File layout -
+    // --------------------------------------------------------------------
+    //  AssetArchiveHeader
+    //  AssetArchiveEntry[entry_count], sorted by id
+    //  blobs, each starting on a `k_asset_blob_alignment` boundary
+    //
+    //  Everything is little endian. Offsets are from the start of the file.
+
+    static const char k_asset_archive_magic[8] = {'P', 'A', 'O', 'P', 'A', 'K', '0', '1'};
+    static const uint32_t k_asset_archive_version = 1;
+    // Enough for SPIR-V, GPU copies and SIMD loads straight from the mapping
+    static const uint64_t k_asset_blob_alignment = 256;
+
+    struct AssetArchiveHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t entry_count;
+        uint64_t table_offset;
+        uint64_t file_size;
+    };
+
+    struct AssetArchiveEntry {
+        AssetId id;
+        uint64_t offset;
+        // Bytes stored in the archive
+        uint64_t stored_size;
+        // Bytes once decompressed
+        uint64_t size;
+        AssetCompression compression;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(AssetArchiveHeader) == 32, "The header is part of the file format");
+    static_assert(sizeof(AssetArchiveEntry) == 40, "Entries are part of the file format");
+
+    /// Bytes of one asset. Points into the archive's mapping for uncompressed
+    /// assets, so it is only valid while the archive is open.
+    ///
+    struct PAOPU_API AssetView {
+        const uint8_t* data{nullptr};
+        size_t size{0};
+
+        inline bool is_valid() const { return data != nullptr; }
+    };
+
+    /// Read-only archive of packed assets, opened once and memory mapped.
+    ///
+    /// Looking up an asset is a binary search over the entry table. Uncompressed
+    /// assets are used straight from the mapping (`get_view`) without a copy or
+    /// a syscall; the OS pages them in on first touch and keeps them in the page
+    /// cache. Compressed ones are decompressed by `load` into caller memory.
+    ///
+    class PAOPU_API AssetArchive {
+
+        public:
+            AssetArchive() = default;
+            ~AssetArchive();
+
+            AssetArchive(const AssetArchive&) = delete;
+            AssetArchive& operator=(const AssetArchive&) = delete;
+
+            /// Maps the archive at `path` and validates its header and table.
+            /// Throws if it can't be opened or isn't a valid archive.
+            ///
+            void open(const std::string& path);
+
+            void close();
+
+            /// The entry for `id`, nullptr if the archive doesn't have it
+            ///
+            ///
+            const AssetArchiveEntry* find(AssetId id) const;
+
+            /// The asset's bytes inside the mapping. Invalid if it is missing or
+            /// compressed, see `load`.
+            ///
+            AssetView get_view(AssetId id) const;
+
+            /// The asset's bytes, decompressed into `buffer` if needed. Returns a
+            /// view into either the mapping or `buffer`, invalid if it is missing
+            /// or corrupt.
+            ///
+            AssetView load(AssetId id, std::pmr::vector<uint8_t>& buffer) const;
+
+            /// Decompresses (or copies) the asset into `dst`, which must hold
+            /// `entry.size` bytes
+            ///
+            bool read(const AssetArchiveEntry& entry, void* dst) const;
+
+            /// Hints the OS to start paging in the asset's bytes
+            ///
+            ///
+            void prefetch(const AssetArchiveEntry& entry) const;
+
+            inline bool is_open() const { return mapping != nullptr; }
+            inline const std::string& get_path() const { return path; }
+            inline uint32_t get_entry_count() const { return entry_count; }
+            inline const AssetArchiveEntry* get_entries() const { return entries; }
+
+        private:
+            inline const uint8_t* get_stored(const AssetArchiveEntry& entry) const { return mapping + entry.offset; }
+
+        private:
+            std::string path;
+            const uint8_t* mapping{nullptr};
+            size_t mapping_size{0};
+            const AssetArchiveEntry* entries{nullptr};
+            uint32_t entry_count{0};
+
+        #ifdef PAO_PLATFORM_WINDOWS
+            void* file_handle{nullptr};
+            void* mapping_handle{nullptr};
+        #endif
+    };
+
+    /// Builds an archive. Assets are buffered until `write`, which sorts them,
+    /// lays out the blobs and writes the file in one go.
+    ///
+    class PAOPU_API AssetArchiveWriter {
+
+        public:
+            /// Adds `size` bytes as `name`. With `compress`, the asset is stored
+            /// LZ4 compressed unless that doesn't make it smaller.
+            ///
+            void add(const std::string& name, const void* data, size_t size, bool compress);
+
+            /// Adds the contents of the file at `path` as `name`. Returns false if
+            /// it can't be read.
+            ///
+            bool add_file(const std::string& name, const std::string& path, bool compress);
+
+            /// Writes the archive to `path`. Throws on duplicate names or if the
+            /// file can't be written.
+            ///
+            void write(const std::string& path);
+
+            inline size_t get_asset_count() const { return assets.size(); }
+
+        private:
+            struct PendingAsset {
+                std::string name;
+                AssetArchiveEntry entry;
+                std::vector<uint8_t> data;
+            };
+
+            std::vector<PendingAsset> assets;
+    };
+
+}
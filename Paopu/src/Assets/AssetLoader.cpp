@@ -0,0 +1,433 @@
+#include "AssetLoader.h"
+#include "Lz4.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Logger.h"
+#include "../Core/Profiler.h"
+
+#include <algorithm>
+
+namespace Paopu {
+
+    // Reads are split so a single one never exceeds what read(2) returns in one go
+    static const uint64_t k_max_read_size = 1ull << 30;
+    static const uint32_t k_max_completions = 64;
+
+    struct AssetLoadRequest {
+        AssetRequestId id{k_invalid_asset_request};
+        AssetPriority priority{AssetPriority::Nearby};
+        AssetLoadDesc desc;
+
+        // Loose files own their file, archive loads share the archive's
+        std::string path;
+        const AssetArchive* archive{nullptr};
+        AssetId asset_id{0};
+        AssetArchiveEntry entry{};
+        AsyncFile file;
+
+        uint64_t offset{0};
+        uint64_t size{0};
+        uint64_t bytes_read{0};
+        std::vector<uint8_t> stored;
+
+        // Taken off the pending queues, so it can't be moved or dropped anymore
+        bool reading{false};
+        std::atomic<bool> cancelled{false};
+
+        AssetLoadResult result;
+    };
+
+    AssetLoader::AssetLoader() = default;
+
+    AssetLoader::~AssetLoader() {
+        shutdown();
+    }
+
+    void AssetLoader::init(const AssetLoaderSettings& loader_settings) {
+        shutdown();
+
+        settings = loader_settings;
+        settings.queue_depth = std::max(1u, settings.queue_depth);
+        reader = AsyncReader::create(settings.queue_depth, settings.fallback_threads, settings.use_io_uring);
+        running = true;
+        thread = std::thread([this]() { loader_main(); });
+
+        PAO_CORE_INFO("[Assets][Loader]: Reading through {}", reader->get_name());
+    }
+
+    void AssetLoader::shutdown() {
+        if(!thread.joinable()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            for(std::deque<AssetLoadRequest*>& queue : pending) {
+                queue.clear();
+            }
+        }
+        wake_condition.notify_all();
+        thread.join();
+
+        // Decode jobs still hold their requests
+        while(decoding.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+
+        for(auto& archive_file : archive_files) {
+            close_async_file(archive_file.second);
+        }
+        archive_files.clear();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto& entry : requests) {
+            close_async_file(entry.second->file);
+        }
+        requests.clear();
+        finished.clear();
+        in_flight = 0;
+        reader.reset();
+    }
+
+    AssetRequestId AssetLoader::load_file(const std::string& path, const AssetLoadDesc& desc) {
+        std::unique_ptr<AssetLoadRequest> request = std::make_unique<AssetLoadRequest>();
+        request->path = path;
+        return queue_request(std::move(request), desc);
+    }
+
+    AssetRequestId AssetLoader::load_asset(const AssetArchive& archive, AssetId id, const AssetLoadDesc& desc) {
+        std::unique_ptr<AssetLoadRequest> request = std::make_unique<AssetLoadRequest>();
+        request->asset_id = id;
+
+        // Missing assets still go through the queue, with neither a path nor an
+        // archive they fail like any other unreadable file
+        if(const AssetArchiveEntry* entry = archive.find(id)) {
+            request->archive = &archive;
+            request->entry = *entry;
+        }
+        return queue_request(std::move(request), desc);
+    }
+
+    AssetRequestId AssetLoader::queue_request(std::unique_ptr<AssetLoadRequest> request, const AssetLoadDesc& desc) {
+        request->desc = desc;
+        request->priority = desc.priority;
+        request->result.user_data = desc.user_data;
+
+        AssetRequestId id;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!running) return k_invalid_asset_request;
+
+            id = next_id++;
+            if(next_id == k_invalid_asset_request) next_id++;
+
+            request->id = id;
+            request->result.id = id;
+            pending[static_cast<uint32_t>(request->priority)].push_back(request.get());
+            requests[id] = std::move(request);
+        }
+        wake_condition.notify_one();
+        return id;
+    }
+
+    /// Removes `request` from its pending queue
+    static void remove_pending(std::deque<AssetLoadRequest*>& queue, AssetLoadRequest* request) {
+        auto found = std::find(queue.begin(), queue.end(), request);
+        if(found != queue.end()) {
+            queue.erase(found);
+        }
+    }
+
+    void AssetLoader::set_priority(AssetRequestId id, AssetPriority priority) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = requests.find(id);
+        if(found == requests.end()) return;
+
+        AssetLoadRequest* request = found->second.get();
+        if(!request->reading && request->priority != priority) {
+            remove_pending(pending[static_cast<uint32_t>(request->priority)], request);
+            pending[static_cast<uint32_t>(priority)].push_back(request);
+        }
+        request->priority = priority;
+    }
+
+    bool AssetLoader::cancel(AssetRequestId id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = requests.find(id);
+        if(found == requests.end()) return false;
+
+        AssetLoadRequest* request = found->second.get();
+        if(!request->reading) {
+            remove_pending(pending[static_cast<uint32_t>(request->priority)], request);
+            requests.erase(found);
+            stats.cancelled++;
+            return true;
+        }
+
+        // Reading or decoding, the result is dropped once it's done
+        if(request->cancelled.exchange(true, std::memory_order_relaxed)) return false;
+        stats.cancelled++;
+        return true;
+    }
+
+    void AssetLoader::update() {
+        PAO_PROFILE_FUNCTION();
+
+        // Pulled out under the lock, callbacks run without it
+        std::unique_ptr<AssetLoadRequest> delivered[k_max_completions];
+        uint32_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint32_t limit = std::min(settings.max_callbacks_per_update, k_max_completions);
+            uint32_t taken = std::min<uint32_t>(limit, static_cast<uint32_t>(finished.size()));
+
+            for(uint32_t i = 0; i < taken; i++) {
+                AssetLoadRequest* request = finished[i];
+                auto found = requests.find(request->id);
+                delivered[count++] = std::move(found->second);
+                requests.erase(found);
+            }
+            finished.erase(finished.begin(), finished.begin() + taken);
+        }
+
+        uint64_t loaded = 0;
+        uint64_t failed = 0;
+        for(uint32_t i = 0; i < count; i++) {
+            AssetLoadRequest* request = delivered[i].get();
+            if(request->cancelled.load(std::memory_order_relaxed)) continue;
+
+            if(request->result.status == AssetLoadStatus::Loaded) {
+                loaded++;
+            } else if(request->path.empty()) {
+                failed++;
+                PAO_CORE_WARN("[Assets][Loader]: Failed to load archive asset {}", request->asset_id);
+            } else {
+                failed++;
+                PAO_CORE_WARN("[Assets][Loader]: Failed to load {}", request->path);
+            }
+
+            if(request->desc.on_loaded != nullptr) {
+                request->desc.on_loaded(request->result);
+            }
+        }
+
+        if(count > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.loaded += loaded;
+            stats.failed += failed;
+        }
+    }
+
+    AssetLoaderStats AssetLoader::get_stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        AssetLoaderStats current = stats;
+        for(const std::deque<AssetLoadRequest*>& queue : pending) {
+            current.pending += static_cast<uint32_t>(queue.size());
+        }
+        current.in_flight = in_flight;
+        return current;
+    }
+
+    const char* AssetLoader::get_backend_name() const {
+        return reader ? reader->get_name() : "";
+    }
+
+    // --------------------------------------------------------------------
+    //                          - Loader thread -
+    // --------------------------------------------------------------------
+
+    void AssetLoader::loader_main() {
+        PAO_PROFILE_THREAD("Asset loader");
+
+        std::vector<AssetLoadRequest*> batch;
+        batch.reserve(settings.queue_depth);
+        AsyncReadResult results[k_max_completions];
+
+        for(;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // Sleep until there's something to submit or a read to collect
+                wake_condition.wait(lock, [this]() {
+                    bool can_submit = in_flight < settings.queue_depth
+                        && (!pending[0].empty() || !pending[1].empty() || !pending[2].empty());
+                    return !running || can_submit || reader->get_in_flight() > 0;
+                });
+
+                if(!running) break;
+                take_pending(batch);
+            }
+
+            submit_reads(batch);
+            batch.clear();
+
+            // Blocks in the kernel until a read is done; new requests wait for that
+            uint32_t count = reader->wait(results, k_max_completions, reader->get_in_flight() > 0);
+            for(uint32_t i = 0; i < count; i++) {
+                complete_read(reinterpret_cast<AssetLoadRequest*>(results[i].user_data), results[i].result);
+            }
+        }
+
+        // The buffers can't go away under reads that are still running
+        while(reader->get_in_flight() > 0) {
+            uint32_t count = reader->wait(results, k_max_completions, true);
+            for(uint32_t i = 0; i < count; i++) {
+                AssetLoadRequest* request = reinterpret_cast<AssetLoadRequest*>(results[i].user_data);
+                request->cancelled.store(true, std::memory_order_relaxed);
+                finish(request, AssetLoadStatus::Failed);
+            }
+        }
+    }
+
+    void AssetLoader::take_pending(std::vector<AssetLoadRequest*>& batch) {
+        for(std::deque<AssetLoadRequest*>& queue : pending) {
+            while(in_flight < settings.queue_depth && !queue.empty()) {
+                AssetLoadRequest* request = queue.front();
+                queue.pop_front();
+
+                request->reading = true;
+                in_flight++;
+                batch.push_back(request);
+            }
+        }
+    }
+
+    /// The next chunk of `request` that hasn't been read yet
+    static AsyncRead make_read(AssetLoadRequest* request) {
+        AsyncRead read;
+        read.file = request->file;
+        read.offset = request->offset + request->bytes_read;
+        read.dst = request->stored.data() + request->bytes_read;
+        read.size = static_cast<uint32_t>(std::min(request->size - request->bytes_read, k_max_read_size));
+        read.user_data = reinterpret_cast<uint64_t>(request);
+        return read;
+    }
+
+    void AssetLoader::submit_reads(std::vector<AssetLoadRequest*>& batch) {
+        if(batch.empty()) return;
+        PAO_PROFILE_SCOPE("Submit asset reads");
+
+        std::vector<AsyncRead> reads;
+        reads.reserve(batch.size());
+
+        for(AssetLoadRequest* request : batch) {
+            if(request->cancelled.load(std::memory_order_relaxed)) {
+                finish(request, AssetLoadStatus::Failed);
+                continue;
+            }
+
+            if(request->archive != nullptr) {
+                request->file = get_archive_file(request->archive);
+                request->offset = request->entry.offset;
+                request->size = request->entry.stored_size;
+            } else if(!request->path.empty()) {
+                request->file = open_async_file(request->path);
+                request->size = request->file.size;
+            }
+
+            if(!request->file.is_open()) {
+                finish(request, AssetLoadStatus::Failed);
+                continue;
+            }
+
+            request->stored.resize(static_cast<size_t>(request->size));
+            if(request->size == 0) {
+                complete_read(request, 0);
+                continue;
+            }
+            reads.push_back(make_read(request));
+        }
+
+        // At most one read per slot, so this always fits
+        if(!reads.empty() && !reader->submit(reads.data(), static_cast<uint32_t>(reads.size()))) {
+            for(const AsyncRead& read : reads) {
+                finish(reinterpret_cast<AssetLoadRequest*>(read.user_data), AssetLoadStatus::Failed);
+            }
+        }
+    }
+
+    void AssetLoader::complete_read(AssetLoadRequest* request, int64_t result) {
+        if(result > 0) {
+            request->bytes_read += static_cast<uint64_t>(result);
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.bytes_read += static_cast<uint64_t>(result);
+        }
+
+        bool done = request->bytes_read == request->size;
+        if(result < 0 || (result == 0 && !done)) {
+            // An error, or the file is shorter than it was
+            finish(request, AssetLoadStatus::Failed);
+            return;
+        }
+
+        if(!done) {
+            AsyncRead read = make_read(request);
+            if(!reader->submit(&read, 1)) {
+                finish(request, AssetLoadStatus::Failed);
+            }
+            return;
+        }
+
+        // The loader thread shouldn't decode while workers can
+        if(JobSystem::get_worker_count() > 1) {
+            decoding.fetch_add(1, std::memory_order_relaxed);
+            JobSystem::run([this, request]() {
+                decode(request);
+                decoding.fetch_sub(1, std::memory_order_release);
+            });
+        } else {
+            decode(request);
+        }
+    }
+
+    void AssetLoader::decode(AssetLoadRequest* request) {
+        PAO_PROFILE_FUNCTION();
+
+        if(request->cancelled.load(std::memory_order_relaxed)) {
+            finish(request, AssetLoadStatus::Failed);
+            return;
+        }
+
+        AssetLoadResult& result = request->result;
+        if(request->archive != nullptr && request->entry.compression == AssetCompression::Lz4) {
+            result.data.resize(static_cast<size_t>(request->entry.size));
+            if(!lz4_decompress(request->stored.data(), request->stored.size(), result.data.data(), result.data.size())) {
+                finish(request, AssetLoadStatus::Failed);
+                return;
+            }
+            request->stored = {};
+        } else {
+            result.data = std::move(request->stored);
+        }
+
+        if(request->desc.decode != nullptr && !request->desc.decode(result)) {
+            finish(request, AssetLoadStatus::Failed);
+            return;
+        }
+
+        finish(request, AssetLoadStatus::Loaded);
+    }
+
+    void AssetLoader::finish(AssetLoadRequest* request, AssetLoadStatus status) {
+        // Archive files stay open for the next load
+        if(request->archive == nullptr) {
+            close_async_file(request->file);
+        }
+        request->result.status = status;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            in_flight--;
+            finished.push_back(request);
+        }
+        // A slot opened up
+        wake_condition.notify_one();
+    }
+
+    AsyncFile AssetLoader::get_archive_file(const AssetArchive* archive) {
+        for(auto& archive_file : archive_files) {
+            if(archive_file.first == archive) return archive_file.second;
+        }
+
+        archive_files.emplace_back(archive, open_async_file(archive->get_path()));
+        return archive_files.back().second;
+    }
+
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include "../Core/Core.h"
+#include "AssetArchive.h"
+#include "AsyncReader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Paopu {
+
+    // Forward Declarations
+    struct AssetLoadRequest;
+
+    /// Lower loads first. Loads already reading keep going when something
+    /// more important comes in, pending ones wait behind it.
+    ///
+    enum class AssetPriority : uint8_t {
+        Visible = 0,
+        Nearby = 1,
+        Background = 2
+    };
+
+    static const uint32_t k_asset_priority_count = 3;
+
+    enum class AssetLoadStatus : uint8_t {
+        Loaded,
+        Failed
+    };
+
+    using AssetRequestId = uint32_t;
+    static const AssetRequestId k_invalid_asset_request = 0;
+
+    /// A finished load. `data` holds the asset's bytes, decompressed; a decode
+    /// function may replace them with whatever it decoded.
+    ///
+    struct PAOPU_API AssetLoadResult {
+        AssetRequestId id{k_invalid_asset_request};
+        AssetLoadStatus status{AssetLoadStatus::Failed};
+        std::vector<uint8_t> data;
+        void* user_data{nullptr};
+    };
+
+    /// Runs on the job system once the bytes are in. Returns false if the
+    /// asset couldn't be decoded.
+    using AssetDecodeFn = bool(*)(AssetLoadResult& result);
+    /// Runs on the frame thread from `AssetLoader::update`, where GPU uploads
+    /// and anything else touching engine state belongs.
+    using AssetLoadedFn = void(*)(AssetLoadResult& result);
+
+    /// `priority`: See AssetPriority
+    /// `decode`: Optional, see AssetDecodeFn
+    /// `on_loaded`: Optional, see AssetLoadedFn. Also called for failed loads.
+    /// `user_data`: Handed to both through the result
+    struct PAOPU_API AssetLoadDesc {
+        AssetPriority priority{AssetPriority::Nearby};
+        AssetDecodeFn decode{nullptr};
+        AssetLoadedFn on_loaded{nullptr};
+        void* user_data{nullptr};
+    };
+
+    /// `queue_depth`: Loads reading or decoding at once
+    /// `fallback_threads`: Reader threads when io_uring isn't available
+    /// `use_io_uring`: Set to false to always use the thread pool
+    /// `max_callbacks_per_update`: Bounds the work `update` does in a frame
+    struct PAOPU_API AssetLoaderSettings {
+        uint32_t queue_depth{32};
+        uint32_t fallback_threads{2};
+        bool use_io_uring{true};
+        uint32_t max_callbacks_per_update{32};
+    };
+
+    /// `loaded` and `failed` count loads delivered by `update`
+    ///
+    ///
+    struct PAOPU_API AssetLoaderStats {
+        uint32_t pending{0};
+        uint32_t in_flight{0};
+        uint64_t loaded{0};
+        uint64_t failed{0};
+        uint64_t cancelled{0};
+        uint64_t bytes_read{0};
+    };
+
+    /// Streams assets in without blocking the frame.
+    ///
+    /// Requests are queued by priority. A loader thread reads them in batches
+    /// through an AsyncReader (io_uring on Linux, a thread pool otherwise),
+    /// LZ4 blobs are decompressed and `decode` runs on the job system, and
+    /// finished loads are handed back to the frame thread in `update`.
+    ///
+    /// Requests can be made and cancelled from any thread. `update` belongs to
+    /// the frame thread.
+    class PAOPU_API AssetLoader {
+
+        public:
+            AssetLoader();
+            ~AssetLoader();
+
+            AssetLoader(const AssetLoader&) = delete;
+            AssetLoader& operator=(const AssetLoader&) = delete;
+
+            /// Starts the loader thread. Decoding uses the job system when it has
+            /// more than one worker, and the loader thread otherwise.
+            ///
+            void init(const AssetLoaderSettings& settings = {});
+
+            /// Drops everything pending, waits for loads in flight and stops the
+            /// loader thread. Callbacks of unfinished loads are never called.
+            ///
+            void shutdown();
+
+            /// Loads a whole loose file
+            ///
+            ///
+            AssetRequestId load_file(const std::string& path, const AssetLoadDesc& desc);
+
+            /// Loads asset `id` from `archive`, which must stay open until the load
+            /// is done. Reads go through the loader rather than the mapping, so
+            /// page faults never land on the caller.
+            ///
+            AssetRequestId load_asset(const AssetArchive& archive, AssetId id, const AssetLoadDesc& desc);
+
+            /// Moves a load that hasn't started reading to another priority
+            ///
+            ///
+            void set_priority(AssetRequestId id, AssetPriority priority);
+
+            /// Cancels a load. Pending loads are dropped; ones already reading
+            /// finish in the background and are discarded. Returns false if it
+            /// had already been delivered (or never existed).
+            ///
+            bool cancel(AssetRequestId id);
+
+            /// Calls `on_loaded` for up to `max_callbacks_per_update` finished
+            /// loads. Never waits on I/O.
+            ///
+            void update();
+
+            AssetLoaderStats get_stats() const;
+
+            /// "io_uring" or "thread pool", empty before `init`
+            ///
+            ///
+            const char* get_backend_name() const;
+
+        private:
+            AssetRequestId queue_request(std::unique_ptr<AssetLoadRequest> request, const AssetLoadDesc& desc);
+
+            /// Loader thread: submits pending reads and handles completions
+            ///
+            ///
+            void loader_main();
+
+            /// Moves as many pending requests as the queue depth allows into
+            /// `batch`, highest priority first. Called with `mutex` held.
+            ///
+            void take_pending(std::vector<AssetLoadRequest*>& batch);
+
+            void submit_reads(std::vector<AssetLoadRequest*>& batch);
+            void complete_read(AssetLoadRequest* request, int64_t result);
+
+            /// Decompresses and decodes, then queues the result for `update`
+            ///
+            ///
+            void decode(AssetLoadRequest* request);
+            void finish(AssetLoadRequest* request, AssetLoadStatus status);
+
+            AsyncFile get_archive_file(const AssetArchive* archive);
+
+        private:
+            AssetLoaderSettings settings;
+            std::unique_ptr<AsyncReader> reader;
+            std::thread thread;
+            bool running{false};
+
+            mutable std::mutex mutex;
+            std::condition_variable wake_condition;
+            std::unordered_map<AssetRequestId, std::unique_ptr<AssetLoadRequest>> requests;
+            std::deque<AssetLoadRequest*> pending[k_asset_priority_count];
+            std::vector<AssetLoadRequest*> finished;
+            uint32_t in_flight{0};
+            AssetRequestId next_id{1};
+            AssetLoaderStats stats;
+
+            // Loader thread only
+            std::vector<std::pair<const AssetArchive*, AsyncFile>> archive_files;
+
+            // Decodes still running on the job system
+            std::atomic<uint32_t> decoding{0};
+    };
+
+}
@@ -0,0 +1,396 @@
+#include "AsyncReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef PAO_PLATFORM_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(PAO_PLATFORM_LINUX) && __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #define PAO_ASSETS_IO_URING
+#endif
+
+namespace Paopu {
+
+    // --------------------------------------------------------------------
+    //                             - Files -
+    // --------------------------------------------------------------------
+
+    bool AsyncFile::is_open() const {
+    #ifdef PAO_PLATFORM_WINDOWS
+        return handle != nullptr;
+    #else
+        return fd >= 0;
+    #endif
+    }
+
+    AsyncFile open_async_file(const std::string& path) {
+        AsyncFile file;
+
+    #ifdef PAO_PLATFORM_WINDOWS
+        HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if(handle == INVALID_HANDLE_VALUE) return file;
+        if(!GetFileSizeEx(handle, &size)) {
+            CloseHandle(handle);
+            return file;
+        }
+        file.handle = handle;
+        file.size = static_cast<uint64_t>(size.QuadPart);
+    #else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info;
+        if(fd < 0) return file;
+        if(fstat(fd, &info) != 0) {
+            ::close(fd);
+            return file;
+        }
+        file.fd = fd;
+        file.size = static_cast<uint64_t>(info.st_size);
+    #endif
+
+        return file;
+    }
+
+    void close_async_file(AsyncFile& file) {
+        if(!file.is_open()) return;
+
+    #ifdef PAO_PLATFORM_WINDOWS
+        CloseHandle(file.handle);
+        file.handle = nullptr;
+    #else
+        ::close(file.fd);
+        file.fd = -1;
+    #endif
+        file.size = 0;
+    }
+
+    /// Plain blocking read, returns the bytes read or a negative error
+    static int64_t read_blocking(const AsyncRead& read) {
+    #ifdef PAO_PLATFORM_WINDOWS
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(read.offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(read.offset >> 32);
+        DWORD bytes_read = 0;
+        if(!ReadFile(read.file.handle, read.dst, read.size, &bytes_read, &overlapped) && GetLastError() != ERROR_HANDLE_EOF) {
+            return -static_cast<int64_t>(GetLastError());
+        }
+        return bytes_read;
+    #else
+        ssize_t bytes_read;
+        do {
+            bytes_read = pread(read.file.fd, read.dst, read.size, static_cast<off_t>(read.offset));
+        } while(bytes_read < 0 && errno == EINTR);
+        return bytes_read < 0 ? -static_cast<int64_t>(errno) : bytes_read;
+    #endif
+    }
+
+    // --------------------------------------------------------------------
+    //                          - Thread pool -
+    // --------------------------------------------------------------------
+
+    /// Blocking reads on a few threads, for platforms and kernels without io_uring
+    class ThreadPoolReader : public AsyncReader {
+
+        public:
+            ThreadPoolReader(uint32_t queue_depth, uint32_t thread_count) : queue_depth(queue_depth) {
+                for(uint32_t i = 0; i < std::max(1u, thread_count); i++) {
+                    threads.emplace_back([this]() { thread_main(); });
+                }
+            }
+
+            ~ThreadPoolReader() override {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    running = false;
+                }
+                work_condition.notify_all();
+                for(std::thread& thread : threads) {
+                    thread.join();
+                }
+            }
+
+            bool submit(const AsyncRead* reads, uint32_t count) override {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if(in_flight + count > queue_depth) return false;
+
+                    pending.insert(pending.end(), reads, reads + count);
+                    in_flight += count;
+                }
+                work_condition.notify_all();
+                return true;
+            }
+
+            uint32_t wait(AsyncReadResult* results, uint32_t max_results, bool block) override {
+                std::unique_lock<std::mutex> lock(mutex);
+                if(block) {
+                    done_condition.wait(lock, [this]() { return !completed.empty() || in_flight == 0; });
+                }
+
+                uint32_t count = 0;
+                while(count < max_results && !completed.empty()) {
+                    results[count++] = completed.front();
+                    completed.pop_front();
+                    in_flight--;
+                }
+                return count;
+            }
+
+            uint32_t get_in_flight() const override {
+                std::lock_guard<std::mutex> lock(mutex);
+                return in_flight;
+            }
+
+            const char* get_name() const override { return "thread pool"; }
+
+        private:
+            void thread_main() {
+                std::unique_lock<std::mutex> lock(mutex);
+                for(;;) {
+                    work_condition.wait(lock, [this]() { return !pending.empty() || !running; });
+                    if(pending.empty()) return;
+
+                    AsyncRead read = pending.front();
+                    pending.pop_front();
+
+                    lock.unlock();
+                    int64_t result = read_blocking(read);
+                    lock.lock();
+
+                    completed.push_back({read.user_data, result});
+                    done_condition.notify_one();
+                }
+            }
+
+        private:
+            const uint32_t queue_depth;
+
+            mutable std::mutex mutex;
+            std::condition_variable work_condition;
+            std::condition_variable done_condition;
+            std::deque<AsyncRead> pending;
+            std::deque<AsyncReadResult> completed;
+            uint32_t in_flight{0};
+            bool running{true};
+
+            std::vector<std::thread> threads;
+    };
+
+    // --------------------------------------------------------------------
+    //                            - io_uring -
+    // --------------------------------------------------------------------
+
+#ifdef PAO_ASSETS_IO_URING
+
+    // Raw syscalls so there's no dependency on liburing
+    static inline int io_uring_setup(uint32_t entries, io_uring_params* params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    static inline int io_uring_enter(int ring_fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    static inline int io_uring_register(int ring_fd, uint32_t opcode, void* arg, uint32_t arg_count) {
+        return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, arg_count));
+    }
+
+    /// One submission and one completion ring shared with the kernel. Reads are
+    /// queued with plain stores into the mapped rings; a single io_uring_enter
+    /// submits a whole batch and, when blocking, waits for a completion.
+    class IoUringReader : public AsyncReader {
+
+        public:
+            ~IoUringReader() override {
+                if(sqes != nullptr) munmap(sqes, sqes_size);
+                if(cq_ring != nullptr && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+                if(sq_ring != nullptr) munmap(sq_ring, sq_ring_size);
+                if(ring_fd >= 0) ::close(ring_fd);
+            }
+
+            /// False if the kernel doesn't have io_uring or IORING_OP_READ
+            bool init(uint32_t queue_depth) {
+                io_uring_params params;
+                memset(&params, 0, sizeof(params));
+
+                ring_fd = io_uring_setup(queue_depth, &params);
+                if(ring_fd < 0) return false;
+
+                sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+                cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if(single_mmap) {
+                    sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+                }
+
+                sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+                if(sq_ring == MAP_FAILED) {
+                    sq_ring = nullptr;
+                    return false;
+                }
+
+                cq_ring = single_mmap ? sq_ring : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+                if(cq_ring == MAP_FAILED) {
+                    cq_ring = nullptr;
+                    return false;
+                }
+
+                sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                void* sqes_mapping = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+                if(sqes_mapping == MAP_FAILED) return false;
+                sqes = static_cast<io_uring_sqe*>(sqes_mapping);
+
+                uint8_t* sq = static_cast<uint8_t*>(sq_ring);
+                sq_head = reinterpret_cast<std::atomic<uint32_t>*>(sq + params.sq_off.head);
+                sq_tail = reinterpret_cast<std::atomic<uint32_t>*>(sq + params.sq_off.tail);
+                sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+                sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+                uint8_t* cq = static_cast<uint8_t*>(cq_ring);
+                cq_head = reinterpret_cast<std::atomic<uint32_t>*>(cq + params.cq_off.head);
+                cq_tail = reinterpret_cast<std::atomic<uint32_t>*>(cq + params.cq_off.tail);
+                cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+                cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+                // Sized by the kernel, may be rounded up from what was asked for
+                capacity = std::min(params.sq_entries, params.cq_entries);
+
+                return supports_read();
+            }
+
+            bool submit(const AsyncRead* reads, uint32_t count) override {
+                if(in_flight + count > capacity) return false;
+
+                uint32_t tail = sq_tail->load(std::memory_order_relaxed);
+                for(uint32_t i = 0; i < count; i++) {
+                    const AsyncRead& read = reads[i];
+                    uint32_t index = tail & sq_mask;
+
+                    io_uring_sqe& sqe = sqes[index];
+                    memset(&sqe, 0, sizeof(sqe));
+                    sqe.opcode = IORING_OP_READ;
+                    sqe.fd = read.file.fd;
+                    sqe.off = read.offset;
+                    sqe.addr = reinterpret_cast<uint64_t>(read.dst);
+                    sqe.len = read.size;
+                    sqe.user_data = read.user_data;
+
+                    sq_array[index] = index;
+                    tail++;
+                }
+                // The kernel reads the entries once it sees the new tail
+                sq_tail->store(tail, std::memory_order_release);
+                in_flight += count;
+
+                // Entries the kernel couldn't take yet (EAGAIN, EBUSY) stay in
+                // the ring and go out with the next enter
+                io_uring_enter(ring_fd, get_unsubmitted(), 0, 0);
+                return true;
+            }
+
+            uint32_t wait(AsyncReadResult* results, uint32_t max_results, bool block) override {
+                uint32_t count = reap(results, max_results);
+                if(count > 0 || !block || in_flight == 0) return count;
+
+                while(count == 0) {
+                    int result = io_uring_enter(ring_fd, get_unsubmitted(), 1, IORING_ENTER_GETEVENTS);
+                    if(result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) break;
+                    count = reap(results, max_results);
+                }
+                return count;
+            }
+
+            uint32_t get_in_flight() const override { return in_flight; }
+
+            const char* get_name() const override { return "io_uring"; }
+
+        private:
+            inline uint32_t get_unsubmitted() const {
+                return sq_tail->load(std::memory_order_relaxed) - sq_head->load(std::memory_order_acquire);
+            }
+
+            uint32_t reap(AsyncReadResult* results, uint32_t max_results) {
+                uint32_t head = cq_head->load(std::memory_order_relaxed);
+                uint32_t tail = cq_tail->load(std::memory_order_acquire);
+
+                uint32_t count = 0;
+                while(head != tail && count < max_results) {
+                    const io_uring_cqe& cqe = cqes[head & cq_mask];
+                    results[count++] = {cqe.user_data, cqe.res};
+                    head++;
+                }
+
+                // Hands the slots back to the kernel
+                cq_head->store(head, std::memory_order_release);
+                in_flight -= count;
+                return count;
+            }
+
+            bool supports_read() {
+                // IORING_REGISTER_PROBE and IORING_OP_READ both arrived in 5.6
+                const uint32_t k_probe_ops = 64;
+                std::vector<uint8_t> storage(sizeof(io_uring_probe) + k_probe_ops * sizeof(io_uring_probe_op), 0);
+                io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+
+                if(io_uring_register(ring_fd, IORING_REGISTER_PROBE, probe, k_probe_ops) < 0) return false;
+                return IORING_OP_READ <= probe->last_op && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0;
+            }
+
+        private:
+            int ring_fd{-1};
+            uint32_t capacity{0};
+            uint32_t in_flight{0};
+
+            void* sq_ring{nullptr};
+            void* cq_ring{nullptr};
+            size_t sq_ring_size{0};
+            size_t cq_ring_size{0};
+            io_uring_sqe* sqes{nullptr};
+            size_t sqes_size{0};
+
+            std::atomic<uint32_t>* sq_head{nullptr};
+            std::atomic<uint32_t>* sq_tail{nullptr};
+            uint32_t sq_mask{0};
+            uint32_t* sq_array{nullptr};
+
+            std::atomic<uint32_t>* cq_head{nullptr};
+            std::atomic<uint32_t>* cq_tail{nullptr};
+            uint32_t cq_mask{0};
+            io_uring_cqe* cqes{nullptr};
+    };
+
+#endif
+
+    std::unique_ptr<AsyncReader> AsyncReader::create(uint32_t queue_depth, uint32_t fallback_threads, bool allow_io_uring) {
+    #ifdef PAO_ASSETS_IO_URING
+        if(allow_io_uring) {
+            std::unique_ptr<IoUringReader> reader = std::make_unique<IoUringReader>();
+            if(reader->init(queue_depth)) {
+                return reader;
+            }
+        }
+    #endif
+
+        return std::make_unique<ThreadPoolReader>(queue_depth, fallback_threads);
+    }
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Paopu {
+
+    /// A file opened for asynchronous reads, see `open_async_file`
+    ///
+    ///
+    struct PAOPU_API AsyncFile {
+    #ifdef PAO_PLATFORM_WINDOWS
+        void* handle{nullptr};
+    #else
+        int fd{-1};
+    #endif
+        uint64_t size{0};
+
+        bool is_open() const;
+    };
+
+    /// Opens `path` for reading. Check `is_open` on the result.
+    ///
+    ///
+    PAOPU_API AsyncFile open_async_file(const std::string& path);
+
+    PAOPU_API void close_async_file(AsyncFile& file);
+
+    /// One read of `size` bytes at `offset` into `dst`
+    ///
+    ///
+    struct AsyncRead {
+        AsyncFile file;
+        uint64_t offset{0};
+        void* dst{nullptr};
+        uint32_t size{0};
+        uint64_t user_data{0};
+    };
+
+    /// `result` is the number of bytes read, or a negative error code. Reads
+    /// can come back short; it's up to the caller to read the rest.
+    ///
+    struct AsyncReadResult {
+        uint64_t user_data{0};
+        int64_t result{0};
+    };
+
+    /// Batched asynchronous file reads. `submit` and `wait` are meant to be
+    /// called from a single thread.
+    ///
+    class PAOPU_API AsyncReader {
+
+        public:
+            virtual ~AsyncReader() = default;
+
+            /// Queues `count` reads. Never blocks; returns false if more than
+            /// the queue depth would be in flight.
+            ///
+            virtual bool submit(const AsyncRead* reads, uint32_t count) = 0;
+
+            /// Fills `results` with up to `max_results` finished reads and returns
+            /// how many. Blocks until at least one is done if `block` is set and
+            /// reads are in flight.
+            ///
+            virtual uint32_t wait(AsyncReadResult* results, uint32_t max_results, bool block) = 0;
+
+            virtual uint32_t get_in_flight() const = 0;
+
+            /// "io_uring" or "thread pool"
+            ///
+            ///
+            virtual const char* get_name() const = 0;
+
+            /// io_uring where the kernel supports it (Linux 5.6+, and not blocked
+            /// by a seccomp policy), a pool of `fallback_threads` doing blocking
+            /// reads otherwise.
+            ///
+            static std::unique_ptr<AsyncReader> create(uint32_t queue_depth, uint32_t fallback_threads, bool allow_io_uring = true);
+    };
+
+}
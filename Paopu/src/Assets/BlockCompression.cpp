@@ -0,0 +1,336 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Paopu {
+
+    static inline uint16_t pack_565(const float* color) {
+        int r = static_cast<int>(std::min(std::max(color[0], 0.0f), 255.0f) * (31.0f / 255.0f) + 0.5f);
+        int g = static_cast<int>(std::min(std::max(color[1], 0.0f), 255.0f) * (63.0f / 255.0f) + 0.5f);
+        int b = static_cast<int>(std::min(std::max(color[2], 0.0f), 255.0f) * (31.0f / 255.0f) + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    /// Expands a 565 color to 8 bits per channel the way GPUs do, by bit replication
+    static inline void unpack_565(uint16_t packed, int* color) {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    /// The four colors of a 4-color block, in index order
+    static inline void build_palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for(int channel = 0; channel < 3; channel++) {
+            palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+            palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+        }
+    }
+
+    /// Picks the nearest palette entry for every texel. Returns the packed
+    /// indices and writes the total squared error to `error`.
+    static uint32_t pick_indices(const float colors[16][3], uint16_t c0, uint16_t c1, float& error) {
+        int palette[4][3];
+        build_palette(c0, c1, palette);
+
+        uint32_t indices = 0;
+        error = 0.0f;
+        for(int i = 0; i < 16; i++) {
+            float best = 1e30f;
+            uint32_t best_index = 0;
+            for(uint32_t entry = 0; entry < 4; entry++) {
+                float dr = colors[i][0] - palette[entry][0];
+                float dg = colors[i][1] - palette[entry][1];
+                float db = colors[i][2] - palette[entry][2];
+                float distance = dr * dr + dg * dg + db * db;
+                if(distance < best) {
+                    best = distance;
+                    best_index = entry;
+                }
+            }
+            indices |= best_index << (2 * i);
+            error += best;
+        }
+        return indices;
+    }
+
+    /// Least squares endpoints for fixed indices. Returns false if the
+    /// indices don't pin both endpoints down.
+    static bool refit_endpoints(const float colors[16][3], uint32_t indices, float* e0, float* e1) {
+        static const float k_weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[3] = {0.0f, 0.0f, 0.0f};
+        float bx[3] = {0.0f, 0.0f, 0.0f};
+        for(int i = 0; i < 16; i++) {
+            float a = k_weights[(indices >> (2 * i)) & 3];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for(int channel = 0; channel < 3; channel++) {
+                ax[channel] += a * colors[i][channel];
+                bx[channel] += b * colors[i][channel];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if(std::abs(determinant) < 1e-6f) return false;
+
+        float inverse = 1.0f / determinant;
+        for(int channel = 0; channel < 3; channel++) {
+            e0[channel] = (ax[channel] * bb - bx[channel] * ab) * inverse;
+            e1[channel] = (bx[channel] * aa - ax[channel] * ab) * inverse;
+        }
+        return true;
+    }
+
+    /// BC1 color block: endpoints along the block's principal axis, then one
+    /// least squares refinement
+    static void encode_color_block(const uint8_t* rgba, uint8_t* block) {
+        float colors[16][3];
+        float mean[3] = {0.0f, 0.0f, 0.0f};
+        for(int i = 0; i < 16; i++) {
+            for(int channel = 0; channel < 3; channel++) {
+                colors[i][channel] = rgba[i * 4 + channel];
+                mean[channel] += colors[i][channel];
+            }
+        }
+        for(int channel = 0; channel < 3; channel++) {
+            mean[channel] /= 16.0f;
+        }
+
+        float covariance[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        for(int i = 0; i < 16; i++) {
+            float r = colors[i][0] - mean[0];
+            float g = colors[i][1] - mean[1];
+            float b = colors[i][2] - mean[2];
+            covariance[0] += r * r;
+            covariance[1] += r * g;
+            covariance[2] += r * b;
+            covariance[3] += g * g;
+            covariance[4] += g * b;
+            covariance[5] += b * b;
+        }
+
+        // Principal axis by power iteration, starting from the diagonal
+        float axis[3] = {1.0f, 1.0f, 1.0f};
+        for(int iteration = 0; iteration < 4; iteration++) {
+            float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+            float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+            float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+            float length = std::max(std::max(std::abs(x), std::abs(y)), std::abs(z));
+            if(length < 1e-6f) break;
+            axis[0] = x / length;
+            axis[1] = y / length;
+            axis[2] = z / length;
+        }
+        float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        for(int channel = 0; channel < 3; channel++) {
+            axis[channel] /= length;
+        }
+
+        float low = 1e30f;
+        float high = -1e30f;
+        for(int i = 0; i < 16; i++) {
+            float t = (colors[i][0] - mean[0]) * axis[0] + (colors[i][1] - mean[1]) * axis[1] + (colors[i][2] - mean[2]) * axis[2];
+            low = std::min(low, t);
+            high = std::max(high, t);
+        }
+
+        // Pull the endpoints in a little, the extremes are rarely worth a full palette step
+        float inset = (high - low) / 16.0f;
+        low += inset;
+        high -= inset;
+
+        float e0[3], e1[3];
+        for(int channel = 0; channel < 3; channel++) {
+            e0[channel] = mean[channel] + axis[channel] * high;
+            e1[channel] = mean[channel] + axis[channel] * low;
+        }
+
+        uint16_t c0 = pack_565(e0);
+        uint16_t c1 = pack_565(e1);
+        float error;
+        uint32_t indices = pick_indices(colors, c0, c1, error);
+
+        if(c0 != c1 && refit_endpoints(colors, indices, e0, e1)) {
+            uint16_t refit_c0 = pack_565(e0);
+            uint16_t refit_c1 = pack_565(e1);
+            float refit_error;
+            uint32_t refit_indices = pick_indices(colors, refit_c0, refit_c1, refit_error);
+            if(refit_error < error) {
+                c0 = refit_c0;
+                c1 = refit_c1;
+                indices = refit_indices;
+            }
+        }
+
+        // BC1 only uses 4 colors when c0 > c1: swap the endpoints and flip
+        // the indices (0 <-> 1, 2 <-> 3) if they came out the other way
+        if(c0 < c1) {
+            std::swap(c0, c1);
+            indices ^= 0x55555555;
+        } else if(c0 == c1) {
+            indices = 0;
+        }
+
+        memcpy(block, &c0, 2);
+        memcpy(block + 2, &c1, 2);
+        memcpy(block + 4, &indices, 4);
+    }
+
+    /// BC4 block of the alpha channel, always in 8 value mode
+    static void encode_alpha_block(const uint8_t* rgba, uint8_t* block) {
+        int low = 255;
+        int high = 0;
+        for(int i = 0; i < 16; i++) {
+            low = std::min(low, static_cast<int>(rgba[i * 4 + 3]));
+            high = std::max(high, static_cast<int>(rgba[i * 4 + 3]));
+        }
+
+        block[0] = static_cast<uint8_t>(high);
+        block[1] = static_cast<uint8_t>(low);
+
+        uint64_t indices = 0;
+        int range = high - low;
+        if(range > 0) {
+            for(int i = 0; i < 16; i++) {
+                // Steps up from `low`, then to index order: 7 is a0 (0), 0 is a1 (1),
+                // the ones in between count down from 7
+                int step = ((rgba[i * 4 + 3] - low) * 7 + range / 2) / range;
+                uint64_t index = step == 7 ? 0 : step == 0 ? 1 : static_cast<uint64_t>(8 - step);
+                indices |= index << (3 * i);
+            }
+        }
+
+        for(int byte = 0; byte < 6; byte++) {
+            block[2 + byte] = static_cast<uint8_t>(indices >> (8 * byte));
+        }
+    }
+
+    void encode_bc1_block(const uint8_t* rgba, uint8_t* block) {
+        encode_color_block(rgba, block);
+    }
+
+    void encode_bc3_block(const uint8_t* rgba, uint8_t* block) {
+        encode_alpha_block(rgba, block);
+        encode_color_block(rgba, block + 8);
+    }
+
+    static void decode_color_block(const uint8_t* block, uint8_t* rgba, bool four_color) {
+        uint16_t c0, c1;
+        uint32_t indices;
+        memcpy(&c0, block, 2);
+        memcpy(&c1, block + 2, 2);
+        memcpy(&indices, block + 4, 4);
+
+        int palette[4][3];
+        int alpha[4] = {255, 255, 255, 255};
+        build_palette(c0, c1, palette);
+
+        // BC1 with c0 <= c1: the midpoint and transparent black
+        if(!four_color && c0 <= c1) {
+            for(int channel = 0; channel < 3; channel++) {
+                palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+                palette[3][channel] = 0;
+            }
+            alpha[3] = 0;
+        }
+
+        for(int i = 0; i < 16; i++) {
+            uint32_t index = (indices >> (2 * i)) & 3;
+            rgba[i * 4 + 0] = static_cast<uint8_t>(palette[index][0]);
+            rgba[i * 4 + 1] = static_cast<uint8_t>(palette[index][1]);
+            rgba[i * 4 + 2] = static_cast<uint8_t>(palette[index][2]);
+            rgba[i * 4 + 3] = static_cast<uint8_t>(alpha[index]);
+        }
+    }
+
+    void decode_bc1_block(const uint8_t* block, uint8_t* rgba) {
+        decode_color_block(block, rgba, false);
+    }
+
+    void decode_bc3_block(const uint8_t* block, uint8_t* rgba) {
+        // BC3's color half always has four colors
+        decode_color_block(block + 8, rgba, true);
+
+        int a0 = block[0];
+        int a1 = block[1];
+        int values[8] = {a0, a1};
+        if(a0 > a1) {
+            for(int i = 2; i < 8; i++) {
+                values[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+            }
+        } else {
+            for(int i = 2; i < 6; i++) {
+                values[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+            }
+            values[6] = 0;
+            values[7] = 255;
+        }
+
+        uint64_t indices = 0;
+        for(int byte = 0; byte < 6; byte++) {
+            indices |= static_cast<uint64_t>(block[2 + byte]) << (8 * byte);
+        }
+        for(int i = 0; i < 16; i++) {
+            rgba[i * 4 + 3] = static_cast<uint8_t>(values[(indices >> (3 * i)) & 7]);
+        }
+    }
+
+    void encode_bc_rows(bool bc3, const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t begin_row, uint32_t end_row, uint8_t* blocks) {
+        uint32_t blocks_x = (width + 3) / 4;
+        uint32_t block_bytes = bc3 ? 16 : 8;
+
+        uint8_t texels[64];
+        for(uint32_t row = begin_row; row < end_row; row++) {
+            for(uint32_t column = 0; column < blocks_x; column++) {
+                for(uint32_t y = 0; y < 4; y++) {
+                    uint32_t source_y = std::min(row * 4 + y, height - 1);
+                    for(uint32_t x = 0; x < 4; x++) {
+                        uint32_t source_x = std::min(column * 4 + x, width - 1);
+                        memcpy(texels + (y * 4 + x) * 4, rgba + (static_cast<size_t>(source_y) * width + source_x) * 4, 4);
+                    }
+                }
+
+                uint8_t* block = blocks + (static_cast<size_t>(row) * blocks_x + column) * block_bytes;
+                if(bc3) {
+                    encode_bc3_block(texels, block);
+                } else {
+                    encode_bc1_block(texels, block);
+                }
+            }
+        }
+    }
+
+    void decode_bc_rows(bool bc3, const uint8_t* blocks, uint32_t width, uint32_t height, uint32_t begin_row, uint32_t end_row, uint8_t* rgba) {
+        uint32_t blocks_x = (width + 3) / 4;
+        uint32_t block_bytes = bc3 ? 16 : 8;
+
+        uint8_t texels[64];
+        for(uint32_t row = begin_row; row < end_row; row++) {
+            for(uint32_t column = 0; column < blocks_x; column++) {
+                const uint8_t* block = blocks + (static_cast<size_t>(row) * blocks_x + column) * block_bytes;
+                if(bc3) {
+                    decode_bc3_block(block, texels);
+                } else {
+                    decode_bc1_block(block, texels);
+                }
+
+                // Edge blocks only write the texels inside the image
+                for(uint32_t y = 0; y < 4 && row * 4 + y < height; y++) {
+                    uint32_t columns = std::min(4u, width - column * 4);
+                    memcpy(rgba + (static_cast<size_t>(row * 4 + y) * width + column * 4) * 4, texels + y * 16, columns * 4);
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstdint>
+
+namespace Paopu {
+
+    // --------------------------------------------------------------------
+    //                        - BC1 and BC3 -
+    // --------------------------------------------------------------------
+    //  Real-time CPU encoders, for RGBA8 sources on devices without a better
+    //  transcoder, and decoders for BC sources on devices that can't sample
+    //  them. Both work on one 4x4 block of RGBA8 texels, 16 bytes per row.
+
+    /// Encodes an opaque block as BC1 (8 bytes). Alpha is ignored.
+    ///
+    ///
+    PAOPU_API void encode_bc1_block(const uint8_t* rgba, uint8_t* block);
+
+    /// Encodes a block as BC3 (16 bytes): BC4 alpha, then BC1 color
+    ///
+    ///
+    PAOPU_API void encode_bc3_block(const uint8_t* rgba, uint8_t* block);
+
+    PAOPU_API void decode_bc1_block(const uint8_t* block, uint8_t* rgba);
+    PAOPU_API void decode_bc3_block(const uint8_t* block, uint8_t* rgba);
+
+    /// Encodes block rows [`begin_row`, `end_row`) of a `width` x `height`
+    /// RGBA8 image into `blocks`, which holds the whole level. Edge blocks
+    /// repeat the last row and column. Split by rows to spread a level over
+    /// jobs. `bc3` picks BC3 over BC1.
+    ///
+    PAOPU_API void encode_bc_rows(bool bc3, const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t begin_row, uint32_t end_row, uint8_t* blocks);
+
+    /// The reverse of `encode_bc_rows`, into a tightly packed RGBA8 image
+    ///
+    ///
+    PAOPU_API void decode_bc_rows(bool bc3, const uint8_t* blocks, uint32_t width, uint32_t height, uint32_t begin_row, uint32_t end_row, uint8_t* rgba);
+
+}
@@ -0,0 +1,203 @@
+#include "Ktx2.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Paopu {
+
+    // --------------------------------------------------------------------
+    //                          - File layout -
+    // --------------------------------------------------------------------
+    //  identifier[12]
+    //  header: vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth,
+    //      layerCount, faceCount, levelCount, supercompressionScheme (u32)
+    //  index: dfd offset/length (u32), kvd offset/length (u32),
+    //      sgd offset/length (u64)
+    //  level index: offset, length, uncompressed length (u64) per level
+    //  data format descriptor, key/values, supercompression global data
+    //  levels, smallest first
+
+    static const uint8_t k_ktx2_identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    static const size_t k_ktx2_header_size = 80;
+    static const size_t k_ktx2_level_entry_size = 24;
+
+    template<typename T>
+    static inline T read_value(const uint8_t* data, size_t offset) {
+        T value;
+        memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    static inline void write_value(std::vector<uint8_t>& out, size_t offset, T value) {
+        memcpy(out.data() + offset, &value, sizeof(T));
+    }
+
+    bool parse_ktx2(const uint8_t* data, size_t size, Ktx2Image& image) {
+        if(size < k_ktx2_header_size || memcmp(data, k_ktx2_identifier, sizeof(k_ktx2_identifier)) != 0) {
+            return false;
+        }
+
+        image = Ktx2Image{};
+        image.vk_format = read_value<uint32_t>(data, 12);
+        image.width = read_value<uint32_t>(data, 20);
+        image.height = read_value<uint32_t>(data, 24);
+        uint32_t depth = read_value<uint32_t>(data, 28);
+        uint32_t layer_count = read_value<uint32_t>(data, 32);
+        uint32_t face_count = read_value<uint32_t>(data, 36);
+        // 0 asks the loader to generate mips, which we don't
+        image.level_count = std::max(read_value<uint32_t>(data, 40), 1u);
+        image.supercompression = static_cast<Ktx2Supercompression>(read_value<uint32_t>(data, 44));
+
+        if(image.width == 0 || image.height == 0 || depth > 1 || layer_count > 1 || face_count != 1 || image.level_count > k_ktx2_max_levels) {
+            return false;
+        }
+        if(size < k_ktx2_header_size + k_ktx2_level_entry_size * image.level_count) {
+            return false;
+        }
+
+        for(uint32_t level = 0; level < image.level_count; level++) {
+            size_t entry = k_ktx2_header_size + k_ktx2_level_entry_size * level;
+            Ktx2Level& info = image.levels[level];
+            info.offset = read_value<uint64_t>(data, entry);
+            info.size = read_value<uint64_t>(data, entry + 8);
+            info.uncompressed_size = read_value<uint64_t>(data, entry + 16);
+
+            if(info.offset > size || info.size > size - info.offset) {
+                return false;
+            }
+        }
+
+        // Only the first descriptor block matters: its color model and transfer function
+        uint32_t dfd_offset = read_value<uint32_t>(data, 48);
+        uint32_t dfd_length = read_value<uint32_t>(data, 52);
+        if(dfd_length >= 16 && dfd_offset <= size && dfd_length <= size - dfd_offset) {
+            image.color_model = data[dfd_offset + 12];
+            image.srgb = data[dfd_offset + 14] == 2;
+        }
+
+        TextureFormat format;
+        bool srgb;
+        if(find_texture_format(image.vk_format, format, srgb)) {
+            image.srgb = srgb;
+        }
+
+        image.data = data;
+        image.size = size;
+        return true;
+    }
+
+    /// One sample of a data format descriptor: which bits of the block hold which channel
+    struct Ktx2Sample {
+        uint16_t bit_offset;
+        uint8_t bit_length;
+        uint8_t channel;
+        uint32_t upper;
+    };
+
+    // KHR_DF_* values the writer needs
+    static const uint8_t k_channel_alpha = 15;
+    static const uint8_t k_qualifier_linear = 0x10;
+
+    void write_ktx2(TextureFormat format, bool srgb, uint32_t width, uint32_t height, uint32_t mip_count, const uint8_t* data, std::vector<uint8_t>& out) {
+        const TextureFormatInfo& info = get_texture_format_info(format);
+
+        uint8_t color_model = 0;
+        Ktx2Sample samples[4];
+        uint32_t sample_count = 0;
+        switch(format) {
+            case TextureFormat::RGBA8:
+                color_model = k_ktx2_model_rgbsda;
+                for(uint8_t channel = 0; channel < 4; channel++) {
+                    samples[sample_count++] = {static_cast<uint16_t>(channel * 8), 7, channel == 3 ? k_channel_alpha : channel, 255};
+                }
+                break;
+            case TextureFormat::BC1:
+                color_model = 128;
+                samples[sample_count++] = {0, 63, 0, ~0u};
+                break;
+            case TextureFormat::BC3:
+                color_model = 130;
+                samples[sample_count++] = {0, 63, k_channel_alpha, ~0u};
+                samples[sample_count++] = {64, 63, 0, ~0u};
+                break;
+            case TextureFormat::BC7:
+                color_model = 133;
+                samples[sample_count++] = {0, 127, 0, ~0u};
+                break;
+            case TextureFormat::ETC2_RGBA8:
+                color_model = 161;
+                samples[sample_count++] = {0, 63, k_channel_alpha, ~0u};
+                samples[sample_count++] = {64, 63, 2, ~0u};
+                break;
+            case TextureFormat::ASTC_4x4:
+                color_model = 162;
+                samples[sample_count++] = {0, 127, 0, ~0u};
+                break;
+        }
+
+        uint32_t block_size = 24 + 16 * sample_count;
+        uint32_t dfd_offset = static_cast<uint32_t>(k_ktx2_header_size + k_ktx2_level_entry_size * mip_count);
+        uint32_t dfd_length = 4 + block_size;
+
+        // Levels go smallest first, each aligned to its block size
+        uint64_t level_offsets[k_ktx2_max_levels];
+        uint64_t level_sizes[k_ktx2_max_levels];
+        uint64_t offset = dfd_offset + dfd_length;
+        for(uint32_t level = mip_count; level-- > 0;) {
+            level_sizes[level] = get_texture_level_size(format, width >> level, height >> level);
+            offset = (offset + 15) & ~15ull;
+            level_offsets[level] = offset;
+            offset += level_sizes[level];
+        }
+
+        out.assign(static_cast<size_t>(offset), 0);
+        memcpy(out.data(), k_ktx2_identifier, sizeof(k_ktx2_identifier));
+        write_value<uint32_t>(out, 12, srgb ? info.vk_srgb_format : info.vk_format);
+        // typeSize, 1 for both 8 bit and block compressed formats
+        write_value<uint32_t>(out, 16, 1);
+        write_value<uint32_t>(out, 20, width);
+        write_value<uint32_t>(out, 24, height);
+        write_value<uint32_t>(out, 36, 1);
+        write_value<uint32_t>(out, 40, mip_count);
+        write_value<uint32_t>(out, 48, dfd_offset);
+        write_value<uint32_t>(out, 52, dfd_length);
+
+        const uint8_t* level_data = data;
+        for(uint32_t level = 0; level < mip_count; level++) {
+            size_t entry = k_ktx2_header_size + k_ktx2_level_entry_size * level;
+            write_value<uint64_t>(out, entry, level_offsets[level]);
+            write_value<uint64_t>(out, entry + 8, level_sizes[level]);
+            write_value<uint64_t>(out, entry + 16, level_sizes[level]);
+
+            memcpy(out.data() + level_offsets[level], level_data, static_cast<size_t>(level_sizes[level]));
+            level_data += level_sizes[level];
+        }
+
+        // Basic data format descriptor block
+        size_t dfd = dfd_offset;
+        write_value<uint32_t>(out, dfd, dfd_length);
+        write_value<uint16_t>(out, dfd + 8, 2);
+        write_value<uint16_t>(out, dfd + 10, static_cast<uint16_t>(block_size));
+        out[dfd + 12] = color_model;
+        // BT.709 primaries, linear or sRGB transfer
+        out[dfd + 13] = 1;
+        out[dfd + 14] = srgb ? 2 : 1;
+        out[dfd + 16] = static_cast<uint8_t>(info.block_width - 1);
+        out[dfd + 17] = static_cast<uint8_t>(info.block_height - 1);
+        out[dfd + 20] = static_cast<uint8_t>(info.block_bytes);
+
+        for(uint32_t i = 0; i < sample_count; i++) {
+            size_t sample = dfd + 28 + 16 * i;
+            uint8_t channel = samples[i].channel;
+            // Alpha is never sRGB encoded
+            if(srgb && channel == k_channel_alpha) channel |= k_qualifier_linear;
+
+            write_value<uint16_t>(out, sample, samples[i].bit_offset);
+            out[sample + 2] = samples[i].bit_length;
+            out[sample + 3] = channel;
+            write_value<uint32_t>(out, sample + 12, samples[i].upper);
+        }
+    }
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "../Core/Core.h"
+#include "TextureFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    static const uint32_t k_ktx2_max_levels = 16;
+
+    enum class Ktx2Supercompression : uint32_t {
+        None = 0,
+        BasisLZ = 1,
+        Zstandard = 2,
+        Zlib = 3
+    };
+
+    // Data format descriptor color models, KHR_DF_MODEL_*
+    static const uint8_t k_ktx2_model_rgbsda = 1;
+    static const uint8_t k_ktx2_model_etc1s = 163;
+    static const uint8_t k_ktx2_model_uastc = 166;
+
+    struct PAOPU_API Ktx2Level {
+        uint64_t offset{0};
+        uint64_t size{0};
+        uint64_t uncompressed_size{0};
+    };
+
+    /// A parsed KTX2 file. Points into the file's bytes, which have to outlive it.
+    ///
+    /// `vk_format` is 0 for universal formats (Basis ETC1S and UASTC), which
+    /// have to be transcoded; `color_model` tells them apart.
+    struct PAOPU_API Ktx2Image {
+        uint32_t vk_format{0};
+        uint32_t width{0};
+        uint32_t height{0};
+        uint32_t level_count{0};
+        Ktx2Supercompression supercompression{Ktx2Supercompression::None};
+        uint8_t color_model{0};
+        bool srgb{false};
+        Ktx2Level levels[k_ktx2_max_levels];
+
+        const uint8_t* data{nullptr};
+        size_t size{0};
+
+        /// Stored bytes of mip `level`, 0 is the largest
+        ///
+        ///
+        inline const uint8_t* get_level(uint32_t level) const { return data + levels[level].offset; }
+    };
+
+    /// Parses the header, level index and data format descriptor of the KTX2
+    /// file in `data`. Only 2D textures without array layers or cube faces are
+    /// accepted. Returns false if it isn't one or is malformed.
+    ///
+    PAOPU_API bool parse_ktx2(const uint8_t* data, size_t size, Ktx2Image& image);
+
+    /// Writes a KTX2 file with `mip_count` levels of `format`, without
+    /// supercompression. `data` holds the levels back to back from mip 0,
+    /// each get_texture_level_size bytes.
+    ///
+    PAOPU_API void write_ktx2(TextureFormat format, bool srgb, uint32_t width, uint32_t height, uint32_t mip_count, const uint8_t* data, std::vector<uint8_t>& out);
+
+}
@@ -0,0 +1,183 @@
+#include "Lz4.h"
+
+#include <cstring>
+
+namespace Paopu {
+
+    static const uint32_t k_min_match = 4;
+    // The last match has to start this far from the end of the input...
+    static const size_t k_match_find_limit = 12;
+    // ...and the last 5 bytes are always literals
+    static const size_t k_last_literals = 5;
+    static const uint32_t k_max_offset = 65535;
+
+    static const uint32_t k_hash_bits = 12;
+
+    static inline uint32_t read32(const uint8_t* ptr) {
+        uint32_t value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    static inline uint32_t hash_sequence(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - k_hash_bits);
+    }
+
+    /// Writes the 255-run continuation of a length that didn't fit in its token nibble
+    static inline bool write_length(uint8_t*& op, const uint8_t* end, size_t length) {
+        while(length >= 255) {
+            if(op >= end) return false;
+            *op++ = 255;
+            length -= 255;
+        }
+        if(op >= end) return false;
+        *op++ = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    /// Writes a token, its literals and, if `match_length` isn't 0, the match
+    static bool write_sequence(uint8_t*& op, const uint8_t* end, const uint8_t* literals, size_t literal_length, uint32_t offset, size_t match_length) {
+        if(op >= end) return false;
+        uint8_t* token = op++;
+
+        size_t match_code = match_length > 0 ? match_length - k_min_match : 0;
+        *token = static_cast<uint8_t>(((literal_length < 15 ? literal_length : 15) << 4) | (match_code < 15 ? match_code : 15));
+
+        if(literal_length >= 15 && !write_length(op, end, literal_length - 15)) return false;
+
+        if(static_cast<size_t>(end - op) < literal_length) return false;
+        if(literal_length > 0) {
+            memcpy(op, literals, literal_length);
+            op += literal_length;
+        }
+
+        if(match_length == 0) return true;
+
+        if(end - op < 2) return false;
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+
+        if(match_code >= 15 && !write_length(op, end, match_code - 15)) return false;
+        return true;
+    }
+
+    size_t lz4_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+        // Offsets into the input are stored as 32 bits
+        if(size > 0x7E000000) return 0;
+
+        uint8_t* op = dst;
+        const uint8_t* end = dst + capacity;
+        size_t anchor = 0;
+
+        if(size > k_match_find_limit) {
+            uint32_t table[1 << k_hash_bits] = {};
+            const size_t match_find_limit = size - k_match_find_limit;
+            const size_t match_limit = size - k_last_literals;
+
+            size_t ip = 1;
+            while(ip < match_find_limit) {
+                uint32_t sequence = read32(src + ip);
+                uint32_t hash = hash_sequence(sequence);
+                size_t candidate = table[hash];
+                table[hash] = static_cast<uint32_t>(ip);
+
+                if(ip - candidate > k_max_offset || read32(src + candidate) != sequence) {
+                    // Skip ahead faster the longer nothing matched
+                    ip += 1 + ((ip - anchor) >> 6);
+                    continue;
+                }
+
+                while(ip > anchor && candidate > 0 && src[ip - 1] == src[candidate - 1]) {
+                    ip--;
+                    candidate--;
+                }
+
+                size_t length = k_min_match;
+                while(ip + length < match_limit && src[ip + length] == src[candidate + length]) {
+                    length++;
+                }
+
+                if(!write_sequence(op, end, src + anchor, ip - anchor, static_cast<uint32_t>(ip - candidate), length)) return 0;
+
+                ip += length;
+                anchor = ip;
+                if(ip < match_find_limit) {
+                    table[hash_sequence(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2);
+                }
+            }
+        }
+
+        if(!write_sequence(op, end, src + anchor, size - anchor, 0, 0)) return 0;
+        return static_cast<size_t>(op - dst);
+    }
+
+    /// Reads the 255-run continuation of a length, false if it runs past the input
+    static inline bool read_length(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+        uint8_t byte;
+        do {
+            if(ip >= end) return false;
+            byte = *ip++;
+            length += byte;
+        } while(byte == 255);
+        return true;
+    }
+
+    /// Copies `size` bytes in 16 byte chunks, writing up to 15 bytes past the end
+    static inline void wild_copy(uint8_t* dst, const uint8_t* src, size_t size) {
+        uint8_t* end = dst + size;
+        do {
+            memcpy(dst, src, 16);
+            dst += 16;
+            src += 16;
+        } while(dst < end);
+    }
+
+    bool lz4_decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_size) {
+        const uint8_t* ip = src;
+        const uint8_t* ip_end = src + size;
+        uint8_t* op = dst;
+        uint8_t* op_end = dst + dst_size;
+
+        while(ip < ip_end) {
+            uint8_t token = *ip++;
+
+            size_t literal_length = token >> 4;
+            if(literal_length == 15 && !read_length(ip, ip_end, literal_length)) return false;
+            if(literal_length > static_cast<size_t>(ip_end - ip) || literal_length > static_cast<size_t>(op_end - op)) return false;
+
+            if(static_cast<size_t>(ip_end - ip) >= literal_length + 16 && static_cast<size_t>(op_end - op) >= literal_length + 16) {
+                wild_copy(op, ip, literal_length);
+            } else if(literal_length > 0) {
+                memcpy(op, ip, literal_length);
+            }
+            ip += literal_length;
+            op += literal_length;
+
+            // The last sequence has no match
+            if(ip == ip_end) break;
+
+            if(ip_end - ip < 2) return false;
+            size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            if(offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+
+            size_t match_length = token & 15;
+            if(match_length == 15 && !read_length(ip, ip_end, match_length)) return false;
+            match_length += k_min_match;
+            if(match_length > static_cast<size_t>(op_end - op)) return false;
+
+            const uint8_t* match = op - offset;
+            if(offset >= 16 && static_cast<size_t>(op_end - op) >= match_length + 16) {
+                // Each 16 byte chunk only reads bytes written before it
+                wild_copy(op, match, match_length);
+                op += match_length;
+            } else {
+                // Overlapping, repeats the last `offset` bytes
+                for(size_t i = 0; i < match_length; i++) *op++ = *match++;
+            }
+        }
+
+        return op == op_end;
+    }
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Paopu {
+
+    // LZ4 block format (no frame header), compatible with the reference
+    // LZ4_compress_default / LZ4_decompress_safe. Used for archive blobs,
+    // which store both sizes next to the data.
+
+    /// Worst case compressed size of `size` bytes
+    ///
+    ///
+    inline size_t lz4_compress_bound(size_t size) {
+        return size + size / 255 + 16;
+    }
+
+    /// Compresses `size` bytes of `src` into `dst`. Returns the compressed size,
+    /// or 0 when it doesn't fit in `capacity`.
+    ///
+    PAOPU_API size_t lz4_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+    /// Decompresses a block into exactly `dst_size` bytes. Returns false on
+    /// malformed input instead of reading or writing out of bounds.
+    ///
+    PAOPU_API bool lz4_decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_size);
+
+}
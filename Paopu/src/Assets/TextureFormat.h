@@ -0,0 +1,78 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Paopu {
+
+    /// GPU texture formats assets can end up in. BC is what desktop GPUs
+    /// sample, ETC2 and ASTC cover mobile, RGBA8 works everywhere.
+    ///
+    enum class TextureFormat : uint8_t {
+        RGBA8 = 0,
+        BC1 = 1,
+        BC3 = 2,
+        BC7 = 3,
+        ETC2_RGBA8 = 4,
+        ASTC_4x4 = 5
+    };
+
+    static const uint32_t k_texture_format_count = 6;
+
+    /// `vk_format`, `vk_srgb_format`: The VkFormat values, which KTX2 files
+    ///     use as well. Kept as integers so assets don't need Vulkan.
+    struct PAOPU_API TextureFormatInfo {
+        const char* name;
+        uint32_t block_width;
+        uint32_t block_height;
+        uint32_t block_bytes;
+        uint32_t vk_format;
+        uint32_t vk_srgb_format;
+    };
+
+    static const TextureFormatInfo k_texture_formats[k_texture_format_count] = {
+        {"RGBA8", 1, 1, 4, 37, 43},
+        {"BC1", 4, 4, 8, 131, 132},
+        {"BC3", 4, 4, 16, 137, 138},
+        {"BC7", 4, 4, 16, 145, 146},
+        {"ETC2", 4, 4, 16, 151, 152},
+        {"ASTC 4x4", 4, 4, 16, 157, 158}
+    };
+
+    inline const TextureFormatInfo& get_texture_format_info(TextureFormat format) {
+        return k_texture_formats[static_cast<uint32_t>(format)];
+    }
+
+    /// Bit of `format` in masks of supported formats
+    ///
+    ///
+    inline uint32_t get_texture_format_bit(TextureFormat format) {
+        return 1u << static_cast<uint32_t>(format);
+    }
+
+    /// Bytes of one mip level of `width` x `height` texels
+    ///
+    ///
+    inline uint64_t get_texture_level_size(TextureFormat format, uint32_t width, uint32_t height) {
+        const TextureFormatInfo& info = get_texture_format_info(format);
+        uint64_t blocks_x = (std::max(width, 1u) + info.block_width - 1) / info.block_width;
+        uint64_t blocks_y = (std::max(height, 1u) + info.block_height - 1) / info.block_height;
+        return blocks_x * blocks_y * info.block_bytes;
+    }
+
+    /// The TextureFormat of VkFormat `vk_format`. Returns false for formats
+    /// the engine doesn't handle.
+    ///
+    inline bool find_texture_format(uint32_t vk_format, TextureFormat& format, bool& srgb) {
+        for(uint32_t i = 0; i < k_texture_format_count; i++) {
+            if(k_texture_formats[i].vk_format == vk_format || k_texture_formats[i].vk_srgb_format == vk_format) {
+                format = static_cast<TextureFormat>(i);
+                srgb = k_texture_formats[i].vk_srgb_format == vk_format;
+                return true;
+            }
+        }
+        return false;
+    }
+
+}
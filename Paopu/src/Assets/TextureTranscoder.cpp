@@ -0,0 +1,185 @@
+#include "TextureTranscoder.h"
+#include "BlockCompression.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace Paopu {
+
+    // Block rows per job when a level is spread over the job system
+    static const uint32_t k_rows_per_job = 8;
+
+    static inline uint32_t get_level_dimension(uint32_t size, uint32_t level) {
+        return std::max(size >> level, 1u);
+    }
+
+    static bool is_opaque(const Ktx2Image& image) {
+        const uint8_t* texels = image.get_level(0);
+        uint64_t size = image.levels[0].size;
+        for(uint64_t i = 3; i < size; i += 4) {
+            if(texels[i] != 255) return false;
+        }
+        return true;
+    }
+
+    void TextureTranscoder::add_transcoder(const TextureTranscoderDesc& transcoder) {
+        transcoders.push_back(transcoder);
+    }
+
+    bool TextureTranscoder::can_convert(const Ktx2Image& image, TextureFormat source, TextureFormat target) const {
+        if(image.supercompression != Ktx2Supercompression::None) return false;
+
+        // Every level has to hold what its size says, the converters read it all
+        for(uint32_t level = 0; level < image.level_count; level++) {
+            uint64_t size = get_texture_level_size(source, get_level_dimension(image.width, level), get_level_dimension(image.height, level));
+            if(image.levels[level].size < size) return false;
+        }
+
+        if(source == target) return true;
+        if(source == TextureFormat::RGBA8) {
+            return target == TextureFormat::BC1 || target == TextureFormat::BC3;
+        }
+        if(source == TextureFormat::BC1 || source == TextureFormat::BC3) {
+            return target == TextureFormat::RGBA8;
+        }
+        return false;
+    }
+
+    int32_t TextureTranscoder::find_transcoder(const Ktx2Image& image, TextureFormat target) const {
+        for(size_t i = 0; i < transcoders.size(); i++) {
+            const TextureTranscoderDesc& transcoder = transcoders[i];
+            if(transcoder.can_transcode(image, target, transcoder.user_data)) {
+                return static_cast<int32_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    bool TextureTranscoder::select_format(const Ktx2Image& image, TextureFormat& format) const {
+        TextureFormat source;
+        bool srgb;
+        bool known_source = find_texture_format(image.vk_format, source, srgb);
+
+        bool keep_source = known_source && (source != TextureFormat::RGBA8 || !compress_rgba8);
+        if(keep_source && (supported_formats & get_texture_format_bit(source)) != 0 && can_convert(image, source, source)) {
+            format = source;
+            return true;
+        }
+
+        // BC1 has no alpha worth the name, so it's only first choice for sources known to be opaque
+        bool opaque = known_source && source == TextureFormat::RGBA8 && image.supercompression == Ktx2Supercompression::None && is_opaque(image);
+
+        const TextureFormat opaque_order[] = {TextureFormat::BC7, TextureFormat::ASTC_4x4, TextureFormat::ETC2_RGBA8, TextureFormat::BC1, TextureFormat::BC3, TextureFormat::RGBA8};
+        const TextureFormat alpha_order[] = {TextureFormat::BC7, TextureFormat::ASTC_4x4, TextureFormat::ETC2_RGBA8, TextureFormat::BC3, TextureFormat::BC1, TextureFormat::RGBA8};
+        const TextureFormat* order = opaque ? opaque_order : alpha_order;
+
+        for(uint32_t i = 0; i < k_texture_format_count; i++) {
+            TextureFormat target = order[i];
+            if((supported_formats & get_texture_format_bit(target)) == 0) continue;
+
+            if((known_source && can_convert(image, source, target)) || find_transcoder(image, target) >= 0) {
+                format = target;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool TextureTranscoder::transcode(const Ktx2Image& image, TextureFormat format, TranscodedTexture& texture) const {
+        PAO_PROFILE_SCOPE("TextureTranscoder::transcode");
+
+        TextureFormat source;
+        bool srgb;
+        bool built_in = find_texture_format(image.vk_format, source, srgb) && can_convert(image, source, format);
+        int32_t transcoder_index = built_in ? -1 : find_transcoder(image, format);
+        if(!built_in && transcoder_index < 0) return false;
+
+        texture.format = format;
+        texture.srgb = image.srgb;
+        texture.width = image.width;
+        texture.height = image.height;
+        texture.mip_count = image.level_count;
+
+        uint64_t size = 0;
+        for(uint32_t level = 0; level < image.level_count; level++) {
+            texture.level_offsets[level] = size;
+            texture.level_sizes[level] = get_texture_level_size(format, get_level_dimension(image.width, level), get_level_dimension(image.height, level));
+            size += texture.level_sizes[level];
+        }
+        texture.data.resize(static_cast<size_t>(size));
+
+        bool parallel = JobSystem::get_worker_count() > 1;
+
+        if(!built_in) {
+            const TextureTranscoderDesc* transcoder = &transcoders[transcoder_index];
+            TranscodedTexture* out = &texture;
+            std::atomic<bool> failed{false};
+
+            auto transcode_levels = [&image, transcoder, format, out, &failed](uint32_t begin, uint32_t end) {
+                for(uint32_t level = begin; level < end; level++) {
+                    uint8_t* dst = out->data.data() + out->level_offsets[level];
+                    if(!transcoder->transcode_level(image, level, format, dst, static_cast<size_t>(out->level_sizes[level]), transcoder->user_data)) {
+                        failed.store(true, std::memory_order_relaxed);
+                    }
+                }
+            };
+            if(parallel) {
+                JobSystem::parallel_for(image.level_count, transcode_levels);
+            } else {
+                transcode_levels(0, image.level_count);
+            }
+            return !failed.load(std::memory_order_relaxed);
+        }
+
+        for(uint32_t level = 0; level < image.level_count; level++) {
+            const uint8_t* src = image.get_level(level);
+            uint8_t* dst = texture.data.data() + texture.level_offsets[level];
+
+            if(source == format) {
+                memcpy(dst, src, static_cast<size_t>(texture.level_sizes[level]));
+                continue;
+            }
+
+            uint32_t width = get_level_dimension(image.width, level);
+            uint32_t height = get_level_dimension(image.height, level);
+            uint32_t block_rows = (height + 3) / 4;
+            bool encode = source == TextureFormat::RGBA8;
+            bool bc3 = (encode ? format : source) == TextureFormat::BC3;
+
+            auto convert_rows = [encode, bc3, src, dst, width, height](uint32_t begin, uint32_t end) {
+                if(encode) {
+                    encode_bc_rows(bc3, src, width, height, begin, end, dst);
+                } else {
+                    decode_bc_rows(bc3, src, width, height, begin, end, dst);
+                }
+            };
+            if(parallel) {
+                JobSystem::parallel_for(block_rows, convert_rows, k_rows_per_job);
+            } else {
+                convert_rows(0, block_rows);
+            }
+        }
+        return true;
+    }
+
+    bool TextureTranscoder::decode_asset(AssetLoadResult& result) {
+        TextureDecode* decode = static_cast<TextureDecode*>(result.user_data);
+
+        Ktx2Image image;
+        if(!parse_ktx2(result.data.data(), result.data.size(), image)) {
+            return false;
+        }
+
+        TextureFormat format;
+        if(!decode->transcoder->select_format(image, format) || !decode->transcoder->transcode(image, format, decode->texture)) {
+            return false;
+        }
+
+        // The file isn't needed anymore, only what will be uploaded
+        std::vector<uint8_t>().swap(result.data);
+        return true;
+    }
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "../Core/Core.h"
+#include "AssetLoader.h"
+#include "Ktx2.h"
+#include "TextureFormat.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    /// A texture in the format it will be uploaded in, every mip back to back
+    ///
+    ///
+    struct PAOPU_API TranscodedTexture {
+        TextureFormat format{TextureFormat::RGBA8};
+        bool srgb{false};
+        uint32_t width{0};
+        uint32_t height{0};
+        uint32_t mip_count{0};
+        uint64_t level_offsets[k_ktx2_max_levels];
+        uint64_t level_sizes[k_ktx2_max_levels];
+        std::vector<uint8_t> data;
+
+        inline const uint8_t* get_level(uint32_t level) const { return data.data() + level_offsets[level]; }
+    };
+
+    /// Transcodes sources the built-in paths don't cover, e.g. Basis Universal.
+    ///
+    /// `can_transcode`: Whether it can turn `image` into `target`
+    /// `transcode_level`: Writes mip `level` of `image` as `target` into `dst`,
+    ///     which holds exactly `dst_size` bytes. Runs on job system workers.
+    struct PAOPU_API TextureTranscoderDesc {
+        const char* name{""};
+        bool (*can_transcode)(const Ktx2Image& image, TextureFormat target, void* user_data){nullptr};
+        bool (*transcode_level)(const Ktx2Image& image, uint32_t level, TextureFormat target, uint8_t* dst, size_t dst_size, void* user_data){nullptr};
+        void* user_data{nullptr};
+    };
+
+    /// Picks the best format a device can sample for each KTX2 source and
+    /// converts it.
+    ///
+    /// Sources already in a supported format are passed through, apart from
+    /// RGBA8 ones, which are encoded to BC1 (opaque) or BC3 on the CPU. BC1
+    /// and BC3 sources are decoded to RGBA8 for devices without BC. Everything
+    /// else, universal formats like Basis ETC1S/UASTC in particular, goes
+    /// through registered transcoders. Levels are spread over the job system
+    /// when it has more than one worker.
+    class PAOPU_API TextureTranscoder {
+
+        public:
+            /// Formats the device can sample, a mask of get_texture_format_bit.
+            /// See Renderer::get_supported_texture_formats.
+            ///
+            inline void set_supported_formats(uint32_t formats) { supported_formats = formats; }
+            inline uint32_t get_supported_formats() const { return supported_formats; }
+
+            /// RGBA8 sources are block compressed when the device allows it.
+            /// Set to false to keep them as they are, e.g. for pixel art.
+            ///
+            inline void set_compress_rgba8(bool compress) { compress_rgba8 = compress; }
+
+            /// Transcoders are tried in the order they were added
+            ///
+            ///
+            void add_transcoder(const TextureTranscoderDesc& transcoder);
+
+            /// The format `image` should be uploaded in: the smallest supported
+            /// one it can be turned into, preferring BC7, ASTC and ETC2 over BC3
+            /// and BC1, with RGBA8 as the last resort. Returns false if none works.
+            ///
+            bool select_format(const Ktx2Image& image, TextureFormat& format) const;
+
+            /// Turns `image` into `format`, see `select_format`
+            ///
+            ///
+            bool transcode(const Ktx2Image& image, TextureFormat format, TranscodedTexture& texture) const;
+
+            /// AssetDecodeFn for KTX2 assets. `user_data` must point to a
+            /// TextureDecode, whose `texture` receives the result.
+            ///
+            static bool decode_asset(AssetLoadResult& result);
+
+        private:
+            /// Whether the built-in paths turn `image` into `target`
+            ///
+            ///
+            bool can_convert(const Ktx2Image& image, TextureFormat source, TextureFormat target) const;
+
+            /// Index of the first registered transcoder that can turn `image`
+            /// into `target`, -1 if none
+            ///
+            int32_t find_transcoder(const Ktx2Image& image, TextureFormat target) const;
+
+        private:
+            uint32_t supported_formats{1u << static_cast<uint32_t>(TextureFormat::RGBA8)};
+            std::vector<TextureTranscoderDesc> transcoders;
+            bool compress_rgba8{true};
+    };
+
+    /// What TextureTranscoder::decode_asset works with. `user_data` is left for
+    /// the `on_loaded` callback.
+    ///
+    struct PAOPU_API TextureDecode {
+        const TextureTranscoder* transcoder{nullptr};
+        TranscodedTexture texture;
+        void* user_data{nullptr};
+    };
+
+}
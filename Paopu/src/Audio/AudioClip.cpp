@@ -0,0 +1,335 @@
+#include "AudioClip.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Paopu {
+
+    static const uint16_t k_wav_format_pcm = 1;
+    static const uint16_t k_wav_format_ima_adpcm = 0x11;
+
+    static const int8_t k_ima_index_table[16] = {
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8
+    };
+
+    static const int16_t k_ima_step_table[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+        19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+        130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+        337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+        876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+        2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+        5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+
+    static inline uint16_t read_u16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    static inline uint32_t read_u32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static inline void write_u16(std::vector<uint8_t>& out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    static inline void write_u32(std::vector<uint8_t>& out, uint32_t value) {
+        write_u16(out, static_cast<uint16_t>(value));
+        write_u16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    struct ImaState {
+        int32_t predictor;
+        int32_t index;
+    };
+
+    static inline int16_t decode_ima_nibble(ImaState& state, uint32_t nibble) {
+        int32_t step = k_ima_step_table[state.index];
+        int32_t difference = step >> 3;
+        if(nibble & 1) difference += step >> 2;
+        if(nibble & 2) difference += step >> 1;
+        if(nibble & 4) difference += step;
+        state.predictor += (nibble & 8) ? -difference : difference;
+        state.predictor = std::min(std::max(state.predictor, -32768), 32767);
+        state.index = std::min(std::max(state.index + k_ima_index_table[nibble], 0), 88);
+        return static_cast<int16_t>(state.predictor);
+    }
+
+    static inline uint32_t encode_ima_sample(ImaState& state, int32_t sample) {
+        int32_t difference = sample - state.predictor;
+        uint32_t nibble = 0;
+        if(difference < 0) {
+            nibble = 8;
+            difference = -difference;
+        }
+
+        int32_t step = k_ima_step_table[state.index];
+        if(difference >= step) { nibble |= 4; difference -= step; }
+        step >>= 1;
+        if(difference >= step) { nibble |= 2; difference -= step; }
+        step >>= 1;
+        if(difference >= step) { nibble |= 1; }
+
+        // Track the decoder exactly, so errors don't accumulate
+        decode_ima_nibble(state, nibble);
+        return nibble;
+    }
+
+    bool parse_wav(const uint8_t* bytes, size_t size, WavInfo& info) {
+        if(size < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0) return false;
+
+        info = WavInfo{};
+        uint16_t format = 0;
+        uint16_t bits = 0;
+        uint32_t fact_frames = 0;
+        bool has_format = false;
+
+        size_t offset = 12;
+        while(offset + 8 <= size) {
+            const uint8_t* chunk = bytes + offset;
+            uint32_t chunk_size = read_u32(chunk + 4);
+            size_t body = offset + 8;
+            if(chunk_size > size - body) return false;
+
+            if(std::memcmp(chunk, "fmt ", 4) == 0) {
+                if(chunk_size < 16) return false;
+                format = read_u16(chunk + 8);
+                info.channel_count = read_u16(chunk + 10);
+                info.sample_rate = read_u32(chunk + 12);
+                info.block_size = read_u16(chunk + 20);
+                bits = read_u16(chunk + 22);
+                has_format = true;
+            } else if(std::memcmp(chunk, "fact", 4) == 0 && chunk_size >= 4) {
+                fact_frames = read_u32(chunk + 8);
+            } else if(std::memcmp(chunk, "data", 4) == 0) {
+                info.data = bytes + body;
+                info.data_size = chunk_size;
+            }
+
+            // Chunks are padded to an even size
+            offset = body + chunk_size + (chunk_size & 1);
+        }
+
+        if(!has_format || info.data == nullptr) return false;
+        if(info.channel_count < 1 || info.channel_count > 2 || info.sample_rate == 0) return false;
+
+        if(format == k_wav_format_pcm && bits == 16) {
+            info.encoding = AudioEncoding::Pcm16;
+            if(info.block_size != 2 * info.channel_count) return false;
+            info.frames_per_block = 1;
+            info.frame_count = static_cast<uint32_t>(info.data_size / info.block_size);
+            return true;
+        }
+
+        if(format == k_wav_format_ima_adpcm && bits == 4) {
+            info.encoding = AudioEncoding::ImaAdpcm;
+            // Data comes in groups of four bytes per channel after the headers
+            uint32_t header_size = 4 * info.channel_count;
+            if(info.block_size <= header_size || (info.block_size - header_size) % header_size != 0) return false;
+            info.frames_per_block = get_ima_adpcm_frames_per_block(info.block_size, info.channel_count);
+
+            uint64_t full_blocks = info.data_size / info.block_size;
+            uint64_t frames = full_blocks * info.frames_per_block;
+            uint32_t tail = static_cast<uint32_t>(info.data_size % info.block_size);
+            if(tail > header_size) frames += 1 + (tail - header_size) / header_size * 8;
+            // The last block is usually padded, "fact" has the real length
+            if(fact_frames != 0 && fact_frames < frames) frames = fact_frames;
+            info.frame_count = static_cast<uint32_t>(std::min<uint64_t>(frames, UINT32_MAX));
+            return true;
+        }
+
+        return false;
+    }
+
+    uint32_t decode_ima_adpcm_block(const uint8_t* block, uint32_t block_size, uint32_t channel_count, float* const* channels) {
+        const float scale = 1.0f / 32768.0f;
+        uint32_t header_size = 4 * channel_count;
+        if(block_size <= header_size) return 0;
+
+        ImaState states[2];
+        for(uint32_t c = 0; c < channel_count; c++) {
+            states[c].predictor = static_cast<int16_t>(read_u16(block + 4 * c));
+            states[c].index = std::min<int32_t>(block[4 * c + 2], 88);
+            channels[c][0] = states[c].predictor * scale;
+        }
+
+        // Each group is four bytes, eight samples, per channel in turn
+        uint32_t group_count = (block_size - header_size) / header_size;
+        const uint8_t* data = block + header_size;
+        for(uint32_t group = 0; group < group_count; group++) {
+            for(uint32_t c = 0; c < channel_count; c++) {
+                float* out = channels[c] + 1 + group * 8;
+                for(uint32_t i = 0; i < 4; i++) {
+                    uint8_t byte = data[i];
+                    out[i * 2] = decode_ima_nibble(states[c], byte & 0x0f) * scale;
+                    out[i * 2 + 1] = decode_ima_nibble(states[c], byte >> 4) * scale;
+                }
+                data += 4;
+            }
+        }
+        return 1 + group_count * 8;
+    }
+
+    std::vector<uint8_t> encode_wav(const int16_t* samples, uint32_t frame_count, uint32_t channel_count,
+                                    uint32_t sample_rate, AudioEncoding encoding, uint32_t adpcm_block_size) {
+        std::vector<uint8_t> data;
+        uint16_t block_align;
+        uint16_t bits;
+        uint32_t frames_per_block = 1;
+
+        if(encoding == AudioEncoding::Pcm16) {
+            block_align = static_cast<uint16_t>(2 * channel_count);
+            bits = 16;
+            data.resize(static_cast<size_t>(frame_count) * block_align);
+            for(size_t i = 0; i < static_cast<size_t>(frame_count) * channel_count; i++) {
+                data[i * 2] = static_cast<uint8_t>(samples[i]);
+                data[i * 2 + 1] = static_cast<uint8_t>(static_cast<uint16_t>(samples[i]) >> 8);
+            }
+        } else {
+            block_align = static_cast<uint16_t>(adpcm_block_size * channel_count);
+            bits = 4;
+            frames_per_block = get_ima_adpcm_frames_per_block(block_align, channel_count);
+            uint32_t group_count = (frames_per_block - 1) / 8;
+
+            // Past the end the signal is padded with silence
+            auto sample_at = [&](uint32_t frame, uint32_t channel) -> int32_t {
+                return frame < frame_count ? samples[static_cast<size_t>(frame) * channel_count + channel] : 0;
+            };
+
+            ImaState states[2] = {};
+            for(uint32_t first = 0; first < frame_count; first += frames_per_block) {
+                for(uint32_t c = 0; c < channel_count; c++) {
+                    // The header holds the first frame exactly
+                    states[c].predictor = sample_at(first, c);
+                    write_u16(data, static_cast<uint16_t>(static_cast<int16_t>(states[c].predictor)));
+                    data.push_back(static_cast<uint8_t>(states[c].index));
+                    data.push_back(0);
+                }
+
+                for(uint32_t group = 0; group < group_count; group++) {
+                    for(uint32_t c = 0; c < channel_count; c++) {
+                        uint32_t frame = first + 1 + group * 8;
+                        for(uint32_t i = 0; i < 4; i++) {
+                            uint32_t low = encode_ima_sample(states[c], sample_at(frame + i * 2, c));
+                            uint32_t high = encode_ima_sample(states[c], sample_at(frame + i * 2 + 1, c));
+                            data.push_back(static_cast<uint8_t>(low | (high << 4)));
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<uint8_t> out;
+        bool adpcm = encoding == AudioEncoding::ImaAdpcm;
+        uint32_t format_size = adpcm ? 20 : 16;
+        uint32_t fact_size = adpcm ? 12 : 0;
+        out.reserve(12 + 8 + format_size + fact_size + 8 + data.size() + 1);
+
+        out.insert(out.end(), {'R', 'I', 'F', 'F'});
+        write_u32(out, static_cast<uint32_t>(4 + 8 + format_size + fact_size + 8 + data.size() + (data.size() & 1)));
+        out.insert(out.end(), {'W', 'A', 'V', 'E'});
+
+        out.insert(out.end(), {'f', 'm', 't', ' '});
+        write_u32(out, format_size);
+        write_u16(out, adpcm ? k_wav_format_ima_adpcm : k_wav_format_pcm);
+        write_u16(out, static_cast<uint16_t>(channel_count));
+        write_u32(out, sample_rate);
+        write_u32(out, static_cast<uint32_t>(static_cast<uint64_t>(sample_rate) * block_align / frames_per_block));
+        write_u16(out, block_align);
+        write_u16(out, bits);
+        if(adpcm) {
+            write_u16(out, 2);
+            write_u16(out, static_cast<uint16_t>(frames_per_block));
+
+            out.insert(out.end(), {'f', 'a', 'c', 't'});
+            write_u32(out, 4);
+            write_u32(out, frame_count);
+        }
+
+        out.insert(out.end(), {'d', 'a', 't', 'a'});
+        write_u32(out, static_cast<uint32_t>(data.size()));
+        out.insert(out.end(), data.begin(), data.end());
+        if(data.size() & 1) out.push_back(0);
+        return out;
+    }
+
+    bool AudioClip::load_wav(const uint8_t* bytes, size_t size) {
+        WavInfo info;
+        if(!parse_wav(bytes, size, info) || info.frame_count == 0) return false;
+
+        allocate(info.channel_count, info.frame_count, info.sample_rate);
+
+        if(info.encoding == AudioEncoding::Pcm16) {
+            const float scale = 1.0f / 32768.0f;
+            for(uint32_t c = 0; c < channel_count; c++) {
+                float* out = get_channel_data(c);
+                const uint8_t* in = info.data + c * 2;
+                for(uint32_t i = 0; i < frame_count; i++) {
+                    out[i] = static_cast<int16_t>(read_u16(in)) * scale;
+                    in += info.block_size;
+                }
+            }
+        } else {
+            // Whole blocks decode straight into the clip, the last one through a
+            // scratch buffer since it may hold padding past the end
+            std::vector<float> scratch(static_cast<size_t>(info.frames_per_block) * channel_count);
+            float* scratch_channels[2] = {scratch.data(), scratch.data() + info.frames_per_block};
+
+            uint32_t frame = 0;
+            const uint8_t* block = info.data;
+            const uint8_t* end = info.data + info.data_size;
+            while(frame < frame_count && block < end) {
+                uint32_t block_size = static_cast<uint32_t>(std::min<size_t>(info.block_size, end - block));
+                uint32_t decoded = decode_ima_adpcm_block(block, block_size, channel_count, scratch_channels);
+                if(decoded == 0) break;
+
+                uint32_t count = std::min(decoded, frame_count - frame);
+                for(uint32_t c = 0; c < channel_count; c++) {
+                    std::memcpy(get_channel_data(c) + frame, scratch_channels[c], count * sizeof(float));
+                }
+                frame += count;
+                block += block_size;
+            }
+
+            if(frame < frame_count) {
+                *this = AudioClip{};
+                return false;
+            }
+        }
+
+        finish();
+        return true;
+    }
+
+    void AudioClip::set_samples(const float* const* channels, uint32_t channel_count, uint32_t frame_count, uint32_t sample_rate) {
+        allocate(channel_count, frame_count, sample_rate);
+        for(uint32_t c = 0; c < channel_count; c++) {
+            std::memcpy(get_channel_data(c), channels[c], frame_count * sizeof(float));
+        }
+        finish();
+    }
+
+    void AudioClip::allocate(uint32_t channel_count, uint32_t frame_count, uint32_t sample_rate) {
+        this->channel_count = channel_count;
+        this->frame_count = frame_count;
+        this->sample_rate = sample_rate;
+        // Keeps every channel 16 byte aligned
+        stride = (frame_count + k_guard_frames + 3) & ~3u;
+        samples.assign(static_cast<size_t>(stride) * channel_count, 0.0f);
+    }
+
+    void AudioClip::finish() {
+        for(uint32_t c = 0; c < channel_count; c++) {
+            float* channel = get_channel_data(c);
+            for(uint32_t i = 0; i < k_guard_frames; i++) {
+                channel[frame_count + i] = channel[i % frame_count];
+            }
+        }
+    }
+
+}
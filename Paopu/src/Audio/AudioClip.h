@@ -0,0 +1,104 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    /// Sample encodings understood in WAV files. IMA ADPCM stores 4 bits per
+    /// sample, a quarter of PCM16, and decodes block by block, which is what
+    /// music is streamed as.
+    ///
+    enum class AudioEncoding : uint8_t {
+        Pcm16 = 0,
+        ImaAdpcm = 1
+    };
+
+    /// Format of a WAV file and where its samples start, see `parse_wav`
+    ///
+    /// `block_size`: Bytes per ADPCM block, or per frame for PCM16
+    /// `frames_per_block`: Frames one ADPCM block decodes to, 1 for PCM16
+    struct PAOPU_API WavInfo {
+        AudioEncoding encoding{AudioEncoding::Pcm16};
+        uint32_t channel_count{0};
+        uint32_t sample_rate{0};
+        uint32_t frame_count{0};
+        uint32_t block_size{0};
+        uint32_t frames_per_block{0};
+        const uint8_t* data{nullptr};
+        size_t data_size{0};
+    };
+
+    /// Reads the RIFF header of a WAV file. Returns false if it isn't one, or
+    /// isn't mono or stereo PCM16 or IMA ADPCM.
+    ///
+    PAOPU_API bool parse_wav(const uint8_t* bytes, size_t size, WavInfo& info);
+
+    /// Decodes one IMA ADPCM block of `block_size` bytes into planar floats,
+    /// channel c into `channels[c]`. Returns the frames decoded; a short last
+    /// block decodes to fewer than `frames_per_block`.
+    ///
+    PAOPU_API uint32_t decode_ima_adpcm_block(const uint8_t* block, uint32_t block_size, uint32_t channel_count, float* const* channels);
+
+    /// Frames in an IMA ADPCM block of `block_size` bytes
+    ///
+    ///
+    inline uint32_t get_ima_adpcm_frames_per_block(uint32_t block_size, uint32_t channel_count) {
+        return (block_size - 4 * channel_count) * 2 / channel_count + 1;
+    }
+
+    /// A WAV file holding `frame_count` frames of interleaved PCM16, stored as
+    /// `encoding`. For tools and tests; IMA ADPCM is written with blocks of
+    /// `adpcm_block_size` bytes per channel.
+    ///
+    PAOPU_API std::vector<uint8_t> encode_wav(const int16_t* samples, uint32_t frame_count, uint32_t channel_count,
+                                                uint32_t sample_rate, AudioEncoding encoding, uint32_t adpcm_block_size = 1024);
+
+    /// A sound decoded into memory, planar floats. Voices play clips without
+    /// copying them, so a clip must outlive every voice playing it.
+    ///
+    /// Each channel is followed by `k_guard_frames` copies of its first frames,
+    /// so the mixer can interpolate past the last frame without a branch, and
+    /// loops wrap around seamlessly.
+    ///
+    class PAOPU_API AudioClip {
+
+        public:
+            static const uint32_t k_guard_frames = 4;
+
+            /// Decodes a mono or stereo PCM16 or IMA ADPCM WAV file. Returns false
+            /// if it's malformed or in another format.
+            ///
+            bool load_wav(const uint8_t* bytes, size_t size);
+
+            /// Copies planar samples, `channel_count` arrays of `frame_count`
+            ///
+            ///
+            void set_samples(const float* const* channels, uint32_t channel_count, uint32_t frame_count, uint32_t sample_rate);
+
+            inline const float* get_channel(uint32_t channel) const { return samples.data() + channel * stride; }
+            inline uint32_t get_channel_count() const { return channel_count; }
+            inline uint32_t get_frame_count() const { return frame_count; }
+            inline uint32_t get_sample_rate() const { return sample_rate; }
+            inline bool is_loaded() const { return frame_count > 0; }
+
+        private:
+            /// Sizes `samples` for the clip, the guard frames are filled by `finish`
+            ///
+            ///
+            void allocate(uint32_t channel_count, uint32_t frame_count, uint32_t sample_rate);
+            void finish();
+
+            inline float* get_channel_data(uint32_t channel) { return samples.data() + channel * stride; }
+
+        private:
+            std::vector<float> samples;
+            uint32_t stride{0};
+            uint32_t channel_count{0};
+            uint32_t frame_count{0};
+            uint32_t sample_rate{0};
+    };
+
+}
@@ -0,0 +1,215 @@
+#include "AudioDevice.h"
+
+#include "../Core/FrameLimiter.h"
+#include "../Core/Profiler.h"
+#include "../Core/Time.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Paopu {
+
+    /// Pulls periods on a thread of its own, paced like a sound card when
+    /// realtime. Outputs override `write`.
+    class ThreadedAudioDevice : public AudioDevice {
+
+        public:
+            explicit ThreadedAudioDevice(const AudioDeviceSettings& settings) : settings(settings) {}
+
+            void start(const AudioFormat& format, AudioRenderFn render, void* user_data) override {
+                stop();
+                this->format = format;
+                this->render = render;
+                this->user_data = user_data;
+                buffer.assign(static_cast<size_t>(format.period_frames) * 2, 0.0f);
+                prepare();
+
+                running.store(true, std::memory_order_relaxed);
+                thread = std::thread(&ThreadedAudioDevice::thread_loop, this);
+            }
+
+            void stop() override {
+                if(!thread.joinable()) return;
+                running.store(false, std::memory_order_relaxed);
+                thread.join();
+                finish();
+            }
+
+            AudioDeviceStats get_stats() const override {
+                AudioDeviceStats stats;
+                stats.periods = periods.load(std::memory_order_relaxed);
+                stats.underruns = underruns.load(std::memory_order_relaxed);
+                stats.render_ns = render_ns.load(std::memory_order_relaxed);
+                stats.max_render_ns = max_render_ns.load(std::memory_order_relaxed);
+                return stats;
+            }
+
+        protected:
+            /// Called before the thread starts, with `format` set
+            virtual void prepare() {}
+
+            /// Called on the audio thread with every rendered period
+            virtual void write(const float* /*frames*/, uint32_t /*frame_count*/) {}
+
+            /// Called once the thread has stopped
+            virtual void finish() {}
+
+        protected:
+            AudioDeviceSettings settings;
+            AudioFormat format;
+
+        private:
+            void thread_loop() {
+                PAO_PROFILE_THREAD("Audio");
+
+                const uint64_t period_ns = static_cast<uint64_t>(format.period_frames) * 1000000000ull / format.sample_rate;
+                const uint64_t buffered = std::max(settings.buffered_periods, 1u);
+                FrameLimiter limiter;
+
+                // The queue starts out full of silence. Period k is pulled when
+                // slot k frees up and plays `buffered` periods later.
+                uint64_t start_ns = get_time_ns();
+                uint64_t index = 0;
+                while(running.load(std::memory_order_relaxed)) {
+                    uint64_t before_ns = get_time_ns();
+                    render(buffer.data(), format.period_frames, user_data);
+                    uint64_t after_ns = get_time_ns();
+                    write(buffer.data(), format.period_frames);
+
+                    uint64_t elapsed_ns = after_ns - before_ns;
+                    periods.fetch_add(1, std::memory_order_relaxed);
+                    render_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+                    if(elapsed_ns > max_render_ns.load(std::memory_order_relaxed)) {
+                        max_render_ns.store(elapsed_ns, std::memory_order_relaxed);
+                    }
+
+                    if(!settings.realtime) continue;
+
+                    if(after_ns > start_ns + (index + buffered) * period_ns) {
+                        // The queue ran dry and the card played silence. It
+                        // restarts from here rather than counting every period
+                        // after as late too.
+                        underruns.fetch_add(1, std::memory_order_relaxed);
+                        start_ns = after_ns - (index + 1) * period_ns;
+                    }
+
+                    index++;
+                    limiter.wait_until(start_ns + index * period_ns);
+                }
+            }
+
+        private:
+            AudioRenderFn render{nullptr};
+            void* user_data{nullptr};
+            std::vector<float> buffer;
+
+            std::thread thread;
+            std::atomic<bool> running{false};
+
+            std::atomic<uint64_t> periods{0};
+            std::atomic<uint64_t> underruns{0};
+            std::atomic<uint64_t> render_ns{0};
+            std::atomic<uint64_t> max_render_ns{0};
+    };
+
+    class NullAudioDevice : public ThreadedAudioDevice {
+
+        public:
+            explicit NullAudioDevice(const AudioDeviceSettings& settings) : ThreadedAudioDevice(settings) {}
+            ~NullAudioDevice() override { stop(); }
+
+            const char* get_name() const override { return "null"; }
+    };
+
+    /// Writes 16 bit PCM. The disk stands in for the sound card, so a slow
+    /// write shows up as an underrun like a slow render does.
+    class WavFileAudioDevice : public ThreadedAudioDevice {
+
+        public:
+            explicit WavFileAudioDevice(const AudioDeviceSettings& settings) : ThreadedAudioDevice(settings) {
+                file = std::fopen(settings.path.c_str(), "wb");
+                if(file == nullptr) {
+                    throw std::runtime_error("[Audio][WavFile]: Failed to create " + settings.path + "!");
+                }
+            }
+
+            ~WavFileAudioDevice() override {
+                stop();
+                if(file != nullptr) std::fclose(file);
+            }
+
+            const char* get_name() const override { return "wav file"; }
+
+        protected:
+            void prepare() override {
+                samples.resize(static_cast<size_t>(format.period_frames) * 2);
+                data_bytes = 0;
+                std::fseek(file, 0, SEEK_SET);
+                write_header();
+            }
+
+            void write(const float* frames, uint32_t frame_count) override {
+                for(uint32_t i = 0; i < frame_count * 2; i++) {
+                    float sample = std::min(std::max(frames[i], -1.0f), 1.0f);
+                    samples[i] = static_cast<int16_t>(sample * 32767.0f);
+                }
+                data_bytes += std::fwrite(samples.data(), sizeof(int16_t), frame_count * 2, file) * sizeof(int16_t);
+            }
+
+            void finish() override {
+                // Now that the sizes are known
+                std::fseek(file, 0, SEEK_SET);
+                write_header();
+                std::fflush(file);
+            }
+
+        private:
+            void write_header() {
+                uint8_t header[44];
+                auto put_u16 = [&header](uint32_t offset, uint32_t value) {
+                    header[offset] = static_cast<uint8_t>(value);
+                    header[offset + 1] = static_cast<uint8_t>(value >> 8);
+                };
+                auto put_u32 = [&put_u16](uint32_t offset, uint32_t value) {
+                    put_u16(offset, value & 0xffff);
+                    put_u16(offset + 2, value >> 16);
+                };
+
+                uint32_t data_size = static_cast<uint32_t>(std::min<uint64_t>(data_bytes, UINT32_MAX - 36));
+                std::copy_n("RIFF", 4, header);
+                put_u32(4, 36 + data_size);
+                std::copy_n("WAVEfmt ", 8, header + 8);
+                put_u32(16, 16);
+                put_u16(20, 1);
+                put_u16(22, 2);
+                put_u32(24, format.sample_rate);
+                put_u32(28, format.sample_rate * 4);
+                put_u16(32, 4);
+                put_u16(34, 16);
+                std::copy_n("data", 4, header + 36);
+                put_u32(40, data_size);
+                std::fwrite(header, 1, sizeof(header), file);
+            }
+
+        private:
+            std::FILE* file{nullptr};
+            std::vector<int16_t> samples;
+            uint64_t data_bytes{0};
+    };
+
+    std::unique_ptr<AudioDevice> AudioDevice::create(const AudioDeviceSettings& settings) {
+        switch(settings.type) {
+            case AudioDeviceType::Null:
+                return std::make_unique<NullAudioDevice>(settings);
+            case AudioDeviceType::WavFile:
+                return std::make_unique<WavFileAudioDevice>(settings);
+            default:
+                return nullptr;
+        }
+    }
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Paopu {
+
+    /// Output is always interleaved stereo floats. `period_frames` are pulled
+    /// from the render function at a time.
+    ///
+    struct PAOPU_API AudioFormat {
+        uint32_t sample_rate{48000};
+        uint32_t period_frames{256};
+    };
+
+    /// Fills `frame_count` interleaved stereo frames. Runs on the device's
+    /// thread, so it must not lock or allocate.
+    using AudioRenderFn = void(*)(float* frames, uint32_t frame_count, void* user_data);
+
+    enum class AudioDeviceType : uint8_t {
+        // No device, nothing pulls from the mixer
+        None = 0,
+        // Pulls and throws the output away
+        Null = 1,
+        // Pulls and writes the output to a 16 bit WAV file
+        WavFile = 2
+    };
+
+    /// `realtime`: Pull one period per period of wall clock time, the way a
+    ///     sound card does. Otherwise periods are pulled as fast as they are
+    ///     rendered, e.g. to capture to a file faster than realtime.
+    /// `buffered_periods`: Periods queued ahead of playback. A period that
+    ///     isn't rendered before the queue runs dry is an underrun.
+    /// `path`: Output file of `WavFile`
+    struct PAOPU_API AudioDeviceSettings {
+        AudioDeviceType type{AudioDeviceType::Null};
+        bool realtime{true};
+        uint32_t buffered_periods{2};
+        std::string path{};
+    };
+
+    /// Render times in nanoseconds
+    ///
+    ///
+    struct PAOPU_API AudioDeviceStats {
+        uint64_t periods{0};
+        uint64_t underruns{0};
+        uint64_t render_ns{0};
+        uint64_t max_render_ns{0};
+    };
+
+    /// Where mixed audio goes. The device owns the audio thread and pulls
+    /// periods from the render function, the way platform audio APIs call
+    /// back into the application.
+    ///
+    /// Only headless outputs exist so far: a null sink and a WAV file, which
+    /// is enough to measure mixing throughput and underruns on machines
+    /// without a sound card. A platform backend plugs in by implementing this.
+    ///
+    class PAOPU_API AudioDevice {
+
+        public:
+            virtual ~AudioDevice() = default;
+
+            /// Starts pulling from `render` on the audio thread
+            ///
+            ///
+            virtual void start(const AudioFormat& format, AudioRenderFn render, void* user_data) = 0;
+
+            /// Joins the audio thread. Safe to call more than once.
+            ///
+            ///
+            virtual void stop() = 0;
+
+            virtual AudioDeviceStats get_stats() const = 0;
+
+            /// "null" or "wav file"
+            ///
+            ///
+            virtual const char* get_name() const = 0;
+
+            /// nullptr for `AudioDeviceType::None`. Throws if the output file
+            /// can't be created.
+            ///
+            static std::unique_ptr<AudioDevice> create(const AudioDeviceSettings& settings);
+    };
+
+}
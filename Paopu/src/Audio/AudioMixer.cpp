@@ -0,0 +1,753 @@
+#include "AudioMixer.h"
+
+#include "../Core/Logger.h"
+#include "../Core/Profiler.h"
+#include "../Core/Time.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PAO_AUDIO_SSE
+#endif
+
+namespace Paopu {
+
+    static const uint32_t k_no_stream = ~0u;
+    static const uint64_t k_fraction_one = 1ull << 32;
+    // Frames of PCM16 a stream converts at a time
+    static const uint32_t k_pcm_block_frames = 1024;
+    static const float k_min_pitch = 1.0f / 16.0f;
+    static const float k_max_pitch = 16.0f;
+
+    enum class StreamState : uint32_t {
+        Free,
+        // Claimed by the game thread, waiting for the streaming thread
+        Opening,
+        Streaming,
+        // Its voice is done, the streaming thread resets it
+        Closing
+    };
+
+    /// Music decoded ahead of the audio thread. The streaming thread writes
+    /// frames at the output rate into the ring and the audio thread reads
+    /// them; `state` hands the stream between the game thread and the
+    /// streaming thread.
+    struct AudioStream {
+        std::atomic<StreamState> state{StreamState::Free};
+
+        // Set by the game thread before it's Opening
+        const AssetArchive* archive{nullptr};
+        AssetId id{0};
+        bool loop{false};
+
+        // Streaming thread only. `source` holds the last decoded block after
+        // the frame carried over from the block before.
+        WavInfo info{};
+        uint32_t next_frame{0};
+        std::vector<float> source[2];
+        uint32_t source_count{0};
+        uint64_t position{0};
+        uint64_t step{0};
+        bool tail{false};
+        bool done{false};
+
+        std::vector<float> ring[2];
+        uint32_t mask{0};
+        std::atomic<uint32_t> write_index{0};
+        std::atomic<uint32_t> read_index{0};
+        // Set once the last frame is in the ring
+        std::atomic<bool> ended{false};
+    };
+
+    /// Left and right gains. Mono sounds pan with equal power, stereo ones
+    /// keep both sides and turn the other one down.
+    static inline void get_pan_gains(float gain, float pan, bool stereo, float& left, float& right) {
+        if(stereo) {
+            left = gain * std::min(1.0f, 1.0f - pan);
+            right = gain * std::min(1.0f, 1.0f + pan);
+        } else {
+            float angle = (pan + 1.0f) * 0.785398163f;
+            left = gain * std::cos(angle);
+            right = gain * std::sin(angle);
+        }
+    }
+
+    /// Adds `count` frames to the mix with gains ramping by a step per frame.
+    /// Mono sources pass the same channel twice.
+    static void mix_direct(const float* left_source, const float* right_source, uint32_t count,
+                            float* left_out, float* right_out, float& left, float& right, float left_step, float right_step) {
+        uint32_t i = 0;
+    #ifdef PAO_AUDIO_SSE
+        const __m128 ramp = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        __m128 left_gain = _mm_add_ps(_mm_set1_ps(left), _mm_mul_ps(ramp, _mm_set1_ps(left_step)));
+        __m128 right_gain = _mm_add_ps(_mm_set1_ps(right), _mm_mul_ps(ramp, _mm_set1_ps(right_step)));
+        const __m128 left_advance = _mm_set1_ps(left_step * 4.0f);
+        const __m128 right_advance = _mm_set1_ps(right_step * 4.0f);
+        for(; i + 4 <= count; i += 4) {
+            __m128 l = _mm_loadu_ps(left_source + i);
+            __m128 r = _mm_loadu_ps(right_source + i);
+            _mm_storeu_ps(left_out + i, _mm_add_ps(_mm_loadu_ps(left_out + i), _mm_mul_ps(l, left_gain)));
+            _mm_storeu_ps(right_out + i, _mm_add_ps(_mm_loadu_ps(right_out + i), _mm_mul_ps(r, right_gain)));
+            left_gain = _mm_add_ps(left_gain, left_advance);
+            right_gain = _mm_add_ps(right_gain, right_advance);
+        }
+    #endif
+        for(; i < count; i++) {
+            float t = static_cast<float>(i);
+            left_out[i] += left_source[i] * (left + left_step * t);
+            right_out[i] += right_source[i] * (right + right_step * t);
+        }
+        left += left_step * count;
+        right += right_step * count;
+    }
+
+    /// Like `mix_direct`, stepping through the source at `step` frames per
+    /// frame, 32.32 fixed point, and interpolating between neighbours. Reads
+    /// one frame past the last position, the clip's guard frame.
+    template<bool Stereo>
+    static void mix_resampled(const float* left_source, const float* right_source, uint64_t position, uint64_t step, uint32_t count,
+                                float* left_out, float* right_out, float& left, float& right, float left_step, float right_step) {
+        const float fraction_scale = 1.0f / 16777216.0f;
+        uint32_t i = 0;
+    #ifdef PAO_AUDIO_SSE
+        const __m128 ramp = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        __m128 left_gain = _mm_add_ps(_mm_set1_ps(left), _mm_mul_ps(ramp, _mm_set1_ps(left_step)));
+        __m128 right_gain = _mm_add_ps(_mm_set1_ps(right), _mm_mul_ps(ramp, _mm_set1_ps(right_step)));
+        const __m128 left_advance = _mm_set1_ps(left_step * 4.0f);
+        const __m128 right_advance = _mm_set1_ps(right_step * 4.0f);
+        for(; i + 4 <= count; i += 4) {
+            // SSE2 has no gather, the neighbours are loaded one by one and
+            // everything after that is four wide
+            uint32_t index[4];
+            alignas(16) float fraction[4];
+            for(uint32_t k = 0; k < 4; k++) {
+                index[k] = static_cast<uint32_t>(position >> 32);
+                fraction[k] = static_cast<float>(static_cast<uint32_t>(position) >> 8) * fraction_scale;
+                position += step;
+            }
+            __m128 t = _mm_load_ps(fraction);
+
+            __m128 a = _mm_setr_ps(left_source[index[0]], left_source[index[1]], left_source[index[2]], left_source[index[3]]);
+            __m128 b = _mm_setr_ps(left_source[index[0] + 1], left_source[index[1] + 1], left_source[index[2] + 1], left_source[index[3] + 1]);
+            __m128 l = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+            __m128 r = l;
+            if(Stereo) {
+                a = _mm_setr_ps(right_source[index[0]], right_source[index[1]], right_source[index[2]], right_source[index[3]]);
+                b = _mm_setr_ps(right_source[index[0] + 1], right_source[index[1] + 1], right_source[index[2] + 1], right_source[index[3] + 1]);
+                r = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+            }
+
+            _mm_storeu_ps(left_out + i, _mm_add_ps(_mm_loadu_ps(left_out + i), _mm_mul_ps(l, left_gain)));
+            _mm_storeu_ps(right_out + i, _mm_add_ps(_mm_loadu_ps(right_out + i), _mm_mul_ps(r, right_gain)));
+            left_gain = _mm_add_ps(left_gain, left_advance);
+            right_gain = _mm_add_ps(right_gain, right_advance);
+        }
+    #endif
+        for(; i < count; i++) {
+            uint32_t index = static_cast<uint32_t>(position >> 32);
+            float t = static_cast<float>(static_cast<uint32_t>(position) >> 8) * fraction_scale;
+            position += step;
+
+            float l = left_source[index] + (left_source[index + 1] - left_source[index]) * t;
+            float r = Stereo ? right_source[index] + (right_source[index + 1] - right_source[index]) * t : l;
+            float frame = static_cast<float>(i);
+            left_out[i] += l * (left + left_step * frame);
+            right_out[i] += r * (right + right_step * frame);
+        }
+        left += left_step * count;
+        right += right_step * count;
+    }
+
+    AudioMixer::AudioMixer() = default;
+
+    AudioMixer::~AudioMixer() {
+        shutdown();
+    }
+
+    void AudioMixer::init(const AudioMixerSettings& settings) {
+        shutdown();
+        this->settings = settings;
+        this->settings.max_voices = std::min(std::max(settings.max_voices, 1u), 65535u);
+        uint32_t voice_count = this->settings.max_voices;
+
+        commands.init(settings.command_capacity);
+        // A voice finishes at most once per play, so this never fills up
+        finished.init(voice_count);
+
+        generations.assign(voice_count, 0);
+        busy.assign(voice_count, 0);
+        voice_streams.assign(voice_count, k_no_stream);
+        free_voices.clear();
+        free_voices.reserve(voice_count);
+        for(uint32_t i = voice_count; i-- > 0;) {
+            free_voices.push_back(i);
+        }
+        dropped_commands = 0;
+
+        voices.assign(voice_count, Voice{});
+        active_voices.clear();
+        active_voices.reserve(voice_count);
+        mix_left.assign(k_block_frames, 0.0f);
+        mix_right.assign(k_block_frames, 0.0f);
+        master_gain = 1.0f;
+        master_current = 1.0f;
+
+        uint32_t ring_size = 1;
+        while(ring_size < std::max(settings.stream_buffer_frames, settings.format.period_frames * 2)) ring_size <<= 1;
+        streams = std::make_unique<AudioStream[]>(settings.max_streams);
+        for(uint32_t i = 0; i < settings.max_streams; i++) {
+            AudioStream& stream = streams[i];
+            stream.ring[0].assign(ring_size, 0.0f);
+            stream.ring[1].assign(ring_size, 0.0f);
+            stream.mask = ring_size - 1;
+        }
+
+        active_count.store(0, std::memory_order_relaxed);
+        frames_mixed.store(0, std::memory_order_relaxed);
+        mix_ns.store(0, std::memory_order_relaxed);
+        starved_frames.store(0, std::memory_order_relaxed);
+
+        streamer_running = true;
+        streamer_wake = false;
+        streamer = std::thread(&AudioMixer::streamer_main, this);
+        initialized = true;
+    }
+
+    void AudioMixer::shutdown() {
+        if(!initialized) return;
+
+        {
+            std::lock_guard<std::mutex> lock(streamer_mutex);
+            streamer_running = false;
+        }
+        streamer_condition.notify_one();
+        streamer.join();
+
+        streams.reset();
+        voices.clear();
+        active_voices.clear();
+        mix_left.clear();
+        mix_right.clear();
+        initialized = false;
+    }
+
+    AudioVoiceHandle AudioMixer::play(const AudioClip& clip, const AudioVoiceDesc& desc) {
+        if(!initialized || !clip.is_loaded()) return k_invalid_voice;
+        return start_voice(&clip, k_no_stream, desc);
+    }
+
+    AudioVoiceHandle AudioMixer::play_stream(const AssetArchive& archive, AssetId id, const AudioVoiceDesc& desc) {
+        if(!initialized) return k_invalid_voice;
+
+        const AssetArchiveEntry* entry = archive.find(id);
+        if(entry == nullptr || entry->compression != AssetCompression::None) {
+            PAO_CORE_WARN("Audio stream {:#x} is missing or compressed in the archive", id);
+            return k_invalid_voice;
+        }
+
+        uint32_t index = k_no_stream;
+        for(uint32_t i = 0; i < settings.max_streams; i++) {
+            if(streams[i].state.load(std::memory_order_acquire) == StreamState::Free) {
+                index = i;
+                break;
+            }
+        }
+        if(index == k_no_stream) {
+            dropped_commands++;
+            return k_invalid_voice;
+        }
+
+        // A free stream's ring is empty, so the voice just waits until the
+        // streaming thread has opened it
+        AudioVoiceHandle voice = start_voice(nullptr, index, desc);
+        if(voice == k_invalid_voice) return k_invalid_voice;
+
+        AudioStream& stream = streams[index];
+        stream.archive = &archive;
+        stream.id = id;
+        stream.loop = desc.loop;
+        stream.state.store(StreamState::Opening, std::memory_order_release);
+
+        {
+            std::lock_guard<std::mutex> lock(streamer_mutex);
+            streamer_wake = true;
+        }
+        streamer_condition.notify_one();
+        return voice;
+    }
+
+    AudioVoiceHandle AudioMixer::start_voice(const AudioClip* clip, uint32_t stream, const AudioVoiceDesc& desc) {
+        if(free_voices.empty()) {
+            dropped_commands++;
+            return k_invalid_voice;
+        }
+
+        uint32_t slot = free_voices.back();
+        Command command;
+        command.type = CommandType::Play;
+        command.voice = slot;
+        command.clip = clip;
+        command.stream = stream;
+        command.desc = desc;
+        if(!commands.push(command)) {
+            dropped_commands++;
+            return k_invalid_voice;
+        }
+
+        free_voices.pop_back();
+        busy[slot] = 1;
+        voice_streams[slot] = stream;
+        return slot | (static_cast<uint32_t>(generations[slot]) << 16);
+    }
+
+    void AudioMixer::stop(AudioVoiceHandle voice) {
+        push_voice_command(voice, CommandType::Stop, 0.0f);
+    }
+
+    void AudioMixer::set_gain(AudioVoiceHandle voice, float gain) {
+        push_voice_command(voice, CommandType::SetGain, gain);
+    }
+
+    void AudioMixer::set_pan(AudioVoiceHandle voice, float pan) {
+        push_voice_command(voice, CommandType::SetPan, pan);
+    }
+
+    void AudioMixer::set_pitch(AudioVoiceHandle voice, float pitch) {
+        push_voice_command(voice, CommandType::SetPitch, pitch);
+    }
+
+    void AudioMixer::set_master_gain(float gain) {
+        if(!initialized) return;
+
+        Command command;
+        command.type = CommandType::SetMasterGain;
+        command.value = gain;
+        if(!commands.push(command)) dropped_commands++;
+    }
+
+    void AudioMixer::push_voice_command(AudioVoiceHandle voice, CommandType type, float value) {
+        uint32_t slot = get_slot(voice);
+        if(slot == ~0u) return;
+
+        Command command;
+        command.type = type;
+        command.voice = slot;
+        command.value = value;
+        if(!commands.push(command)) dropped_commands++;
+    }
+
+    uint32_t AudioMixer::get_slot(AudioVoiceHandle voice) const {
+        uint32_t slot = voice & 0xffff;
+        if(voice == k_invalid_voice || slot >= generations.size()) return ~0u;
+        if(generations[slot] != (voice >> 16) || !busy[slot]) return ~0u;
+        return slot;
+    }
+
+    bool AudioMixer::is_playing(AudioVoiceHandle voice) const {
+        return get_slot(voice) != ~0u;
+    }
+
+    void AudioMixer::update() {
+        if(!initialized) return;
+
+        bool wake = false;
+        uint32_t slot;
+        while(finished.pop(slot)) {
+            busy[slot] = 0;
+            generations[slot]++;
+            if(voice_streams[slot] != k_no_stream) {
+                // The audio thread is done with the ring, the streaming thread
+                // can reset it
+                streams[voice_streams[slot]].state.store(StreamState::Closing, std::memory_order_release);
+                voice_streams[slot] = k_no_stream;
+                wake = true;
+            }
+            free_voices.push_back(slot);
+        }
+
+        if(wake) {
+            {
+                std::lock_guard<std::mutex> lock(streamer_mutex);
+                streamer_wake = true;
+            }
+            streamer_condition.notify_one();
+        }
+    }
+
+    AudioMixerStats AudioMixer::get_stats() const {
+        AudioMixerStats stats;
+        stats.active_voices = active_count.load(std::memory_order_relaxed);
+        stats.frames_mixed = frames_mixed.load(std::memory_order_relaxed);
+        stats.mix_ns = mix_ns.load(std::memory_order_relaxed);
+        stats.dropped_commands = dropped_commands;
+        stats.starved_frames = starved_frames.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void AudioMixer::render_callback(float* frames, uint32_t frame_count, void* user_data) {
+        static_cast<AudioMixer*>(user_data)->render(frames, frame_count);
+    }
+
+    void AudioMixer::render(float* frames, uint32_t frame_count) {
+        PAO_PROFILE_FUNCTION();
+        if(mix_left.empty()) {
+            std::memset(frames, 0, static_cast<size_t>(frame_count) * 2 * sizeof(float));
+            return;
+        }
+
+        uint64_t start_ns = get_time_ns();
+
+        Command command;
+        while(commands.pop(command)) {
+            execute(command);
+        }
+
+        for(uint32_t offset = 0; offset < frame_count; offset += k_block_frames) {
+            uint32_t block_frames = frame_count - offset;
+            if(block_frames > k_block_frames) block_frames = k_block_frames;
+            mix_block(frames + static_cast<size_t>(offset) * 2, block_frames);
+        }
+
+        active_count.store(static_cast<uint32_t>(active_voices.size()), std::memory_order_relaxed);
+        frames_mixed.fetch_add(frame_count, std::memory_order_relaxed);
+        mix_ns.fetch_add(get_time_ns() - start_ns, std::memory_order_relaxed);
+    }
+
+    void AudioMixer::execute(const Command& command) {
+        if(command.type == CommandType::SetMasterGain) {
+            master_gain = command.value;
+            return;
+        }
+
+        Voice& voice = voices[command.voice];
+        switch(command.type) {
+            case CommandType::Play: {
+                voice = Voice{};
+                voice.clip = command.clip;
+                voice.stream = command.clip == nullptr ? &streams[command.stream] : nullptr;
+                voice.gain = command.desc.gain;
+                voice.pan = std::min(std::max(command.desc.pan, -1.0f), 1.0f);
+                voice.loop = command.desc.loop;
+                voice.waiting = voice.stream != nullptr;
+                if(voice.clip != nullptr) set_step(voice, command.desc.pitch);
+
+                // Starts at full gain, a fade in would soften the attack
+                bool stereo = voice.clip == nullptr || voice.clip->get_channel_count() > 1;
+                get_pan_gains(voice.gain, voice.pan, stereo, voice.left, voice.right);
+                active_voices.push_back(command.voice);
+                break;
+            }
+            case CommandType::Stop:
+                voice.stopping = true;
+                break;
+            case CommandType::SetGain:
+                voice.gain = command.value;
+                break;
+            case CommandType::SetPan:
+                voice.pan = std::min(std::max(command.value, -1.0f), 1.0f);
+                break;
+            case CommandType::SetPitch:
+                if(voice.clip != nullptr) set_step(voice, command.value);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void AudioMixer::set_step(Voice& voice, float pitch) {
+        pitch = std::min(std::max(pitch, k_min_pitch), k_max_pitch);
+        double step = static_cast<double>(pitch) * voice.clip->get_sample_rate() / settings.format.sample_rate;
+        voice.step = std::max<uint64_t>(static_cast<uint64_t>(step * k_fraction_one + 0.5), 1);
+    }
+
+    void AudioMixer::mix_block(float* frames, uint32_t frame_count) {
+        std::fill_n(mix_left.data(), frame_count, 0.0f);
+        std::fill_n(mix_right.data(), frame_count, 0.0f);
+        float inverse_count = 1.0f / frame_count;
+
+        uint32_t i = 0;
+        while(i < active_voices.size()) {
+            uint32_t slot = active_voices[i];
+            Voice& voice = voices[slot];
+
+            float left, right;
+            bool stereo = voice.clip == nullptr || voice.clip->get_channel_count() > 1;
+            get_pan_gains(voice.stopping ? 0.0f : voice.gain, voice.pan, stereo, left, right);
+            float left_step = (left - voice.left) * inverse_count;
+            float right_step = (right - voice.right) * inverse_count;
+
+            bool alive = voice.clip != nullptr ? mix_clip(voice, left_step, right_step, frame_count)
+                                                : mix_stream(voice, left_step, right_step, frame_count);
+            voice.left = left;
+            voice.right = right;
+
+            // A stopping voice has faded out over this block
+            if(alive && !voice.stopping) {
+                i++;
+                continue;
+            }
+
+            voice.clip = nullptr;
+            voice.stream = nullptr;
+            active_voices[i] = active_voices.back();
+            active_voices.pop_back();
+            finished.push(slot);
+        }
+
+        // Master gain, then interleave
+        float gain = master_current;
+        float gain_step = (master_gain - master_current) * inverse_count;
+        i = 0;
+    #ifdef PAO_AUDIO_SSE
+        __m128 gains = _mm_add_ps(_mm_set1_ps(gain), _mm_mul_ps(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_set1_ps(gain_step)));
+        const __m128 advance = _mm_set1_ps(gain_step * 4.0f);
+        for(; i + 4 <= frame_count; i += 4) {
+            __m128 l = _mm_mul_ps(_mm_loadu_ps(mix_left.data() + i), gains);
+            __m128 r = _mm_mul_ps(_mm_loadu_ps(mix_right.data() + i), gains);
+            _mm_storeu_ps(frames + i * 2, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(frames + i * 2 + 4, _mm_unpackhi_ps(l, r));
+            gains = _mm_add_ps(gains, advance);
+        }
+    #endif
+        for(; i < frame_count; i++) {
+            float g = gain + gain_step * static_cast<float>(i);
+            frames[i * 2] = mix_left[i] * g;
+            frames[i * 2 + 1] = mix_right[i] * g;
+        }
+        master_current = master_gain;
+    }
+
+    bool AudioMixer::mix_clip(Voice& voice, float left_step, float right_step, uint32_t frame_count) {
+        const AudioClip& clip = *voice.clip;
+        bool stereo = clip.get_channel_count() > 1;
+        const float* left_source = clip.get_channel(0);
+        const float* right_source = clip.get_channel(stereo ? 1 : 0);
+        const uint64_t end = static_cast<uint64_t>(clip.get_frame_count()) << 32;
+
+        uint32_t done = 0;
+        while(done < frame_count) {
+            if(voice.position >= end) {
+                if(!voice.loop) return false;
+                voice.position %= end;
+            }
+
+            // Up to the end of the clip, so no frame reads past the guard
+            uint64_t until_end = (end - voice.position + voice.step - 1) / voice.step;
+            uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(frame_count - done, until_end));
+            float* left_out = mix_left.data() + done;
+            float* right_out = mix_right.data() + done;
+
+            if(voice.step == k_fraction_one && static_cast<uint32_t>(voice.position) == 0) {
+                uint32_t first = static_cast<uint32_t>(voice.position >> 32);
+                mix_direct(left_source + first, right_source + first, count, left_out, right_out,
+                            voice.left, voice.right, left_step, right_step);
+            } else if(stereo) {
+                mix_resampled<true>(left_source, right_source, voice.position, voice.step, count, left_out, right_out,
+                                    voice.left, voice.right, left_step, right_step);
+            } else {
+                mix_resampled<false>(left_source, right_source, voice.position, voice.step, count, left_out, right_out,
+                                    voice.left, voice.right, left_step, right_step);
+            }
+
+            voice.position += voice.step * count;
+            done += count;
+        }
+        return true;
+    }
+
+    bool AudioMixer::mix_stream(Voice& voice, float left_step, float right_step, uint32_t frame_count) {
+        AudioStream& stream = *voice.stream;
+
+        // `ended` is set after the last write, so read it first
+        bool ended = stream.ended.load(std::memory_order_acquire);
+        uint32_t read = stream.read_index.load(std::memory_order_relaxed);
+        uint32_t available = stream.write_index.load(std::memory_order_acquire) - read;
+
+        if(voice.waiting) {
+            if(!ended && available < settings.format.period_frames) return true;
+            voice.waiting = false;
+        }
+
+        uint32_t count = std::min(frame_count, available);
+        uint32_t first = read & stream.mask;
+        uint32_t before_wrap = std::min(count, stream.mask + 1 - first);
+        mix_direct(stream.ring[0].data() + first, stream.ring[1].data() + first, before_wrap,
+                    mix_left.data(), mix_right.data(), voice.left, voice.right, left_step, right_step);
+        mix_direct(stream.ring[0].data(), stream.ring[1].data(), count - before_wrap,
+                    mix_left.data() + before_wrap, mix_right.data() + before_wrap, voice.left, voice.right, left_step, right_step);
+        stream.read_index.store(read + count, std::memory_order_release);
+
+        if(count < frame_count) {
+            if(ended) return false;
+            starved_frames.fetch_add(frame_count - count, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void AudioMixer::streamer_main() {
+        PAO_PROFILE_THREAD("Audio streaming");
+        const auto interval = std::chrono::duration<double>(settings.stream_poll_interval);
+
+        std::unique_lock<std::mutex> lock(streamer_mutex);
+        while(streamer_running) {
+            lock.unlock();
+
+            for(uint32_t i = 0; i < settings.max_streams; i++) {
+                AudioStream& stream = streams[i];
+                switch(stream.state.load(std::memory_order_acquire)) {
+                    case StreamState::Opening: {
+                        open_stream(stream);
+                        // The voice may already be done and the stream closing
+                        StreamState expected = StreamState::Opening;
+                        stream.state.compare_exchange_strong(expected, StreamState::Streaming, std::memory_order_acq_rel);
+                        fill_stream(stream);
+                        break;
+                    }
+                    case StreamState::Streaming:
+                        fill_stream(stream);
+                        break;
+                    case StreamState::Closing:
+                        stream.write_index.store(0, std::memory_order_relaxed);
+                        stream.read_index.store(0, std::memory_order_relaxed);
+                        stream.ended.store(false, std::memory_order_relaxed);
+                        stream.state.store(StreamState::Free, std::memory_order_release);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            lock.lock();
+            streamer_condition.wait_for(lock, interval, [this]() { return !streamer_running || streamer_wake; });
+            streamer_wake = false;
+        }
+    }
+
+    void AudioMixer::open_stream(AudioStream& stream) {
+        PAO_PROFILE_FUNCTION();
+        stream.source_count = 0;
+        stream.next_frame = 0;
+        stream.position = 0;
+        stream.tail = false;
+        stream.done = false;
+
+        AssetView view = stream.archive->get_view(stream.id);
+        if(!view.is_valid() || !parse_wav(view.data, view.size, stream.info)) {
+            PAO_CORE_WARN("Audio stream {:#x} isn't a PCM16 or IMA ADPCM WAV", stream.id);
+            stream.done = true;
+            stream.ended.store(true, std::memory_order_release);
+            return;
+        }
+
+        // Page the file in ahead of the decoder
+        stream.archive->prefetch(*stream.archive->find(stream.id));
+
+        // A block plus the frame carried over
+        uint32_t block_frames = stream.info.encoding == AudioEncoding::Pcm16 ? k_pcm_block_frames : stream.info.frames_per_block;
+        stream.source[0].resize(block_frames + 1);
+        stream.source[1].resize(block_frames + 1);
+
+        double step = static_cast<double>(stream.info.sample_rate) / settings.format.sample_rate;
+        stream.step = static_cast<uint64_t>(step * k_fraction_one + 0.5);
+    }
+
+    bool AudioMixer::decode_stream_block(AudioStream& stream) {
+        const WavInfo& info = stream.info;
+        if(stream.next_frame >= info.frame_count) {
+            if(!stream.loop || info.frame_count == 0) return false;
+            stream.next_frame = 0;
+        }
+
+        // Interpolation runs across the block boundary from the last frame
+        uint32_t carry = 0;
+        if(stream.source_count > 0) {
+            for(uint32_t c = 0; c < info.channel_count; c++) {
+                stream.source[c][0] = stream.source[c][stream.source_count - 1];
+            }
+            stream.position -= static_cast<uint64_t>(stream.source_count - 1) << 32;
+            carry = 1;
+        }
+
+        float* out[2] = {stream.source[0].data() + carry, stream.source[1].data() + carry};
+        uint32_t decoded;
+        if(info.encoding == AudioEncoding::ImaAdpcm) {
+            size_t offset = static_cast<size_t>(stream.next_frame / info.frames_per_block) * info.block_size;
+            uint32_t block_size = static_cast<uint32_t>(std::min<size_t>(info.block_size, info.data_size - offset));
+            decoded = decode_ima_adpcm_block(info.data + offset, block_size, info.channel_count, out);
+        } else {
+            const float scale = 1.0f / 32768.0f;
+            decoded = std::min(k_pcm_block_frames, info.frame_count - stream.next_frame);
+            const uint8_t* in = info.data + static_cast<size_t>(stream.next_frame) * info.block_size;
+            for(uint32_t i = 0; i < decoded; i++) {
+                for(uint32_t c = 0; c < info.channel_count; c++) {
+                    out[c][i] = static_cast<int16_t>(in[0] | (in[1] << 8)) * scale;
+                    in += 2;
+                }
+            }
+        }
+
+        // Padding in the last block isn't part of the sound
+        decoded = std::min(decoded, info.frame_count - stream.next_frame);
+        if(decoded == 0) {
+            // Corrupt, end on the carried frame
+            stream.source_count = carry;
+            return false;
+        }
+
+        stream.next_frame += decoded;
+        stream.source_count = carry + decoded;
+        return true;
+    }
+
+    void AudioMixer::fill_stream(AudioStream& stream) {
+        if(stream.done) return;
+
+        const uint32_t capacity = stream.mask + 1;
+        uint32_t write = stream.write_index.load(std::memory_order_relaxed);
+        uint32_t space = capacity - (write - stream.read_index.load(std::memory_order_acquire));
+        uint32_t right_channel = stream.info.channel_count > 1 ? 1 : 0;
+
+        while(space > 0) {
+            // Make sure the frame after the current one is decoded
+            while((stream.position >> 32) + 1 >= stream.source_count) {
+                if(decode_stream_block(stream)) continue;
+
+                if(stream.tail || stream.source_count == 0) {
+                    stream.done = true;
+                    break;
+                }
+
+                // The last frame fades into a frame of silence
+                for(uint32_t c = 0; c < stream.info.channel_count; c++) {
+                    stream.source[c][0] = stream.source[c][stream.source_count - 1];
+                    stream.source[c][1] = 0.0f;
+                }
+                stream.position -= static_cast<uint64_t>(stream.source_count - 1) << 32;
+                stream.source_count = 2;
+                stream.tail = true;
+            }
+            if(stream.done) break;
+
+            const float* left = stream.source[0].data();
+            const float* right = stream.source[right_channel].data();
+            while(space > 0 && (stream.position >> 32) + 1 < stream.source_count) {
+                uint32_t index = static_cast<uint32_t>(stream.position >> 32);
+                float t = static_cast<float>(static_cast<uint32_t>(stream.position) >> 8) * (1.0f / 16777216.0f);
+                uint32_t slot = write & stream.mask;
+                stream.ring[0][slot] = left[index] + (left[index + 1] - left[index]) * t;
+                stream.ring[1][slot] = right[index] + (right[index + 1] - right[index]) * t;
+                stream.position += stream.step;
+                write++;
+                space--;
+            }
+        }
+
+        stream.write_index.store(write, std::memory_order_release);
+        if(stream.done) stream.ended.store(true, std::memory_order_release);
+    }
+
+}
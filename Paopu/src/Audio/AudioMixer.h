@@ -0,0 +1,250 @@
+#pragma once
+#include "../Core/Core.h"
+#include "../Assets/AssetArchive.h"
+#include "AudioClip.h"
+#include "AudioDevice.h"
+#include "AudioQueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Paopu {
+
+    // Forward Declarations
+    struct AudioStream;
+
+    /// A playing clip or stream. The low 16 bits are the voice slot, the
+    /// rest a generation, so handles of finished voices go stale.
+    using AudioVoiceHandle = uint32_t;
+    static const AudioVoiceHandle k_invalid_voice = ~0u;
+
+    /// `gain`: Linear, 1 plays the clip as it is
+    /// `pan`: -1 is left, 1 right. Mono sounds pan with equal power, stereo
+    ///     ones turn the other side down.
+    /// `pitch`: Playback speed, 2 is an octave up. Streams ignore it.
+    /// `loop`: Play until stopped
+    struct PAOPU_API AudioVoiceDesc {
+        float gain{1.0f};
+        float pan{0.0f};
+        float pitch{1.0f};
+        bool loop{false};
+    };
+
+    /// `max_voices`: Clips and streams playing at once, up to 65535
+    /// `max_streams`: Streams decoding at once
+    /// `command_capacity`: Commands the game can queue between two periods
+    /// `stream_buffer_frames`: Frames decoded ahead of each stream, rounded up
+    ///     to a power of two. Has to cover `stream_poll_interval` and then some.
+    /// `stream_poll_interval`: Seconds between refills of the stream buffers
+    struct PAOPU_API AudioMixerSettings {
+        AudioFormat format{};
+        uint32_t max_voices{256};
+        uint32_t max_streams{4};
+        uint32_t command_capacity{1024};
+        uint32_t stream_buffer_frames{16384};
+        double stream_poll_interval{0.005};
+    };
+
+    /// `active_voices`: Voices mixed by the last period
+    /// `dropped_commands`: Commands lost to a full queue or voice limit
+    /// `starved_frames`: Stream frames that weren't decoded in time and
+    ///     played as silence
+    struct PAOPU_API AudioMixerStats {
+        uint32_t active_voices{0};
+        uint64_t frames_mixed{0};
+        uint64_t mix_ns{0};
+        uint64_t dropped_commands{0};
+        uint64_t starved_frames{0};
+    };
+
+    /// Mixes clips and streamed music into stereo periods for an AudioDevice.
+    ///
+    /// The game thread never touches the mixer's state directly; `play`,
+    /// `stop` and the setters push commands into a wait-free queue that the
+    /// audio thread drains at the start of every period, and finished voices
+    /// come back through a second one in `update`. Everything the audio thread
+    /// uses is allocated in `init`, so `render` never locks, allocates or
+    /// waits.
+    ///
+    /// Voices are resampled with linear interpolation and mixed four frames
+    /// at a time with SSE, gain and pan ramped across each block so changes
+    /// don't click. Streams are decoded from the asset archive's mapping on a
+    /// streaming thread of their own, resampled to the output rate there, and
+    /// handed over through a ring per stream; page faults and decoding never
+    /// land on the audio thread.
+    ///
+    /// The game-side functions belong to one thread, the frame thread in the
+    /// Application.
+    class PAOPU_API AudioMixer {
+
+        public:
+            static const uint32_t k_block_frames = 256;
+
+            AudioMixer();
+            ~AudioMixer();
+
+            AudioMixer(const AudioMixer&) = delete;
+            AudioMixer& operator=(const AudioMixer&) = delete;
+
+            /// Allocates voices and queues and starts the streaming thread
+            ///
+            ///
+            void init(const AudioMixerSettings& settings = {});
+
+            /// Stops the streaming thread. Stop the device pulling from the
+            /// mixer first.
+            ///
+            void shutdown();
+
+            /// Plays `clip`, which must outlive the voice. Returns
+            /// `k_invalid_voice` if every voice is busy.
+            ///
+            AudioVoiceHandle play(const AudioClip& clip, const AudioVoiceDesc& desc = {});
+
+            /// Streams a PCM16 or IMA ADPCM WAV from `archive`, which must stay
+            /// open while it plays. The asset has to be stored uncompressed so
+            /// it can be read from the mapping. Returns `k_invalid_voice` if
+            /// it can't be, or every stream is busy.
+            ///
+            AudioVoiceHandle play_stream(const AssetArchive& archive, AssetId id, const AudioVoiceDesc& desc = {});
+
+            /// Fades the voice out over a block and frees it
+            ///
+            ///
+            void stop(AudioVoiceHandle voice);
+
+            void set_gain(AudioVoiceHandle voice, float gain);
+            void set_pan(AudioVoiceHandle voice, float pan);
+            void set_pitch(AudioVoiceHandle voice, float pitch);
+            void set_master_gain(float gain);
+
+            /// False once the audio thread finished the voice and `update` has
+            /// seen it
+            ///
+            bool is_playing(AudioVoiceHandle voice) const;
+
+            /// Frees voices the audio thread has finished. Call once a frame.
+            ///
+            ///
+            void update();
+
+            AudioMixerStats get_stats() const;
+            inline const AudioFormat& get_format() const { return settings.format; }
+
+            /// Mixes `frame_count` interleaved stereo frames. Audio thread only.
+            ///
+            ///
+            void render(float* frames, uint32_t frame_count);
+
+            /// AudioRenderFn for AudioDevice::start, `user_data` is the mixer
+            ///
+            ///
+            static void render_callback(float* frames, uint32_t frame_count, void* user_data);
+
+        private:
+            enum class CommandType : uint8_t {
+                Play,
+                Stop,
+                SetGain,
+                SetPan,
+                SetPitch,
+                SetMasterGain
+            };
+
+            struct Command {
+                CommandType type{CommandType::Play};
+                uint32_t voice{0};
+                const AudioClip* clip{nullptr};
+                uint32_t stream{0};
+                float value{0.0f};
+                AudioVoiceDesc desc{};
+            };
+
+            /// Audio thread state of a voice slot
+            struct Voice {
+                const AudioClip* clip;
+                AudioStream* stream;
+                // Frames into the clip, 32.32 fixed point
+                uint64_t position;
+                uint64_t step;
+                float gain;
+                float pan;
+                // Gains the last block ended on, ramped towards gain and pan
+                float left;
+                float right;
+                bool loop;
+                bool stopping;
+                // Streams wait until a period is decoded before starting
+                bool waiting;
+            };
+
+            /// Finds the slot of a live handle, or ~0u
+            ///
+            ///
+            uint32_t get_slot(AudioVoiceHandle voice) const;
+
+            AudioVoiceHandle start_voice(const AudioClip* clip, uint32_t stream, const AudioVoiceDesc& desc);
+            void push_voice_command(AudioVoiceHandle voice, CommandType type, float value);
+
+            // Audio thread
+            void execute(const Command& command);
+            void mix_block(float* frames, uint32_t frame_count);
+            /// Returns false once the voice is done
+            bool mix_clip(Voice& voice, float left_step, float right_step, uint32_t frame_count);
+            bool mix_stream(Voice& voice, float left_step, float right_step, uint32_t frame_count);
+            void set_step(Voice& voice, float pitch);
+
+            // Streaming thread
+            void streamer_main();
+            void open_stream(AudioStream& stream);
+            void fill_stream(AudioStream& stream);
+            /// Decodes the stream's next block after the frame it carries over.
+            /// Returns false at the end of a stream that doesn't loop.
+            bool decode_stream_block(AudioStream& stream);
+
+        private:
+            AudioMixerSettings settings;
+            bool initialized{false};
+
+            SpscQueue<Command> commands;
+            // Voice slots the audio thread finished
+            SpscQueue<uint32_t> finished;
+
+            // Game thread
+            std::vector<uint16_t> generations;
+            std::vector<uint8_t> busy;
+            // Stream index of each busy voice, ~0u for clips
+            std::vector<uint32_t> voice_streams;
+            std::vector<uint32_t> free_voices;
+            uint64_t dropped_commands{0};
+
+            // Audio thread
+            std::vector<Voice> voices;
+            std::vector<uint32_t> active_voices;
+            std::vector<float> mix_left;
+            std::vector<float> mix_right;
+            float master_gain{1.0f};
+            float master_current{1.0f};
+
+            std::unique_ptr<AudioStream[]> streams;
+
+            std::thread streamer;
+            std::mutex streamer_mutex;
+            std::condition_variable streamer_condition;
+            bool streamer_running{false};
+            // Set when a stream opens or closes, so it's handled before the next poll
+            bool streamer_wake{false};
+
+            // Written by the audio thread
+            std::atomic<uint32_t> active_count{0};
+            std::atomic<uint64_t> frames_mixed{0};
+            std::atomic<uint64_t> mix_ns{0};
+            std::atomic<uint64_t> starved_frames{0};
+    };
+
+}
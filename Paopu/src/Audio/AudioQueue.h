@@ -0,0 +1,66 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    /// Bounded single-producer, single-consumer ring.
+    ///
+    /// Both `push` and `pop` are wait-free: one side only ever writes the
+    /// write index and the other the read index, so neither loops, locks or
+    /// allocates. Used to talk to the audio thread, which must never block on
+    /// the game thread. The capacity is rounded up to a power of two and
+    /// allocated by `init`, before either thread starts using the ring.
+    ///
+    template<typename T>
+    class SpscQueue {
+
+        public:
+            void init(uint32_t capacity) {
+                uint32_t size = 1;
+                while(size < capacity) size <<= 1;
+                slots.assign(size, T{});
+                mask = size - 1;
+                write_index.store(0, std::memory_order_relaxed);
+                read_index.store(0, std::memory_order_relaxed);
+            }
+
+            /// Producer only. Returns false if the ring is full.
+            ///
+            ///
+            bool push(const T& value) {
+                uint32_t write = write_index.load(std::memory_order_relaxed);
+                if(write - read_index.load(std::memory_order_acquire) > mask) return false;
+
+                slots[write & mask] = value;
+                write_index.store(write + 1, std::memory_order_release);
+                return true;
+            }
+
+            /// Consumer only. Returns false if the ring is empty.
+            ///
+            ///
+            bool pop(T& value) {
+                uint32_t read = read_index.load(std::memory_order_relaxed);
+                if(read == write_index.load(std::memory_order_acquire)) return false;
+
+                value = slots[read & mask];
+                read_index.store(read + 1, std::memory_order_release);
+                return true;
+            }
+
+            inline uint32_t get_capacity() const { return mask + 1; }
+
+        private:
+            std::vector<T> slots;
+            uint32_t mask{0};
+
+            // On their own cache lines, each is written by one thread only
+            alignas(64) std::atomic<uint32_t> write_index{0};
+            alignas(64) std::atomic<uint32_t> read_index{0};
+    };
+
+}
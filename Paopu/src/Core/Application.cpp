@@ -1,47 +1,402 @@
 #include "Application.h"
 
 #include "Window.h"
+#include "FrameLimiter.h"
+#include "JobSystem.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "Time.h"
+#include "../Assets/AssetArchive.h"
+#include "../Memory/AllocationTracker.h"
+#include "../Memory/FrameMemory.h"
 #include "../Renderer/Renderer.h"
 
+#include <exception>
+#include <thread>
+
 namespace Paopu {
+
+    // How often input latency and stray allocations are reported
+    static const uint64_t k_report_interval_ns = 5000000000ull;
     
     Application::Application() {
-        renderer = new Renderer();
+        renderer = std::make_unique<Renderer>();
         
     }
+
+    // Out of line so the unique_ptrs see the complete Renderer and PaopuWindow
+    Application::~Application() = default;
     
 
     void Application::run() {
 
-        // Create our window
-        window = new PaopuWindow("Sandbox");
-        
-        // See Window.h
-        build_window(window);
+        // A replay runs headless, nothing but the recording feeds the loop
+        const bool headless = !settings.replay_input.empty();
+        if(headless) {
+            input_replay.open(settings.replay_input);
+            PAO_CORE_INFO("Replaying {} ({} frames, {} ticks)", settings.replay_input,
+                          input_replay.get_frame_count(), input_replay.get_tick_count());
+        } else {
+            // Create our window
+            window = std::make_unique<PaopuWindow>("Sandbox");
+
+            // See Window.h
+            build_window(window.get());
+            attach_event_queue(window.get(), &event_queue);
+            attach_input_state(window.get(), &input_state);
+        }
 
-        renderer->init_backend(window);
+        // One open and one mapping for every asset, see AssetArchive.h
+        if(!settings.asset_archive.empty()) {
+            assets = std::make_unique<AssetArchive>();
+            assets->open(settings.asset_archive);
+            renderer->set_asset_archive(assets.get());
+        }
+
+        if(!headless) {
+            renderer->init_backend(window.get());
+        }
 
-        main_loop();
+        if(settings.use_input_thread && !headless) {
+            // GLFW only allows event processing on the main thread, so the
+            // frame loop moves to a thread of its own instead.
+            std::exception_ptr frame_error;
+            std::thread frame_thread([this, &frame_error]() {
+                try {
+                    main_loop();
+                } catch (...) {
+                    frame_error = std::current_exception();
+                    glfwSetWindowShouldClose(window->glfw_window, GLFW_TRUE);
+                    glfwPostEmptyEvent();
+                }
+            });
+
+            input_loop();
+            frame_thread.join();
+
+            if(frame_error) {
+                free();
+                std::rethrow_exception(frame_error);
+            }
+        } else {
+            main_loop();
+        }
 
         free();     
     }
 
     void Application::free() {
-        renderer->free_renderer();
-        
-        // See Window.h
-        free_window(window);
+        // Also reached when the frame loop threw, so workers never outlive the app.
+        // Decode jobs run on the workers, so the loader stops first. The render
+        // thread goes before anything it draws with, the audio device before
+        // the mixer it pulls from.
+        render_thread.stop();
+        if(audio_device) audio_device->stop();
+        audio.shutdown();
+        asset_loader.shutdown();
+        JobSystem::shutdown();
+        input_recorder.close(timestep.tick_index);
+
+        if(window) {
+            renderer->free_renderer();
+
+            // See Window.h
+            free_window(window.get());
+        }
 
-        delete window;
-        delete renderer;
+        window.reset();
+        renderer.reset();
+        assets.reset();
 
     }
 
-    void Application::main_loop() {
+    void Application::input_loop() {
+        PAO_PROFILE_THREAD("Input");
         while(!glfwWindowShouldClose(window->glfw_window)) {
-            glfwPollEvents();
+            if(settings.idle_when_minimized && is_window_minimized()) {
+                if(!minimized.load(std::memory_order_relaxed)) {
+                    std::lock_guard<std::mutex> lock(idle_mutex);
+                    minimized.store(true, std::memory_order_relaxed);
+                }
+
+                // Nothing to poll while minimized, sleep until the OS has something
+                glfwWaitEvents();
+                continue;
+            }
+
+            if(minimized.load(std::memory_order_relaxed)) {
+                {
+                    std::lock_guard<std::mutex> lock(idle_mutex);
+                    minimized.store(false, std::memory_order_relaxed);
+                }
+                idle_condition.notify_all();
+            }
+
+            // Wakes as soon as the OS has input for us, callbacks run in here
+            glfwWaitEventsTimeout(settings.input_poll_interval);
+            // See Window.h
+            poll_gamepad_events(window.get());
+
+            input_state.publish(get_time_ns());
+        }
+
+        // Let an idle frame thread see the window closing
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            minimized.store(false, std::memory_order_relaxed);
+        }
+        idle_condition.notify_all();
+    }
+
+    bool Application::should_close() const {
+        if(input_replay.is_open()) {
+            return input_replay.is_finished(timestep.tick_index);
+        }
+        return glfwWindowShouldClose(window->glfw_window);
+    }
+
+    uint64_t Application::get_tick_seed() const {
+        // splitmix64, so neighbouring ticks get unrelated seeds
+        uint64_t seed = random_seed + (timestep.tick_index + 1) * 0x9e3779b97f4a7c15ull;
+        seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ull;
+        seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebull;
+        return seed ^ (seed >> 31);
+    }
+
+    bool Application::is_window_minimized() const {
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window->glfw_window, &width, &height);
+        return glfwGetWindowAttrib(window->glfw_window, GLFW_ICONIFIED) || width == 0 || height == 0;
+    }
+
+    bool Application::wait_while_minimized() {
+        if(!settings.use_input_thread) {
+            // Single threaded we're on the main thread and can block on GLFW directly
+            if(!is_window_minimized()) return false;
+
+            while(is_window_minimized() && !glfwWindowShouldClose(window->glfw_window)) {
+                glfwWaitEvents();
+            }
+            return true;
+        }
+
+        if(!minimized.load(std::memory_order_relaxed)) return false;
+
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        idle_condition.wait(lock, [this]() { return !minimized.load(std::memory_order_relaxed); });
+        return true;
+    }
+
+    void Application::main_loop() {
+        PAO_PROFILE_THREAD("Frame");
+
+        // The frame thread is worker 0, it runs jobs whenever it waits on them
+        JobSystem::init(settings.job_worker_count);
+        PAO_CORE_INFO("Job system running on {} workers", JobSystem::get_worker_count());
+        asset_loader.init(settings.asset_loader);
+        audio.init(settings.audio);
+        audio_device = AudioDevice::create(settings.audio_device);
+        if(audio_device) {
+            audio_device->start(audio.get_format(), &AudioMixer::render_callback, &audio);
+            PAO_CORE_INFO("Audio output: {}", audio_device->get_name());
+        }
+        // The renderer belongs to the render thread from here on. Headless
+        // snapshots are still built and handed over, just not drawn.
+        const bool headless = input_replay.is_open();
+        render_thread.start(settings.render_latency_frames, &Application::render_snapshot, headless ? nullptr : renderer.get());
+
+        timestep.step = settings.fixed_timestep;
+        timestep.max_frame_time = settings.max_frame_time;
+        physics.set_settings(settings.physics);
+
+        random_seed = headless ? input_replay.get_seed() : settings.random_seed;
+        if(random_seed == 0) {
+            random_seed = get_time_ns() * 0x9e3779b97f4a7c15ull;
+        }
+        if(headless && input_replay.get_fixed_timestep() != timestep.step) {
+            PAO_CORE_WARN("Replay was recorded at a {:.6f}s timestep, not {:.6f}s; using the recording's",
+                          input_replay.get_fixed_timestep(), timestep.step);
+            timestep.step = input_replay.get_fixed_timestep();
         }
+        if(!settings.record_input.empty()) {
+            input_recorder.open(settings.record_input, timestep.step, random_seed);
+            PAO_CORE_INFO("Recording input to {}", settings.record_input);
+        }
+
+        FrameLimiter limiter;
+        const uint64_t frame_period_ns = settings.target_frame_rate > 0.0 ? static_cast<uint64_t>(1e9 / settings.target_frame_rate) : 0;
+
+        uint64_t last_report_ns = get_time_ns();
+        uint64_t previous_frame_ns = last_report_ns;
+        const uint64_t loop_start_ns = last_report_ns;
+
+        while(!should_close()) {
+            if(!settings.use_input_thread && !headless) {
+                glfwPollEvents();
+                // See Window.h
+                poll_gamepad_events(window.get());
+                input_state.publish(get_time_ns());
+            }
+
+            if(!headless && settings.idle_when_minimized && wait_while_minimized()) {
+                // The time spent minimized shouldn't be simulated
+                previous_frame_ns = get_time_ns();
+                continue;
+            }
+
+            // Replays advance exactly one tick per frame, however long it took
+            uint64_t frame_start_ns = get_time_ns();
+            double frame_time = headless ? timestep.step : ns_to_seconds(frame_start_ns - previous_frame_ns);
+            previous_frame_ns = frame_start_ns;
+
+            AllocationStats allocations_before = get_allocation_stats();
+
+            run_frame(frame_time);
+
+            uint64_t frame_end_ns = get_time_ns();
+            input_latency.record(*current_input, frame_end_ns);
+
+            if(frame_end_ns - last_report_ns >= k_report_interval_ns) {
+                if(input_latency.samples > 0) {
+                    PAO_CORE_TRACE("Input latency: {:.3f}ms avg, {:.3f}ms max", input_latency.get_average_ms(), input_latency.max_ns * 1e-6);
+                    input_latency.reset();
+                }
+                if(steady_state_allocations > 0) {
+                    PAO_CORE_WARN("{} heap allocations in steady-state frames since the last report", steady_state_allocations);
+                    steady_state_allocations = 0;
+                }
+                last_report_ns = frame_end_ns;
+            }
+
+            // Everything a steady-state frame needs should come from frame
+            // arenas or pools, see Memory/
+            FrameMemory::end_frame();
+            frame_count++;
+
+            if(k_track_allocations && frame_count > k_allocation_warmup_frames) {
+                steady_state_allocations += get_allocation_stats().count - allocations_before.count;
+            }
+
+            if(frame_period_ns > 0) {
+                PAO_PROFILE_SCOPE("Frame limiter");
+                limiter.wait_until(frame_start_ns + frame_period_ns);
+            }
+
+            PAO_PROFILE_FRAME();
+        }
+
+        render_thread.stop();
+
+        if(headless) {
+            double seconds = ns_to_seconds(get_time_ns() - loop_start_ns);
+            PAO_CORE_INFO("Replayed {} ticks in {:.3f}s, {:.3f}ms per frame", timestep.tick_index, seconds,
+                          frame_count > 0 ? seconds * 1e3 / frame_count : 0.0);
+        }
+    }
+
+    void Application::render_snapshot(const RenderSnapshot& snapshot, void* user_data) {
+        Renderer* renderer = static_cast<Renderer*>(user_data);
+        // Headless
+        if(renderer == nullptr) return;
+
+        // Set here rather than by the frame thread, the renderer is only
+        // touched from this thread
+        if(snapshot.has_lighting) {
+            renderer->enable_lighting();
+            renderer->set_lights(snapshot.lights.data(), static_cast<uint32_t>(snapshot.lights.size()), snapshot.ambient);
+        }
+        if(snapshot.has_post_processing) {
+            // Only builds the stack once, after that it just takes the settings
+            renderer->enable_post_processing(snapshot.post_settings);
+        }
+        renderer->draw_sprites(snapshot.sprites.data(), static_cast<uint32_t>(snapshot.sprites.size()),
+                                snapshot.has_camera ? &snapshot.camera : nullptr);
+    }
+
+    void Application::drain_events() {
+        if(!input_recorder.is_open()) {
+            event_dispatcher.drain(event_queue);
+            return;
+        }
+
+        // Recorded as dispatched, so the recording holds exactly what this frame saw
+        input_recorder.begin_frame(timestep.tick_index);
+        Event event;
+        uint32_t pending = event_queue.get_pending_count();
+        for(uint32_t i = 0; i < pending && event_queue.pop(event); i++) {
+            input_recorder.record_event(event);
+            event_dispatcher.dispatch(event);
+        }
+    }
+
+    void Application::run_frame(double frame_time) {
+        PAO_PROFILE_FUNCTION();
+        if(input_replay.is_open() && !input_replay.play(timestep.tick_index, event_queue, replay_snapshot)) {
+            PAO_CORE_WARN("Replayed events didn't fit in the event queue and were dropped");
+        }
+        drain_events();
+        asset_loader.update();
+        audio.update();
+
+        // Sample as late as possible, right before the frame is simulated,
+        // so the frame sees the freshest input available.
+        current_input = input_replay.is_open() ? &replay_snapshot : &input_state.sample();
+        if(input_recorder.is_open()) {
+            input_recorder.end_frame(*current_input);
+        }
+
+        Event event;
+
+        timestep.accumulate(frame_time);
+        while(timestep.consume_step()) {
+            PAO_PROFILE_SCOPE("Tick");
+            event.type = EventType::Tick;
+            event.handled = false;
+            event.timestamp_ns = get_time_ns();
+            event.frame = {timestep.step, timestep.tick_index, 0.0};
+            event_dispatcher.dispatch(event);
+
+            physics.step(static_cast<float>(timestep.step));
+            systems.run(world, timestep.step);
+            on_tick(timestep.step);
+        }
+
+        {
+            PAO_PROFILE_SCOPE("Update");
+            event.type = EventType::Update;
+            event.handled = false;
+            event.timestamp_ns = get_time_ns();
+            event.frame = {frame_time, frame_count, 0.0};
+            event_dispatcher.dispatch(event);
+
+            on_update(frame_time);
+        }
+
+        PAO_PROFILE_SCOPE("Render");
+
+        double interpolation = timestep.get_interpolation();
+
+        // Blocks only while the render thread is `render_latency_frames` behind
+        RenderSnapshot& snapshot = render_thread.begin_snapshot();
+        snapshot.frame = frame_count;
+        snapshot.frame_time = frame_time;
+        snapshot.interpolation = interpolation;
+        snapshot.has_camera = false;
+        snapshot.sprites.clear();
+        snapshot.has_lighting = false;
+        snapshot.lights.clear();
+        snapshot.has_post_processing = false;
+        current_snapshot = &snapshot;
+
+        event.type = EventType::Render;
+        event.handled = false;
+        event.timestamp_ns = get_time_ns();
+        event.frame = {frame_time, frame_count, interpolation};
+        event_dispatcher.dispatch(event);
+
+        on_render(interpolation);
 
+        render_thread.submit_snapshot();
     }
 
 
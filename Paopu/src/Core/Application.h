@@ -1,5 +1,22 @@
 #pragma once
 #include "Core.h"
+#include "FixedTimestep.h"
+#include "Input.h"
+#include "InputRecording.h"
+#include "../Events/EventQueue.h"
+#include "../Events/EventDispatcher.h"
+#include "../ECS/System.h"
+#include "../ECS/World.h"
+#include "../Assets/AssetLoader.h"
+#include "../Audio/AudioMixer.h"
+#include "../Renderer/RenderThread.h"
+#include "../Physics/PhysicsWorld.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
 
 //#define GLFW_INCLUDE_VULKAN
 //#include <GLFW/glfw3.h>
@@ -9,21 +26,193 @@ namespace Paopu {
     // Forward Declarations
     class Renderer;
     class PaopuWindow;
+    class AssetArchive;
+
+    /// Knobs a client can change in its constructor, before `run` is called
+    ///
+    /// `use_input_thread`: Pump GLFW on the main thread while the frame loop
+    ///     runs on its own thread, so input is sampled continuously instead of
+    ///     once per frame.
+    /// `input_poll_interval`: Seconds the input thread waits for OS events
+    ///     before polling gamepads, which GLFW can't wait on.
+    /// `job_worker_count`: Threads running jobs, including the frame thread.
+    ///     0 uses one per physical core, see JobSystem.h
+    /// `fixed_timestep`: Seconds simulated by each Tick
+    /// `max_frame_time`: Longest frame fed to the simulation, see FixedTimestep.h
+    /// `target_frame_rate`: Frames per second to cap at, 0 for uncapped
+    /// `idle_when_minimized`: Stop running frames while the window is minimized
+    ///     and block on OS events until it comes back
+    /// `render_latency_frames`: Frames the simulation may run ahead of the
+    ///     render thread, see RenderThread.h. 0 renders on the frame thread.
+    /// `asset_archive`: Packed asset archive mounted at startup, see
+    ///     AssetArchive.h. Empty loads loose files instead.
+    /// `asset_loader`: See AssetLoader.h
+    /// `physics`: See PhysicsWorld.h
+    /// `audio`: See AudioMixer.h
+    /// `audio_device`: Where the mixer's output goes, see AudioDevice.h
+    /// `record_input`: File the session's input is recorded to, see
+    ///     InputRecording.h. Empty records nothing.
+    /// `replay_input`: Recording to play back instead of reading input. Runs
+    ///     headless, without a window or GPU, one tick per frame until the
+    ///     recording ends, so the same session can be profiled across builds.
+    /// `random_seed`: Seed behind `get_tick_seed`, 0 picks a new one every
+    ///     run. Recordings store theirs and replays use it.
+    struct PAOPU_API ApplicationSettings {
+        bool use_input_thread{true};
+        double input_poll_interval{0.001};
+        uint32_t job_worker_count{0};
+
+        double fixed_timestep{1.0 / 60.0};
+        double max_frame_time{0.25};
+        double target_frame_rate{0.0};
+        bool idle_when_minimized{true};
+        uint32_t render_latency_frames{1};
+
+        std::string asset_archive{};
+        AssetLoaderSettings asset_loader{};
+        PhysicsSettings physics{};
+        AudioMixerSettings audio{};
+        AudioDeviceSettings audio_device{};
+
+        std::string record_input{};
+        std::string replay_input{};
+        uint64_t random_seed{0};
+    };
 
     class PAOPU_API Application {
 
         public:
             Application();
-            virtual ~Application() = default;
+            virtual ~Application();
 
             void run();
 
-        private:
-            /// The main application loop
+            /// Queue that input and worker threads push events onto. Events are
+            /// dispatched once per frame on the frame thread.
+            ///
+            inline EventQueue& get_event_queue() { return event_queue; }
+
+            /// Subscribe here to receive events, see EventDispatcher.h
+            ///
+            ///
+            inline EventDispatcher& get_event_dispatcher() { return event_dispatcher; }
+
+            /// Latency between the newest input a frame saw and that frame finishing
+            ///
+            ///
+            inline const InputLatencyStats& get_input_latency() const { return input_latency; }
+
+            /// Entities and components of the running game, see World.h
+            ///
+            ///
+            inline World& get_world() { return world; }
+
+            /// Systems added here run over the World every tick, before `on_tick`
+            ///
+            ///
+            inline SystemScheduler& get_systems() { return systems; }
+
+            /// Rigid bodies, stepped every tick after the Tick handlers and
+            /// before the systems and `on_tick`
+            ///
+            inline PhysicsWorld& get_physics() { return physics; }
+
+            /// The mounted asset archive, nullptr if `settings.asset_archive` is empty
+            ///
+            ///
+            inline const AssetArchive* get_assets() const { return assets.get(); }
+
+            /// Streams assets in the background. Finished loads are delivered at
+            /// the start of each frame, before the ticks.
+            ///
+            inline AssetLoader& get_asset_loader() { return asset_loader; }
+
+            /// Plays clips and music on the audio device's thread, see AudioMixer.h
+            ///
+            ///
+            inline AudioMixer& get_audio() { return audio; }
+
+        protected:
+            /// Runs zero or more times per frame, each advancing the simulation
+            /// by exactly `fixed_dt` seconds. Deterministic game logic goes here.
+            ///
+            virtual void on_tick(double /*fixed_dt*/) {}
+
+            /// Runs once per frame after the ticks with the real frame time, for
+            /// things that don't need a fixed step (camera smoothing, UI).
+            ///
+            virtual void on_update(double /*dt*/) {}
+
+            /// Runs once per frame last. `interpolation` is how far the frame is
+            /// between the previous tick and the next, see FixedTimestep.h.
+            /// Fill `get_render_snapshot` here, the render thread draws it.
+            ///
+            virtual void on_render(double /*interpolation*/) {}
+
+            /// Input sampled for the current frame, valid inside the hooks
             ///
             ///
+            inline const InputSnapshot& get_input() const { return *current_input; }
+
+            inline const FixedTimestep& get_timestep() const { return timestep; }
+
+            /// Seed for anything random in the current tick. Derived from
+            /// `settings.random_seed` and the tick index, so a replay draws the
+            /// same numbers the recorded session did.
+            ///
+            uint64_t get_tick_seed() const;
+
+            /// What the current frame will draw, valid inside `on_render`. Its
+            /// sprites and lights start out empty every frame.
+            ///
+            inline RenderSnapshot& get_render_snapshot() { return *current_snapshot; }
+
+            inline RenderThreadStats get_render_stats() const { return render_thread.get_stats(); }
+
+        protected:
+            ApplicationSettings settings;
+
+        private:
+            /// The main application loop. Runs on its own thread when
+            /// `settings.use_input_thread` is set.
+            ///
             void main_loop();
 
+            /// Pumps GLFW events and publishes input snapshots until the window
+            /// closes. Must run on the main thread.
+            ///
+            void input_loop();
+
+            /// Runs one frame: events, ticks, update and render
+            ///
+            ///
+            void run_frame(double frame_time);
+
+            /// Blocks the frame thread while the window is minimized. Returns
+            /// true if it waited.
+            ///
+            bool wait_while_minimized();
+
+            /// Whether the frame loop should stop: the window was closed, or
+            /// the replay ran out
+            ///
+            bool should_close() const;
+
+            /// Dispatches queued events, recording them if `settings.record_input` is set
+            ///
+            ///
+            void drain_events();
+
+            /// Whether the window is minimized. Main thread only.
+            ///
+            ///
+            bool is_window_minimized() const;
+
+            /// Draws a snapshot on the render thread, see RenderThread.h
+            ///
+            ///
+            static void render_snapshot(const RenderSnapshot& snapshot, void* user_data);
+
             /// Call to clean up before being destroyed
             ///
             ///
@@ -31,10 +220,49 @@ namespace Paopu {
 
 
         private:
-            Renderer* renderer;
-            PaopuWindow* window;
+            std::unique_ptr<Renderer> renderer;
+            std::unique_ptr<PaopuWindow> window;
+            std::unique_ptr<AssetArchive> assets;
+            AssetLoader asset_loader;
+
+            AudioMixer audio;
+            std::unique_ptr<AudioDevice> audio_device;
+
+            EventQueue event_queue;
+            EventDispatcher event_dispatcher;
+
+            InputState input_state;
+            InputLatencyStats input_latency;
+            const InputSnapshot* current_input{nullptr};
+
+            InputRecorder input_recorder;
+            InputReplay input_replay;
+            // What a replay feeds the frames instead of `input_state`
+            InputSnapshot replay_snapshot;
+            uint64_t random_seed{0};
+
+            FixedTimestep timestep;
+
+            RenderThread render_thread;
+            RenderSnapshot* current_snapshot{nullptr};
+
+            World world;
+            SystemScheduler systems;
+            PhysicsWorld physics;
+
+            // Set by the input thread; the frame thread sleeps on
+            // `idle_condition` while it is
+            std::atomic<bool> minimized{false};
+            std::mutex idle_mutex;
+            std::condition_variable idle_condition;
+
+            // Frames allowed to allocate while caches and arenas warm up
+            // before steady-state allocations are reported
+            static const uint64_t k_allocation_warmup_frames = 120;
+            uint64_t frame_count{0};
+            uint64_t steady_state_allocations{0};
     };
 
     // Defined by the client
     Application* create_application();
-}
\ No newline at end of file
+}
@@ -6,7 +6,6 @@
     #endif
 #elif defined(__linux__)
     #define PAO_PLATFORM_LINUX
-    #error "Linux is not currently supported!"
 #endif
 
 #ifdef PAO_PLATFORM_WINDOWS
@@ -19,8 +18,11 @@
     #else
         #define PAOPU_API
     #endif
+#elif defined(PAO_PLATFORM_LINUX)
+    // Linux is only used for headless runs (see PaopuBench)
+    #define PAOPU_API
 #else
-    #error Paopu currently only supports Windows!
+    #error Paopu currently only supports Windows and Linux!
 #endif
 
 #define BIT(x) (1 << x)
\ No newline at end of file
@@ -3,15 +3,23 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstdlib>
+#include <cstring>
 
 
-#ifdef PAO_PLATFORM_WINDOWS
+#if defined(PAO_PLATFORM_WINDOWS) || defined(PAO_PLATFORM_LINUX)
 
     extern Paopu::Application* Paopu::create_application();
 
     int main(int argc, char** argv){
-        
-        Paopu::Logger::init();
+
+        // `--binary-log <path>` additionally writes every message unformatted,
+        // see Logger::decode_binary_log
+        Paopu::LoggerSettings log_settings;
+        for(int i = 1; i + 1 < argc; i++) {
+            if(std::strcmp(argv[i], "--binary-log") == 0) log_settings.binary_path = argv[i + 1];
+        }
+
+        Paopu::Logger::init(log_settings);
         PAO_CORE_INFO("Logger initialized..");
         PAO_INFO("Client Logger connected..");
         // Comment
@@ -24,10 +32,12 @@
             app->run();
         } catch (const std::exception& e) {
             std::cerr << e.what() << std::endl;
+            Paopu::Logger::shutdown();
             return EXIT_FAILURE;
         }
 
         delete app;
+        Paopu::Logger::shutdown();
 
         return EXIT_SUCCESS;
     }
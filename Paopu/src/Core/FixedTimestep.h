@@ -0,0 +1,86 @@
+#pragma once
+#include "Core.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Accumulator for a fixed simulation step. Real frame time is added each
+    /// frame and consumed in whole steps, so the simulation advances by the
+    /// same `step` no matter how fast frames are.
+    ///
+    /// `max_frame_time`: Longest frame that is fed into the accumulator. A
+    ///     hitch (breakpoint, window drag) would otherwise queue up so many
+    ///     ticks the game can never catch up again.
+    /// `max_ticks_per_frame`: Ticks run in one frame before the remainder is dropped
+    struct PAOPU_API FixedTimestep {
+        double step{1.0 / 60.0};
+        double max_frame_time{0.25};
+        uint32_t max_ticks_per_frame{8};
+
+        double accumulator{0.0};
+        uint64_t tick_index{0};
+        uint32_t ticks_this_frame{0};
+
+        /// Adds a frame's worth of real time
+        ///
+        ///
+        inline void accumulate(double frame_time) {
+            accumulator += std::min(std::max(frame_time, 0.0), max_frame_time);
+            ticks_this_frame = 0;
+        }
+
+        /// Returns true while there is a whole step left to simulate, consuming it
+        ///
+        ///
+        inline bool consume_step() {
+            if(accumulator < step) return false;
+
+            if(ticks_this_frame == max_ticks_per_frame) {
+                // Behind for good, drop the backlog rather than spiralling
+                accumulator = std::min(accumulator, step);
+                return false;
+            }
+
+            accumulator -= step;
+            tick_index++;
+            ticks_this_frame++;
+            return true;
+        }
+
+        /// How far between the last tick and the next one the current frame
+        /// is, in [0, 1). Render interpolates simulation state by this.
+        ///
+        inline double get_interpolation() const {
+            return std::min(accumulator / step, 1.0);
+        }
+    };
+
+    /// The last two simulated values of some state, so rendering can blend
+    /// between them by FixedTimestep::get_interpolation. Call `set` once per tick.
+    ///
+    template<typename T>
+    struct Interpolated {
+        T previous{};
+        T current{};
+
+        inline void set(const T& value) {
+            previous = current;
+            current = value;
+        }
+
+        /// Sets both states, e.g. when teleporting, so nothing is blended
+        ///
+        ///
+        inline void reset(const T& value) {
+            previous = value;
+            current = value;
+        }
+
+        inline T get(double interpolation) const {
+            return previous + (current - previous) * static_cast<float>(interpolation);
+        }
+    };
+
+}
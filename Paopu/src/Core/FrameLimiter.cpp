@@ -0,0 +1,68 @@
+#include "FrameLimiter.h"
+
+#include "Time.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#ifdef PAO_PLATFORM_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <timeapi.h>
+#endif
+
+namespace Paopu {
+
+    // Samples kept in the running estimate before older ones are down-weighted
+    static const uint64_t k_max_sleep_samples = 256;
+
+    FrameLimiter::FrameLimiter() {
+    #ifdef PAO_PLATFORM_WINDOWS
+        // The default 15.6ms timer resolution makes Sleep(1) useless for pacing
+        timeBeginPeriod(1);
+    #endif
+    }
+
+    FrameLimiter::~FrameLimiter() {
+    #ifdef PAO_PLATFORM_WINDOWS
+        timeEndPeriod(1);
+    #endif
+    }
+
+    void FrameLimiter::wait_until(uint64_t deadline_ns) {
+        uint64_t now = get_time_ns();
+
+        while(now < deadline_ns && ns_to_seconds(deadline_ns - now) > sleep_estimate) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            uint64_t after = get_time_ns();
+            record_sleep(ns_to_seconds(after - now));
+            now = after;
+        }
+
+        // Whatever is left is shorter than a sleep can be trusted with
+        while(get_time_ns() < deadline_ns) {
+            std::this_thread::yield();
+        }
+    }
+
+    void FrameLimiter::record_sleep(double seconds) {
+        if(sleep_samples < k_max_sleep_samples) {
+            sleep_samples++;
+        }
+
+        // Running mean and variance; once the sample cap is reached this
+        // turns into an exponential moving average that follows the machine
+        double weight = 1.0 / static_cast<double>(sleep_samples);
+        double delta = seconds - sleep_mean;
+        sleep_mean += weight * delta;
+        sleep_variance = (1.0 - weight) * (sleep_variance + weight * delta * delta);
+
+        sleep_estimate = sleep_mean + std::sqrt(sleep_variance);
+    }
+
+}
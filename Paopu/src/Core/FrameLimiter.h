@@ -0,0 +1,42 @@
+#pragma once
+#include "Core.h"
+
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Waits until a deadline with sub-millisecond precision without burning
+    /// a core for the whole wait.
+    ///
+    /// The OS sleep is only accurate to its scheduler quantum, so the limiter
+    /// sleeps in 1ms slices while the remaining time is comfortably above how
+    /// long such a slice has actually been taking, then spins for the rest.
+    /// The estimate (mean plus one standard deviation of observed slices)
+    /// adapts to the machine, so the spin stays short.
+    ///
+    class PAOPU_API FrameLimiter {
+
+        public:
+            FrameLimiter();
+            ~FrameLimiter();
+
+            FrameLimiter(const FrameLimiter&) = delete;
+            FrameLimiter& operator=(const FrameLimiter&) = delete;
+
+            /// Returns once `get_time_ns() >= deadline_ns`, see Time.h
+            ///
+            ///
+            void wait_until(uint64_t deadline_ns);
+
+        private:
+            /// Records how long a 1ms sleep really took
+            void record_sleep(double seconds);
+
+            // Starts pessimistic, the first few frames spin a little longer
+            double sleep_estimate{0.005};
+            double sleep_mean{0.005};
+            double sleep_variance{0.0};
+            uint64_t sleep_samples{0};
+    };
+
+}
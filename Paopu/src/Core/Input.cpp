@@ -0,0 +1,24 @@
+#include "Input.h"
+
+namespace Paopu {
+
+    void InputState::publish(uint64_t now_ns) {
+        pending.sequence++;
+        pending.published_ns = now_ns;
+        buffers[back_index] = pending;
+
+        // Hand the back buffer over and take whatever the middle slot held
+        uint32_t previous = middle.exchange(back_index | k_fresh_bit, std::memory_order_acq_rel);
+        back_index = previous & ~k_fresh_bit;
+    }
+
+    const InputSnapshot& InputState::sample() {
+        if(middle.load(std::memory_order_relaxed) & k_fresh_bit) {
+            uint32_t previous = middle.exchange(front_index, std::memory_order_acq_rel);
+            front_index = previous & ~k_fresh_bit;
+        }
+
+        return buffers[front_index];
+    }
+
+}
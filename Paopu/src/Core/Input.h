@@ -0,0 +1,125 @@
+#pragma once
+#include "Core.h"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace Paopu {
+
+    /// The full input state at one point in time. Written by the input thread,
+    /// read by the simulation through InputState::sample.
+    ///
+    /// `last_event_ns`: Timestamp of the newest input event folded into this snapshot
+    /// `published_ns`: When the input thread published the snapshot
+    /// `scroll_x/y`: Total scroll since startup. Diff against the previous
+    ///     sample to get the per-frame scroll, so skipped snapshots lose nothing.
+    struct PAOPU_API InputSnapshot {
+        uint64_t sequence{0};
+        uint64_t last_event_ns{0};
+        uint64_t published_ns{0};
+
+        uint8_t keys[GLFW_KEY_LAST + 1]{};
+        uint8_t mouse_buttons[GLFW_MOUSE_BUTTON_LAST + 1]{};
+        double mouse_x{0.0};
+        double mouse_y{0.0};
+        double scroll_x{0.0};
+        double scroll_y{0.0};
+
+        uint8_t gamepad_connected[GLFW_JOYSTICK_LAST + 1]{};
+        GLFWgamepadstate gamepads[GLFW_JOYSTICK_LAST + 1]{};
+
+        inline bool is_key_down(int key) const {
+            return key >= 0 && key <= GLFW_KEY_LAST && keys[key] != 0;
+        }
+
+        inline bool is_mouse_button_down(int button) const {
+            return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && mouse_buttons[button] != 0;
+        }
+    };
+
+    /// Tracks how old the newest input is by the time a frame that used it is
+    /// finished, i.e. the engine's share of input-to-photon latency.
+    ///
+    struct PAOPU_API InputLatencyStats {
+        uint64_t samples{0};
+        uint64_t total_ns{0};
+        uint64_t max_ns{0};
+        uint64_t last_event_ns{0};
+
+        /// Records the latency of `snapshot` if it carries input that hasn't
+        /// been measured yet. `now_ns` is when the frame using it completed.
+        ///
+        inline void record(const InputSnapshot& snapshot, uint64_t now_ns) {
+            if(snapshot.last_event_ns == 0 || snapshot.last_event_ns == last_event_ns || now_ns < snapshot.last_event_ns) return;
+
+            uint64_t latency = now_ns - snapshot.last_event_ns;
+            last_event_ns = snapshot.last_event_ns;
+            samples++;
+            total_ns += latency;
+            max_ns = latency > max_ns ? latency : max_ns;
+        }
+
+        inline double get_average_ms() const {
+            return samples > 0 ? static_cast<double>(total_ns) / samples * 1e-6 : 0.0;
+        }
+
+        inline void reset() {
+            samples = 0;
+            total_ns = 0;
+            max_ns = 0;
+        }
+    };
+
+    /// Hands input snapshots from the input thread to the simulation without
+    /// either side waiting on the other.
+    ///
+    /// The writer fills `pending` as callbacks arrive and `publish`es it into
+    /// its back buffer. The reader keeps a front buffer it can hold onto for
+    /// the whole frame. A third, shared slot is swapped atomically between
+    /// them so a publish never overwrites what the reader is looking at and
+    /// the reader always gets the newest complete snapshot.
+    ///
+    class PAOPU_API InputState {
+
+        public:
+            InputState() = default;
+            InputState(const InputState&) = delete;
+            InputState& operator=(const InputState&) = delete;
+
+            /// State being accumulated by the input thread. Writer only.
+            ///
+            ///
+            inline InputSnapshot& get_pending() { return pending; }
+
+            /// Stamps `timestamp_ns` as the newest input seen. Writer only.
+            ///
+            ///
+            inline void mark_event(uint64_t timestamp_ns) { pending.last_event_ns = timestamp_ns; }
+
+            /// Makes the pending state visible to the reader. Writer only.
+            ///
+            ///
+            void publish(uint64_t now_ns);
+
+            /// Returns the newest published snapshot. Reader only; the reference
+            /// stays valid until the next call to `sample`.
+            ///
+            const InputSnapshot& sample();
+
+        private:
+            static const uint32_t k_fresh_bit = 4;
+
+            InputSnapshot pending;
+            InputSnapshot buffers[3];
+
+            uint32_t back_index{0};
+            uint32_t front_index{1};
+            // Index of the shared slot, with `k_fresh_bit` set when it holds a
+            // snapshot the reader hasn't taken yet
+            std::atomic<uint32_t> middle{2};
+    };
+
+}
@@ -0,0 +1,301 @@
+#include "InputRecording.h"
+
+#include "Profiler.h"
+#include "Time.h"
+#include "../Events/EventQueue.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace Paopu {
+
+    // Frames are written once this much has piled up
+    static const size_t k_recording_flush_size = 64 * 1024;
+    // Unchanged bytes between two changed runs that still merge them, since
+    // a run costs a couple of bytes of its own
+    static const uint32_t k_snapshot_run_gap = 4;
+    // Snapshot bytes that are recorded, everything but the sequence and timestamps
+    static const size_t k_snapshot_offset = offsetof(InputSnapshot, keys);
+    static const size_t k_snapshot_size = sizeof(InputSnapshot) - k_snapshot_offset;
+
+    /// Bytes of the Event union a type uses
+    static uint32_t get_payload_size(EventType type) {
+        switch(type) {
+            case EventType::WindowResize:           return sizeof(WindowResizeEvent);
+            case EventType::WindowMoved:            return sizeof(WindowMovedEvent);
+            case EventType::Tick:
+            case EventType::Update:
+            case EventType::Render:                 return sizeof(FrameEvent);
+            case EventType::KeyPressed:
+            case EventType::KeyReleased:            return sizeof(KeyEvent);
+            case EventType::MouseButtonPressed:
+            case EventType::MouseButtonReleased:    return sizeof(MouseButtonEvent);
+            case EventType::MouseMoved:             return sizeof(MouseMovedEvent);
+            case EventType::MouseScrolled:          return sizeof(MouseScrolledEvent);
+            case EventType::GamepadButtonPressed:
+            case EventType::GamepadButtonReleased:  return sizeof(GamepadButtonEvent);
+            case EventType::GamepadAxisMoved:       return sizeof(GamepadAxisEvent);
+            default:                                return 0;
+        }
+    }
+
+    static inline const uint8_t* get_payload(const Event& event) {
+        return reinterpret_cast<const uint8_t*>(&event.window_resize);
+    }
+
+    static inline void write_varint(std::vector<uint8_t>& out, uint64_t value) {
+        while(value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static inline bool read_varint(const std::vector<uint8_t>& in, size_t& offset, uint64_t& value) {
+        value = 0;
+        for(uint32_t shift = 0; shift < 64; shift += 7) {
+            if(offset >= in.size()) return false;
+            uint8_t byte = in[offset++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    InputRecorder::~InputRecorder() {
+        close();
+    }
+
+    void InputRecorder::open(const std::string& path, double fixed_timestep, uint64_t seed) {
+        close();
+
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if(!file.is_open()) {
+            throw std::runtime_error("[Core][InputRecorder]: Failed to open " + path + " for writing!");
+        }
+        this->path = path;
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, k_input_recording_magic, sizeof(header.magic));
+        header.version = k_input_recording_version;
+        header.fixed_timestep = fixed_timestep;
+        header.seed = seed;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        buffer.clear();
+        buffer.reserve(k_recording_flush_size * 2);
+        frame_events.clear();
+        frame_event_count = 0;
+        start_ns = get_time_ns();
+        last_event_ns = 0;
+        frame_tick = 0;
+        last_tick = 0;
+        frame_count = 0;
+        // Runs are diffed against an empty snapshot to begin with
+        previous = InputSnapshot{};
+    }
+
+    void InputRecorder::close(uint64_t tick_count) {
+        if(!file.is_open()) return;
+
+        // Also reached from the destructor, so a failed write only costs the
+        // frames that didn't make it
+        flush();
+        header.frame_count = frame_count;
+        header.tick_count = std::max(tick_count, last_tick);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.close();
+    }
+
+    void InputRecorder::begin_frame(uint64_t tick_index) {
+        frame_tick = tick_index;
+        frame_events.clear();
+        frame_event_count = 0;
+    }
+
+    void InputRecorder::record_event(const Event& event) {
+        // Relative to the start of the recording and to the previous event,
+        // so they fit a byte or two
+        uint64_t timestamp_ns = event.timestamp_ns > start_ns ? event.timestamp_ns - start_ns : 0;
+        timestamp_ns = std::max(timestamp_ns, last_event_ns);
+
+        frame_events.push_back(static_cast<uint8_t>(event.type));
+        write_varint(frame_events, timestamp_ns - last_event_ns);
+        const uint8_t* payload = get_payload(event);
+        frame_events.insert(frame_events.end(), payload, payload + get_payload_size(event.type));
+
+        last_event_ns = timestamp_ns;
+        frame_event_count++;
+    }
+
+    void InputRecorder::end_frame(const InputSnapshot& snapshot) {
+        PAO_PROFILE_FUNCTION();
+
+        write_varint(buffer, frame_tick - last_tick);
+        write_varint(buffer, frame_event_count);
+        buffer.insert(buffer.end(), frame_events.begin(), frame_events.end());
+
+        const uint8_t* current = reinterpret_cast<const uint8_t*>(&snapshot) + k_snapshot_offset;
+        uint8_t* last = reinterpret_cast<uint8_t*>(&previous) + k_snapshot_offset;
+
+        // Runs are counted up front so the count can go first
+        uint32_t run_count = 0;
+        for(size_t i = 0; i < k_snapshot_size; ) {
+            if(current[i] == last[i]) { i++; continue; }
+            run_count++;
+            size_t same = 0;
+            for(i++; i < k_snapshot_size && same <= k_snapshot_run_gap; i++) {
+                same = current[i] == last[i] ? same + 1 : 0;
+            }
+        }
+
+        write_varint(buffer, run_count);
+        size_t run_end = 0;
+        for(size_t i = 0; i < k_snapshot_size; ) {
+            if(current[i] == last[i]) { i++; continue; }
+            size_t start = i;
+            size_t end = i + 1;
+            size_t same = 0;
+            for(i++; i < k_snapshot_size && same <= k_snapshot_run_gap; i++) {
+                if(current[i] == last[i]) {
+                    same++;
+                } else {
+                    same = 0;
+                    end = i + 1;
+                }
+            }
+
+            write_varint(buffer, start - run_end);
+            write_varint(buffer, end - start);
+            buffer.insert(buffer.end(), current + start, current + end);
+            run_end = end;
+        }
+        memcpy(last, current, k_snapshot_size);
+
+        last_tick = frame_tick;
+        frame_count++;
+        if(buffer.size() >= k_recording_flush_size && !flush()) {
+            throw std::runtime_error("[Core][InputRecorder]: Failed to write " + path + "!");
+        }
+    }
+
+    bool InputRecorder::flush() {
+        if(buffer.empty()) return true;
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+        return static_cast<bool>(file);
+    }
+
+    void InputReplay::open(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if(!file.is_open()) {
+            throw std::runtime_error("[Core][InputReplay]: Failed to open " + path + "!");
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        if(data.size() < sizeof(InputRecordingHeader)) {
+            data.clear();
+            throw std::runtime_error("[Core][InputReplay]: " + path + " is too small to be an input recording!");
+        }
+        memcpy(&header, data.data(), sizeof(header));
+        if(memcmp(header.magic, k_input_recording_magic, sizeof(header.magic)) != 0 || header.version != k_input_recording_version
+            || !(header.fixed_timestep > 0.0)) {
+            data.clear();
+            throw std::runtime_error("[Core][InputReplay]: " + path + " is not a valid input recording!");
+        }
+
+        // Walk every frame once, so a recording that was cut short ends
+        // cleanly after its last whole frame
+        size_t offset = sizeof(InputRecordingHeader);
+        uint64_t tick = 0;
+        bool queue_full = false;
+        frame_count = 0;
+        for(size_t next = offset; read_frame(next, tick, nullptr, nullptr, queue_full); offset = next) {
+            frame_count++;
+        }
+        data.resize(offset);
+        tick_count = std::max(header.tick_count, tick);
+
+        frame_offset = sizeof(InputRecordingHeader);
+        frame_tick = 0;
+        start_ns = get_time_ns();
+        event_ns = 0;
+    }
+
+    bool InputReplay::play(uint64_t tick_index, EventQueue& queue, InputSnapshot& snapshot) {
+        PAO_PROFILE_FUNCTION();
+
+        bool queue_full = false;
+        while(frame_offset < data.size()) {
+            // Frames that start after this tick wait for a later one
+            size_t offset = frame_offset;
+            uint64_t delta = 0;
+            if(!read_varint(data, offset, delta) || frame_tick + delta > tick_index) break;
+
+            read_frame(frame_offset, frame_tick, &queue, &snapshot, queue_full);
+        }
+
+        // Nothing in the recording measured latency through this snapshot
+        snapshot.sequence++;
+        snapshot.last_event_ns = 0;
+        return !queue_full;
+    }
+
+    bool InputReplay::is_finished(uint64_t tick_index) const {
+        return frame_offset >= data.size() && tick_index >= tick_count;
+    }
+
+    bool InputReplay::read_frame(size_t& offset, uint64_t& tick, EventQueue* queue, InputSnapshot* snapshot, bool& queue_full) {
+        size_t position = offset;
+        uint64_t delta = 0;
+        uint64_t event_count = 0;
+        if(!read_varint(data, position, delta) || !read_varint(data, position, event_count)) return false;
+
+        for(uint64_t i = 0; i < event_count; i++) {
+            if(position >= data.size() || data[position] >= k_event_type_count) return false;
+            EventType type = static_cast<EventType>(data[position++]);
+
+            uint64_t elapsed_ns = 0;
+            uint32_t payload_size = get_payload_size(type);
+            if(!read_varint(data, position, elapsed_ns) || data.size() - position < payload_size) return false;
+
+            if(queue != nullptr) {
+                event_ns += elapsed_ns;
+
+                Event event;
+                event.type = type;
+                event.timestamp_ns = start_ns + event_ns;
+                memcpy(reinterpret_cast<uint8_t*>(&event.window_resize), &data[position], payload_size);
+                queue_full |= !queue->push(event);
+            }
+            position += payload_size;
+        }
+
+        uint64_t run_count = 0;
+        if(!read_varint(data, position, run_count)) return false;
+
+        uint8_t* bytes = snapshot != nullptr ? reinterpret_cast<uint8_t*>(snapshot) + k_snapshot_offset : nullptr;
+        uint64_t run_end = 0;
+        for(uint64_t i = 0; i < run_count; i++) {
+            uint64_t skip = 0;
+            uint64_t length = 0;
+            if(!read_varint(data, position, skip) || !read_varint(data, position, length)) return false;
+            if(run_end + skip + length > k_snapshot_size || data.size() - position < length) return false;
+
+            if(bytes != nullptr) {
+                memcpy(bytes + run_end + skip, &data[position], length);
+            }
+            run_end += skip + length;
+            position += length;
+        }
+
+        offset = position;
+        tick += delta;
+        return true;
+    }
+
+}
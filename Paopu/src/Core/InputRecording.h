@@ -0,0 +1,166 @@
+#pragma once
+#include "Core.h"
+#include "Input.h"
+#include "../Events/Event.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Paopu {
+
+    // Forward Declarations
+    class EventQueue;
+
+    // --------------------------------------------------------------------
+    //                          - File layout -
+    // --------------------------------------------------------------------
+    //  InputRecordingHeader
+    //  One record per frame, until the end of the file:
+    //      varint  ticks since the previous frame's
+    //      varint  event count
+    //      events: u8 type, varint ns since the previous event, the type's
+    //              payload as it is laid out in Event
+    //      varint  changed run count
+    //      runs:   varint offset past the previous run, varint length, the
+    //              InputSnapshot bytes from `keys` on that changed
+    //
+    //  Everything is little endian. A recording cut short by a crash keeps
+    //  every whole frame written before it.
+
+    static const char k_input_recording_magic[8] = {'P', 'A', 'O', 'R', 'E', 'C', '0', '1'};
+    static const uint32_t k_input_recording_version = 1;
+
+    struct InputRecordingHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        double fixed_timestep;
+        uint64_t seed;
+        // Written when the recording is closed, 0 if it never was
+        uint64_t frame_count;
+        uint64_t tick_count;
+    };
+
+    static_assert(sizeof(InputRecordingHeader) == 48, "The header is part of the file format");
+
+    /// Writes the events and input snapshots the simulation saw, frame by
+    /// frame, keyed by the tick each frame started on.
+    ///
+    /// Only what changed is written: events with their payload, and the runs
+    /// of the sampled InputSnapshot that differ from the previous frame's.
+    /// Frames are buffered and written in large chunks, so recording costs
+    /// the frame thread a few hundred nanoseconds and no allocations once
+    /// the buffer has grown.
+    class PAOPU_API InputRecorder {
+
+        public:
+            InputRecorder() = default;
+            ~InputRecorder();
+
+            InputRecorder(const InputRecorder&) = delete;
+            InputRecorder& operator=(const InputRecorder&) = delete;
+
+            /// Throws if `path` can't be created
+            ///
+            ///
+            void open(const std::string& path, double fixed_timestep, uint64_t seed);
+
+            /// Flushes everything and fills in the header. `tick_count` is how
+            /// many ticks the session ran, if it's known. Safe to call more
+            /// than once.
+            ///
+            void close(uint64_t tick_count = 0);
+
+            /// Starts the record of a frame whose first tick will be `tick_index` + 1
+            ///
+            ///
+            void begin_frame(uint64_t tick_index);
+
+            void record_event(const Event& event);
+
+            /// Finishes the frame with the snapshot it sampled
+            ///
+            ///
+            void end_frame(const InputSnapshot& snapshot);
+
+            inline bool is_open() const { return file.is_open(); }
+            inline uint64_t get_frame_count() const { return frame_count; }
+
+        private:
+            /// Writes the buffered frames, false if the file couldn't take them
+            bool flush();
+
+            std::ofstream file;
+            std::string path;
+            InputRecordingHeader header{};
+
+            // Whole frames waiting to be written
+            std::vector<uint8_t> buffer;
+            // Events of the frame being recorded
+            std::vector<uint8_t> frame_events;
+            uint32_t frame_event_count{0};
+
+            uint64_t start_ns{0};
+            uint64_t last_event_ns{0};
+            uint64_t frame_tick{0};
+            uint64_t last_tick{0};
+            uint64_t frame_count{0};
+
+            InputSnapshot previous;
+    };
+
+    /// Plays a recording back into the frame loop, one tick per frame.
+    ///
+    /// Every recorded frame that started on or before the current tick is
+    /// applied before it runs: its events are pushed onto the EventQueue the
+    /// Application drains, and its snapshot changes patched into the replayed
+    /// snapshot. Ticks therefore see exactly the input they saw when it was
+    /// recorded, however long the recorded frames took.
+    class PAOPU_API InputReplay {
+
+        public:
+            /// Reads the whole recording. Throws if it can't be read or isn't one.
+            ///
+            ///
+            void open(const std::string& path);
+
+            /// Applies the recorded frames up to `tick_index` to `queue` and
+            /// `snapshot`. Returns false if an event didn't fit in the queue.
+            ///
+            bool play(uint64_t tick_index, EventQueue& queue, InputSnapshot& snapshot);
+
+            /// True once every frame was played and the recorded ticks have run
+            ///
+            ///
+            bool is_finished(uint64_t tick_index) const;
+
+            inline bool is_open() const { return !data.empty(); }
+            inline double get_fixed_timestep() const { return header.fixed_timestep; }
+            inline uint64_t get_seed() const { return header.seed; }
+            inline uint64_t get_tick_count() const { return tick_count; }
+            inline uint64_t get_frame_count() const { return frame_count; }
+
+        private:
+            /// Reads the frame at `offset` that follows one on `tick`, moving
+            /// both past it. Events go to `queue` and snapshot runs to
+            /// `snapshot` when they're set. False where the recording ends or
+            /// was cut short.
+            bool read_frame(size_t& offset, uint64_t& tick, EventQueue* queue, InputSnapshot* snapshot, bool& queue_full);
+
+            std::vector<uint8_t> data;
+            InputRecordingHeader header{};
+
+            // Next frame to play, and the tick the last played one started on
+            size_t frame_offset{0};
+            uint64_t frame_tick{0};
+
+            uint64_t tick_count{0};
+            uint64_t frame_count{0};
+
+            uint64_t start_ns{0};
+            uint64_t event_ns{0};
+    };
+
+}
@@ -0,0 +1,470 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#ifdef PAO_PLATFORM_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(PAO_PLATFORM_LINUX)
+    #include <fstream>
+    #include <string>
+    #include <utility>
+#endif
+
+namespace Paopu {
+
+    /// Chase-Lev work-stealing deque of a single worker. The owner pushes and
+    /// pops at the bottom, any thread may steal from the top.
+    ///
+    class JobDeque {
+
+        public:
+            static const int64_t k_capacity = 4096;
+
+            /// Owner only. Returns false if the deque is full.
+            bool push(Job* job) {
+                int64_t b = bottom.load(std::memory_order_relaxed);
+                int64_t t = top.load(std::memory_order_acquire);
+                if(b - t >= k_capacity) {
+                    return false;
+                }
+
+                jobs[b & k_mask].store(job, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return true;
+            }
+
+            /// Owner only
+            Job* pop() {
+                int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+                bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t t = top.load(std::memory_order_relaxed);
+
+                if(t > b) {
+                    // Empty
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                Job* job = jobs[b & k_mask].load(std::memory_order_relaxed);
+                if(t == b) {
+                    // Last job, race the thieves for it
+                    if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                        job = nullptr;
+                    }
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return job;
+            }
+
+            /// Any thread
+            Job* steal() {
+                int64_t t = top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t b = bottom.load(std::memory_order_acquire);
+
+                if(t >= b) {
+                    return nullptr;
+                }
+
+                Job* job = jobs[t & k_mask].load(std::memory_order_relaxed);
+                if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    return nullptr;
+                }
+                return job;
+            }
+
+            bool is_empty() const {
+                return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+            }
+
+        private:
+            static const int64_t k_mask = k_capacity - 1;
+
+            alignas(64) std::atomic<int64_t> top{0};
+            alignas(64) std::atomic<int64_t> bottom{0};
+            std::atomic<Job*> jobs[k_capacity];
+    };
+
+    /// Fixed slots jobs are allocated from. Only the owner takes slots; any
+    /// thread that finishes a job hands its slot back through `returned`,
+    /// which the owner drains in one exchange once its own list runs dry.
+    /// Free slots are linked through `Job::next_continuation`, and every slot
+    /// records its owner so it finds its way back without a search.
+    template<uint32_t Capacity>
+    struct JobPool {
+        Job jobs[Capacity];
+        Job* free_jobs{nullptr};
+        alignas(64) std::atomic<Job*> returned{nullptr};
+
+        explicit JobPool(int32_t owner) {
+            for(uint32_t i = Capacity; i > 0; i--) {
+                jobs[i - 1].owner = owner;
+                jobs[i - 1].next_continuation = free_jobs;
+                free_jobs = &jobs[i - 1];
+            }
+        }
+
+        /// Owner only. Returns nullptr if every slot is queued or running.
+        Job* take() {
+            if(free_jobs == nullptr) {
+                free_jobs = returned.exchange(nullptr, std::memory_order_acquire);
+            }
+
+            Job* job = free_jobs;
+            if(job != nullptr) {
+                free_jobs = job->next_continuation;
+            }
+            return job;
+        }
+
+        /// Any thread, once the job has finished
+        void give_back(Job* job) {
+            Job* head = returned.load(std::memory_order_relaxed);
+            do {
+                job->next_continuation = head;
+            } while(!returned.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+        }
+    };
+
+    /// Per-worker state. Twice the deque's capacity in slots so continuations
+    /// parked with `run_after` rarely make a worker wait for one.
+    struct alignas(64) Worker {
+        static const uint32_t k_job_pool_size = JobDeque::k_capacity * 2;
+
+        JobDeque deque;
+        JobPool<k_job_pool_size> job_pool;
+        uint32_t steal_seed{0};
+        std::thread thread;
+
+        explicit Worker(int32_t index) : job_pool(index) {}
+    };
+
+    // Jobs submitted from threads that aren't workers, `job_pool` is
+    // guarded by `mutex` like the queue
+    struct ExternalQueue {
+        static const uint32_t k_capacity = 1024;
+
+        std::mutex mutex;
+        JobPool<k_capacity> job_pool{-1};
+        std::vector<Job*> pending;
+    };
+
+    static std::vector<Worker*> s_workers;
+    static ExternalQueue* s_external{nullptr};
+    static std::atomic<bool> s_running{false};
+
+    // Sleeping workers wait for `s_wake_epoch` to change
+    static std::atomic<uint32_t> s_sleeping_workers{0};
+    static std::atomic<uint32_t> s_wake_epoch{0};
+    static std::mutex s_sleep_mutex;
+    static std::condition_variable s_sleep_condition;
+
+    static thread_local int32_t s_worker_index = -1;
+
+    // Failed search rounds before a worker goes to sleep
+    static const uint32_t k_spin_rounds = 64;
+
+    /// Wakes sleeping workers if there are any. Called after new work is queued.
+    static void wake_workers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(s_sleeping_workers.load(std::memory_order_relaxed) == 0) return;
+
+        s_wake_epoch.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(s_sleep_mutex);
+        }
+        s_sleep_condition.notify_all();
+    }
+
+    /// Looks for a job: own deque first, then the external queue, then steals
+    static Job* find_job(int32_t worker_index) {
+        if(worker_index >= 0) {
+            if(Job* job = s_workers[worker_index]->deque.pop()) {
+                return job;
+            }
+        }
+
+        if(s_external != nullptr) {
+            std::unique_lock<std::mutex> lock(s_external->mutex, std::try_to_lock);
+            if(lock.owns_lock() && !s_external->pending.empty()) {
+                Job* job = s_external->pending.back();
+                s_external->pending.pop_back();
+                return job;
+            }
+        }
+
+        // Start stealing at a different victim each time to spread contention
+        uint32_t worker_count = static_cast<uint32_t>(s_workers.size());
+        uint32_t seed = worker_index >= 0 ? s_workers[worker_index]->steal_seed++ : 0;
+        for(uint32_t i = 0; i < worker_count; i++) {
+            uint32_t victim = (seed + i) % worker_count;
+            if(static_cast<int32_t>(victim) == worker_index) continue;
+
+            if(Job* job = s_workers[victim]->deque.steal()) {
+                return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void JobSystem::worker_main(int32_t worker_index) {
+        s_worker_index = worker_index;
+        PAO_PROFILE_THREAD("Job worker");
+        uint32_t failed_rounds = 0;
+
+        while(s_running.load(std::memory_order_acquire)) {
+            if(Job* job = find_job(worker_index)) {
+                execute(job);
+                failed_rounds = 0;
+                continue;
+            }
+
+            if(++failed_rounds < k_spin_rounds) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Announce we're going to sleep, then look once more so a job
+            // queued in between isn't missed.
+            s_sleeping_workers.fetch_add(1, std::memory_order_seq_cst);
+            uint32_t epoch = s_wake_epoch.load(std::memory_order_seq_cst);
+
+            if(Job* job = find_job(worker_index)) {
+                s_sleeping_workers.fetch_sub(1, std::memory_order_relaxed);
+                execute(job);
+                failed_rounds = 0;
+                continue;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(s_sleep_mutex);
+                s_sleep_condition.wait(lock, [epoch]() {
+                    return s_wake_epoch.load(std::memory_order_seq_cst) != epoch || !s_running.load(std::memory_order_acquire);
+                });
+            }
+            s_sleeping_workers.fetch_sub(1, std::memory_order_relaxed);
+            failed_rounds = 0;
+        }
+
+        s_worker_index = -1;
+    }
+
+    void JobSystem::init(uint32_t thread_count) {
+        if(s_running.load()) return;
+
+        if(thread_count == 0) {
+            thread_count = get_physical_core_count();
+        }
+        thread_count = std::max(thread_count, 1u);
+
+        s_external = new ExternalQueue();
+        s_workers.resize(thread_count);
+        for(uint32_t i = 0; i < thread_count; i++) {
+            s_workers[i] = new Worker(static_cast<int32_t>(i));
+            s_workers[i]->steal_seed = i + 1;
+        }
+
+        s_running.store(true, std::memory_order_release);
+
+        // The calling thread is worker 0
+        s_worker_index = 0;
+        for(uint32_t i = 1; i < thread_count; i++) {
+            s_workers[i]->thread = std::thread(&JobSystem::worker_main, static_cast<int32_t>(i));
+        }
+    }
+
+    void JobSystem::shutdown() {
+        if(!s_running.load()) return;
+
+        // Drain whatever is left so counters other threads wait on complete
+        while(Job* job = find_job(s_worker_index)) {
+            execute(job);
+        }
+
+        s_running.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(s_sleep_mutex);
+            s_wake_epoch.fetch_add(1);
+        }
+        s_sleep_condition.notify_all();
+
+        for(size_t i = 1; i < s_workers.size(); i++) {
+            s_workers[i]->thread.join();
+        }
+        for(Worker* worker : s_workers) {
+            delete worker;
+        }
+        s_workers.clear();
+
+        delete s_external;
+        s_external = nullptr;
+        s_worker_index = -1;
+    }
+
+    uint32_t JobSystem::get_worker_count() {
+        return std::max<uint32_t>(1, static_cast<uint32_t>(s_workers.size()));
+    }
+
+    int32_t JobSystem::get_worker_index() {
+        return s_worker_index;
+    }
+
+    uint32_t JobSystem::get_physical_core_count() {
+        uint32_t logical = std::max(1u, std::thread::hardware_concurrency());
+
+    #ifdef PAO_PLATFORM_WINDOWS
+        DWORD length = 0;
+        GetLogicalProcessorInformation(nullptr, &length);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+
+        if(!info.empty() && GetLogicalProcessorInformation(info.data(), &length)) {
+            uint32_t cores = 0;
+            for(const auto& entry : info) {
+                if(entry.Relationship == RelationProcessorCore) {
+                    cores++;
+                }
+            }
+            if(cores > 0) return cores;
+        }
+    #elif defined(PAO_PLATFORM_LINUX)
+        // Each distinct (package, core) pair is one physical core
+        std::set<std::pair<int, int>> cores;
+        for(uint32_t cpu = 0; cpu < logical; cpu++) {
+            std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            std::ifstream package_file(topology + "physical_package_id");
+            std::ifstream core_file(topology + "core_id");
+
+            int package = 0, core = 0;
+            if(!(package_file >> package) || !(core_file >> core)) {
+                cores.clear();
+                break;
+            }
+            cores.insert({package, core});
+        }
+        if(!cores.empty()) return static_cast<uint32_t>(cores.size());
+    #endif
+
+        return logical;
+    }
+
+    Job* JobSystem::allocate_job() {
+        for(;;) {
+            Job* job = nullptr;
+            if(s_worker_index >= 0) {
+                job = s_workers[s_worker_index]->job_pool.take();
+            } else {
+                std::lock_guard<std::mutex> lock(s_external->mutex);
+                job = s_external->job_pool.take();
+            }
+            if(job != nullptr) return job;
+
+            // Every slot is queued or running. Help finish some rather than
+            // hand out one that's still in use.
+            if(Job* other = find_job(s_worker_index)) {
+                execute(other);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::release_job(Job* job) {
+        if(job->owner >= 0) {
+            s_workers[job->owner]->job_pool.give_back(job);
+        } else {
+            s_external->job_pool.give_back(job);
+        }
+    }
+
+    void JobSystem::submit(Job* job) {
+        if(!s_running.load(std::memory_order_relaxed)) {
+            // Not initialized, behave like a plain function call
+            execute(job);
+            return;
+        }
+
+        if(s_worker_index >= 0) {
+            if(!s_workers[s_worker_index]->deque.push(job)) {
+                // Deque is full, running it here is the cheapest way to make room
+                execute(job);
+                return;
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(s_external->mutex);
+            s_external->pending.push_back(job);
+        }
+
+        wake_workers();
+    }
+
+    void JobSystem::submit_after(JobCounter* dependency, Job* job) {
+        dependency->continuation_lock.lock();
+        if(dependency->value.load(std::memory_order_acquire) == 0) {
+            dependency->continuation_lock.unlock();
+            submit(job);
+            return;
+        }
+
+        job->next_continuation = dependency->continuations;
+        dependency->continuations = job;
+        dependency->continuation_lock.unlock();
+    }
+
+    bool JobSystem::is_local_queue_empty() {
+        return s_worker_index >= 0 && s_workers[s_worker_index]->deque.is_empty();
+    }
+
+    void JobSystem::wait(JobCounter* counter) {
+        while(!counter->is_done()) {
+            if(s_running.load(std::memory_order_relaxed)) {
+                if(Job* job = find_job(s_worker_index)) {
+                    execute(job);
+                    continue;
+                }
+            }
+            std::this_thread::yield();
+        }
+
+        // The job that released the counter may still hold its lock, the
+        // counter is often on the caller's stack so it must not go away before that
+        counter->continuation_lock.lock();
+        counter->continuation_lock.unlock();
+    }
+
+    void JobSystem::execute(Job* job) {
+        JobCounter* counter = job->counter;
+        job->invoke(job);
+        release_job(job);
+
+        if(counter == nullptr) return;
+
+        // The decrement happens under the lock so a waiter that saw zero can
+        // tell when we are done touching the counter, see `wait`
+        Job* continuation = nullptr;
+        counter->continuation_lock.lock();
+        if(counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            continuation = counter->continuations;
+            counter->continuations = nullptr;
+        }
+        counter->continuation_lock.unlock();
+
+        while(continuation != nullptr) {
+            Job* next = continuation->next_continuation;
+            submit(continuation);
+            continuation = next;
+        }
+    }
+
+}
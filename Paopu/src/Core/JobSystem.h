@@ -0,0 +1,224 @@
+#pragma once
+#include "Core.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Paopu {
+
+    // Forward Declarations
+    struct Job;
+
+    /// Minimal test-and-test-and-set lock for very short critical sections
+    ///
+    ///
+    class PAOPU_API SpinLock {
+
+        public:
+            inline void lock() {
+                for(;;) {
+                    if(!locked.exchange(true, std::memory_order_acquire)) return;
+                    while(locked.load(std::memory_order_relaxed)) {}
+                }
+            }
+
+            inline void unlock() { locked.store(false, std::memory_order_release); }
+
+        private:
+            std::atomic<bool> locked{false};
+    };
+
+    /// Counts outstanding jobs. A job run with a counter increments it when
+    /// scheduled and decrements it when finished, so a counter reaching zero
+    /// means every job it tracked is done.
+    ///
+    /// Jobs can also be made to depend on a counter with `JobSystem::run_after`;
+    /// they are parked on the counter and scheduled once it reaches zero.
+    class PAOPU_API JobCounter {
+        friend class JobSystem;
+
+        public:
+            JobCounter() = default;
+            JobCounter(const JobCounter&) = delete;
+            JobCounter& operator=(const JobCounter&) = delete;
+
+            inline bool is_done() const { return value.load(std::memory_order_acquire) == 0; }
+
+        private:
+            std::atomic<int32_t> value{0};
+
+            SpinLock continuation_lock;
+            Job* continuations{nullptr};
+    };
+
+    static const uint32_t k_job_payload_size = 32;
+
+    /// A unit of work. Small closures are stored inline in `payload` so
+    /// scheduling a job never touches the heap.
+    ///
+    struct alignas(64) Job {
+        void (*invoke)(Job* job){nullptr};
+        JobCounter* counter{nullptr};
+        // Next job parked on the same counter, see `JobSystem::run_after`
+        Job* next_continuation{nullptr};
+        // Worker whose pool the slot comes from, -1 for the external queue's
+        int32_t owner{-1};
+        alignas(8) unsigned char payload[k_job_payload_size];
+    };
+
+    static_assert(sizeof(Job) == 64, "Jobs are sized to a single cache line");
+
+    /// Work-stealing job scheduler.
+    ///
+    /// Each worker owns a Chase-Lev deque: it pushes and pops jobs at the
+    /// bottom without contention while idle workers steal from the top. The
+    /// thread that calls `init` becomes worker 0 and keeps running its own
+    /// code; it only executes jobs while it `wait`s. Threads that aren't
+    /// workers can still `run` jobs, they go through a small locked queue.
+    ///
+    /// Waiting never blocks a worker: `wait` keeps executing other jobs until
+    /// the counter it waits on reaches zero. Each thread allocates jobs from
+    /// a fixed pool of slots; once they are all queued or running, `run`
+    /// executes other jobs until one is freed.
+    class PAOPU_API JobSystem {
+
+        public:
+            /// Starts `thread_count - 1` worker threads; the caller becomes worker 0.
+            /// Pass 0 to use one worker per physical core.
+            ///
+            static void init(uint32_t thread_count = 0);
+
+            /// Finishes outstanding jobs and joins every worker
+            ///
+            ///
+            static void shutdown();
+
+            /// Number of threads executing jobs, including the one that called `init`
+            ///
+            ///
+            static uint32_t get_worker_count();
+
+            /// Index of the calling worker in [0, get_worker_count()), or -1 if the
+            /// calling thread isn't a worker
+            ///
+            static int32_t get_worker_index();
+
+            /// Number of physical cores, ignoring SMT siblings
+            ///
+            ///
+            static uint32_t get_physical_core_count();
+
+            /// Schedules `function` to run on any worker. If `counter` is given it is
+            /// incremented now and decremented once the job finishes.
+            ///
+            template<typename F>
+            static void run(F&& function, JobCounter* counter = nullptr) {
+                Job* job = make_job(std::forward<F>(function), counter);
+                submit(job);
+            }
+
+            /// Schedules `function` once `dependency` reaches zero. `counter`, if
+            /// given, is incremented immediately so it can be waited on as usual.
+            ///
+            template<typename F>
+            static void run_after(JobCounter* dependency, F&& function, JobCounter* counter = nullptr) {
+                Job* job = make_job(std::forward<F>(function), counter);
+                submit_after(dependency, job);
+            }
+
+            /// Returns once `counter` reaches zero, running other jobs meanwhile
+            ///
+            ///
+            static void wait(JobCounter* counter);
+
+            /// Calls `function(begin, end)` over sub-ranges covering [0, count) in
+            /// parallel, returning once all of them are done.
+            ///
+            /// The grain adapts to the work: ranges start at `count / (workers * 4)`
+            /// items, never below `min_grain`, and a worker only splits its range
+            /// further while its own deque is empty, i.e. when another worker has
+            /// stolen from it and more parallelism is actually useful.
+            template<typename F>
+            static void parallel_for(uint32_t count, const F& function, uint32_t min_grain = 1) {
+                if(count == 0) return;
+
+                uint32_t grain = std::max(std::max(min_grain, 1u), count / (get_worker_count() * k_chunks_per_worker));
+                if(count <= grain) {
+                    function(0u, count);
+                    return;
+                }
+
+                // Workers take part in their own loop, other threads hand it off
+                JobCounter counter;
+                if(get_worker_index() >= 0) {
+                    execute_range(&function, 0, count, grain, &counter);
+                } else {
+                    run_range(&function, 0, count, grain, &counter);
+                }
+                wait(&counter);
+            }
+
+        private:
+            static const uint32_t k_chunks_per_worker = 4;
+
+            template<typename F>
+            static void run_range(const F* function, uint32_t begin, uint32_t end, uint32_t grain, JobCounter* counter) {
+                run([function, begin, end, grain, counter]() {
+                    execute_range(function, begin, end, grain, counter);
+                }, counter);
+            }
+
+            template<typename F>
+            static void execute_range(const F* function, uint32_t begin, uint32_t end, uint32_t grain, JobCounter* counter) {
+                while(begin < end) {
+                    // Lazy binary splitting: only hand off half the range when
+                    // our deque ran dry, which means somebody is stealing.
+                    if(end - begin > grain && is_local_queue_empty()) {
+                        uint32_t middle = begin + (end - begin) / 2;
+                        run_range(function, middle, end, grain, counter);
+                        end = middle;
+                        continue;
+                    }
+
+                    uint32_t chunk_end = std::min(begin + grain, end);
+                    (*function)(begin, chunk_end);
+                    begin = chunk_end;
+                }
+            }
+
+            template<typename F>
+            static Job* make_job(F&& function, JobCounter* counter) {
+                using Closure = typename std::decay<F>::type;
+                static_assert(sizeof(Closure) <= k_job_payload_size, "Job closure too large, capture a pointer to the data instead");
+                static_assert(alignof(Closure) <= 8, "Job closure is over-aligned");
+
+                Job* job = allocate_job();
+                new (job->payload) Closure(std::forward<F>(function));
+                job->invoke = [](Job* self) {
+                    Closure* closure = std::launder(reinterpret_cast<Closure*>(self->payload));
+                    (*closure)();
+                    closure->~Closure();
+                };
+                job->counter = counter;
+                job->next_continuation = nullptr;
+
+                if(counter != nullptr) {
+                    counter->value.fetch_add(1, std::memory_order_relaxed);
+                }
+                return job;
+            }
+
+            static Job* allocate_job();
+            static void release_job(Job* job);
+            static void execute(Job* job);
+            static void worker_main(int32_t worker_index);
+            static void submit(Job* job);
+            static void submit_after(JobCounter* dependency, Job* job);
+            static bool is_local_queue_empty();
+    };
+
+}
@@ -1,20 +1,617 @@
 #include "Logger.h"
+#include "Profiler.h"
 
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
+#include "spdlog/fmt/fmt.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace Paopu {
 
+    std::atomic<uint8_t> Logger::s_level{0};
     std::shared_ptr<spdlog::logger> Logger::s_core_logger;
     std::shared_ptr<spdlog::logger> Logger::s_client_logger;
 
-    void Logger::init(){
-        spdlog::set_pattern("%^[%T] %n: %v%$");
+    /// Header of every record in a ring, followed by the encoded arguments
+    struct LogRecord {
+        uint32_t size;
+        uint8_t level;
+        uint8_t source;
+        uint8_t argument_count;
+        uint8_t flags;
+        uint64_t timestamp_ns;
+        const char* format;
+    };
+
+    // The rest of the ring is empty, continue from the start
+    static const uint8_t k_wrap_record = 1;
+
+    static const char k_binary_magic[8] = {'P', 'A', 'O', 'L', 'O', 'G', '0', '1'};
+    static const uint8_t k_binary_format = 0;
+    static const uint8_t k_binary_record = 1;
+
+    static const char* const k_source_names[] = {"Paopu", "App"};
+
+    /// Single producer, single consumer byte ring. The owning thread writes
+    /// records, the flusher reads them.
+    struct LogRing {
+        LogRing(uint32_t capacity, uint32_t generation) : data(new uint8_t[capacity]), capacity(capacity), generation(generation) {}
+
+        std::unique_ptr<uint8_t[]> data;
+        const uint32_t capacity;
+        // The `Logger::init` this ring was made for
+        const uint32_t generation;
+
+        alignas(64) std::atomic<uint64_t> head{0};
+        uint64_t cached_tail{0};
+        uint64_t pending_head{0};
+        std::atomic<uint64_t> dropped{0};
+
+        alignas(64) std::atomic<uint64_t> tail{0};
+        std::atomic<bool> retired{false};
+    };
+
+    /// Marks the thread's ring as retired when the thread exits, the flusher
+    /// frees it once drained
+    struct LogRingOwner {
+        LogRing* ring{nullptr};
+        ~LogRingOwner() {
+            if(ring != nullptr) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    struct LoggerState {
+        LoggerSettings settings;
+        std::atomic<bool> running{false};
+        std::atomic<uint32_t> generation{0};
+
+        std::mutex registry_lock;
+        std::vector<LogRing*> rings;
+
+        // Serializes consumers (the flusher thread and `Logger::flush`)
+        std::mutex drain_lock;
+        std::FILE* binary_file{nullptr};
+        std::unordered_map<const char*, uint32_t> format_ids;
+        std::string message;
+        std::string line;
+        uint64_t dropped_reported{0};
+        // Dropped by threads that have exited since
+        uint64_t retired_dropped{0};
+
+        std::thread flusher;
+        std::mutex flusher_lock;
+        std::condition_variable flusher_wake;
+
+        ~LoggerState() { Logger::shutdown(); }
+    };
+
+    static LoggerState s_state;
+    static thread_local LogRingOwner t_ring_owner;
+
+    static inline uint32_t align_record(uint32_t size) {
+        return (size + 7u) & ~7u;
+    }
+
+    static uint64_t get_wall_time_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    static spdlog::level::level_enum to_spdlog_level(uint8_t level) {
+        switch(static_cast<LogLevel>(level)) {
+            case LogLevel::Trace: return spdlog::level::trace;
+            case LogLevel::Debug: return spdlog::level::debug;
+            case LogLevel::Info:  return spdlog::level::info;
+            case LogLevel::Warn:  return spdlog::level::warn;
+            case LogLevel::Error: return spdlog::level::err;
+            default:              return spdlog::level::critical;
+        }
+    }
+
+    /// One decoded argument
+    struct LogValue {
+        LogArgument type;
+        union {
+            int64_t i;
+            uint64_t u;
+            double f;
+        };
+        std::string_view string;
+    };
+
+    /// Decodes `count` arguments, returns false if they run past `end`
+    static bool decode_arguments(const uint8_t* data, const uint8_t* end, uint32_t count, LogValue* values) {
+        for(uint32_t i = 0; i < count; i++) {
+            if(data >= end) return false;
+            values[i].type = static_cast<LogArgument>(*data++);
+
+            if(values[i].type == LogArgument::String) {
+                uint32_t length;
+                if(end - data < static_cast<ptrdiff_t>(sizeof(uint32_t))) return false;
+                memcpy(&length, data, sizeof(uint32_t));
+                data += sizeof(uint32_t);
+                if(static_cast<uint64_t>(end - data) < length) return false;
+                values[i].string = std::string_view(reinterpret_cast<const char*>(data), length);
+                data += length;
+            } else {
+                if(end - data < static_cast<ptrdiff_t>(sizeof(uint64_t))) return false;
+                memcpy(&values[i].u, data, sizeof(uint64_t));
+                data += sizeof(uint64_t);
+            }
+        }
+        return true;
+    }
+
+    static void format_value(const LogValue& value, fmt::string_view spec, std::string& out) {
+        switch(value.type) {
+            case LogArgument::Int: {
+                int64_t v = value.i;
+                out += fmt::vformat(spec, fmt::make_format_args(v));
+            } break;
+            case LogArgument::Uint: {
+                uint64_t v = value.u;
+                out += fmt::vformat(spec, fmt::make_format_args(v));
+            } break;
+            case LogArgument::Float: {
+                double v = value.f;
+                out += fmt::vformat(spec, fmt::make_format_args(v));
+            } break;
+            case LogArgument::Bool: {
+                bool v = value.u != 0;
+                out += fmt::vformat(spec, fmt::make_format_args(v));
+            } break;
+            case LogArgument::Char: {
+                char v = static_cast<char>(value.u);
+                out += fmt::vformat(spec, fmt::make_format_args(v));
+            } break;
+            case LogArgument::String: {
+                fmt::string_view v(value.string.data(), value.string.size());
+                out += fmt::vformat(spec, fmt::make_format_args(v));
+            } break;
+            case LogArgument::Pointer: {
+                const void* v = reinterpret_cast<const void*>(static_cast<uintptr_t>(value.u));
+                out += fmt::vformat(spec, fmt::make_format_args(v));
+            } break;
+        }
+    }
+
+    /// Formats a message one replacement field at a time, since the argument
+    /// types are only known at runtime. Supports automatic and numbered fields
+    /// with format specs; nested fields (`{:{}}`) aren't supported.
+    static void format_message(const char* format, const LogValue* values, uint32_t count, std::string& out) {
+        out.clear();
+        uint32_t next_argument = 0;
+        std::string spec;
+
+        for(const char* c = format; *c != '\0'; c++) {
+            if(*c == '}') {
+                if(c[1] == '}') c++;
+                out += '}';
+                continue;
+            }
+            if(*c != '{') {
+                out += *c;
+                continue;
+            }
+            if(c[1] == '{') {
+                out += '{';
+                c++;
+                continue;
+            }
+
+            const char* field_end = strchr(c, '}');
+            if(field_end == nullptr) {
+                out += c;
+                return;
+            }
+
+            const char* colon = c + 1;
+            while(colon < field_end && *colon != ':') colon++;
+
+            uint32_t argument = next_argument++;
+            if(colon > c + 1) {
+                argument = static_cast<uint32_t>(strtoul(c + 1, nullptr, 10));
+            }
+
+            spec.assign("{");
+            spec.append(colon, field_end + 1);
+
+            if(argument < count) {
+                try {
+                    format_value(values[argument], fmt::string_view(spec.data(), spec.size()), out);
+                } catch(const std::exception&) {
+                    out += "<bad format>";
+                }
+            } else {
+                out += "<missing>";
+            }
+            c = field_end;
+        }
+    }
+
+    /// "[12:34:56] Paopu: message"
+    static void format_line(uint64_t timestamp_ns, uint8_t source, const std::string& message, std::string& out) {
+        std::time_t seconds = static_cast<std::time_t>(timestamp_ns / 1000000000ull);
+        std::tm local_time{};
+    #ifdef PAO_PLATFORM_WINDOWS
+        localtime_s(&local_time, &seconds);
+    #else
+        localtime_r(&seconds, &local_time);
+    #endif
+
+        char prefix[64];
+        snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d] %s: ", local_time.tm_hour, local_time.tm_min, local_time.tm_sec,
+                 k_source_names[source < 2 ? source : 0]);
+        out.assign(prefix);
+        out += message;
+    }
+
+    static void write_binary_record(LoggerState& state, const LogRecord& record, const uint8_t* payload, uint32_t payload_size) {
+        auto found = state.format_ids.find(record.format);
+        uint32_t format_id;
+        if(found == state.format_ids.end()) {
+            format_id = static_cast<uint32_t>(state.format_ids.size());
+            state.format_ids.emplace(record.format, format_id);
+
+            uint32_t length = static_cast<uint32_t>(strlen(record.format));
+            std::fwrite(&k_binary_format, 1, 1, state.binary_file);
+            std::fwrite(&format_id, sizeof(format_id), 1, state.binary_file);
+            std::fwrite(&length, sizeof(length), 1, state.binary_file);
+            std::fwrite(record.format, 1, length, state.binary_file);
+        } else {
+            format_id = found->second;
+        }
+
+        std::fwrite(&k_binary_record, 1, 1, state.binary_file);
+        std::fwrite(&format_id, sizeof(format_id), 1, state.binary_file);
+        std::fwrite(&record.timestamp_ns, sizeof(record.timestamp_ns), 1, state.binary_file);
+        std::fwrite(&record.level, 1, 1, state.binary_file);
+        std::fwrite(&record.source, 1, 1, state.binary_file);
+        std::fwrite(&record.argument_count, 1, 1, state.binary_file);
+        std::fwrite(&payload_size, sizeof(payload_size), 1, state.binary_file);
+        std::fwrite(payload, 1, payload_size, state.binary_file);
+    }
+
+    static void consume_record(LoggerState& state, const LogRecord& record) {
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(&record + 1);
+        const uint8_t* end = reinterpret_cast<const uint8_t*>(&record) + record.size;
+
+        if(state.binary_file != nullptr) {
+            // Records are padded to 8 bytes, only the encoded arguments are kept
+            LogValue values[Logger::k_max_arguments];
+            decode_arguments(payload, end, record.argument_count, values);
+            const uint8_t* payload_end = payload;
+            for(uint32_t i = 0; i < record.argument_count; i++) {
+                payload_end += 1 + (values[i].type == LogArgument::String ? sizeof(uint32_t) + values[i].string.size() : sizeof(uint64_t));
+            }
+            write_binary_record(state, record, payload, static_cast<uint32_t>(payload_end - payload));
+        }
+
+        if(state.settings.text_output) {
+            LogValue values[Logger::k_max_arguments];
+            if(!decode_arguments(payload, end, record.argument_count, values)) return;
+
+            format_message(record.format, values, record.argument_count, state.message);
+            format_line(record.timestamp_ns, record.source, state.message, state.line);
+
+            auto& logger = record.source == static_cast<uint8_t>(LogSource::Core) ? Logger::get_core_logger() : Logger::get_client_logger();
+            logger->log(to_spdlog_level(record.level), "{}", state.line);
+        }
+    }
+
+    /// Read position in one ring during a drain
+    struct LogCursor {
+        LogRing* ring;
+        uint64_t tail;
+        uint64_t head;
+        bool retired;
+
+        /// Next committed record, skipping the wrapped end of the ring
+        inline const LogRecord* peek() {
+            while(tail < head) {
+                uint32_t offset = static_cast<uint32_t>(tail % ring->capacity);
+                uint32_t contiguous = ring->capacity - offset;
+                const LogRecord* record = reinterpret_cast<const LogRecord*>(ring->data.get() + offset);
 
-        s_core_logger = spdlog::stdout_color_mt("Paopu");
+                if(contiguous >= sizeof(LogRecord) && !(record->flags & k_wrap_record)) {
+                    return record;
+                }
+                tail += contiguous;
+            }
+            return nullptr;
+        }
+    };
+
+    static void drain_all(LoggerState& state) {
+        std::lock_guard<std::mutex> drain_guard(state.drain_lock);
+
+        std::vector<LogRing*> rings;
+        {
+            std::lock_guard<std::mutex> registry_guard(state.registry_lock);
+            rings = state.rings;
+        }
+
+        // Retirement is checked before reading the head, so everything a thread
+        // logged before exiting is drained too
+        std::vector<LogCursor> cursors;
+        cursors.reserve(rings.size());
+        for(LogRing* ring : rings) {
+            bool retired = ring->retired.load(std::memory_order_acquire);
+            cursors.push_back({ring, ring->tail.load(std::memory_order_relaxed), ring->head.load(std::memory_order_acquire), retired});
+        }
+
+        // Each ring is in order already, merging them by timestamp keeps the
+        // output in order across threads
+        for(;;) {
+            LogCursor* next = nullptr;
+            const LogRecord* next_record = nullptr;
+            for(LogCursor& cursor : cursors) {
+                const LogRecord* record = cursor.peek();
+                if(record != nullptr && (next_record == nullptr || record->timestamp_ns < next_record->timestamp_ns)) {
+                    next = &cursor;
+                    next_record = record;
+                }
+            }
+            if(next == nullptr) break;
+
+            consume_record(state, *next_record);
+            next->tail += next_record->size;
+        }
+
+        uint64_t dropped = state.retired_dropped;
+        std::vector<LogRing*> finished;
+        for(LogCursor& cursor : cursors) {
+            cursor.ring->tail.store(cursor.tail, std::memory_order_release);
+            dropped += cursor.ring->dropped.load(std::memory_order_relaxed);
+            if(cursor.retired) finished.push_back(cursor.ring);
+        }
+
+        if(dropped > state.dropped_reported && state.settings.text_output) {
+            std::string message = fmt::format("[Core][Logger]: {} messages dropped, the log rings are full", dropped - state.dropped_reported);
+            format_line(get_wall_time_ns(), static_cast<uint8_t>(LogSource::Core), message, state.line);
+            Logger::get_core_logger()->log(spdlog::level::warn, "{}", state.line);
+        }
+        state.dropped_reported = dropped;
+
+        if(!finished.empty()) {
+            std::lock_guard<std::mutex> registry_guard(state.registry_lock);
+            for(LogRing* ring : finished) {
+                state.retired_dropped += ring->dropped.load(std::memory_order_relaxed);
+                state.rings.erase(std::find(state.rings.begin(), state.rings.end(), ring));
+                delete ring;
+            }
+        }
+
+        if(state.binary_file != nullptr) {
+            std::fflush(state.binary_file);
+        }
+    }
+
+    static void flusher_main() {
+        PAO_PROFILE_THREAD("Logger");
+        LoggerState& state = s_state;
+        std::unique_lock<std::mutex> lock(state.flusher_lock);
+        while(state.running.load(std::memory_order_acquire)) {
+            lock.unlock();
+            drain_all(state);
+            lock.lock();
+            state.flusher_wake.wait_for(lock, std::chrono::milliseconds(state.settings.flush_interval_ms), [&state]() {
+                return !state.running.load(std::memory_order_acquire);
+            });
+        }
+    }
+
+    void Logger::init(const LoggerSettings& settings){
+        shutdown();
+
+        s_state.settings = settings;
+        s_state.settings.ring_size = align_record(std::max<uint32_t>(settings.ring_size, 4096));
+        s_state.dropped_reported = 0;
+        s_state.retired_dropped = 0;
+        for(LogRing* ring : s_state.rings) {
+            ring->dropped.store(0, std::memory_order_relaxed);
+        }
+        s_state.generation.fetch_add(1, std::memory_order_relaxed);
+        s_state.format_ids.clear();
+
+        // Only the flusher thread logs through these, so the single-threaded
+        // sinks are enough. They stay out of spdlog's registry, which may be
+        // gone by the time the last messages are drained at exit. Timestamps
+        // are from when the message was logged, see format_line.
+        s_core_logger = std::make_shared<spdlog::logger>("Paopu", std::make_shared<spdlog::sinks::stdout_color_sink_st>());
+        s_core_logger->set_pattern("%^%v%$");
         s_core_logger->set_level(spdlog::level::trace);
 
-        s_client_logger = spdlog::stdout_color_mt("App");
+        s_client_logger = std::make_shared<spdlog::logger>("App", std::make_shared<spdlog::sinks::stdout_color_sink_st>());
+        s_client_logger->set_pattern("%^%v%$");
         s_client_logger->set_level(spdlog::level::trace);
+
+        if(!settings.binary_path.empty()) {
+            s_state.binary_file = std::fopen(settings.binary_path.c_str(), "wb");
+            if(s_state.binary_file == nullptr) {
+                throw std::runtime_error("[Core][Logger]: Failed to open the binary log!");
+            }
+            uint32_t version = 1;
+            std::fwrite(k_binary_magic, 1, sizeof(k_binary_magic), s_state.binary_file);
+            std::fwrite(&version, sizeof(version), 1, s_state.binary_file);
+        }
+
+        s_level.store(static_cast<uint8_t>(settings.level), std::memory_order_relaxed);
+        s_state.running.store(true, std::memory_order_release);
+        s_state.flusher = std::thread(flusher_main);
+    }
+
+    void Logger::shutdown() {
+        if(!s_state.running.exchange(false, std::memory_order_acq_rel)) return;
+
+        {
+            std::lock_guard<std::mutex> lock(s_state.flusher_lock);
+            s_state.flusher_wake.notify_one();
+        }
+        if(s_state.flusher.joinable()) {
+            s_state.flusher.join();
+        }
+
+        drain_all(s_state);
+        s_core_logger->flush();
+        s_client_logger->flush();
+
+        if(s_state.binary_file != nullptr) {
+            std::fclose(s_state.binary_file);
+            s_state.binary_file = nullptr;
+        }
+
+        s_core_logger.reset();
+        s_client_logger.reset();
+    }
+
+    void Logger::flush() {
+        if(!s_state.running.load(std::memory_order_acquire)) return;
+        drain_all(s_state);
+        s_core_logger->flush();
+        s_client_logger->flush();
+    }
+
+    uint64_t Logger::get_dropped_count() {
+        std::lock_guard<std::mutex> registry_guard(s_state.registry_lock);
+        uint64_t dropped = s_state.retired_dropped;
+        for(LogRing* ring : s_state.rings) {
+            dropped += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+
+    uint8_t* Logger::begin_record(LogSource source, LogLevel level, const char* format, uint8_t argument_count, uint32_t payload_size) {
+        if(!s_state.running.load(std::memory_order_relaxed)) return nullptr;
+
+        LogRing* ring = t_ring_owner.ring;
+        uint32_t generation = s_state.generation.load(std::memory_order_relaxed);
+        if(ring == nullptr || ring->generation != generation) {
+            // First message from this thread since `init`, the only time it takes
+            // a lock. A ring from an earlier `init` is handed to the flusher.
+            if(ring != nullptr) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+            ring = new LogRing(s_state.settings.ring_size, generation);
+            std::lock_guard<std::mutex> registry_guard(s_state.registry_lock);
+            s_state.rings.push_back(ring);
+            t_ring_owner.ring = ring;
+        }
+
+        uint32_t size = align_record(static_cast<uint32_t>(sizeof(LogRecord)) + payload_size);
+        if(size > ring->capacity / 2) {
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        uint32_t offset = static_cast<uint32_t>(head % ring->capacity);
+        uint32_t contiguous = ring->capacity - offset;
+        uint32_t needed = contiguous < size ? contiguous + size : size;
+
+        if(head + needed - ring->cached_tail > ring->capacity) {
+            ring->cached_tail = ring->tail.load(std::memory_order_acquire);
+            if(head + needed - ring->cached_tail > ring->capacity) {
+                ring->dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+
+        if(contiguous < size) {
+            if(contiguous >= sizeof(LogRecord)) {
+                reinterpret_cast<LogRecord*>(ring->data.get() + offset)->flags = k_wrap_record;
+            }
+            head += contiguous;
+            offset = 0;
+        }
+
+        LogRecord* record = reinterpret_cast<LogRecord*>(ring->data.get() + offset);
+        record->size = size;
+        record->level = static_cast<uint8_t>(level);
+        record->source = static_cast<uint8_t>(source);
+        record->argument_count = argument_count;
+        record->flags = 0;
+        record->timestamp_ns = get_wall_time_ns();
+        record->format = format;
+
+        ring->pending_head = head + size;
+        return reinterpret_cast<uint8_t*>(record + 1);
+    }
+
+    void Logger::end_record(LogLevel level) {
+        LogRing* ring = t_ring_owner.ring;
+        ring->head.store(ring->pending_head, std::memory_order_release);
+
+        if(level == LogLevel::Fatal) {
+            flush();
+        }
+    }
+
+    bool Logger::decode_binary_log(const char* path, std::ostream& out) {
+        std::FILE* file = std::fopen(path, "rb");
+        if(file == nullptr) return false;
+
+        char magic[sizeof(k_binary_magic)];
+        uint32_t version = 0;
+        if(std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, k_binary_magic, sizeof(magic)) != 0 ||
+           std::fread(&version, sizeof(version), 1, file) != 1 || version != 1) {
+            std::fclose(file);
+            return false;
+        }
+
+        std::vector<std::string> formats;
+        std::vector<uint8_t> payload;
+        std::string message;
+        std::string line;
+        LogValue values[k_max_arguments];
+
+        uint8_t kind;
+        while(std::fread(&kind, 1, 1, file) == 1) {
+            uint32_t format_id = 0;
+            if(std::fread(&format_id, sizeof(format_id), 1, file) != 1) break;
+
+            if(kind == k_binary_format) {
+                uint32_t length = 0;
+                if(std::fread(&length, sizeof(length), 1, file) != 1) break;
+                std::string format(length, '\0');
+                if(std::fread(&format[0], 1, length, file) != length) break;
+                if(formats.size() <= format_id) formats.resize(format_id + 1);
+                formats[format_id] = std::move(format);
+                continue;
+            }
+
+            uint64_t timestamp_ns = 0;
+            uint8_t level = 0, source = 0, argument_count = 0;
+            uint32_t payload_size = 0;
+            if(std::fread(&timestamp_ns, sizeof(timestamp_ns), 1, file) != 1 ||
+               std::fread(&level, 1, 1, file) != 1 || std::fread(&source, 1, 1, file) != 1 ||
+               std::fread(&argument_count, 1, 1, file) != 1 || std::fread(&payload_size, sizeof(payload_size), 1, file) != 1) {
+                break;
+            }
+            payload.resize(payload_size);
+            if(payload_size > 0 && std::fread(payload.data(), 1, payload_size, file) != payload_size) break;
+
+            if(format_id >= formats.size() || argument_count > k_max_arguments ||
+               !decode_arguments(payload.data(), payload.data() + payload.size(), argument_count, values)) {
+                continue;
+            }
+
+            format_message(formats[format_id].c_str(), values, argument_count, message);
+            format_line(timestamp_ns, source, message, line);
+            out << line << "\n";
+        }
+
+        std::fclose(file);
+        return true;
     }
-}
\ No newline at end of file
+}
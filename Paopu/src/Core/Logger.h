@@ -1,35 +1,249 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "Core.h"
 #include "spdlog/spdlog.h"
 
+// Compile-time minimum level. Macros below it expand to nothing, their
+// arguments aren't even evaluated. Defaults to everything in debug builds
+// and Info and up in release.
+#define PAO_LOG_LEVEL_TRACE 0
+#define PAO_LOG_LEVEL_DEBUG 1
+#define PAO_LOG_LEVEL_INFO  2
+#define PAO_LOG_LEVEL_WARN  3
+#define PAO_LOG_LEVEL_ERROR 4
+#define PAO_LOG_LEVEL_FATAL 5
+
+#ifndef PAO_LOG_LEVEL
+    #ifdef NDEBUG
+        #define PAO_LOG_LEVEL PAO_LOG_LEVEL_INFO
+    #else
+        #define PAO_LOG_LEVEL PAO_LOG_LEVEL_TRACE
+    #endif
+#endif
+
 namespace Paopu {
-    
+
+    enum class LogLevel : uint8_t { Trace = 0, Debug, Info, Warn, Error, Fatal };
+
+    enum class LogSource : uint8_t { Core = 0, Client };
+
+    struct PAOPU_API LoggerSettings {
+        /// Runtime minimum, on top of PAO_LOG_LEVEL
+        LogLevel level{LogLevel::Trace};
+
+        /// Bytes of each thread's ring. A full ring drops messages instead of
+        /// blocking the thread that logs.
+        uint32_t ring_size{256 * 1024};
+
+        /// How often the background thread drains the rings
+        uint32_t flush_interval_ms{5};
+
+        /// Format and print messages to stdout
+        bool text_output{true};
+
+        /// When set, records are also written unformatted to this file. See
+        /// `Logger::decode_binary_log`.
+        std::string binary_path;
+    };
+
+    /// Type of each argument stored in a log record
+    enum class LogArgument : uint8_t { Int = 0, Uint, Float, Bool, Char, String, Pointer };
+
+    /// Asynchronous logger.
+    ///
+    /// Logging never locks or touches I/O on the calling thread: the arguments
+    /// are copied unformatted into a lock-free ring owned by that thread, and a
+    /// background thread drains every ring, formats the messages and hands them
+    /// to spdlog. Only that thread ever talks to the spdlog loggers. Format
+    /// strings must be string literals since only their address is stored.
+    ///
+    /// Fatal messages are flushed before the call returns.
     class PAOPU_API Logger {
 
         public:
-            static void init();
+            static void init(const LoggerSettings& settings = LoggerSettings());
+
+            /// Drains what is left and stops the background thread
+            ///
+            ///
+            static void shutdown();
+
+            /// Drains everything logged so far from the calling thread. Takes a
+            /// lock, so keep it out of hot paths.
+            ///
+            static void flush();
+
+            /// Messages lost to full rings since `init`
+            ///
+            ///
+            static uint64_t get_dropped_count();
+
+            /// Formats a binary log written through `LoggerSettings::binary_path`
+            /// into `out`, one line per message. Returns false if the file can't
+            /// be read.
+            static bool decode_binary_log(const char* path, std::ostream& out);
+
+            template<size_t N, typename... Args>
+            static void log(LogSource source, LogLevel level, const char (&format)[N], const Args&... args) {
+                static_assert(sizeof...(Args) <= k_max_arguments, "[Core][Logger]: Too many log arguments!");
+
+                if(static_cast<uint8_t>(level) < s_level.load(std::memory_order_relaxed)) return;
+
+                uint32_t payload_size = (0u + ... + get_encoded_size(args));
+                uint8_t* out = begin_record(source, level, format, static_cast<uint8_t>(sizeof...(Args)), payload_size);
+                if(out == nullptr) return;
+
+                (encode(out, args), ...);
+                end_record(level);
+            }
 
             inline static std::shared_ptr<spdlog::logger>& get_core_logger() { return s_core_logger; }
             inline static std::shared_ptr<spdlog::logger>& get_client_logger() { return s_client_logger; }
+
+            static const uint32_t k_max_arguments = 16;
+            static const uint32_t k_max_string_length = 1024;
+
         private:
+            /// Reserves a record in the calling thread's ring, returns where the
+            /// arguments go or nullptr if the ring is full
+            static uint8_t* begin_record(LogSource source, LogLevel level, const char* format, uint8_t argument_count, uint32_t payload_size);
+
+            static void end_record(LogLevel level);
+
+            template<typename T>
+            static constexpr bool is_c_string() {
+                return std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>;
+            }
+
+            template<typename T>
+            static constexpr bool is_string() {
+                return std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+            }
+
+            // Takes the decayed pointer so string literals and char arrays,
+            // which can't be null, don't get a null test of their own
+            static inline uint32_t get_c_string_length(const char* value) {
+                return static_cast<uint32_t>(value != nullptr ? strnlen(value, k_max_string_length) : 0);
+            }
+
+            template<typename T>
+            static inline uint32_t get_encoded_size(const T& value) {
+                if constexpr(is_c_string<T>()) {
+                    return 1 + sizeof(uint32_t) + get_c_string_length(value);
+                } else if constexpr(is_string<T>()) {
+                    return 1 + sizeof(uint32_t) + static_cast<uint32_t>(std::min<size_t>(value.size(), k_max_string_length));
+                } else {
+                    return 1 + sizeof(uint64_t);
+                }
+            }
+
+            static inline void encode_scalar(uint8_t*& out, LogArgument type, const void* value) {
+                *out++ = static_cast<uint8_t>(type);
+                memcpy(out, value, sizeof(uint64_t));
+                out += sizeof(uint64_t);
+            }
+
+            static inline void encode_string(uint8_t*& out, const char* data, uint32_t length) {
+                *out++ = static_cast<uint8_t>(LogArgument::String);
+                memcpy(out, &length, sizeof(uint32_t));
+                out += sizeof(uint32_t);
+                if(length > 0) memcpy(out, data, length);
+                out += length;
+            }
+
+            template<typename T>
+            static inline void encode(uint8_t*& out, const T& value) {
+                if constexpr(is_c_string<T>()) {
+                    encode_string(out, value, get_c_string_length(value));
+                } else if constexpr(is_string<T>()) {
+                    encode_string(out, value.data(), static_cast<uint32_t>(std::min<size_t>(value.size(), k_max_string_length)));
+                } else if constexpr(std::is_same_v<T, bool>) {
+                    uint64_t raw = value ? 1 : 0;
+                    encode_scalar(out, LogArgument::Bool, &raw);
+                } else if constexpr(std::is_same_v<T, char>) {
+                    uint64_t raw = static_cast<uint8_t>(value);
+                    encode_scalar(out, LogArgument::Char, &raw);
+                } else if constexpr(std::is_enum_v<T>) {
+                    encode(out, static_cast<std::underlying_type_t<T>>(value));
+                } else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>) {
+                    int64_t raw = value;
+                    encode_scalar(out, LogArgument::Int, &raw);
+                } else if constexpr(std::is_integral_v<T>) {
+                    uint64_t raw = value;
+                    encode_scalar(out, LogArgument::Uint, &raw);
+                } else if constexpr(std::is_floating_point_v<T>) {
+                    double raw = static_cast<double>(value);
+                    encode_scalar(out, LogArgument::Float, &raw);
+                } else if constexpr(std::is_pointer_v<T>) {
+                    uint64_t raw = reinterpret_cast<uintptr_t>(value);
+                    encode_scalar(out, LogArgument::Pointer, &raw);
+                } else {
+                    static_assert(std::is_pointer_v<T>, "[Core][Logger]: Log arguments must be numbers, pointers or strings!");
+                }
+            }
+
+            static std::atomic<uint8_t> s_level;
+
             static std::shared_ptr<spdlog::logger> s_core_logger;
             static std::shared_ptr<spdlog::logger> s_client_logger;
     };
 
 }
 
+#if PAO_LOG_LEVEL <= PAO_LOG_LEVEL_TRACE
+    #define PAO_LOG_TRACE(source, ...) ::Paopu::Logger::log(source, ::Paopu::LogLevel::Trace, __VA_ARGS__)
+#else
+    #define PAO_LOG_TRACE(source, ...) ((void)0)
+#endif
+
+#if PAO_LOG_LEVEL <= PAO_LOG_LEVEL_DEBUG
+    #define PAO_LOG_DEBUG(source, ...) ::Paopu::Logger::log(source, ::Paopu::LogLevel::Debug, __VA_ARGS__)
+#else
+    #define PAO_LOG_DEBUG(source, ...) ((void)0)
+#endif
+
+#if PAO_LOG_LEVEL <= PAO_LOG_LEVEL_INFO
+    #define PAO_LOG_INFO(source, ...) ::Paopu::Logger::log(source, ::Paopu::LogLevel::Info, __VA_ARGS__)
+#else
+    #define PAO_LOG_INFO(source, ...) ((void)0)
+#endif
+
+#if PAO_LOG_LEVEL <= PAO_LOG_LEVEL_WARN
+    #define PAO_LOG_WARN(source, ...) ::Paopu::Logger::log(source, ::Paopu::LogLevel::Warn, __VA_ARGS__)
+#else
+    #define PAO_LOG_WARN(source, ...) ((void)0)
+#endif
+
+#if PAO_LOG_LEVEL <= PAO_LOG_LEVEL_ERROR
+    #define PAO_LOG_ERROR(source, ...) ::Paopu::Logger::log(source, ::Paopu::LogLevel::Error, __VA_ARGS__)
+#else
+    #define PAO_LOG_ERROR(source, ...) ((void)0)
+#endif
+
+// Fatal messages are never stripped
+#define PAO_LOG_FATAL(source, ...) ::Paopu::Logger::log(source, ::Paopu::LogLevel::Fatal, __VA_ARGS__)
+
 // Core logger macros
-#define PAO_CORE_FATAL(...) ::Paopu::Logger::get_core_logger()->fatal(__VA_ARGS__)
-#define PAO_CORE_ERROR(...) ::Paopu::Logger::get_core_logger()->err(__VA_ARGS__)
-#define PAO_CORE_WARN(...)  ::Paopu::Logger::get_core_logger()->warn(__VA_ARGS__)
-#define PAO_CORE_INFO(...)  ::Paopu::Logger::get_core_logger()->info(__VA_ARGS__)
-#define PAO_CORE_TRACE(...) ::Paopu::Logger::get_core_logger()->trace(__VA_ARGS__)
+#define PAO_CORE_FATAL(...) PAO_LOG_FATAL(::Paopu::LogSource::Core, __VA_ARGS__)
+#define PAO_CORE_ERROR(...) PAO_LOG_ERROR(::Paopu::LogSource::Core, __VA_ARGS__)
+#define PAO_CORE_WARN(...)  PAO_LOG_WARN(::Paopu::LogSource::Core, __VA_ARGS__)
+#define PAO_CORE_INFO(...)  PAO_LOG_INFO(::Paopu::LogSource::Core, __VA_ARGS__)
+#define PAO_CORE_DEBUG(...) PAO_LOG_DEBUG(::Paopu::LogSource::Core, __VA_ARGS__)
+#define PAO_CORE_TRACE(...) PAO_LOG_TRACE(::Paopu::LogSource::Core, __VA_ARGS__)
 
 // Clinet logger macros
-#define PAO_FATAL(...) ::Paopu::Logger::get_client_logger()->fatal(__VA_ARGS__)
-#define PAO_ERROR(...) ::Paopu::Logger::get_client_logger()->err(__VA_ARGS__)
-#define PAO_WARN(...)  ::Paopu::Logger::get_client_logger()->warn(__VA_ARGS__)
-#define PAO_INFO(...)  ::Paopu::Logger::get_client_logger()->info(__VA_ARGS__)
-#define PAO_TRACE(...) ::Paopu::Logger::get_client_logger()->trace(__VA_ARGS__)
\ No newline at end of file
+#define PAO_FATAL(...) PAO_LOG_FATAL(::Paopu::LogSource::Client, __VA_ARGS__)
+#define PAO_ERROR(...) PAO_LOG_ERROR(::Paopu::LogSource::Client, __VA_ARGS__)
+#define PAO_WARN(...)  PAO_LOG_WARN(::Paopu::LogSource::Client, __VA_ARGS__)
+#define PAO_INFO(...)  PAO_LOG_INFO(::Paopu::LogSource::Client, __VA_ARGS__)
+#define PAO_DEBUG(...) PAO_LOG_DEBUG(::Paopu::LogSource::Client, __VA_ARGS__)
+#define PAO_TRACE(...) PAO_LOG_TRACE(::Paopu::LogSource::Client, __VA_ARGS__)
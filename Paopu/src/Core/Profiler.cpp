@@ -0,0 +1,194 @@
+#include "Profiler.h"
+#include "Logger.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Paopu {
+
+    std::atomic<bool> Profiler::s_capturing{false};
+
+    struct ProfileZone {
+        const char* name;
+        uint64_t begin_ticks;
+        uint64_t end_ticks;
+    };
+
+    /// Zones recorded by one thread. Only the owner writes; the capture is
+    /// read after it stops, up to the published count.
+    struct ProfileThread {
+        static const uint32_t k_block_size = 16384;
+        static const uint32_t k_max_blocks = 256;
+
+        std::unique_ptr<ProfileZone[]> blocks[k_max_blocks];
+        std::atomic<uint32_t> count{0};
+        // The capture `count` belongs to
+        std::atomic<uint32_t> generation{0};
+        uint32_t id{0};
+        std::string name;
+    };
+
+    struct ProfilerState {
+        std::mutex lock;
+        std::vector<std::unique_ptr<ProfileThread>> threads;
+
+        // Written under `lock` by request_capture, read by the frame thread
+        std::atomic<uint32_t> requested_frames{0};
+        std::string requested_path;
+
+        // Frame thread only
+        std::string path;
+        uint32_t frames_left{0};
+        uint64_t frame_begin_ticks{0};
+        uint64_t start_ticks{0};
+        std::chrono::steady_clock::time_point start_time;
+
+        std::atomic<uint32_t> generation{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    static ProfilerState s_state;
+    static thread_local ProfileThread* t_thread = nullptr;
+
+    static ProfileThread* get_thread() {
+        if(t_thread == nullptr) {
+            std::lock_guard<std::mutex> guard(s_state.lock);
+            s_state.threads.emplace_back(new ProfileThread());
+            t_thread = s_state.threads.back().get();
+            t_thread->id = static_cast<uint32_t>(s_state.threads.size());
+            t_thread->blocks[0].reset(new ProfileZone[ProfileThread::k_block_size]);
+        }
+        return t_thread;
+    }
+
+    void Profiler::record(const char* name, uint64_t begin_ticks, uint64_t end_ticks) {
+        ProfileThread* thread = get_thread();
+
+        // First zone of a new capture, the previous one has been written out
+        uint32_t generation = s_state.generation.load(std::memory_order_acquire);
+        if(thread->generation.load(std::memory_order_relaxed) != generation) {
+            thread->generation.store(generation, std::memory_order_relaxed);
+            thread->count.store(0, std::memory_order_relaxed);
+        }
+
+        uint32_t index = thread->count.load(std::memory_order_relaxed);
+        uint32_t block = index / ProfileThread::k_block_size;
+        if(block >= ProfileThread::k_max_blocks) {
+            s_state.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if(!thread->blocks[block]) {
+            thread->blocks[block].reset(new ProfileZone[ProfileThread::k_block_size]);
+        }
+
+        thread->blocks[block][index % ProfileThread::k_block_size] = {name, begin_ticks, end_ticks};
+        thread->count.store(index + 1, std::memory_order_release);
+    }
+
+    void Profiler::set_thread_name(const char* name) {
+        ProfileThread* thread = get_thread();
+        std::lock_guard<std::mutex> guard(s_state.lock);
+        thread->name = name;
+    }
+
+    void Profiler::request_capture(uint32_t frame_count, const std::string& path) {
+        std::lock_guard<std::mutex> guard(s_state.lock);
+        s_state.requested_path = path;
+        s_state.requested_frames.store(frame_count, std::memory_order_release);
+    }
+
+    void Profiler::mark_frame() {
+        uint64_t now = get_ticks();
+
+        if(is_capturing()) {
+            record("Frame", s_state.frame_begin_ticks, now);
+            if(--s_state.frames_left == 0) {
+                stop_capture();
+            }
+        } else if(s_state.requested_frames.load(std::memory_order_acquire) > 0) {
+            start_capture();
+        }
+
+        s_state.frame_begin_ticks = get_ticks();
+    }
+
+    void Profiler::start_capture() {
+        {
+            std::lock_guard<std::mutex> guard(s_state.lock);
+            s_state.frames_left = s_state.requested_frames.exchange(0, std::memory_order_acq_rel);
+            s_state.path = s_state.requested_path;
+        }
+
+        s_state.dropped.store(0, std::memory_order_relaxed);
+        s_state.generation.fetch_add(1, std::memory_order_release);
+        s_state.start_time = std::chrono::steady_clock::now();
+        s_state.start_ticks = get_ticks();
+        s_capturing.store(true, std::memory_order_release);
+    }
+
+    static void write_json_string(std::FILE* file, const char* text) {
+        std::fputc('"', file);
+        for(const char* c = text; *c != '\0'; c++) {
+            if(*c == '"' || *c == '\\') std::fputc('\\', file);
+            if(static_cast<unsigned char>(*c) >= 0x20) std::fputc(*c, file);
+        }
+        std::fputc('"', file);
+    }
+
+    void Profiler::stop_capture() {
+        s_capturing.store(false, std::memory_order_release);
+
+        // Tick rate measured over the capture itself, rdtsc doesn't tell it
+        uint64_t stop_ticks = get_ticks();
+        double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_state.start_time).count();
+        double us_per_tick = stop_ticks > s_state.start_ticks ? elapsed_us / static_cast<double>(stop_ticks - s_state.start_ticks) : 0.0;
+
+        std::FILE* file = std::fopen(s_state.path.c_str(), "w");
+        if(file == nullptr) {
+            PAO_CORE_ERROR("[Core][Profiler]: Failed to open {} for the capture!", s_state.path);
+            return;
+        }
+
+        std::fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", file);
+        std::fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"Paopu\"}}");
+
+        uint32_t generation = s_state.generation.load(std::memory_order_relaxed);
+        uint64_t zone_count = 0;
+
+        std::lock_guard<std::mutex> guard(s_state.lock);
+        for(const std::unique_ptr<ProfileThread>& thread : s_state.threads) {
+            if(!thread->name.empty()) {
+                std::fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ", thread->id);
+                write_json_string(file, thread->name.c_str());
+                std::fputs("}}", file);
+            }
+
+            // Threads that recorded nothing this capture still hold the last one
+            uint32_t count = thread->count.load(std::memory_order_acquire);
+            if(thread->generation.load(std::memory_order_relaxed) != generation) continue;
+
+            for(uint32_t i = 0; i < count; i++) {
+                const ProfileZone& zone = thread->blocks[i / ProfileThread::k_block_size][i % ProfileThread::k_block_size];
+                double begin_us = (static_cast<double>(zone.begin_ticks) - static_cast<double>(s_state.start_ticks)) * us_per_tick;
+                double duration_us = static_cast<double>(zone.end_ticks - zone.begin_ticks) * us_per_tick;
+
+                std::fputs(",\n{\"name\": ", file);
+                write_json_string(file, zone.name);
+                std::fprintf(file, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}", thread->id, begin_us, duration_us);
+            }
+            zone_count += count;
+        }
+
+        std::fputs("\n]}\n", file);
+        std::fclose(file);
+
+        PAO_CORE_INFO("[Core][Profiler]: Wrote {} zones to {}", zone_count, s_state.path);
+        uint64_t dropped = s_state.dropped.load(std::memory_order_relaxed);
+        if(dropped > 0) {
+            PAO_CORE_WARN("[Core][Profiler]: {} zones didn't fit in the capture buffers", dropped);
+        }
+    }
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "Core.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_M_X64)
+    #include <intrin.h>
+    #define PAO_PROFILE_RDTSC
+#elif defined(__x86_64__)
+    #include <x86intrin.h>
+    #define PAO_PROFILE_RDTSC
+#endif
+
+namespace Paopu {
+
+    /// CPU profiler recording scoped zones into per-thread buffers, exported as
+    /// Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+    ///
+    /// Nothing is recorded until a capture is requested. A capture starts at
+    /// the next frame marker and stops after the requested number of frames,
+    /// then writes the file. While capturing, a zone costs two timestamp reads
+    /// and one write into its thread's buffer, no locks.
+    ///
+    /// Zone names must stay alive until the capture is written, string literals
+    /// or `__FUNCTION__` in practice.
+    class PAOPU_API Profiler {
+
+        public:
+            /// Captures the next `frame_count` frames into the Chrome trace file
+            /// at `path`. Safe from any thread.
+            ///
+            static void request_capture(uint32_t frame_count, const std::string& path);
+
+            /// Marks the end of a frame, called from the frame loop. Starts and
+            /// stops requested captures.
+            ///
+            static void mark_frame();
+
+            /// Shown instead of the thread id in the trace
+            ///
+            ///
+            static void set_thread_name(const char* name);
+
+            static void record(const char* name, uint64_t begin_ticks, uint64_t end_ticks);
+
+            inline static bool is_capturing() { return s_capturing.load(std::memory_order_relaxed); }
+
+            /// rdtsc where available, the steady clock in nanoseconds otherwise
+            ///
+            ///
+            inline static uint64_t get_ticks() {
+            #ifdef PAO_PROFILE_RDTSC
+                return __rdtsc();
+            #else
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+            #endif
+            }
+
+        private:
+            static void start_capture();
+            static void stop_capture();
+
+            static std::atomic<bool> s_capturing;
+    };
+
+    /// Records a zone from construction to destruction, see PAO_PROFILE_SCOPE
+    ///
+    ///
+    class ProfileScope {
+
+        public:
+            inline explicit ProfileScope(const char* name)
+                : name(name), begin_ticks(Profiler::is_capturing() ? Profiler::get_ticks() : 0) {}
+
+            inline ~ProfileScope() {
+                if(begin_ticks != 0) {
+                    Profiler::record(name, begin_ticks, Profiler::get_ticks());
+                }
+            }
+
+            ProfileScope(const ProfileScope&) = delete;
+            ProfileScope& operator=(const ProfileScope&) = delete;
+
+        private:
+            const char* name;
+            uint64_t begin_ticks;
+    };
+
+}
+
+#define PAO_PROFILE_CONCAT_INNER(a, b) a##b
+#define PAO_PROFILE_CONCAT(a, b) PAO_PROFILE_CONCAT_INNER(a, b)
+
+// Profiling macros, compiled out unless PAO_PROFILE is defined (the
+// PAOPU_PROFILE CMake option)
+#ifdef PAO_PROFILE
+    #define PAO_PROFILE_SCOPE(name) ::Paopu::ProfileScope PAO_PROFILE_CONCAT(pao_profile_scope_, __LINE__)(name)
+    #define PAO_PROFILE_FUNCTION() PAO_PROFILE_SCOPE(__FUNCTION__)
+    #define PAO_PROFILE_FRAME() ::Paopu::Profiler::mark_frame()
+    #define PAO_PROFILE_THREAD(name) ::Paopu::Profiler::set_thread_name(name)
+#else
+    #define PAO_PROFILE_SCOPE(name) ((void)0)
+    #define PAO_PROFILE_FUNCTION() ((void)0)
+    #define PAO_PROFILE_FRAME() ((void)0)
+    #define PAO_PROFILE_THREAD(name) ((void)0)
+#endif
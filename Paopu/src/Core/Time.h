@@ -0,0 +1,21 @@
+#pragma once
+#include "Core.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Monotonic time in nanoseconds. Safe to call from any thread, unlike
+    /// most of GLFW, so it's used to timestamp events and frames.
+    ///
+    inline uint64_t get_time_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    inline double ns_to_seconds(uint64_t ns) {
+        return static_cast<double>(ns) * 1e-9;
+    }
+
+}
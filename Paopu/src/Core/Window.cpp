@@ -0,0 +1,208 @@
+#include "Window.h"
+
+#include "Time.h"
+#include "Input.h"
+#include "../Events/EventQueue.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Paopu {
+
+    // Axes jitter around their rest position, ignore changes smaller than this
+    static const float k_gamepad_axis_epsilon = 0.01f;
+
+    /// Builds an event of `type` stamped with the current time
+    static Event make_event(EventType type) {
+        Event event;
+        event.type = type;
+        event.timestamp_ns = get_time_ns();
+        return event;
+    }
+
+    static EventQueue* get_event_queue(GLFWwindow* glfw_window) {
+        PaopuWindow* window = static_cast<PaopuWindow*>(glfwGetWindowUserPointer(glfw_window));
+        return window != nullptr ? window->event_queue : nullptr;
+    }
+
+    /// Returns the window's input state, or nullptr if none is attached
+    static InputState* get_input_state(GLFWwindow* glfw_window) {
+        PaopuWindow* window = static_cast<PaopuWindow*>(glfwGetWindowUserPointer(glfw_window));
+        return window != nullptr ? window->input_state : nullptr;
+    }
+
+    static void window_close_callback(GLFWwindow* glfw_window) {
+        if(EventQueue* queue = get_event_queue(glfw_window)) {
+            queue->push(make_event(EventType::WindowClose));
+        }
+    }
+
+    static void window_size_callback(GLFWwindow* glfw_window, int width, int height) {
+        if(EventQueue* queue = get_event_queue(glfw_window)) {
+            Event event = make_event(EventType::WindowResize);
+            event.window_resize = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+            queue->push(event);
+        }
+    }
+
+    /// Stores the size for `get_framebuffer_extent`
+    static void publish_framebuffer_size(PaopuWindow* window, int width, int height) {
+        uint64_t size = (static_cast<uint64_t>(std::max(width, 0)) << 32) | static_cast<uint32_t>(std::max(height, 0));
+        window->framebuffer_size.store(size, std::memory_order_release);
+    }
+
+    static void framebuffer_size_callback(GLFWwindow* glfw_window, int width, int height) {
+        if(PaopuWindow* window = static_cast<PaopuWindow*>(glfwGetWindowUserPointer(glfw_window))) {
+            publish_framebuffer_size(window, width, height);
+        }
+    }
+
+    static void window_focus_callback(GLFWwindow* glfw_window, int focused) {
+        if(EventQueue* queue = get_event_queue(glfw_window)) {
+            queue->push(make_event(focused ? EventType::WindowFocus : EventType::WindowLostFocus));
+        }
+    }
+
+    static void window_pos_callback(GLFWwindow* glfw_window, int x, int y) {
+        if(EventQueue* queue = get_event_queue(glfw_window)) {
+            Event event = make_event(EventType::WindowMoved);
+            event.window_moved = {x, y};
+            queue->push(event);
+        }
+    }
+
+    static void key_callback(GLFWwindow* glfw_window, int key, int scancode, int action, int mods) {
+        Event event = make_event(action == GLFW_RELEASE ? EventType::KeyReleased : EventType::KeyPressed);
+        event.key = {key, scancode, mods, action == GLFW_REPEAT};
+
+        if(InputState* state = get_input_state(glfw_window)) {
+            if(key >= 0 && key <= GLFW_KEY_LAST) {
+                state->get_pending().keys[key] = action != GLFW_RELEASE;
+            }
+            state->mark_event(event.timestamp_ns);
+        }
+        if(EventQueue* queue = get_event_queue(glfw_window)) {
+            queue->push(event);
+        }
+    }
+
+    static void mouse_button_callback(GLFWwindow* glfw_window, int button, int action, int mods) {
+        Event event = make_event(action == GLFW_PRESS ? EventType::MouseButtonPressed : EventType::MouseButtonReleased);
+        event.mouse_button = {button, mods};
+
+        if(InputState* state = get_input_state(glfw_window)) {
+            if(button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST) {
+                state->get_pending().mouse_buttons[button] = action == GLFW_PRESS;
+            }
+            state->mark_event(event.timestamp_ns);
+        }
+        if(EventQueue* queue = get_event_queue(glfw_window)) {
+            queue->push(event);
+        }
+    }
+
+    static void cursor_pos_callback(GLFWwindow* glfw_window, double x, double y) {
+        Event event = make_event(EventType::MouseMoved);
+        event.mouse_moved = {x, y};
+
+        if(InputState* state = get_input_state(glfw_window)) {
+            state->get_pending().mouse_x = x;
+            state->get_pending().mouse_y = y;
+            state->mark_event(event.timestamp_ns);
+        }
+        if(EventQueue* queue = get_event_queue(glfw_window)) {
+            queue->push(event);
+        }
+    }
+
+    static void scroll_callback(GLFWwindow* glfw_window, double x_offset, double y_offset) {
+        Event event = make_event(EventType::MouseScrolled);
+        event.mouse_scrolled = {x_offset, y_offset};
+
+        if(InputState* state = get_input_state(glfw_window)) {
+            state->get_pending().scroll_x += x_offset;
+            state->get_pending().scroll_y += y_offset;
+            state->mark_event(event.timestamp_ns);
+        }
+        if(EventQueue* queue = get_event_queue(glfw_window)) {
+            queue->push(event);
+        }
+    }
+
+    void attach_event_queue(PaopuWindow* window, EventQueue* queue) {
+        window->event_queue = queue;
+
+        glfwSetWindowUserPointer(window->glfw_window, window);
+        glfwSetWindowCloseCallback(window->glfw_window, window_close_callback);
+        glfwSetWindowSizeCallback(window->glfw_window, window_size_callback);
+        glfwSetWindowFocusCallback(window->glfw_window, window_focus_callback);
+        glfwSetWindowPosCallback(window->glfw_window, window_pos_callback);
+        glfwSetKeyCallback(window->glfw_window, key_callback);
+        glfwSetMouseButtonCallback(window->glfw_window, mouse_button_callback);
+        glfwSetCursorPosCallback(window->glfw_window, cursor_pos_callback);
+        glfwSetScrollCallback(window->glfw_window, scroll_callback);
+    }
+
+    void track_framebuffer_size(PaopuWindow* window) {
+        glfwSetWindowUserPointer(window->glfw_window, window);
+        glfwSetFramebufferSizeCallback(window->glfw_window, framebuffer_size_callback);
+
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window->glfw_window, &width, &height);
+        publish_framebuffer_size(window, width, height);
+    }
+
+    void attach_input_state(PaopuWindow* window, InputState* state) {
+        window->input_state = state;
+    }
+
+    void poll_gamepad_events(PaopuWindow* window) {
+        if(window->event_queue == nullptr) return;
+
+        for(int gamepad = GLFW_JOYSTICK_1; gamepad <= GLFW_JOYSTICK_LAST; gamepad++) {
+            GLFWgamepadstate state;
+            bool connected = glfwGetGamepadState(gamepad, &state) == GLFW_TRUE;
+
+            if(window->input_state != nullptr) {
+                InputSnapshot& pending = window->input_state->get_pending();
+                pending.gamepad_connected[gamepad] = connected;
+                if(connected) {
+                    pending.gamepads[gamepad] = state;
+                }
+            }
+
+            if(!connected) continue;
+
+            GLFWgamepadstate& previous = window->gamepad_states[gamepad];
+
+            for(int button = 0; button <= GLFW_GAMEPAD_BUTTON_LAST; button++) {
+                if(state.buttons[button] == previous.buttons[button]) continue;
+
+                Event event = make_event(state.buttons[button] == GLFW_PRESS ? EventType::GamepadButtonPressed : EventType::GamepadButtonReleased);
+                event.gamepad_button = {gamepad, button};
+                window->event_queue->push(event);
+                previous.buttons[button] = state.buttons[button];
+
+                if(window->input_state != nullptr) {
+                    window->input_state->mark_event(event.timestamp_ns);
+                }
+            }
+
+            // Only remember an axis once it's reported, so slow drifts still
+            // produce an event once they add up.
+            for(int axis = 0; axis <= GLFW_GAMEPAD_AXIS_LAST; axis++) {
+                if(std::fabs(state.axes[axis] - previous.axes[axis]) < k_gamepad_axis_epsilon) continue;
+
+                Event event = make_event(EventType::GamepadAxisMoved);
+                event.gamepad_axis = {gamepad, axis, state.axes[axis]};
+                window->event_queue->push(event);
+                previous.axes[axis] = state.axes[axis];
+
+                if(window->input_state != nullptr) {
+                    window->input_state->mark_event(event.timestamp_ns);
+                }
+            }
+        }
+    }
+
+}
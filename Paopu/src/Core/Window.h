@@ -4,9 +4,14 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include <atomic>
 #include <iostream>
 
 namespace Paopu {
+
+    // Forward Declarations
+    class EventQueue;
+    class InputState;
     struct PaopuWindow {
         PaopuWindow() = default;
         PaopuWindow(const char* title) :
@@ -24,9 +29,49 @@ namespace Paopu {
 
         GLFWwindow* glfw_window{nullptr};
 
-        
+        // Where the window's GLFW callbacks push their events, see `attach_event_queue`
+        EventQueue* event_queue{nullptr};
+
+        // Input state the window's callbacks keep up to date, see `attach_input_state`
+        InputState* input_state{nullptr};
+
+        // Last polled state of each gamepad, used to turn polling into events
+        GLFWgamepadstate gamepad_states[GLFW_JOYSTICK_LAST + 1]{};
+
+        // Width in the high half, height in the low one, so both are read
+        // together. Kept up to date by the thread that processes GLFW
+        // events, see `get_framebuffer_extent`.
+        std::atomic<uint64_t> framebuffer_size{0};
     };
 
+	/// Installs the GLFW callback that publishes the window's framebuffer
+	/// size, and publishes the current one. Called by `build_window`.
+	///
+	PAOPU_API void track_framebuffer_size(PaopuWindow* window);
+
+	/// Last framebuffer size the event thread saw, in pixels. Safe to call
+	/// from any thread, unlike glfwGetFramebufferSize.
+	///
+	inline VkExtent2D get_framebuffer_extent(const PaopuWindow* window) {
+		uint64_t size = window->framebuffer_size.load(std::memory_order_acquire);
+		return {static_cast<uint32_t>(size >> 32), static_cast<uint32_t>(size)};
+	}
+
+	/// Installs GLFW callbacks on the window that translate window, key and
+	/// mouse input into Events pushed onto `queue`.
+	///
+	PAOPU_API void attach_event_queue(PaopuWindow* window, EventQueue* queue);
+
+	/// Makes the window's GLFW callbacks also update `state`'s pending
+	/// snapshot. Must be called after `attach_event_queue`.
+	///
+	PAOPU_API void attach_input_state(PaopuWindow* window, InputState* state);
+
+	/// Polls every connected gamepad and pushes an event for each button or
+	/// axis that changed since the last poll. GLFW has no gamepad callbacks.
+	///
+	PAOPU_API void poll_gamepad_events(PaopuWindow* window);
+
 	/// Initializes GLFW and creates the window
 	///
 	///
@@ -41,6 +86,7 @@ namespace Paopu {
 		}
 
 		window->glfw_window = glfwCreateWindow(window->WINDOW_WIDTH, window->WINDOW_HEIGHT, window->window_title, nullptr, nullptr);
+		track_framebuffer_size(window);
 	}
 
 	/// Cleans up before being destroyed
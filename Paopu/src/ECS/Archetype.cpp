@@ -0,0 +1,42 @@
+#include "Archetype.h"
+
+namespace Paopu {
+
+    /// Bytes needed to lay out `capacity` rows, or more than the chunk holds
+    static size_t get_layout_size(const Archetype& archetype, uint32_t capacity, uint32_t* offsets) {
+        size_t offset = sizeof(Entity) * capacity;
+        for(uint32_t i = 0; i < archetype.component_count; i++) {
+            const ComponentInfo& info = ComponentRegistry::get_info(archetype.components[i]);
+            offset = (offset + info.alignment - 1) & ~static_cast<size_t>(info.alignment - 1);
+            if(offsets != nullptr) {
+                offsets[archetype.components[i]] = static_cast<uint32_t>(offset);
+            }
+            offset += static_cast<size_t>(info.size) * capacity;
+        }
+        return offset;
+    }
+
+    Archetype::Archetype(ComponentMask mask) : mask(mask) {
+        uint32_t row_size = sizeof(Entity);
+        for(ComponentId id = 0; id < k_max_components; id++) {
+            column_offsets[id] = k_no_column;
+            if(mask & get_component_bit(id)) {
+                components[component_count++] = id;
+                row_size += ComponentRegistry::get_info(id).size;
+            }
+        }
+
+        // Start from the padding-free estimate and back off until the
+        // aligned columns fit
+        const size_t available = sizeof(Chunk::data);
+        chunk_capacity = static_cast<uint32_t>(available / row_size);
+        while(chunk_capacity > 1 && get_layout_size(*this, chunk_capacity, nullptr) > available) {
+            chunk_capacity--;
+        }
+
+        if(get_layout_size(*this, chunk_capacity, column_offsets) > available) {
+            throw std::runtime_error("[ECS][Archetype]: Components don't fit in a single chunk!");
+        }
+    }
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "../Core/Core.h"
+#include "Entity.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    static const uint32_t k_chunk_size = 16 * 1024;
+
+    /// A fixed 16 KB block holding up to `Archetype::chunk_capacity` entities
+    /// of one archetype. Storage is SoA: after the header comes the array of
+    /// Entity handles, then one tightly packed array per component, so a
+    /// system reading two components streams through two linear arrays.
+    ///
+    struct alignas(64) Chunk {
+        uint32_t count;
+        unsigned char padding[60];
+        unsigned char data[k_chunk_size - 64];
+    };
+
+    static_assert(sizeof(Chunk) == k_chunk_size, "Chunks are exactly k_chunk_size bytes");
+
+    /// Every entity with exactly the same set of components lives in the same
+    /// archetype. The layout is computed once; `column_offsets` is indexed by
+    /// ComponentId so finding a component's array is a single lookup.
+    ///
+    class PAOPU_API Archetype {
+
+        public:
+            explicit Archetype(ComponentMask mask);
+
+            inline bool has_component(ComponentId id) const { return (mask & get_component_bit(id)) != 0; }
+
+            inline Entity* get_entities(Chunk* chunk) const {
+                return reinterpret_cast<Entity*>(chunk->data);
+            }
+
+            inline void* get_column(Chunk* chunk, ComponentId id) const {
+                return chunk->data + column_offsets[id];
+            }
+
+            inline void* get_component(Chunk* chunk, ComponentId id, uint32_t row) const {
+                return chunk->data + column_offsets[id] + static_cast<size_t>(row) * ComponentRegistry::get_info(id).size;
+            }
+
+        public:
+            static const uint32_t k_no_column = ~0u;
+
+            ComponentMask mask;
+            // Component ids in ascending order
+            ComponentId components[k_max_components];
+            uint32_t component_count{0};
+            uint32_t column_offsets[k_max_components];
+
+            uint32_t chunk_capacity{0};
+            uint32_t entity_count{0};
+            // Every chunk but the last is always full
+            std::vector<Chunk*> chunks;
+
+            // Archetype reached by adding or removing a component, filled in lazily
+            Archetype* add_edges[k_max_components]{};
+            Archetype* remove_edges[k_max_components]{};
+    };
+
+}
@@ -0,0 +1,69 @@
+#include "CommandBuffer.h"
+
+#include "World.h"
+
+namespace Paopu {
+
+    Entity CommandBuffer::create_entity() {
+        Entity placeholder{pending_entity_count++, k_pending_generation};
+        record(CommandType::CreateEntity, placeholder, 0, nullptr, 0);
+        return placeholder;
+    }
+
+    void CommandBuffer::destroy_entity(Entity entity) {
+        record(CommandType::DestroyEntity, entity, 0, nullptr, 0);
+    }
+
+    void CommandBuffer::record(CommandType type, Entity entity, ComponentId component, const void* payload, uint32_t payload_size) {
+        CommandHeader header{type, component, entity, payload_size};
+
+        size_t offset = data.size();
+        data.resize(offset + sizeof(CommandHeader) + payload_size);
+        memcpy(data.data() + offset, &header, sizeof(CommandHeader));
+        if(payload_size > 0) {
+            memcpy(data.data() + offset + sizeof(CommandHeader), payload, payload_size);
+        }
+    }
+
+    Entity CommandBuffer::resolve(Entity entity) const {
+        if(entity.generation != k_pending_generation) return entity;
+        return entity.index < created_entities.size() ? created_entities[entity.index] : k_null_entity;
+    }
+
+    void CommandBuffer::playback(World& world) {
+        created_entities.clear();
+
+        size_t offset = 0;
+        while(offset < data.size()) {
+            CommandHeader header;
+            memcpy(&header, data.data() + offset, sizeof(CommandHeader));
+            const unsigned char* payload = data.data() + offset + sizeof(CommandHeader);
+            offset += sizeof(CommandHeader) + header.payload_size;
+
+            switch(header.type) {
+                case CommandType::CreateEntity:
+                    created_entities.push_back(world.create_entity());
+                    break;
+                case CommandType::DestroyEntity:
+                    world.destroy_entity(resolve(header.entity));
+                    break;
+                case CommandType::AddComponent: {
+                    // Another command buffer may have destroyed it first
+                    Entity entity = resolve(header.entity);
+                    if(world.is_alive(entity)) {
+                        // The payload is unaligned, add_component_raw copies it with memcpy
+                        world.add_component_raw(entity, header.component, payload);
+                    }
+                    break;
+                }
+                case CommandType::RemoveComponent:
+                    world.remove_component_raw(resolve(header.entity), header.component);
+                    break;
+            }
+        }
+
+        data.clear();
+        pending_entity_count = 0;
+    }
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "../Core/Core.h"
+#include "Entity.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Paopu {
+
+    // Forward Declarations
+    class World;
+
+    /// Records structural changes to apply to a World later, on one thread,
+    /// in the order they were recorded. Systems get one each from the
+    /// scheduler, see System.h.
+    ///
+    /// Entities created through a command buffer don't exist until playback.
+    /// The returned handle is a placeholder that is only meaningful to the
+    /// same command buffer, e.g. to add components to it.
+    ///
+    /// Commands are packed into a byte buffer that is reused between frames,
+    /// so recording doesn't allocate once it has grown to its working size.
+    class PAOPU_API CommandBuffer {
+
+        public:
+            /// Generation marking a placeholder from `create_entity`
+            static const uint32_t k_pending_generation = ~0u;
+
+            Entity create_entity();
+
+            void destroy_entity(Entity entity);
+
+            template<typename T>
+            void add_component(Entity entity, const T& value = T{}) {
+                record(CommandType::AddComponent, entity, ComponentRegistry::get_id<T>(), &value, sizeof(T));
+            }
+
+            template<typename T>
+            void remove_component(Entity entity) {
+                record(CommandType::RemoveComponent, entity, ComponentRegistry::get_id<T>(), nullptr, 0);
+            }
+
+            /// Applies every recorded command to `world` and clears the buffer
+            ///
+            ///
+            void playback(World& world);
+
+            inline bool is_empty() const { return data.empty(); }
+
+        private:
+            enum class CommandType : uint32_t {
+                CreateEntity, DestroyEntity, AddComponent, RemoveComponent
+            };
+
+            struct CommandHeader {
+                CommandType type;
+                ComponentId component;
+                Entity entity;
+                uint32_t payload_size;
+            };
+
+            void record(CommandType type, Entity entity, ComponentId component, const void* payload, uint32_t payload_size);
+
+            /// Maps a placeholder to the entity created for it during playback
+            Entity resolve(Entity entity) const;
+
+            std::vector<unsigned char> data;
+            uint32_t pending_entity_count{0};
+
+            // Scratch for playback, kept to avoid reallocating every frame
+            std::vector<Entity> created_entities;
+    };
+
+}
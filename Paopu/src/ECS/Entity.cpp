@@ -0,0 +1,31 @@
+#include "Entity.h"
+
+#include <mutex>
+
+namespace Paopu {
+
+    static ComponentInfo s_component_infos[k_max_components];
+    static uint32_t s_component_count{0};
+    static std::mutex s_component_mutex;
+
+    ComponentId ComponentRegistry::register_component(const char* name, uint32_t size, uint32_t alignment) {
+        // Ids are handed out once per type from function-local statics, the
+        // lock only matters if two threads touch a new type at the same time
+        std::lock_guard<std::mutex> lock(s_component_mutex);
+        if(s_component_count == k_max_components) {
+            throw std::runtime_error("[ECS][Registry]: Too many component types!");
+        }
+
+        s_component_infos[s_component_count] = {name, size, alignment};
+        return s_component_count++;
+    }
+
+    const ComponentInfo& ComponentRegistry::get_info(ComponentId id) {
+        return s_component_infos[id];
+    }
+
+    uint32_t ComponentRegistry::get_count() {
+        return s_component_count;
+    }
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+
+namespace Paopu {
+
+    /// Handle to an entity in a World. `generation` changes every time an
+    /// index is reused, so stale handles are detected instead of silently
+    /// pointing at a different entity.
+    ///
+    struct PAOPU_API Entity {
+        uint32_t index{0};
+        uint32_t generation{0};
+
+        inline bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+        inline bool operator!=(const Entity& other) const { return !(*this == other); }
+    };
+
+    /// Never a live entity, generations start at 1
+    static const Entity k_null_entity{0, 0};
+
+    using ComponentId = uint32_t;
+
+    /// One bit per component type, so archetype matching is a couple of ANDs
+    using ComponentMask = uint64_t;
+
+    static const uint32_t k_max_components = 64;
+
+    inline ComponentMask get_component_bit(ComponentId id) {
+        return 1ull << id;
+    }
+
+    /// What the ECS needs to know to store a component type
+    ///
+    ///
+    struct PAOPU_API ComponentInfo {
+        const char* name;
+        uint32_t size;
+        uint32_t alignment;
+    };
+
+    /// Assigns every component type a small id the first time it is used.
+    ///
+    /// Components must be plain data. Chunks move them around
+    /// with memcpy and never run constructors or destructors, which is what
+    /// keeps structural changes and iteration cheap.
+    class PAOPU_API ComponentRegistry {
+
+        public:
+            /// `const T` maps to the same id as `T`
+            ///
+            ///
+            template<typename T>
+            static ComponentId get_id() {
+                return get_unqualified_id<typename std::remove_const<T>::type>();
+            }
+
+            static const ComponentInfo& get_info(ComponentId id);
+
+            static uint32_t get_count();
+
+        private:
+            template<typename T>
+            static ComponentId get_unqualified_id() {
+                static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                    "Components must be plain data, chunks move them with memcpy");
+
+                static const ComponentId s_id = register_component(typeid(T).name(), sizeof(T), alignof(T));
+                return s_id;
+            }
+
+            static ComponentId register_component(const char* name, uint32_t size, uint32_t alignment);
+    };
+
+    /// Mask holding each of `Ts`
+    ///
+    ///
+    template<typename... Ts>
+    inline ComponentMask make_component_mask() {
+        ComponentMask mask = 0;
+        ((mask |= get_component_bit(ComponentRegistry::get_id<Ts>())), ...);
+        return mask;
+    }
+
+}
@@ -0,0 +1,83 @@
+#include "System.h"
+
+#include "World.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+
+#include <algorithm>
+
+namespace Paopu {
+
+    void SystemScheduler::add_system(System* system) {
+        systems.push_back(system);
+        dirty = true;
+    }
+
+    void SystemScheduler::remove_system(System* system) {
+        systems.erase(std::remove(systems.begin(), systems.end(), system), systems.end());
+        dirty = true;
+    }
+
+    bool SystemScheduler::conflicts(const System& a, const System& b) {
+        if(a.is_exclusive() || b.is_exclusive()) return true;
+
+        return (a.get_writes() & (b.get_reads() | b.get_writes())) != 0
+            || (b.get_writes() & a.get_reads()) != 0;
+    }
+
+    void SystemScheduler::build_phases() {
+        if(!dirty) return;
+        dirty = false;
+
+        schedule.clear();
+        phases.clear();
+        command_buffers.resize(systems.size());
+
+        for(uint32_t i = 0; i < systems.size(); i++) {
+            uint32_t phase = 0;
+            for(uint32_t earlier = 0; earlier < i; earlier++) {
+                if(conflicts(*systems[i], *systems[earlier])) {
+                    phase = std::max(phase, schedule[earlier].phase + 1);
+                }
+            }
+
+            schedule.push_back({systems[i], phase});
+            if(phase >= phases.size()) {
+                phases.resize(phase + 1);
+            }
+            phases[phase].systems.push_back(i);
+        }
+    }
+
+    void SystemScheduler::run(World& world, double delta_time) {
+        build_phases();
+
+        for(const Phase& phase : phases) {
+            if(phase.systems.size() == 1) {
+                uint32_t index = phase.systems[0];
+                SystemContext context{world, command_buffers[index], delta_time};
+                PAO_PROFILE_SCOPE(schedule[index].system->get_name());
+                schedule[index].system->update(context);
+            } else {
+                JobCounter counter;
+                for(uint32_t index : phase.systems) {
+                    JobSystem::run([this, &world, index, delta_time]() {
+                        SystemContext context{world, command_buffers[index], delta_time};
+                        PAO_PROFILE_SCOPE(schedule[index].system->get_name());
+                        schedule[index].system->update(context);
+                    }, &counter);
+                }
+                JobSystem::wait(&counter);
+            }
+
+            // Structural changes only once nothing is iterating anymore
+            PAO_PROFILE_SCOPE("Command playback");
+            for(uint32_t index : phase.systems) {
+                if(!command_buffers[index].is_empty()) {
+                    command_buffers[index].playback(world);
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "../Core/Core.h"
+#include "CommandBuffer.h"
+#include "Entity.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    // Forward Declarations
+    class World;
+
+    /// What a system gets each time it runs
+    ///
+    /// `commands`: Where structural changes go, applied once the system's
+    ///     phase has finished
+    struct PAOPU_API SystemContext {
+        World& world;
+        CommandBuffer& commands;
+        double delta_time;
+    };
+
+    /// Game logic that runs over the World every tick.
+    ///
+    /// A system declares the components it reads and writes in its
+    /// constructor. The scheduler uses that to run systems that don't touch
+    /// the same data at the same time; a system must not access components it
+    /// didn't declare.
+    class PAOPU_API System {
+
+        public:
+            virtual ~System() = default;
+
+            virtual const char* get_name() const = 0;
+
+            virtual void update(SystemContext& context) = 0;
+
+            inline ComponentMask get_reads() const { return reads; }
+            inline ComponentMask get_writes() const { return writes; }
+            inline bool is_exclusive() const { return exclusive; }
+
+        protected:
+            template<typename... Ts>
+            void declare_reads() { reads |= make_component_mask<Ts...>(); }
+
+            template<typename... Ts>
+            void declare_writes() { writes |= make_component_mask<Ts...>(); }
+
+            /// For systems that touch state outside the World, they run alone
+            ///
+            ///
+            void declare_exclusive() { exclusive = true; }
+
+        private:
+            ComponentMask reads{0};
+            ComponentMask writes{0};
+            bool exclusive{false};
+    };
+
+    /// Runs systems in parallel on the JobSystem where their declared
+    /// accesses allow it.
+    ///
+    /// Systems are split into phases. A system goes in the phase after the
+    /// last earlier-added system it conflicts with (one writes what the other
+    /// reads or writes), so conflicting systems always run in the order they
+    /// were added and everything else overlaps. Command buffers are played
+    /// back after each phase in the order the systems were added, keeping
+    /// results deterministic.
+    class PAOPU_API SystemScheduler {
+
+        public:
+            /// The scheduler doesn't own the system
+            ///
+            ///
+            void add_system(System* system);
+
+            void remove_system(System* system);
+
+            /// Runs every system once
+            ///
+            ///
+            void run(World& world, double delta_time);
+
+            inline uint32_t get_phase_count() {
+                build_phases();
+                return static_cast<uint32_t>(phases.size());
+            }
+
+        private:
+            struct ScheduledSystem {
+                System* system;
+                uint32_t phase;
+            };
+
+            struct Phase {
+                // Systems of this phase, indices into `schedule`
+                std::vector<uint32_t> systems;
+            };
+
+            static bool conflicts(const System& a, const System& b);
+
+            void build_phases();
+
+            std::vector<System*> systems;
+            std::vector<ScheduledSystem> schedule;
+            std::vector<Phase> phases;
+            std::vector<CommandBuffer> command_buffers;
+            bool dirty{false};
+    };
+
+}
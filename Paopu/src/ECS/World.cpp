@@ -0,0 +1,190 @@
+#include "World.h"
+
+namespace Paopu {
+
+    // Chunks come from the pool in pages of this many
+    static const uint32_t k_chunks_per_page = 16;
+
+    World::World() : chunk_pool(sizeof(Chunk), alignof(Chunk), k_chunks_per_page) {
+        // Index 0 is never handed out so k_null_entity is never alive
+        records.emplace_back();
+        empty_archetype = get_archetype(0);
+    }
+
+    World::~World() {
+        // Chunks go back with the pool, components are plain data
+    }
+
+    Entity World::create_entity() {
+        Entity entity = allocate_entity();
+        place_entity(entity, empty_archetype);
+        return entity;
+    }
+
+    void World::destroy_entity(Entity entity) {
+        if(!is_alive(entity)) return;
+
+        EntityRecord& record = records[entity.index];
+        remove_row(record);
+
+        record.archetype = nullptr;
+        record.generation++;
+        free_indices.push_back(entity.index);
+        entity_count--;
+    }
+
+    bool World::is_alive(Entity entity) const {
+        return entity.index != 0 && entity.index < records.size()
+            && records[entity.index].generation == entity.generation
+            && records[entity.index].archetype != nullptr;
+    }
+
+    void World::add_component_raw(Entity entity, ComponentId id, const void* data) {
+        if(!is_alive(entity)) {
+            throw std::runtime_error("[ECS][World]: Adding a component to a dead entity!");
+        }
+
+        Archetype* archetype = records[entity.index].archetype;
+        if(!archetype->has_component(id)) {
+            Archetype* target = archetype->add_edges[id];
+            if(target == nullptr) {
+                target = get_archetype(archetype->mask | get_component_bit(id));
+                archetype->add_edges[id] = target;
+            }
+            move_entity(entity, target);
+        }
+
+        write_component(entity, id, data);
+    }
+
+    void World::remove_component_raw(Entity entity, ComponentId id) {
+        if(!is_alive(entity)) return;
+
+        Archetype* archetype = records[entity.index].archetype;
+        if(!archetype->has_component(id)) return;
+
+        Archetype* target = archetype->remove_edges[id];
+        if(target == nullptr) {
+            target = get_archetype(archetype->mask & ~get_component_bit(id));
+            archetype->remove_edges[id] = target;
+        }
+        move_entity(entity, target);
+    }
+
+    void* World::get_component_raw(Entity entity, ComponentId id) {
+        if(!is_alive(entity)) return nullptr;
+
+        const EntityRecord& record = records[entity.index];
+        if(!record.archetype->has_component(id)) return nullptr;
+
+        return record.archetype->get_component(record.archetype->chunks[record.chunk_index], id, record.row);
+    }
+
+    Entity World::allocate_entity() {
+        uint32_t index;
+        if(!free_indices.empty()) {
+            index = free_indices.back();
+            free_indices.pop_back();
+        } else {
+            index = static_cast<uint32_t>(records.size());
+            records.emplace_back();
+        }
+
+        entity_count++;
+        return Entity{index, records[index].generation};
+    }
+
+    Archetype* World::get_archetype(ComponentMask mask) {
+        auto found = archetype_lookup.find(mask);
+        if(found != archetype_lookup.end()) {
+            return found->second;
+        }
+
+        archetypes.push_back(std::make_unique<Archetype>(mask));
+        Archetype* archetype = archetypes.back().get();
+        archetype_lookup[mask] = archetype;
+        return archetype;
+    }
+
+    void World::place_entity(Entity entity, Archetype* archetype) {
+        if(archetype->chunks.empty() || archetype->chunks.back()->count == archetype->chunk_capacity) {
+            Chunk* chunk = static_cast<Chunk*>(chunk_pool.allocate());
+            chunk->count = 0;
+            archetype->chunks.push_back(chunk);
+        }
+
+        uint32_t chunk_index = static_cast<uint32_t>(archetype->chunks.size() - 1);
+        Chunk* chunk = archetype->chunks[chunk_index];
+        uint32_t row = chunk->count++;
+        archetype->get_entities(chunk)[row] = entity;
+        archetype->entity_count++;
+
+        EntityRecord& record = records[entity.index];
+        record.archetype = archetype;
+        record.chunk_index = chunk_index;
+        record.row = row;
+    }
+
+    void World::move_entity(Entity entity, Archetype* target) {
+        EntityRecord old_record = records[entity.index];
+        Archetype* source = old_record.archetype;
+        Chunk* source_chunk = source->chunks[old_record.chunk_index];
+
+        place_entity(entity, target);
+        const EntityRecord& new_record = records[entity.index];
+        Chunk* target_chunk = target->chunks[new_record.chunk_index];
+
+        // Carry over the components both archetypes have
+        ComponentMask shared = source->mask & target->mask;
+        for(uint32_t i = 0; i < source->component_count; i++) {
+            ComponentId id = source->components[i];
+            if(shared & get_component_bit(id)) {
+                memcpy(target->get_component(target_chunk, id, new_record.row),
+                    source->get_component(source_chunk, id, old_record.row),
+                    ComponentRegistry::get_info(id).size);
+            }
+        }
+
+        remove_row(old_record);
+    }
+
+    void World::remove_row(const EntityRecord& record) {
+        Archetype* archetype = record.archetype;
+        Chunk* chunk = archetype->chunks[record.chunk_index];
+
+        // Keep chunks dense by moving the archetype's very last row into the hole
+        Chunk* last_chunk = archetype->chunks.back();
+        uint32_t last_row = last_chunk->count - 1;
+
+        if(chunk != last_chunk || record.row != last_row) {
+            Entity moved = archetype->get_entities(last_chunk)[last_row];
+            archetype->get_entities(chunk)[record.row] = moved;
+
+            for(uint32_t i = 0; i < archetype->component_count; i++) {
+                ComponentId id = archetype->components[i];
+                memcpy(archetype->get_component(chunk, id, record.row),
+                    archetype->get_component(last_chunk, id, last_row),
+                    ComponentRegistry::get_info(id).size);
+            }
+
+            EntityRecord& moved_record = records[moved.index];
+            moved_record.chunk_index = record.chunk_index;
+            moved_record.row = record.row;
+        }
+
+        last_chunk->count--;
+        archetype->entity_count--;
+
+        if(last_chunk->count == 0) {
+            chunk_pool.free(last_chunk);
+            archetype->chunks.pop_back();
+        }
+    }
+
+    void World::write_component(Entity entity, ComponentId id, const void* data) {
+        const EntityRecord& record = records[entity.index];
+        memcpy(record.archetype->get_component(record.archetype->chunks[record.chunk_index], id, record.row),
+            data, ComponentRegistry::get_info(id).size);
+    }
+
+}
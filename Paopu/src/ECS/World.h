@@ -0,0 +1,279 @@
+#pragma once
+#include "../Core/Core.h"
+#include "../Core/JobSystem.h"
+#include "../Memory/FrameMemory.h"
+#include "../Memory/Pool.h"
+#include "Archetype.h"
+#include "Entity.h"
+
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Paopu {
+
+    // Forward Declarations
+    class World;
+
+    /// One chunk's worth of entities handed to a query callback
+    ///
+    ///
+    struct PAOPU_API ChunkView {
+        const Archetype* archetype;
+        Chunk* chunk;
+        uint32_t count;
+
+        /// The chunk's array of `T`, `count` long. The component must be part
+        /// of the query.
+        ///
+        template<typename T>
+        inline T* get() const {
+            using Component = typename std::remove_const<T>::type;
+            return static_cast<T*>(archetype->get_column(chunk, ComponentRegistry::get_id<Component>()));
+        }
+
+        /// Optional components: null if this chunk's archetype doesn't have `T`
+        ///
+        ///
+        template<typename T>
+        inline T* try_get() const {
+            using Component = typename std::remove_const<T>::type;
+            ComponentId id = ComponentRegistry::get_id<Component>();
+            return archetype->has_component(id) ? static_cast<T*>(archetype->get_column(chunk, id)) : nullptr;
+        }
+
+        inline const Entity* get_entities() const { return archetype->get_entities(chunk); }
+    };
+
+    /// Entities that have every component in `Ts` (and none in `excluded`).
+    /// `const` components are read only, which is what a System declares.
+    ///
+    /// The matching archetypes are cached and topped up with archetypes
+    /// created since the last use, so a query is cheap to keep around.
+    template<typename... Ts>
+    class Query {
+
+        public:
+            Query(World* world, ComponentMask excluded = 0)
+                : world(world), required(make_component_mask<Ts...>()), excluded(excluded) {}
+
+            /// Calls `function(Ts&...)` for every matching entity
+            ///
+            ///
+            template<typename F>
+            void for_each(F&& function) {
+                for_each_chunk([&function](const ChunkView& view) {
+                    std::tuple<Ts*...> columns(view.get<Ts>()...);
+                    for(uint32_t row = 0; row < view.count; row++) {
+                        function(std::get<Ts*>(columns)[row]...);
+                    }
+                });
+            }
+
+            /// Calls `function(const ChunkView&)` for every non-empty chunk. This
+            /// is the fast path: the callback can loop over raw arrays.
+            ///
+            template<typename F>
+            void for_each_chunk(F&& function) {
+                refresh();
+                for(Archetype* archetype : archetypes) {
+                    for(Chunk* chunk : archetype->chunks) {
+                        if(chunk->count > 0) {
+                            function(ChunkView{archetype, chunk, chunk->count});
+                        }
+                    }
+                }
+            }
+
+            /// Same as `for_each_chunk` with chunks spread over the JobSystem.
+            /// The callback must only touch the chunk it is given.
+            ///
+            template<typename F>
+            void parallel_for_each_chunk(const F& function) {
+                refresh();
+
+                uint32_t chunk_count = 0;
+                for(Archetype* archetype : archetypes) {
+                    chunk_count += static_cast<uint32_t>(archetype->chunks.size());
+                }
+                if(chunk_count == 0) return;
+
+                // Flattened once so workers can index straight into it, see FrameMemory.h
+                ChunkView* views = FrameMemory::allocate_array<ChunkView>(chunk_count);
+                uint32_t view_count = 0;
+                for(Archetype* archetype : archetypes) {
+                    for(Chunk* chunk : archetype->chunks) {
+                        views[view_count++] = ChunkView{archetype, chunk, chunk->count};
+                    }
+                }
+
+                JobSystem::parallel_for(view_count, [views, &function](uint32_t begin, uint32_t end) {
+                    for(uint32_t i = begin; i < end; i++) {
+                        if(views[i].count > 0) {
+                            function(views[i]);
+                        }
+                    }
+                });
+            }
+
+            /// Same as `for_each` with chunks spread over the JobSystem
+            ///
+            ///
+            template<typename F>
+            void parallel_for_each(const F& function) {
+                parallel_for_each_chunk([&function](const ChunkView& view) {
+                    std::tuple<Ts*...> columns(view.get<Ts>()...);
+                    for(uint32_t row = 0; row < view.count; row++) {
+                        function(std::get<Ts*>(columns)[row]...);
+                    }
+                });
+            }
+
+            uint32_t get_entity_count() {
+                refresh();
+                uint32_t count = 0;
+                for(Archetype* archetype : archetypes) {
+                    count += archetype->entity_count;
+                }
+                return count;
+            }
+
+        private:
+            void refresh();
+
+            World* world;
+            ComponentMask required;
+            ComponentMask excluded;
+
+            std::vector<Archetype*> archetypes;
+            // How many of the world's archetypes have been checked so far
+            size_t checked_archetypes{0};
+    };
+
+    /// Owns entities and their components, grouped into archetypes.
+    ///
+    /// Structural changes (creating and destroying entities, adding and
+    /// removing components) move data between chunks and are not thread-safe.
+    /// Systems running in parallel record them in a CommandBuffer instead,
+    /// see CommandBuffer.h. Reading and writing component values in place is
+    /// fine from any thread as long as the accesses don't overlap.
+    class PAOPU_API World {
+        template<typename... Ts> friend class Query;
+
+        public:
+            World();
+            ~World();
+
+            World(const World&) = delete;
+            World& operator=(const World&) = delete;
+
+            /// Creates an entity with no components
+            ///
+            ///
+            Entity create_entity();
+
+            /// Creates an entity with `components` already set, moving it
+            /// straight into its final archetype
+            ///
+            template<typename... Ts>
+            Entity create_entity(const Ts&... components) {
+                Entity entity = allocate_entity();
+                place_entity(entity, get_archetype(make_component_mask<Ts...>()));
+                (write_component(entity, ComponentRegistry::get_id<Ts>(), &components), ...);
+                return entity;
+            }
+
+            void destroy_entity(Entity entity);
+
+            bool is_alive(Entity entity) const;
+
+            template<typename T>
+            void add_component(Entity entity, const T& value = T{}) {
+                add_component_raw(entity, ComponentRegistry::get_id<T>(), &value);
+            }
+
+            template<typename T>
+            void remove_component(Entity entity) {
+                remove_component_raw(entity, ComponentRegistry::get_id<T>());
+            }
+
+            /// Null if the entity is dead or doesn't have `T`. Valid until the
+            /// next structural change.
+            ///
+            template<typename T>
+            T* get_component(Entity entity) {
+                return static_cast<T*>(get_component_raw(entity, ComponentRegistry::get_id<T>()));
+            }
+
+            template<typename T>
+            bool has_component(Entity entity) const {
+                return is_alive(entity) && records[entity.index].archetype->has_component(ComponentRegistry::get_id<T>());
+            }
+
+            /// See Query. Components listed as `const T` are read only.
+            ///
+            ///
+            template<typename... Ts>
+            Query<Ts...> query(ComponentMask excluded = 0) {
+                return Query<Ts...>(this, excluded);
+            }
+
+            inline uint32_t get_entity_count() const { return entity_count; }
+            inline uint32_t get_archetype_count() const { return static_cast<uint32_t>(archetypes.size()); }
+
+            // Untyped versions, used by CommandBuffer playback
+
+            /// Adds or overwrites a component. `data` may be unaligned.
+            void add_component_raw(Entity entity, ComponentId id, const void* data);
+            void remove_component_raw(Entity entity, ComponentId id);
+            void* get_component_raw(Entity entity, ComponentId id);
+
+        private:
+            /// Where an entity's data currently lives
+            struct EntityRecord {
+                Archetype* archetype{nullptr};
+                uint32_t chunk_index{0};
+                uint32_t row{0};
+                uint32_t generation{1};
+            };
+
+            Entity allocate_entity();
+            Archetype* get_archetype(ComponentMask mask);
+
+            /// Appends a row for `entity` to `archetype` and points its record there
+            void place_entity(Entity entity, Archetype* archetype);
+
+            /// Moves `entity` into `target`, carrying over the components both share
+            void move_entity(Entity entity, Archetype* target);
+
+            /// Fills the hole at the entity's row with the archetype's last row
+            void remove_row(const EntityRecord& record);
+
+            void write_component(Entity entity, ComponentId id, const void* data);
+
+            std::vector<EntityRecord> records;
+            std::vector<uint32_t> free_indices;
+            uint32_t entity_count{0};
+
+            std::vector<std::unique_ptr<Archetype>> archetypes;
+            std::unordered_map<ComponentMask, Archetype*> archetype_lookup;
+            Archetype* empty_archetype{nullptr};
+
+            FixedPool chunk_pool;
+    };
+
+    template<typename... Ts>
+    void Query<Ts...>::refresh() {
+        const auto& world_archetypes = world->archetypes;
+        for(; checked_archetypes < world_archetypes.size(); checked_archetypes++) {
+            Archetype* archetype = world_archetypes[checked_archetypes].get();
+            if((archetype->mask & required) == required && (archetype->mask & excluded) == 0) {
+                archetypes.push_back(archetype);
+            }
+        }
+    }
+
+}
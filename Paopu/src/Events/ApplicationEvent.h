@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../Core/Core.h"
+
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Payload of `EventType::WindowResize`
+    struct PAOPU_API WindowResizeEvent {
+        uint32_t width;
+        uint32_t height;
+    };
+
+    /// Payload of `EventType::WindowMoved`
+    struct PAOPU_API WindowMovedEvent {
+        int32_t x;
+        int32_t y;
+    };
+
+    /// Payload of `EventType::Tick`, `EventType::Update` and `EventType::Render`
+    ///
+    /// `frame_index`: Tick count for Tick, frame count for Update and Render
+    /// `interpolation`: Render only, see FixedTimestep::get_interpolation
+    struct PAOPU_API FrameEvent {
+        double delta_time;
+        uint64_t frame_index;
+        double interpolation;
+    };
+
+}
@@ -1,81 +1,109 @@
 #pragma once
 
 #include "../Core/Core.h"
+#include "ApplicationEvent.h"
+#include "KeyEvent.h"
+#include "MouseEvent.h"
+#include "GamepadEvent.h"
 
-#include <string>
-#include <functional>
+#include <cstdint>
+#include <type_traits>
 
 namespace Paopu {
-    
-    //TODO (Devon): Add an event buffer as this is currently blocking
-    enum class EventType {
+
+    enum class EventType : uint32_t {
         None = 0,
         WindowClose, WindowResize, WindowFocus, WindowLostFocus, WindowMoved,
         Tick, Update, Render,
         KeyPressed, KeyReleased,
-        MouseButtonPressed, MouseButtonReleased, MouseMoved, MouseScrolled
+        MouseButtonPressed, MouseButtonReleased, MouseMoved, MouseScrolled,
+        GamepadButtonPressed, GamepadButtonReleased, GamepadAxisMoved,
+        Count
     };
 
+    static const uint32_t k_event_type_count = static_cast<uint32_t>(EventType::Count);
+
     enum EventCategory {
         None = 0,
         EventCategoryApplication    = BIT(0),
         EventCategoryInput          = BIT(1),
         EventCategoryKeyboard       = BIT(2),
         EventCategoryMouse          = BIT(3),
-        EventCategoryMouseButton    = BIT(4)
-    };
-
-#define EVENT_CLASS_TYPE(type) static EventType GetStaticType() { return EventType::##type; }\
-                                virtual EventType GetEventType() const override { return GetStaticType(); }\
-                                virtual const char* GetName() const override { return #type; }
-
-#define EVENT_CLASS_CATEGORY(category) virtual int GetCategoryFlags() const override { return category; }
-
-    class PAO_API Event {
-        // 
-        friend class EventDispatcher;
-        
-        public:
-            virtual EventType GetEventType() const = 0;
-            virtual const char* GetName() const = 0;
-            virtual int GetCategoryFlags() const = 0;
-            virtual std::string ToString() const { return GetName(); }
-
-
-            inline bool IsInCategory(EventCategory category) {
-                return GetCategoryFlags() & category;
-            }
-
-        protected:
-            bool m_Handled = false;
+        EventCategoryMouseButton    = BIT(4),
+        EventCategoryGamepad        = BIT(5)
     };
 
-    class EventDispatcher {
-        
-        template<typename T>
-        using EventFn = std::function<bool(T&)>;
-
-        public:
-            EventDispatcher(Event& event)
-                : m_Event(event) {
-
-            }
-
-            template<typename T>
-            bool Dispatch(EventFn<T> func) {
-                if (m_Event.GetEventType() == T::GetStaticType()) {
-                    m_Event.m_Handled = func(*(T*)&m_Event);
-                    return true;
-                }
-                return false;
-            }
-    private:
-		Event& m_Event;
-
+    /// A single event record. Events are plain data so they can be copied
+    /// into the EventQueue's ring without allocating; the payload that is
+    /// valid depends on `type`.
+    ///
+    /// `timestamp_ns`: When the event was produced, see Time.h
+    struct PAOPU_API Event {
+        EventType type{EventType::None};
+        bool handled{false};
+        uint64_t timestamp_ns{0};
+
+        union {
+            WindowResizeEvent window_resize;
+            WindowMovedEvent window_moved;
+            FrameEvent frame;
+            KeyEvent key;
+            MouseButtonEvent mouse_button;
+            MouseMovedEvent mouse_moved;
+            MouseScrolledEvent mouse_scrolled;
+            GamepadButtonEvent gamepad_button;
+            GamepadAxisEvent gamepad_axis;
+        };
+
+        Event() : window_resize{} {}
     };
 
-    inline std::ostream& operator<<(std::ostream& os, const Event& e) {
-        return os << e.ToString();
-	}
-
-}
\ No newline at end of file
+    static_assert(std::is_trivially_copyable<Event>::value, "Events are copied into a ring buffer and must stay plain data");
+
+    /// Returns the EventCategory flags an event type belongs to
+    ///
+    ///
+    inline PAOPU_API int get_event_category_flags(EventType type) {
+        switch(type) {
+            case EventType::KeyPressed:
+            case EventType::KeyReleased:
+                return EventCategoryInput | EventCategoryKeyboard;
+            case EventType::MouseButtonPressed:
+            case EventType::MouseButtonReleased:
+                return EventCategoryInput | EventCategoryMouse | EventCategoryMouseButton;
+            case EventType::MouseMoved:
+            case EventType::MouseScrolled:
+                return EventCategoryInput | EventCategoryMouse;
+            case EventType::GamepadButtonPressed:
+            case EventType::GamepadButtonReleased:
+            case EventType::GamepadAxisMoved:
+                return EventCategoryInput | EventCategoryGamepad;
+            case EventType::None:
+            case EventType::Count:
+                return None;
+            default:
+                return EventCategoryApplication;
+        }
+    }
+
+    inline PAOPU_API bool is_in_category(const Event& event, EventCategory category) {
+        return get_event_category_flags(event.type) & category;
+    }
+
+    /// Returns the name of an event type, for logging
+    ///
+    ///
+    inline PAOPU_API const char* get_event_name(EventType type) {
+        static const char* const k_names[k_event_type_count] = {
+            "None",
+            "WindowClose", "WindowResize", "WindowFocus", "WindowLostFocus", "WindowMoved",
+            "Tick", "Update", "Render",
+            "KeyPressed", "KeyReleased",
+            "MouseButtonPressed", "MouseButtonReleased", "MouseMoved", "MouseScrolled",
+            "GamepadButtonPressed", "GamepadButtonReleased", "GamepadAxisMoved"
+        };
+        uint32_t index = static_cast<uint32_t>(type);
+        return index < k_event_type_count ? k_names[index] : "Unknown";
+    }
+
+}
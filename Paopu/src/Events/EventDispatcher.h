@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../Core/Core.h"
+#include "Event.h"
+#include "EventQueue.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace Paopu {
+
+    /// Returns true if the event was handled and shouldn't reach later handlers
+    using EventHandlerFn = bool(*)(Event& event, void* user_data);
+
+    /// Routes events to handlers through a jump table indexed by EventType.
+    /// Handlers are plain function pointers plus a user pointer, so dispatching
+    /// an event is an array lookup and an indirect call per handler.
+    ///
+    class PAOPU_API EventDispatcher {
+
+        public:
+            static const uint32_t k_max_handlers_per_type = 8;
+
+            /// Registers `handler` for events of `type`. Handlers run in the
+            /// order they were subscribed.
+            ///
+            void subscribe(EventType type, EventHandlerFn handler, void* user_data = nullptr) {
+                HandlerList& list = handlers[static_cast<uint32_t>(type)];
+                if(list.count == k_max_handlers_per_type) {
+                    throw std::runtime_error("[Events][Dispatcher]: Too many handlers for a single event type!");
+                }
+                list.entries[list.count++] = {handler, user_data};
+            }
+
+            /// Registers a member function as a handler, e.g.
+            /// `dispatcher.subscribe<MyApp, &MyApp::on_key>(EventType::KeyPressed, this);`
+            ///
+            template<typename T, bool (T::*Method)(Event&)>
+            void subscribe(EventType type, T* object) {
+                subscribe(type, [](Event& event, void* user_data) {
+                    return (static_cast<T*>(user_data)->*Method)(event);
+                }, object);
+            }
+
+            /// Removes every handler registered with `user_data` for `type`
+            ///
+            ///
+            void unsubscribe(EventType type, void* user_data) {
+                HandlerList& list = handlers[static_cast<uint32_t>(type)];
+                uint32_t kept = 0;
+                for(uint32_t i = 0; i < list.count; i++) {
+                    if(list.entries[i].user_data != user_data) {
+                        list.entries[kept++] = list.entries[i];
+                    }
+                }
+                list.count = kept;
+            }
+
+            /// Sends `event` to the handlers of its type until one handles it
+            ///
+            ///
+            void dispatch(Event& event) const {
+                const HandlerList& list = handlers[static_cast<uint32_t>(event.type)];
+                for(uint32_t i = 0; i < list.count && !event.handled; i++) {
+                    event.handled = list.entries[i].handler(event, list.entries[i].user_data);
+                }
+            }
+
+            /// Dispatches every event currently in `queue`. Events pushed while
+            /// draining are left for the next frame.
+            ///
+            /// Returns the number of events dispatched.
+            uint32_t drain(EventQueue& queue) const {
+                Event event;
+                uint32_t pending = queue.get_pending_count();
+                uint32_t count = 0;
+                while(count < pending && queue.pop(event)) {
+                    dispatch(event);
+                    count++;
+                }
+                return count;
+            }
+
+        private:
+            struct HandlerEntry {
+                EventHandlerFn handler;
+                void* user_data;
+            };
+
+            struct HandlerList {
+                uint32_t count{0};
+                HandlerEntry entries[k_max_handlers_per_type];
+            };
+
+            HandlerList handlers[k_event_type_count];
+    };
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../Core/Core.h"
+#include "Event.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Bounded multi-producer, single-consumer ring of Events.
+    ///
+    /// GLFW callbacks and worker threads `push` from any thread without locking
+    /// or allocating; the main thread drains the ring once per frame. Each slot
+    /// carries a sequence number so producers claim slots with a single CAS and
+    /// the consumer can tell when a claimed slot has been fully written.
+    ///
+    /// When the ring is full new events are dropped rather than
+    /// blocking the producer. `get_dropped_count` reports how many were lost.
+    class PAOPU_API EventQueue {
+
+        public:
+            static const uint32_t k_capacity = 4096;
+
+            EventQueue() {
+                for(uint32_t i = 0; i < k_capacity; i++) {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            EventQueue(const EventQueue&) = delete;
+            EventQueue& operator=(const EventQueue&) = delete;
+
+            /// Copies `event` into the ring. Safe to call from any thread.
+            ///
+            /// Returns false if the ring was full and the event was dropped.
+            bool push(const Event& event) {
+                uint32_t position = write_index.load(std::memory_order_relaxed);
+                Slot* slot;
+
+                for(;;) {
+                    slot = &slots[position & k_mask];
+                    uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+                    int32_t difference = static_cast<int32_t>(sequence - position);
+
+                    if(difference == 0) {
+                        if(write_index.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    } else if(difference < 0) {
+                        dropped_count.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    } else {
+                        position = write_index.load(std::memory_order_relaxed);
+                    }
+                }
+
+                slot->event = event;
+                slot->sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            /// Pops the oldest event into `event`. Only the consumer thread may call this.
+            ///
+            /// Returns false if there was nothing to pop.
+            bool pop(Event& event) {
+                Slot& slot = slots[read_index & k_mask];
+                uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+                if(static_cast<int32_t>(sequence - (read_index + 1)) < 0) {
+                    return false;
+                }
+
+                event = slot.event;
+                slot.sequence.store(read_index + k_capacity, std::memory_order_release);
+                read_index++;
+                return true;
+            }
+
+            /// Number of events pushed but not popped yet. Only meaningful on the
+            /// consumer thread, producers may add more at any time.
+            ///
+            inline uint32_t get_pending_count() const { return write_index.load(std::memory_order_acquire) - read_index; }
+
+            inline uint32_t get_dropped_count() const { return dropped_count.load(std::memory_order_relaxed); }
+
+        private:
+            static_assert((k_capacity & (k_capacity - 1)) == 0, "EventQueue capacity must be a power of two");
+            static const uint32_t k_mask = k_capacity - 1;
+
+            struct Slot {
+                std::atomic<uint32_t> sequence;
+                Event event;
+            };
+
+            // Producers and the consumer write to different cache lines
+            alignas(64) std::atomic<uint32_t> write_index{0};
+            alignas(64) uint32_t read_index{0};
+            std::atomic<uint32_t> dropped_count{0};
+
+            alignas(64) Slot slots[k_capacity];
+    };
+
+}
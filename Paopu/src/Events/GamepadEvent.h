@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../Core/Core.h"
+
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Payload of `EventType::GamepadButtonPressed` and `EventType::GamepadButtonReleased`
+    struct PAOPU_API GamepadButtonEvent {
+        int32_t gamepad;
+        int32_t button;
+    };
+
+    /// Payload of `EventType::GamepadAxisMoved`. `value` is in [-1, 1].
+    struct PAOPU_API GamepadAxisEvent {
+        int32_t gamepad;
+        int32_t axis;
+        float value;
+    };
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "../Core/Core.h"
+
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Payload of `EventType::KeyPressed` and `EventType::KeyReleased`.
+    /// `key`, `scancode` and `mods` are the GLFW values.
+    struct PAOPU_API KeyEvent {
+        int32_t key;
+        int32_t scancode;
+        int32_t mods;
+        bool repeat;
+    };
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../Core/Core.h"
+
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Payload of `EventType::MouseButtonPressed` and `EventType::MouseButtonReleased`
+    struct PAOPU_API MouseButtonEvent {
+        int32_t button;
+        int32_t mods;
+    };
+
+    /// Payload of `EventType::MouseMoved`, in screen coordinates
+    struct PAOPU_API MouseMovedEvent {
+        double x;
+        double y;
+    };
+
+    /// Payload of `EventType::MouseScrolled`
+    struct PAOPU_API MouseScrolledEvent {
+        double x_offset;
+        double y_offset;
+    };
+
+}
@@ -0,0 +1,79 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace Paopu {
+
+    static std::atomic<uint64_t> s_allocation_count{0};
+    static std::atomic<uint64_t> s_allocated_bytes{0};
+
+    AllocationStats get_allocation_stats() {
+        AllocationStats stats;
+        stats.count = s_allocation_count.load(std::memory_order_relaxed);
+        stats.bytes = s_allocated_bytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+#ifdef PAO_TRACK_ALLOCATIONS
+    static inline void track_allocation(std::size_t size) {
+        s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+        s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+#endif
+
+}
+
+#ifdef PAO_TRACK_ALLOCATIONS
+
+// Replacing these in the engine means the linker pulls them in with
+// get_allocation_stats, so every module is counted the same way.
+// Array and nothrow forms forward to these by default.
+
+void* operator new(std::size_t size) {
+    Paopu::track_allocation(size);
+    if(void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    Paopu::track_allocation(size);
+
+    // aligned_alloc wants the size to be a multiple of the alignment
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t padded = (size + align - 1) & ~(align - 1);
+#ifdef PAO_PLATFORM_WINDOWS
+    void* ptr = _aligned_malloc(padded == 0 ? align : padded, align);
+#else
+    void* ptr = std::aligned_alloc(align, padded == 0 ? align : padded);
+#endif
+    if(ptr != nullptr) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+#ifdef PAO_PLATFORM_WINDOWS
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(ptr, alignment);
+}
+
+#endif
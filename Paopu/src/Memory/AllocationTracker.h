@@ -0,0 +1,30 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Counts every global operator new in the process. Only active when built
+    /// with PAO_TRACK_ALLOCATIONS (on by default in Debug, see CMakeLists.txt);
+    /// otherwise the counters stay at zero and cost nothing.
+    ///
+    /// The Application uses it to warn about heap allocations in steady-state
+    /// frames, which should all come from frame arenas or pools.
+    struct PAOPU_API AllocationStats {
+        uint64_t count{0};
+        uint64_t bytes{0};
+    };
+
+#ifdef PAO_TRACK_ALLOCATIONS
+    static const bool k_track_allocations = true;
+#else
+    static const bool k_track_allocations = false;
+#endif
+
+    /// Totals since startup
+    ///
+    ///
+    PAOPU_API AllocationStats get_allocation_stats();
+
+}
@@ -0,0 +1,35 @@
+#include "FrameMemory.h"
+
+namespace Paopu {
+
+    std::atomic<uint64_t> FrameMemory::s_frame_index{0};
+
+    namespace {
+
+        struct ThreadFrameArena {
+            LinearArena arena{FrameMemory::k_arena_size};
+            uint64_t frame_index{0};
+        };
+
+        thread_local ThreadFrameArena s_thread_arena;
+
+    }
+
+    LinearArena& FrameMemory::get_thread_arena() {
+        uint64_t frame_index = get_frame_index();
+        if(s_thread_arena.frame_index != frame_index) {
+            s_thread_arena.arena.reset();
+            s_thread_arena.frame_index = frame_index;
+        }
+        return s_thread_arena.arena;
+    }
+
+    void* FrameMemory::allocate(size_t size, size_t alignment) {
+        return get_thread_arena().allocate(size, alignment);
+    }
+
+    void FrameMemory::end_frame() {
+        s_frame_index.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+}
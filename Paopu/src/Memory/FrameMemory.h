@@ -0,0 +1,53 @@
+#pragma once
+#include "../Core/Core.h"
+#include "LinearArena.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Scratch memory that lives until the end of the current frame.
+    ///
+    /// Every thread gets its own LinearArena, so allocating never contends.
+    /// `end_frame` doesn't touch the arenas directly; it bumps the frame index
+    /// and each arena resets itself the next time its thread allocates. Memory
+    /// from the frame arena must not be kept past `end_frame`.
+    ///
+    /// Only the frame thread, the one calling `end_frame`, and the jobs it
+    /// waits on within the frame may use it, FrameResource included. Any other
+    /// thread can see `end_frame` land between two of its allocations, and
+    /// its arena then hands out the first one's memory again.
+    ///
+    class PAOPU_API FrameMemory {
+
+        public:
+            static const size_t k_arena_size = 1024 * 1024;
+
+            /// Frame scratch memory from the calling thread's arena
+            ///
+            ///
+            static void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+            template<typename T>
+            static T* allocate_array(size_t count) {
+                return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            }
+
+            /// The calling thread's arena, already reset for the current frame
+            ///
+            ///
+            static LinearArena& get_thread_arena();
+
+            /// Invalidates all frame memory handed out so far, on every thread.
+            /// Called once per frame by the Application.
+            ///
+            static void end_frame();
+
+            static inline uint64_t get_frame_index() { return s_frame_index.load(std::memory_order_acquire); }
+
+        private:
+            static std::atomic<uint64_t> s_frame_index;
+    };
+
+}
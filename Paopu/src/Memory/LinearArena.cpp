@@ -0,0 +1,69 @@
+#include "LinearArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace Paopu {
+
+    LinearArena::LinearArena(size_t initial_size) {
+        push_block(std::max<size_t>(initial_size, 256));
+    }
+
+    LinearArena::~LinearArena() {
+        free_blocks();
+    }
+
+    void LinearArena::reset() {
+        high_water = get_high_water();
+
+        // Overflowed during the last frame, fold the chain into one block big
+        // enough for all of it so steady-state frames stay in a single block
+        if(head != nullptr && head->previous != nullptr) {
+            size_t total = capacity;
+            free_blocks();
+            push_block(total);
+        }
+
+        current = reinterpret_cast<uintptr_t>(head) + sizeof(Block);
+        end = reinterpret_cast<uintptr_t>(head) + head->size;
+        used = 0;
+    }
+
+    void* LinearArena::allocate_slow(size_t size, size_t alignment) {
+        // Double each time so a burst doesn't chain lots of small blocks
+        push_block(std::max(capacity, size + alignment + sizeof(Block)));
+
+        uintptr_t aligned = (current + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+        current = aligned + size;
+        used += size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void LinearArena::push_block(size_t size) {
+        Block* block = static_cast<Block*>(std::malloc(size));
+        if(block == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        block->previous = head;
+        block->size = size;
+        head = block;
+        capacity += size;
+
+        current = reinterpret_cast<uintptr_t>(block) + sizeof(Block);
+        end = reinterpret_cast<uintptr_t>(block) + size;
+    }
+
+    void LinearArena::free_blocks() {
+        while(head != nullptr) {
+            Block* previous = head->previous;
+            std::free(head);
+            head = previous;
+        }
+        capacity = 0;
+        current = 0;
+        end = 0;
+    }
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Bump allocator. Allocating is a pointer increment, memory is only ever
+    /// released all at once by `reset`.
+    ///
+    /// When the current block runs out the arena chains another one. On the
+    /// next `reset` the chain is replaced by a single block large enough for
+    /// everything, so after a few frames an arena stops touching the heap.
+    ///
+    /// Not thread-safe, give each thread its own arena (see FrameMemory.h).
+    class PAOPU_API LinearArena {
+
+        public:
+            static const size_t k_default_block_size = 64 * 1024;
+
+            explicit LinearArena(size_t initial_size = k_default_block_size);
+            ~LinearArena();
+
+            LinearArena(const LinearArena&) = delete;
+            LinearArena& operator=(const LinearArena&) = delete;
+
+            /// Returns `size` bytes aligned to `alignment`, which must be a power of two
+            ///
+            ///
+            inline void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+                uintptr_t aligned = (current + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+                if(aligned + size <= end) {
+                    current = aligned + size;
+                    used += size;
+                    return reinterpret_cast<void*>(aligned);
+                }
+                return allocate_slow(size, alignment);
+            }
+
+            template<typename T>
+            inline T* allocate_array(size_t count) {
+                return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            }
+
+            /// Releases everything allocated since the last reset
+            ///
+            ///
+            void reset();
+
+            /// Bytes handed out since the last reset
+            ///
+            ///
+            inline size_t get_used() const { return used; }
+
+            /// Most bytes ever in use between two resets
+            ///
+            ///
+            inline size_t get_high_water() const { return high_water > used ? high_water : used; }
+
+            /// Total bytes currently reserved from the heap
+            ///
+            ///
+            inline size_t get_capacity() const { return capacity; }
+
+        private:
+            /// Header at the start of every heap block
+            struct Block {
+                Block* previous;
+                size_t size;
+            };
+
+            void* allocate_slow(size_t size, size_t alignment);
+            void push_block(size_t size);
+            void free_blocks();
+
+            Block* head{nullptr};
+            uintptr_t current{0};
+            uintptr_t end{0};
+
+            size_t used{0};
+            size_t high_water{0};
+            size_t capacity{0};
+    };
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "../Core/Core.h"
+#include "FrameMemory.h"
+#include "LinearArena.h"
+#include "Pool.h"
+
+#include <memory_resource>
+
+namespace Paopu {
+
+    /// std::pmr adapters so STL containers can allocate from the engine's
+    /// allocators, e.g.
+    /// `std::pmr::vector<VkPhysicalDevice> devices(count, FrameResource::get());`
+
+    /// Allocates from a specific LinearArena. Deallocation is a no-op, the
+    /// memory comes back when the arena is reset.
+    ///
+    class PAOPU_API ArenaResource : public std::pmr::memory_resource {
+
+        public:
+            explicit ArenaResource(LinearArena* arena) : arena(arena) {}
+
+        private:
+            void* do_allocate(size_t bytes, size_t alignment) override {
+                return arena->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void*, size_t, size_t) override {}
+
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+
+            LinearArena* arena;
+    };
+
+    /// Allocates from whichever thread's frame arena is calling, see FrameMemory.h.
+    /// Containers using it must not outlive the frame.
+    ///
+    class PAOPU_API FrameResource : public std::pmr::memory_resource {
+
+        public:
+            /// The process-wide instance, the resource itself is stateless
+            ///
+            ///
+            static FrameResource* get() {
+                static FrameResource s_instance;
+                return &s_instance;
+            }
+
+        private:
+            void* do_allocate(size_t bytes, size_t alignment) override {
+                return FrameMemory::allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void*, size_t, size_t) override {}
+
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+    };
+
+    /// Serves requests that fit a FixedPool slot from the pool and passes
+    /// larger ones to `upstream`. Meant for node based containers (std::pmr::map,
+    /// std::pmr::list) whose nodes all have the same size.
+    ///
+    class PAOPU_API PoolResource : public std::pmr::memory_resource {
+
+        public:
+            PoolResource(FixedPool* pool, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+                : pool(pool), upstream(upstream) {}
+
+        private:
+            inline bool fits(size_t bytes, size_t alignment) const {
+                return bytes <= pool->get_slot_size() && alignment <= pool->get_slot_alignment();
+            }
+
+            void* do_allocate(size_t bytes, size_t alignment) override {
+                return fits(bytes, alignment) ? pool->allocate() : upstream->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+                if(fits(bytes, alignment)) {
+                    pool->free(ptr);
+                } else {
+                    upstream->deallocate(ptr, bytes, alignment);
+                }
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+
+            FixedPool* pool;
+            std::pmr::memory_resource* upstream;
+    };
+
+}
@@ -0,0 +1,53 @@
+#include "Pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace Paopu {
+
+    FixedPool::FixedPool(size_t slot_size, size_t slot_alignment, uint32_t slots_per_page)
+        : slot_alignment(std::max(slot_alignment, alignof(FreeSlot))),
+          slots_per_page(std::max(slots_per_page, 1u)) {
+        // Free slots store the list link in place, so they're at least a pointer
+        size_t size = std::max(slot_size, sizeof(FreeSlot));
+        this->slot_size = (size + this->slot_alignment - 1) & ~(this->slot_alignment - 1);
+    }
+
+    FixedPool::~FixedPool() {
+        while(pages != nullptr) {
+            Page* next = pages->next;
+            std::free(pages);
+            pages = next;
+        }
+    }
+
+    void FixedPool::reserve(uint32_t count) {
+        while(capacity - live_count < count) {
+            add_page();
+        }
+    }
+
+    void FixedPool::add_page() {
+        // Room for the header plus worst case padding up to the slot alignment,
+        // malloc only guarantees alignof(std::max_align_t)
+        size_t page_size = sizeof(Page) + slot_alignment + slot_size * slots_per_page;
+
+        Page* page = static_cast<Page*>(std::malloc(page_size));
+        if(page == nullptr) {
+            throw std::bad_alloc();
+        }
+        page->next = pages;
+        pages = page;
+
+        // Thread the new slots onto the free list in address order
+        uintptr_t start = reinterpret_cast<uintptr_t>(page) + sizeof(Page);
+        unsigned char* first = reinterpret_cast<unsigned char*>((start + slot_alignment - 1) & ~(slot_alignment - 1));
+        for(uint32_t i = slots_per_page; i > 0; i--) {
+            FreeSlot* slot = reinterpret_cast<FreeSlot*>(first + slot_size * (i - 1));
+            slot->next = free_list;
+            free_list = slot;
+        }
+        capacity += slots_per_page;
+    }
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace Paopu {
+
+    /// Hands out fixed-size slots from pages carved into a free list.
+    /// Allocating and freeing are a couple of pointer moves; the heap is only
+    /// touched when every page is full and another one is added.
+    ///
+    /// Not thread-safe.
+    class PAOPU_API FixedPool {
+
+        public:
+            FixedPool(size_t slot_size, size_t slot_alignment, uint32_t slots_per_page = 256);
+            ~FixedPool();
+
+            FixedPool(const FixedPool&) = delete;
+            FixedPool& operator=(const FixedPool&) = delete;
+
+            inline void* allocate() {
+                if(free_list == nullptr) {
+                    add_page();
+                }
+
+                FreeSlot* slot = free_list;
+                free_list = slot->next;
+                live_count++;
+                return slot;
+            }
+
+            inline void free(void* ptr) {
+                if(ptr == nullptr) return;
+
+                FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+                slot->next = free_list;
+                free_list = slot;
+                live_count--;
+            }
+
+            /// Makes sure `count` slots can be allocated without growing
+            ///
+            ///
+            void reserve(uint32_t count);
+
+            inline size_t get_slot_size() const { return slot_size; }
+            inline size_t get_slot_alignment() const { return slot_alignment; }
+            inline uint32_t get_live_count() const { return live_count; }
+            inline uint32_t get_capacity() const { return capacity; }
+
+        private:
+            struct FreeSlot {
+                FreeSlot* next;
+            };
+
+            struct Page {
+                Page* next;
+            };
+
+            void add_page();
+
+            size_t slot_size;
+            size_t slot_alignment;
+            uint32_t slots_per_page;
+
+            Page* pages{nullptr};
+            FreeSlot* free_list{nullptr};
+            uint32_t live_count{0};
+            uint32_t capacity{0};
+    };
+
+    /// Typed FixedPool that constructs and destroys the objects it hands out
+    ///
+    ///
+    template<typename T>
+    class ObjectPool {
+
+        public:
+            explicit ObjectPool(uint32_t objects_per_page = 256)
+                : pool(sizeof(T), alignof(T), objects_per_page) {}
+
+            template<typename... Args>
+            T* create(Args&&... args) {
+                void* slot = pool.allocate();
+                return new (slot) T(std::forward<Args>(args)...);
+            }
+
+            void destroy(T* object) {
+                if(object == nullptr) return;
+
+                object->~T();
+                pool.free(object);
+            }
+
+            inline void reserve(uint32_t count) { pool.reserve(count); }
+            inline uint32_t get_live_count() const { return pool.get_live_count(); }
+
+        private:
+            FixedPool pool;
+    };
+
+}
@@ -3,7 +3,35 @@
 #include <stdio.h>
 #include "Core/Application.h"
 #include "Core/Window.h"
+#include "Core/FixedTimestep.h"
+#include "Core/Input.h"
+#include "Core/InputRecording.h"
+#include "Core/JobSystem.h"
 #include "Core/Logger.h"
+#include "Core/Profiler.h"
+#include "Assets/AssetArchive.h"
+#include "Assets/AssetLoader.h"
+#include "Assets/Ktx2.h"
+#include "Assets/TextureTranscoder.h"
+#include "Audio/AudioClip.h"
+#include "Audio/AudioDevice.h"
+#include "Audio/AudioMixer.h"
+#include "Memory/AllocationTracker.h"
+#include "Memory/FrameMemory.h"
+#include "Memory/LinearArena.h"
+#include "Memory/MemoryResource.h"
+#include "Memory/Pool.h"
+#include "ECS/CommandBuffer.h"
+#include "ECS/Entity.h"
+#include "ECS/System.h"
+#include "ECS/World.h"
+#include "Scene/SpriteAnimation.h"
+#include "Scene/TransformHierarchy.h"
+#include "Physics/Broadphase.h"
+#include "Physics/PhysicsWorld.h"
+#include "Events/Event.h"
+#include "Events/EventQueue.h"
+#include "Events/EventDispatcher.h"
 
 #include "Core/EntryPoint.h"
 
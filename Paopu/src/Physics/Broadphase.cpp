@@ -0,0 +1,491 @@
+#include "Broadphase.h"
+
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PAO_BROADPHASE_SSE
+#endif
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+namespace Paopu {
+
+    // Sorted arrays run this far past the last collider, see `sweep`
+    static const uint32_t k_sweep_padding = 4;
+    // The incremental sort gives up past this many moves per collider
+    static const uint64_t k_max_sort_moves_per_collider = 16;
+    // Spread the sweep axis has to lose against the other one before it's
+    // switched, so it doesn't flip back and forth
+    static const double k_axis_switch_ratio = 2.0;
+    // Keeps cell coordinates of far away or degenerate bounds in range
+    static const float k_max_cell = 1.0e9f;
+
+    static inline uint32_t count_trailing_zeros(uint32_t mask) {
+    #ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<uint32_t>(index);
+    #else
+        return static_cast<uint32_t>(__builtin_ctz(mask));
+    #endif
+    }
+
+    static inline ColliderPair make_pair(ColliderHandle a, ColliderHandle b) {
+        return a < b ? ColliderPair{a, b} : ColliderPair{b, a};
+    }
+
+    void Broadphase::set_settings(const BroadphaseSettings& new_settings) {
+        if(new_settings.cell_size <= 0.0f) {
+            throw std::runtime_error("[Physics][Broadphase]: Cell size has to be positive!");
+        }
+        if(new_settings.cell_size != settings.cell_size) {
+            grid_valid = false;
+        }
+        settings = new_settings;
+    }
+
+    ColliderHandle Broadphase::create(const Aabb2D& bounds) {
+        ColliderHandle handle;
+        if(!free_handles.empty()) {
+            handle = free_handles.back();
+            free_handles.pop_back();
+        } else {
+            handle = static_cast<ColliderHandle>(alive.size());
+            min_x.push_back(0.0f);
+            min_y.push_back(0.0f);
+            max_x.push_back(0.0f);
+            max_y.push_back(0.0f);
+            alive.push_back(0);
+            ordered.push_back(0);
+            cell_min_x.push_back(0);
+            cell_min_y.push_back(0);
+            cell_max_x.push_back(-1);
+            cell_max_y.push_back(-1);
+        }
+
+        alive[handle] = 1;
+        // A handle destroyed and reused before the next update is still in `order`
+        if(!ordered[handle]) {
+            ordered[handle] = 1;
+            created.push_back(handle);
+        }
+        set_bounds(handle, bounds);
+
+        collider_count++;
+        grid_valid = false;
+        return handle;
+    }
+
+    void Broadphase::destroy(ColliderHandle handle) {
+        if(handle >= alive.size() || !alive[handle]) {
+            throw std::runtime_error("[Physics][Broadphase]: Destroyed a collider that doesn't exist!");
+        }
+
+        alive[handle] = 0;
+        free_handles.push_back(handle);
+        collider_count--;
+        destroyed_any = true;
+        grid_valid = false;
+    }
+
+    void Broadphase::set_bounds(ColliderHandle handle, const Aabb2D& bounds) {
+        min_x[handle] = bounds.min.x;
+        min_y[handle] = bounds.min.y;
+        max_x[handle] = bounds.max.x;
+        max_y[handle] = bounds.max.y;
+    }
+
+    Aabb2D Broadphase::get_bounds(ColliderHandle handle) const {
+        return Aabb2D{{min_x[handle], min_y[handle]}, {max_x[handle], max_y[handle]}};
+    }
+
+    void Broadphase::update() {
+        PAO_PROFILE_FUNCTION();
+
+        stats = BroadphaseStats{};
+        stats.collider_count = collider_count;
+
+        refresh_order();
+
+        if(settings.method == BroadphaseMethod::SweepAndPrune) {
+            sort_bounds();
+            find_pairs(sorted_count, [](const Broadphase* broadphase, uint32_t begin, uint32_t end, std::vector<ColliderPair>& out) {
+                broadphase->sweep(begin, end, out);
+            });
+        } else {
+            build_grid();
+            find_pairs(bucket_count, [](const Broadphase* broadphase, uint32_t begin, uint32_t end, std::vector<ColliderPair>& out) {
+                broadphase->collide_buckets(begin, end, out);
+            });
+        }
+
+        stats.pair_count = static_cast<uint32_t>(pairs.size());
+    }
+
+    void Broadphase::refresh_order() {
+        if(destroyed_any) {
+            uint32_t kept = 0;
+            for(uint32_t i = 0; i < order.size(); i++) {
+                ColliderHandle handle = order[i];
+                if(alive[handle]) {
+                    order[kept] = order[i];
+                    sort_keys[kept] = sort_keys[i];
+                    kept++;
+                } else {
+                    ordered[handle] = 0;
+                }
+            }
+            order.resize(kept);
+            sort_keys.resize(kept);
+            destroyed_any = false;
+        }
+
+        for(ColliderHandle handle : created) {
+            if(alive[handle]) {
+                order.push_back(handle);
+                sort_keys.push_back(0.0f);
+            } else {
+                // Created and destroyed again before ever being swept
+                ordered[handle] = 0;
+            }
+        }
+        created.clear();
+    }
+
+    void Broadphase::sort_bounds() {
+        uint32_t count = static_cast<uint32_t>(order.size());
+
+        // Sweep along the axis the colliders are spread out the most on, so the
+        // fewest of them overlap on it
+        double sum[2] = {0.0, 0.0};
+        double sum_squared[2] = {0.0, 0.0};
+        for(uint32_t i = 0; i < count; i++) {
+            ColliderHandle handle = order[i];
+            double center_x = 0.5 * (static_cast<double>(min_x[handle]) + max_x[handle]);
+            double center_y = 0.5 * (static_cast<double>(min_y[handle]) + max_y[handle]);
+            sum[0] += center_x;
+            sum[1] += center_y;
+            sum_squared[0] += center_x * center_x;
+            sum_squared[1] += center_y * center_y;
+        }
+
+        bool full_sort = false;
+        if(count > 0) {
+            double variance[2];
+            for(uint32_t axis = 0; axis < 2; axis++) {
+                double mean = sum[axis] / count;
+                variance[axis] = sum_squared[axis] / count - mean * mean;
+            }
+            uint32_t other_axis = 1 - sweep_axis;
+            if(variance[other_axis] > variance[sweep_axis] * k_axis_switch_ratio) {
+                sweep_axis = other_axis;
+                full_sort = true;
+            }
+        }
+
+        const float* min_sweep = sweep_axis == 0 ? min_x.data() : min_y.data();
+        const float* max_sweep = sweep_axis == 0 ? max_x.data() : max_y.data();
+        const float* min_other = sweep_axis == 0 ? min_y.data() : min_x.data();
+        const float* max_other = sweep_axis == 0 ? max_y.data() : max_x.data();
+
+        for(uint32_t i = 0; i < count; i++) {
+            sort_keys[i] = min_sweep[order[i]];
+        }
+
+        // Last frame's order is nearly sorted still, so insertion sort is close
+        // to linear. Teleports and new colliders can make it quadratic, which
+        // is when it bails out to a full sort.
+        uint64_t moves = 0;
+        uint64_t max_moves = static_cast<uint64_t>(count) * k_max_sort_moves_per_collider;
+        for(uint32_t i = 1; i < count && !full_sort; i++) {
+            float key = sort_keys[i];
+            ColliderHandle handle = order[i];
+            uint32_t j = i;
+            while(j > 0 && sort_keys[j - 1] > key) {
+                sort_keys[j] = sort_keys[j - 1];
+                order[j] = order[j - 1];
+                j--;
+            }
+            sort_keys[j] = key;
+            order[j] = handle;
+
+            moves += i - j;
+            full_sort = moves > max_moves;
+        }
+
+        if(full_sort) {
+            std::sort(order.begin(), order.end(), [min_sweep](ColliderHandle a, ColliderHandle b) {
+                return min_sweep[a] < min_sweep[b] || (min_sweep[a] == min_sweep[b] && a < b);
+            });
+            for(uint32_t i = 0; i < count; i++) {
+                sort_keys[i] = min_sweep[order[i]];
+            }
+        }
+        stats.sort_moves = moves;
+        stats.full_sort = full_sort;
+
+        // Padding never overlaps anything, so the sweep stops on it
+        const float infinity = std::numeric_limits<float>::infinity();
+        sorted_min_sweep.resize(count + k_sweep_padding);
+        sorted_max_sweep.resize(count + k_sweep_padding);
+        sorted_min_other.resize(count + k_sweep_padding);
+        sorted_max_other.resize(count + k_sweep_padding);
+        sorted_handles.resize(count + k_sweep_padding);
+
+        for(uint32_t i = 0; i < count; i++) {
+            ColliderHandle handle = order[i];
+            sorted_min_sweep[i] = min_sweep[handle];
+            sorted_max_sweep[i] = max_sweep[handle];
+            sorted_min_other[i] = min_other[handle];
+            sorted_max_other[i] = max_other[handle];
+            sorted_handles[i] = handle;
+        }
+        for(uint32_t i = count; i < count + k_sweep_padding; i++) {
+            sorted_min_sweep[i] = infinity;
+            sorted_max_sweep[i] = -infinity;
+            sorted_min_other[i] = infinity;
+            sorted_max_other[i] = -infinity;
+            sorted_handles[i] = k_no_collider;
+        }
+        sorted_count = count;
+    }
+
+    void Broadphase::sweep(uint32_t begin, uint32_t end, std::vector<ColliderPair>& out) const {
+        const float* min_sweep = sorted_min_sweep.data();
+        const float* min_other = sorted_min_other.data();
+        const float* max_other = sorted_max_other.data();
+        const ColliderHandle* handles = sorted_handles.data();
+
+        for(uint32_t i = begin; i < end; i++) {
+            float limit = sorted_max_sweep[i];
+            float other_min = min_other[i];
+            float other_max = max_other[i];
+            ColliderHandle handle = handles[i];
+            uint32_t j = i + 1;
+
+        #ifdef PAO_BROADPHASE_SSE
+            // Everything after `i` starts at or after it on the sweep axis, so
+            // the candidates are exactly those starting before `limit`. Once a
+            // lane starts past it, so do all lanes after it.
+            __m128 limit4 = _mm_set1_ps(limit);
+            __m128 other_min4 = _mm_set1_ps(other_min);
+            __m128 other_max4 = _mm_set1_ps(other_max);
+            while(true) {
+                __m128 in_range = _mm_cmple_ps(_mm_loadu_ps(min_sweep + j), limit4);
+                uint32_t range_mask = static_cast<uint32_t>(_mm_movemask_ps(in_range));
+                if(range_mask == 0) break;
+
+                __m128 overlap = _mm_and_ps(in_range, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(min_other + j), other_max4),
+                                                                 _mm_cmpge_ps(_mm_loadu_ps(max_other + j), other_min4)));
+                uint32_t overlap_mask = static_cast<uint32_t>(_mm_movemask_ps(overlap));
+                while(overlap_mask != 0) {
+                    uint32_t lane = count_trailing_zeros(overlap_mask);
+                    out.push_back(make_pair(handle, handles[j + lane]));
+                    overlap_mask &= overlap_mask - 1;
+                }
+
+                if(range_mask != 0xF) break;
+                j += 4;
+            }
+        #else
+            for(; min_sweep[j] <= limit; j++) {
+                if(min_other[j] <= other_max && max_other[j] >= other_min) {
+                    out.push_back(make_pair(handle, handles[j]));
+                }
+            }
+        #endif
+        }
+    }
+
+    inline int32_t Broadphase::get_cell(float coordinate) const {
+        float cell = std::floor(coordinate / settings.cell_size);
+        return static_cast<int32_t>(std::max(-k_max_cell, std::min(k_max_cell, cell)));
+    }
+
+    inline uint32_t Broadphase::get_bucket(int32_t x, int32_t y) const {
+        uint32_t hash = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+        return hash & (bucket_count - 1);
+    }
+
+    void Broadphase::build_grid() {
+        // Moving inside the same cells keeps the buckets as they are
+        bool changed = !grid_valid;
+        uint64_t entry_count = 0;
+        for(ColliderHandle handle : order) {
+            int32_t x0 = get_cell(min_x[handle]);
+            int32_t y0 = get_cell(min_y[handle]);
+            int32_t x1 = get_cell(max_x[handle]);
+            int32_t y1 = get_cell(max_y[handle]);
+
+            if(x0 != cell_min_x[handle] || y0 != cell_min_y[handle] || x1 != cell_max_x[handle] || y1 != cell_max_y[handle]) {
+                cell_min_x[handle] = x0;
+                cell_min_y[handle] = y0;
+                cell_max_x[handle] = x1;
+                cell_max_y[handle] = y1;
+                changed = true;
+            }
+            entry_count += static_cast<uint64_t>(x1 - x0 + 1) * static_cast<uint64_t>(y1 - y0 + 1);
+        }
+
+        if(!changed) return;
+        if(entry_count > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("[Physics][Broadphase]: Colliders cover too many cells, raise the cell size!");
+        }
+        stats.grid_rebuilt = true;
+
+        // About one cell per bucket
+        bucket_count = 16;
+        while(bucket_count < entry_count) {
+            bucket_count *= 2;
+        }
+
+        // Counting sort by bucket: count, turn into bucket ends, then fill each
+        // bucket back to front so its end becomes its start
+        bucket_starts.assign(bucket_count + 1, 0);
+        for(ColliderHandle handle : order) {
+            for(int32_t y = cell_min_y[handle]; y <= cell_max_y[handle]; y++) {
+                for(int32_t x = cell_min_x[handle]; x <= cell_max_x[handle]; x++) {
+                    bucket_starts[get_bucket(x, y)]++;
+                }
+            }
+        }
+        uint32_t total = 0;
+        for(uint32_t bucket = 0; bucket < bucket_count; bucket++) {
+            total += bucket_starts[bucket];
+            bucket_starts[bucket] = total;
+        }
+        bucket_starts[bucket_count] = total;
+
+        cell_entries.resize(total);
+        for(ColliderHandle handle : order) {
+            for(int32_t y = cell_min_y[handle]; y <= cell_max_y[handle]; y++) {
+                for(int32_t x = cell_min_x[handle]; x <= cell_max_x[handle]; x++) {
+                    cell_entries[--bucket_starts[get_bucket(x, y)]] = CellEntry{x, y, handle};
+                }
+            }
+        }
+        grid_valid = true;
+    }
+
+    void Broadphase::collide_buckets(uint32_t begin, uint32_t end, std::vector<ColliderPair>& out) const {
+        for(uint32_t bucket = begin; bucket < end; bucket++) {
+            uint32_t first = bucket_starts[bucket];
+            uint32_t last = bucket_starts[bucket + 1];
+
+            for(uint32_t i = first; i < last; i++) {
+                const CellEntry& entry = cell_entries[i];
+                ColliderHandle a = entry.handle;
+
+                for(uint32_t j = i + 1; j < last; j++) {
+                    const CellEntry& other = cell_entries[j];
+                    // Different cells can share a bucket
+                    if(other.x != entry.x || other.y != entry.y) continue;
+
+                    ColliderHandle b = other.handle;
+                    if(min_x[b] > max_x[a] || max_x[b] < min_x[a] || min_y[b] > max_y[a] || max_y[b] < min_y[a]) continue;
+
+                    // Colliders sharing several cells are only reported by the one
+                    // holding the corner where their overlap starts
+                    if(get_cell(std::max(min_x[a], min_x[b])) != entry.x || get_cell(std::max(min_y[a], min_y[b])) != entry.y) continue;
+
+                    out.push_back(make_pair(a, b));
+                }
+            }
+        }
+    }
+
+    void Broadphase::find_pairs(uint32_t count, void (*find)(const Broadphase* broadphase, uint32_t begin, uint32_t end, std::vector<ColliderPair>& out)) {
+        uint32_t chunk_count = 1;
+        uint32_t worker_count = JobSystem::get_worker_count();
+        if(worker_count > 1) {
+            uint32_t per_job = std::max(settings.min_colliders_per_job, 1u);
+            chunk_count = std::max(1u, std::min(collider_count / per_job, worker_count * 4));
+        }
+        stats.jobs = chunk_count;
+
+        if(chunk_pairs.size() < chunk_count) {
+            chunk_pairs.resize(chunk_count);
+        }
+
+        if(chunk_count == 1) {
+            chunk_pairs[0].clear();
+            find(this, 0, count, chunk_pairs[0]);
+        } else {
+            std::vector<ColliderPair>* outputs = chunk_pairs.data();
+            JobSystem::parallel_for(chunk_count, [this, find, count, chunk_count, outputs](uint32_t begin, uint32_t end) {
+                for(uint32_t chunk = begin; chunk < end; chunk++) {
+                    uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(count) * chunk / chunk_count);
+                    uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(count) * (chunk + 1) / chunk_count);
+                    outputs[chunk].clear();
+                    find(this, first, last, outputs[chunk]);
+                }
+            });
+        }
+
+        // Packed in chunk order, so the result doesn't depend on scheduling
+        size_t total = 0;
+        for(uint32_t chunk = 0; chunk < chunk_count; chunk++) {
+            total += chunk_pairs[chunk].size();
+        }
+        pairs.resize(total);
+
+        size_t offset = 0;
+        for(uint32_t chunk = 0; chunk < chunk_count; chunk++) {
+            const std::vector<ColliderPair>& chunk_output = chunk_pairs[chunk];
+            if(!chunk_output.empty()) {
+                memcpy(pairs.data() + offset, chunk_output.data(), chunk_output.size() * sizeof(ColliderPair));
+            }
+            offset += chunk_output.size();
+        }
+    }
+
+    void Broadphase::query(const Aabb2D& bounds, std::vector<ColliderHandle>& colliders) const {
+        if(settings.method == BroadphaseMethod::SweepAndPrune) {
+            float sweep_min = sweep_axis == 0 ? bounds.min.x : bounds.min.y;
+            float sweep_max = sweep_axis == 0 ? bounds.max.x : bounds.max.y;
+            float other_min = sweep_axis == 0 ? bounds.min.y : bounds.min.x;
+            float other_max = sweep_axis == 0 ? bounds.max.y : bounds.max.x;
+
+            for(uint32_t i = 0; i < sorted_count && sorted_min_sweep[i] <= sweep_max; i++) {
+                if(sorted_max_sweep[i] >= sweep_min && sorted_min_other[i] <= other_max && sorted_max_other[i] >= other_min) {
+                    colliders.push_back(sorted_handles[i]);
+                }
+            }
+            return;
+        }
+
+        if(!grid_valid) return;
+
+        int32_t x0 = get_cell(bounds.min.x);
+        int32_t y0 = get_cell(bounds.min.y);
+        int32_t x1 = get_cell(bounds.max.x);
+        int32_t y1 = get_cell(bounds.max.y);
+        for(int32_t y = y0; y <= y1; y++) {
+            for(int32_t x = x0; x <= x1; x++) {
+                uint32_t bucket = get_bucket(x, y);
+                for(uint32_t i = bucket_starts[bucket]; i < bucket_starts[bucket + 1]; i++) {
+                    const CellEntry& entry = cell_entries[i];
+                    if(entry.x != x || entry.y != y) continue;
+
+                    ColliderHandle handle = entry.handle;
+                    if(!alive[handle] || min_x[handle] > bounds.max.x || max_x[handle] < bounds.min.x || min_y[handle] > bounds.max.y || max_y[handle] < bounds.min.y) continue;
+
+                    // Same trick as `collide_buckets`: only the cell where the overlap starts reports it
+                    if(get_cell(std::max(min_x[handle], bounds.min.x)) != x || get_cell(std::max(min_y[handle], bounds.min.y)) != y) continue;
+                    colliders.push_back(handle);
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    /// Axis aligned box, `min` and `max` inclusive
+    ///
+    ///
+    struct PAOPU_API Aabb2D {
+        glm::vec2 min{0.0f, 0.0f};
+        glm::vec2 max{0.0f, 0.0f};
+    };
+
+    using ColliderHandle = uint32_t;
+
+    static const ColliderHandle k_no_collider = ~0u;
+
+    /// Two colliders whose bounds overlap, `a < b`
+    ///
+    ///
+    struct PAOPU_API ColliderPair {
+        ColliderHandle a;
+        ColliderHandle b;
+    };
+
+    /// `SweepAndPrune`: Sorts bounds along the axis they are most spread out
+    ///     on and sweeps. Handles any mix of sizes and clustering.
+    /// `SpatialHash`: Buckets bounds into a uniform grid of `cell_size`. Faster
+    ///     for dense scenes of similarly sized colliders.
+    enum class BroadphaseMethod : uint8_t {
+        SweepAndPrune = 0,
+        SpatialHash = 1
+    };
+
+    /// `cell_size`: Grid cell edge for SpatialHash, around the size of a
+    ///     typical collider
+    /// `min_colliders_per_job`: Below this many colliders per job, pairs are
+    ///     found on the calling thread
+    struct PAOPU_API BroadphaseSettings {
+        BroadphaseMethod method{BroadphaseMethod::SweepAndPrune};
+        float cell_size{64.0f};
+        uint32_t min_colliders_per_job{2048};
+    };
+
+    /// What the last `update` did
+    ///
+    /// `sort_moves`: Elements the incremental sort shifted, low while the
+    ///     scene is coherent from frame to frame
+    /// `full_sort`: Whether it gave up on that and sorted from scratch
+    /// `grid_rebuilt`: Whether any collider changed cells
+    struct PAOPU_API BroadphaseStats {
+        uint32_t collider_count{0};
+        uint32_t pair_count{0};
+        uint64_t sort_moves{0};
+        bool full_sort{false};
+        bool grid_rebuilt{false};
+        uint32_t jobs{0};
+    };
+
+    /// Finds every pair of overlapping collider bounds, for tens of thousands
+    /// of moving colliders.
+    ///
+    /// Bounds live in SoA arrays. Sweep and prune keeps its order between
+    /// updates and repairs it with an insertion sort, which is close to linear
+    /// while colliders only move a little each frame, and tests four
+    /// candidates at a time with SSE. The spatial hash only re-buckets when a
+    /// collider crossed into another cell. Either way pairs are found on the
+    /// job system in chunks that write into buffers of their own, which are
+    /// then packed into one flat array; after warming up, an update allocates
+    /// nothing.
+    ///
+    /// Pairs come out in the same order for the same inputs, regardless of
+    /// the number of workers.
+    class PAOPU_API Broadphase {
+
+        public:
+            void set_settings(const BroadphaseSettings& settings);
+            inline const BroadphaseSettings& get_settings() const { return settings; }
+
+            ColliderHandle create(const Aabb2D& bounds);
+            void destroy(ColliderHandle handle);
+
+            void set_bounds(ColliderHandle handle, const Aabb2D& bounds);
+            Aabb2D get_bounds(ColliderHandle handle) const;
+
+            /// Finds the overlapping pairs of the current bounds, see `get_pairs`
+            ///
+            ///
+            void update();
+
+            /// Pairs found by the last `update`
+            ///
+            ///
+            inline const std::vector<ColliderPair>& get_pairs() const { return pairs; }
+            inline const BroadphaseStats& get_stats() const { return stats; }
+            inline uint32_t get_collider_count() const { return collider_count; }
+
+            /// Appends every collider whose bounds overlap `bounds` to `colliders`.
+            /// Sees the colliders as they were at the last `update`, so changes
+            /// since then only show up after the next one.
+            ///
+            void query(const Aabb2D& bounds, std::vector<ColliderHandle>& colliders) const;
+
+        private:
+            /// One grid cell a collider touches, bucketed by the cell's hash
+            struct CellEntry {
+                int32_t x;
+                int32_t y;
+                ColliderHandle handle;
+            };
+
+            /// Drops destroyed colliders from `order` and appends created ones
+            void refresh_order();
+
+            /// Picks the sweep axis, repairs the order and gathers the sorted bounds
+            void sort_bounds();
+
+            /// Pairs whose first collider is in sorted positions [begin, end)
+            void sweep(uint32_t begin, uint32_t end, std::vector<ColliderPair>& out) const;
+
+            /// Re-buckets the grid if any collider changed cells
+            void build_grid();
+
+            /// Pairs found in hash buckets [begin, end)
+            void collide_buckets(uint32_t begin, uint32_t end, std::vector<ColliderPair>& out) const;
+
+            /// Splits `count` items into chunks, runs `find` on each (in parallel
+            /// when worth it) and packs the chunks' pairs into `pairs`
+            void find_pairs(uint32_t count, void (*find)(const Broadphase* broadphase, uint32_t begin, uint32_t end, std::vector<ColliderPair>& out));
+
+            inline int32_t get_cell(float coordinate) const;
+            inline uint32_t get_bucket(int32_t x, int32_t y) const;
+
+        private:
+            BroadphaseSettings settings;
+
+            // Indexed by handle, destroyed colliders leave holes
+            std::vector<float> min_x;
+            std::vector<float> min_y;
+            std::vector<float> max_x;
+            std::vector<float> max_y;
+            std::vector<uint8_t> alive;
+            // Whether the handle is in `order`; it stays there for a while after
+            // being destroyed
+            std::vector<uint8_t> ordered;
+            std::vector<ColliderHandle> free_handles;
+            std::vector<ColliderHandle> created;
+            uint32_t collider_count{0};
+            bool destroyed_any{false};
+
+            // Live colliders, sorted by `sort_keys` for sweep and prune
+            std::vector<ColliderHandle> order;
+            std::vector<float> sort_keys;
+            // 0 sweeps along x, 1 along y
+            uint32_t sweep_axis{0};
+
+            // Bounds gathered in sweep order, the sweep axis first. Padded so
+            // SSE loads can run past the end.
+            std::vector<float> sorted_min_sweep;
+            std::vector<float> sorted_max_sweep;
+            std::vector<float> sorted_min_other;
+            std::vector<float> sorted_max_other;
+            std::vector<ColliderHandle> sorted_handles;
+            uint32_t sorted_count{0};
+
+            // Cells each collider covered at the last grid build, indexed by handle
+            std::vector<int32_t> cell_min_x;
+            std::vector<int32_t> cell_min_y;
+            std::vector<int32_t> cell_max_x;
+            std::vector<int32_t> cell_max_y;
+            std::vector<CellEntry> cell_entries;
+            // `bucket_count + 1` offsets into `cell_entries`
+            std::vector<uint32_t> bucket_starts;
+            uint32_t bucket_count{0};
+            bool grid_valid{false};
+
+            std::vector<std::vector<ColliderPair>> chunk_pairs;
+            std::vector<ColliderPair> pairs;
+            BroadphaseStats stats;
+    };
+
+}
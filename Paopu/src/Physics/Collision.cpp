@@ -0,0 +1,273 @@
+#include "Collision.h"
+
+#include <cmath>
+
+namespace Paopu {
+
+    enum class BoxAxis : uint8_t {
+        FaceAX,
+        FaceAY,
+        FaceBX,
+        FaceBY
+    };
+
+    // A point of the incident edge while it's clipped, `id` names the
+    // incident box's corner it came from
+    struct ClipVertex {
+        glm::vec2 point;
+        uint32_t id;
+    };
+
+    static inline glm::vec2 rotate(glm::vec2 rotation, glm::vec2 v) {
+        return {rotation.x * v.x - rotation.y * v.y, rotation.y * v.x + rotation.x * v.y};
+    }
+
+    static inline glm::vec2 inverse_rotate(glm::vec2 rotation, glm::vec2 v) {
+        return {rotation.x * v.x + rotation.y * v.y, rotation.x * v.y - rotation.y * v.x};
+    }
+
+    static inline void add_point(ContactManifold& manifold, glm::vec2 point, const Pose2D& pose_a, const Pose2D& pose_b, float separation, uint32_t id) {
+        ContactPoint& contact = manifold.points[manifold.point_count++];
+        contact.anchor_a = point - pose_a.position;
+        contact.anchor_b = point - pose_b.position;
+        contact.separation = separation;
+        contact.normal_impulse = 0.0f;
+        contact.tangent_impulse = 0.0f;
+        contact.id = id;
+    }
+
+    /// The edge of the incident box most anti-parallel to the reference face's
+    /// `normal`. Corners are numbered counter-clockwise from (+x, -y).
+    static void find_incident_edge(ClipVertex edge[2], glm::vec2 half_extents, const Pose2D& pose, glm::vec2 normal) {
+        const glm::vec2 corners[4] = {{1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}, {-1.0f, -1.0f}};
+
+        // The edge starting at corner i faces +x, +y, -x, -y in that order
+        glm::vec2 local = -inverse_rotate(pose.rotation, normal);
+        uint32_t first;
+        if(std::fabs(local.x) > std::fabs(local.y)) {
+            first = local.x >= 0.0f ? 0 : 2;
+        } else {
+            first = local.y >= 0.0f ? 1 : 3;
+        }
+
+        for(uint32_t i = 0; i < 2; i++) {
+            uint32_t corner = (first + i) % 4;
+            edge[i].point = pose.position + rotate(pose.rotation, corners[corner] * half_extents);
+            edge[i].id = corner;
+        }
+    }
+
+    /// Keeps the part of the segment behind the plane `dot(normal, p) = offset`
+    static uint32_t clip_segment(ClipVertex out[2], const ClipVertex in[2], glm::vec2 normal, float offset) {
+        uint32_t count = 0;
+        float distance0 = glm::dot(normal, in[0].point) - offset;
+        float distance1 = glm::dot(normal, in[1].point) - offset;
+
+        if(distance0 <= 0.0f) out[count++] = in[0];
+        if(distance1 <= 0.0f) out[count++] = in[1];
+
+        if(distance0 * distance1 < 0.0f) {
+            // The cut point stands in for the corner that was cut off, so a
+            // point keeps its id whether or not it's clipped this step
+            float t = distance0 / (distance0 - distance1);
+            out[count].point = in[0].point + t * (in[1].point - in[0].point);
+            out[count].id = distance0 > 0.0f ? in[0].id : in[1].id;
+            count++;
+        }
+        return count;
+    }
+
+    /// Separating axis test over the four face normals, then the incident
+    /// edge is clipped against the reference face's sides
+    static void collide_boxes(const Shape2D& shape_a, const Pose2D& pose_a, const Shape2D& shape_b, const Pose2D& pose_b, float margin, ContactManifold& manifold) {
+        glm::vec2 ha = shape_a.half_extents;
+        glm::vec2 hb = shape_b.half_extents;
+        glm::vec2 axis_ax = pose_a.rotation;
+        glm::vec2 axis_ay = {-pose_a.rotation.y, pose_a.rotation.x};
+        glm::vec2 axis_bx = pose_b.rotation;
+        glm::vec2 axis_by = {-pose_b.rotation.y, pose_b.rotation.x};
+
+        glm::vec2 offset = pose_b.position - pose_a.position;
+        glm::vec2 offset_a = inverse_rotate(pose_a.rotation, offset);
+        glm::vec2 offset_b = inverse_rotate(pose_b.rotation, offset);
+
+        // B's axes in A's frame, |C| projects one box's extents onto the other's axes
+        float c11 = std::fabs(glm::dot(axis_ax, axis_bx));
+        float c12 = std::fabs(glm::dot(axis_ax, axis_by));
+        float c21 = std::fabs(glm::dot(axis_ay, axis_bx));
+        float c22 = std::fabs(glm::dot(axis_ay, axis_by));
+
+        float face_ax = std::fabs(offset_a.x) - ha.x - (c11 * hb.x + c12 * hb.y);
+        float face_ay = std::fabs(offset_a.y) - ha.y - (c21 * hb.x + c22 * hb.y);
+        if(face_ax > margin || face_ay > margin) return;
+
+        float face_bx = std::fabs(offset_b.x) - (c11 * ha.x + c21 * ha.y) - hb.x;
+        float face_by = std::fabs(offset_b.y) - (c12 * ha.x + c22 * ha.y) - hb.y;
+        if(face_bx > margin || face_by > margin) return;
+
+        // Prefer A's faces and the x axes unless another is clearly better, so
+        // the reference face doesn't flip between steps on near ties
+        const float relative_tolerance = 0.95f;
+        const float absolute_tolerance = 0.01f;
+
+        BoxAxis axis = BoxAxis::FaceAX;
+        float separation = face_ax;
+        glm::vec2 normal = offset_a.x > 0.0f ? axis_ax : -axis_ax;
+
+        if(face_ay > relative_tolerance * separation + absolute_tolerance * ha.y) {
+            axis = BoxAxis::FaceAY;
+            separation = face_ay;
+            normal = offset_a.y > 0.0f ? axis_ay : -axis_ay;
+        }
+        if(face_bx > relative_tolerance * separation + absolute_tolerance * hb.x) {
+            axis = BoxAxis::FaceBX;
+            separation = face_bx;
+            normal = offset_b.x > 0.0f ? axis_bx : -axis_bx;
+        }
+        if(face_by > relative_tolerance * separation + absolute_tolerance * hb.y) {
+            axis = BoxAxis::FaceBY;
+            separation = face_by;
+            normal = offset_b.y > 0.0f ? axis_by : -axis_by;
+        }
+
+        glm::vec2 front_normal;
+        glm::vec2 side_normal;
+        float front;
+        float negative_side;
+        float positive_side;
+        ClipVertex incident[2];
+
+        switch(axis) {
+            case BoxAxis::FaceAX: {
+                front_normal = normal;
+                front = glm::dot(pose_a.position, front_normal) + ha.x;
+                side_normal = axis_ay;
+                float side = glm::dot(pose_a.position, side_normal);
+                negative_side = -side + ha.y;
+                positive_side = side + ha.y;
+                find_incident_edge(incident, hb, pose_b, front_normal);
+            } break;
+            case BoxAxis::FaceAY: {
+                front_normal = normal;
+                front = glm::dot(pose_a.position, front_normal) + ha.y;
+                side_normal = axis_ax;
+                float side = glm::dot(pose_a.position, side_normal);
+                negative_side = -side + ha.x;
+                positive_side = side + ha.x;
+                find_incident_edge(incident, hb, pose_b, front_normal);
+            } break;
+            case BoxAxis::FaceBX: {
+                front_normal = -normal;
+                front = glm::dot(pose_b.position, front_normal) + hb.x;
+                side_normal = axis_by;
+                float side = glm::dot(pose_b.position, side_normal);
+                negative_side = -side + hb.y;
+                positive_side = side + hb.y;
+                find_incident_edge(incident, ha, pose_a, front_normal);
+            } break;
+            default: {
+                front_normal = -normal;
+                front = glm::dot(pose_b.position, front_normal) + hb.y;
+                side_normal = axis_bx;
+                float side = glm::dot(pose_b.position, side_normal);
+                negative_side = -side + hb.x;
+                positive_side = side + hb.x;
+                find_incident_edge(incident, ha, pose_a, front_normal);
+            } break;
+        }
+
+        ClipVertex clipped1[2];
+        ClipVertex clipped2[2];
+        if(clip_segment(clipped1, incident, -side_normal, negative_side) < 2) return;
+        if(clip_segment(clipped2, clipped1, side_normal, positive_side) < 2) return;
+
+        // The reference face and the incident corner name a point
+        const glm::vec2 reference_axes[4] = {axis_ax, axis_ay, axis_bx, axis_by};
+        uint32_t face = static_cast<uint32_t>(axis) * 2 + (glm::dot(front_normal, reference_axes[static_cast<uint32_t>(axis)]) >= 0.0f ? 0 : 1);
+        manifold.normal = normal;
+        for(uint32_t i = 0; i < 2; i++) {
+            float point_separation = glm::dot(front_normal, clipped2[i].point) - front;
+            if(point_separation <= margin) {
+                // Onto the reference face, the middle of the overlap would do as well
+                glm::vec2 point = clipped2[i].point - point_separation * front_normal;
+                add_point(manifold, point, pose_a, pose_b, point_separation, (face << 8) | clipped2[i].id);
+            }
+        }
+    }
+
+    static void collide_box_circle(const Shape2D& box, const Pose2D& pose_a, const Shape2D& circle, const Pose2D& pose_b, float margin, ContactManifold& manifold) {
+        glm::vec2 h = box.half_extents;
+        glm::vec2 center = inverse_rotate(pose_a.rotation, pose_b.position - pose_a.position);
+        glm::vec2 closest = glm::clamp(center, -h, h);
+
+        glm::vec2 local_normal;
+        float separation;
+        if(closest == center) {
+            // Center inside the box, push out through the nearest face
+            float depth_x = h.x - std::fabs(center.x);
+            float depth_y = h.y - std::fabs(center.y);
+            if(depth_x < depth_y) {
+                local_normal = {center.x < 0.0f ? -1.0f : 1.0f, 0.0f};
+                closest.x = local_normal.x * h.x;
+                separation = -depth_x - circle.radius;
+            } else {
+                local_normal = {0.0f, center.y < 0.0f ? -1.0f : 1.0f};
+                closest.y = local_normal.y * h.y;
+                separation = -depth_y - circle.radius;
+            }
+        } else {
+            glm::vec2 delta = center - closest;
+            float distance_squared = glm::dot(delta, delta);
+            float reach = circle.radius + margin;
+            if(distance_squared > reach * reach) return;
+
+            float distance = std::sqrt(distance_squared);
+            local_normal = delta / distance;
+            separation = distance - circle.radius;
+        }
+
+        manifold.normal = rotate(pose_a.rotation, local_normal);
+        glm::vec2 surface = pose_a.position + rotate(pose_a.rotation, closest);
+        add_point(manifold, surface + 0.5f * separation * manifold.normal, pose_a, pose_b, separation, 0);
+    }
+
+    static void collide_circles(const Shape2D& shape_a, const Pose2D& pose_a, const Shape2D& shape_b, const Pose2D& pose_b, float margin, ContactManifold& manifold) {
+        glm::vec2 delta = pose_b.position - pose_a.position;
+        float radius = shape_a.radius + shape_b.radius;
+        float distance_squared = glm::dot(delta, delta);
+        float reach = radius + margin;
+        if(distance_squared > reach * reach) return;
+
+        float distance = std::sqrt(distance_squared);
+        manifold.normal = distance > 1.0e-6f ? delta / distance : glm::vec2{0.0f, 1.0f};
+        float separation = distance - radius;
+        glm::vec2 point = pose_a.position + manifold.normal * (shape_a.radius + 0.5f * separation);
+        add_point(manifold, point, pose_a, pose_b, separation, 0);
+    }
+
+    void collide(const Shape2D& shape_a, const Pose2D& pose_a, const Shape2D& shape_b, const Pose2D& pose_b, float margin, ContactManifold& manifold) {
+        manifold.point_count = 0;
+        if(shape_a.type == ShapeType::Box) {
+            if(shape_b.type == ShapeType::Box) {
+                collide_boxes(shape_a, pose_a, shape_b, pose_b, margin, manifold);
+            } else {
+                collide_box_circle(shape_a, pose_a, shape_b, pose_b, margin, manifold);
+            }
+        } else {
+            collide_circles(shape_a, pose_a, shape_b, pose_b, margin, manifold);
+        }
+    }
+
+    Aabb2D compute_bounds(const Shape2D& shape, const Pose2D& pose) {
+        glm::vec2 extent;
+        if(shape.type == ShapeType::Box) {
+            float c = std::fabs(pose.rotation.x);
+            float s = std::fabs(pose.rotation.y);
+            extent = {c * shape.half_extents.x + s * shape.half_extents.y, s * shape.half_extents.x + c * shape.half_extents.y};
+        } else {
+            extent = {shape.radius, shape.radius};
+        }
+        return Aabb2D{pose.position - extent, pose.position + extent};
+    }
+
+}
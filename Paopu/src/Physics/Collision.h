@@ -0,0 +1,76 @@
+#pragma once
+#include "../Core/Core.h"
+#include "Broadphase.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace Paopu {
+
+    using BodyHandle = uint32_t;
+
+    static const BodyHandle k_no_body = ~0u;
+
+    /// Boxes sort before circles, a manifold's first body always has the
+    /// lower shape type
+    enum class ShapeType : uint8_t {
+        Box = 0,
+        Circle = 1
+    };
+
+    /// `half_extents`: Box only, half its width and height
+    /// `radius`: Circle only
+    struct PAOPU_API Shape2D {
+        ShapeType type{ShapeType::Box};
+        glm::vec2 half_extents{0.5f, 0.5f};
+        float radius{0.5f};
+    };
+
+    /// Where a shape is, `rotation` is (cos, sin) of its angle
+    ///
+    ///
+    struct PAOPU_API Pose2D {
+        glm::vec2 position{0.0f, 0.0f};
+        glm::vec2 rotation{1.0f, 0.0f};
+    };
+
+    /// `anchor_a`, `anchor_b`: The contact point relative to each body's center
+    /// `separation`: Negative while the shapes overlap, positive for a
+    ///     speculative point that isn't touching yet
+    /// `id`: Identifies the features that touch, so a point can be matched
+    ///     with the same one last step and start from its impulses
+    struct PAOPU_API ContactPoint {
+        glm::vec2 anchor_a;
+        glm::vec2 anchor_b;
+        float separation;
+        float normal_impulse;
+        float tangent_impulse;
+        uint32_t id;
+    };
+
+    /// Where two bodies touch. `normal` points from `a` to `b`.
+    ///
+    ///
+    struct PAOPU_API ContactManifold {
+        BodyHandle a;
+        BodyHandle b;
+        glm::vec2 normal;
+        float friction;
+        float restitution;
+        uint32_t point_count;
+        ContactPoint points[2];
+    };
+
+    /// Fills `manifold`'s normal and points for two shapes, `shape_a.type` no
+    /// greater than `shape_b.type`. Points up to `margin` apart are kept, so
+    /// shapes about to touch already have contacts. Impulses start out zero.
+    ///
+    PAOPU_API void collide(const Shape2D& shape_a, const Pose2D& pose_a, const Shape2D& shape_b, const Pose2D& pose_b, float margin, ContactManifold& manifold);
+
+    /// Bounds of `shape` at `pose`
+    ///
+    ///
+    PAOPU_API Aabb2D compute_bounds(const Shape2D& shape, const Pose2D& pose);
+
+}
@@ -0,0 +1,456 @@
+#include "ContactSolver.h"
+
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PAO_SOLVER_SSE
+#endif
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+namespace Paopu {
+
+    static const uint32_t k_no_manifold = ~0u;
+
+    // Four lanes of floats, the batch code is written once against these
+#ifdef PAO_SOLVER_SSE
+    struct Float4 {
+        __m128 v;
+    };
+
+    static inline Float4 load4(const float* p) { return {_mm_load_ps(p)}; }
+    static inline void store4(float* p, Float4 a) { _mm_store_ps(p, a.v); }
+    static inline Float4 splat4(float f) { return {_mm_set1_ps(f)}; }
+    static inline Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+    static inline Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+    static inline Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+    static inline Float4 min4(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+    static inline Float4 max4(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+
+    /// Velocities of four bodies, transposed from SolverBody rows into lanes
+    static inline void gather_velocities(const SolverBody* bodies, const uint32_t* indices, Float4& vx, Float4& vy, Float4& w) {
+        __m128 row0 = _mm_load_ps(&bodies[indices[0]].vx);
+        __m128 row1 = _mm_load_ps(&bodies[indices[1]].vx);
+        __m128 row2 = _mm_load_ps(&bodies[indices[2]].vx);
+        __m128 row3 = _mm_load_ps(&bodies[indices[3]].vx);
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+        vx.v = row0;
+        vy.v = row1;
+        w.v = row2;
+    }
+
+    /// Writes the velocities back, skipping the static body
+    static inline void scatter_velocities(SolverBody* bodies, const uint32_t* indices, Float4 vx, Float4 vy, Float4 w) {
+        __m128 row0 = vx.v;
+        __m128 row1 = vy.v;
+        __m128 row2 = w.v;
+        __m128 row3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+        if(indices[0] != 0) _mm_store_ps(&bodies[indices[0]].vx, row0);
+        if(indices[1] != 0) _mm_store_ps(&bodies[indices[1]].vx, row1);
+        if(indices[2] != 0) _mm_store_ps(&bodies[indices[2]].vx, row2);
+        if(indices[3] != 0) _mm_store_ps(&bodies[indices[3]].vx, row3);
+    }
+#else
+    struct Float4 {
+        float v[4];
+    };
+
+    static inline Float4 load4(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+    static inline void store4(float* p, Float4 a) { std::memcpy(p, a.v, sizeof(a.v)); }
+    static inline Float4 splat4(float f) { return {{f, f, f, f}}; }
+    static inline Float4 operator+(Float4 a, Float4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+    static inline Float4 operator-(Float4 a, Float4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+    static inline Float4 operator*(Float4 a, Float4 b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+    static inline Float4 min4(Float4 a, Float4 b) { return {{std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3])}}; }
+    static inline Float4 max4(Float4 a, Float4 b) { return {{std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3])}}; }
+
+    static inline void gather_velocities(const SolverBody* bodies, const uint32_t* indices, Float4& vx, Float4& vy, Float4& w) {
+        for(uint32_t lane = 0; lane < 4; lane++) {
+            const SolverBody& body = bodies[indices[lane]];
+            vx.v[lane] = body.vx;
+            vy.v[lane] = body.vy;
+            w.v[lane] = body.w;
+        }
+    }
+
+    static inline void scatter_velocities(SolverBody* bodies, const uint32_t* indices, Float4 vx, Float4 vy, Float4 w) {
+        for(uint32_t lane = 0; lane < 4; lane++) {
+            if(indices[lane] == 0) continue;
+            SolverBody& body = bodies[indices[lane]];
+            body.vx = vx.v[lane];
+            body.vy = vy.v[lane];
+            body.w = w.v[lane];
+        }
+    }
+#endif
+
+    static inline uint32_t count_trailing_zeros(uint32_t mask) {
+    #ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<uint32_t>(index);
+    #else
+        return static_cast<uint32_t>(__builtin_ctz(mask));
+    #endif
+    }
+
+    static inline float cross(glm::vec2 a, glm::vec2 b) {
+        return a.x * b.y - a.y * b.x;
+    }
+
+    template<typename F>
+    void ContactSolver::for_each_color(const F& function) {
+        bool parallel = JobSystem::get_worker_count() > 1;
+        for(uint32_t color = 0; color <= k_max_colors; color++) {
+            uint32_t begin = color_starts[color];
+            uint32_t count = color_starts[color + 1] - begin;
+
+            // Overflow batches may share bodies, they always go one at a time
+            if(!parallel || color == k_max_colors || count < settings.min_batches_per_job * 2) {
+                for(uint32_t i = begin; i < begin + count; i++) {
+                    function(i);
+                }
+                continue;
+            }
+
+            JobSystem::parallel_for(count, [&function, begin](uint32_t chunk_begin, uint32_t chunk_end) {
+                for(uint32_t i = chunk_begin; i < chunk_end; i++) {
+                    function(begin + i);
+                }
+            }, settings.min_batches_per_job);
+        }
+    }
+
+    void ContactSolver::solve(ContactManifold* manifolds, uint32_t manifold_count, const uint32_t* solver_indices,
+                                SolverBody* bodies, uint32_t body_count, float dt) {
+        PAO_PROFILE_FUNCTION();
+
+        stats = ContactSolverStats{};
+        stats.contact_count = manifold_count;
+        if(manifold_count == 0 || dt <= 0.0f) return;
+
+        color(manifolds, manifold_count, solver_indices, body_count);
+        stats.batch_count = static_cast<uint32_t>(batches.size());
+
+        float inv_dt = 1.0f / dt;
+        uint32_t batch_count = stats.batch_count;
+        if(JobSystem::get_worker_count() > 1 && batch_count >= settings.min_batches_per_job * 2) {
+            JobSystem::parallel_for(batch_count, [&](uint32_t begin, uint32_t end) {
+                for(uint32_t i = begin; i < end; i++) {
+                    prepare(i, manifolds, solver_indices, bodies, inv_dt);
+                }
+            }, settings.min_batches_per_job);
+        } else {
+            for(uint32_t i = 0; i < batch_count; i++) {
+                prepare(i, manifolds, solver_indices, bodies, inv_dt);
+            }
+        }
+
+        {
+            PAO_PROFILE_SCOPE("Warm start");
+            for_each_color([this, bodies](uint32_t index) {
+                ContactBatch& batch = batches[index];
+                Float4 vax, vay, wa, vbx, vby, wb;
+                gather_velocities(bodies, batch.body_a, vax, vay, wa);
+                gather_velocities(bodies, batch.body_b, vbx, vby, wb);
+
+                Float4 nx = load4(batch.normal_x);
+                Float4 ny = load4(batch.normal_y);
+                Float4 ma = load4(batch.inv_mass_a);
+                Float4 ia = load4(batch.inv_inertia_a);
+                Float4 mb = load4(batch.inv_mass_b);
+                Float4 ib = load4(batch.inv_inertia_b);
+
+                for(uint32_t p = 0; p < 2; p++) {
+                    const ContactBatchPoint& point = batch.points[p];
+                    Float4 normal_impulse = load4(point.normal_impulse);
+                    Float4 tangent_impulse = load4(point.tangent_impulse);
+                    // Tangent is (ny, -nx)
+                    Float4 px = nx * normal_impulse + ny * tangent_impulse;
+                    Float4 py = ny * normal_impulse - nx * tangent_impulse;
+
+                    Float4 rax = load4(point.anchor_a_x);
+                    Float4 ray = load4(point.anchor_a_y);
+                    Float4 rbx = load4(point.anchor_b_x);
+                    Float4 rby = load4(point.anchor_b_y);
+
+                    vax = vax - ma * px;
+                    vay = vay - ma * py;
+                    wa = wa - ia * (rax * py - ray * px);
+                    vbx = vbx + mb * px;
+                    vby = vby + mb * py;
+                    wb = wb + ib * (rbx * py - rby * px);
+                }
+
+                scatter_velocities(bodies, batch.body_a, vax, vay, wa);
+                scatter_velocities(bodies, batch.body_b, vbx, vby, wb);
+            });
+        }
+
+        for(uint32_t iteration = 0; iteration < settings.velocity_iterations; iteration++) {
+            PAO_PROFILE_SCOPE("Velocity iteration");
+            for_each_color([this, bodies](uint32_t index) {
+                ContactBatch& batch = batches[index];
+                Float4 vax, vay, wa, vbx, vby, wb;
+                gather_velocities(bodies, batch.body_a, vax, vay, wa);
+                gather_velocities(bodies, batch.body_b, vbx, vby, wb);
+
+                Float4 nx = load4(batch.normal_x);
+                Float4 ny = load4(batch.normal_y);
+                Float4 ma = load4(batch.inv_mass_a);
+                Float4 ia = load4(batch.inv_inertia_a);
+                Float4 mb = load4(batch.inv_mass_b);
+                Float4 ib = load4(batch.inv_inertia_b);
+                Float4 friction = load4(batch.friction);
+                Float4 zero = splat4(0.0f);
+
+                // Friction first, staying on the surface matters more than sliding right
+                for(uint32_t p = 0; p < 2; p++) {
+                    ContactBatchPoint& point = batch.points[p];
+                    Float4 rax = load4(point.anchor_a_x);
+                    Float4 ray = load4(point.anchor_a_y);
+                    Float4 rbx = load4(point.anchor_b_x);
+                    Float4 rby = load4(point.anchor_b_y);
+
+                    // dv = vb + wb x rb - va - wa x ra
+                    Float4 dvx = vbx - wb * rby - vax + wa * ray;
+                    Float4 dvy = vby + wb * rbx - vay - wa * rax;
+                    Float4 vt = dvx * ny - dvy * nx;
+
+                    Float4 old_impulse = load4(point.tangent_impulse);
+                    Float4 max_friction = friction * load4(point.normal_impulse);
+                    Float4 impulse = old_impulse - load4(point.tangent_mass) * vt;
+                    impulse = max4(min4(impulse, max_friction), zero - max_friction);
+                    store4(point.tangent_impulse, impulse);
+                    Float4 lambda = impulse - old_impulse;
+
+                    Float4 px = ny * lambda;
+                    Float4 py = zero - nx * lambda;
+                    vax = vax - ma * px;
+                    vay = vay - ma * py;
+                    wa = wa - ia * (rax * py - ray * px);
+                    vbx = vbx + mb * px;
+                    vby = vby + mb * py;
+                    wb = wb + ib * (rbx * py - rby * px);
+                }
+
+                for(uint32_t p = 0; p < 2; p++) {
+                    ContactBatchPoint& point = batch.points[p];
+                    Float4 rax = load4(point.anchor_a_x);
+                    Float4 ray = load4(point.anchor_a_y);
+                    Float4 rbx = load4(point.anchor_b_x);
+                    Float4 rby = load4(point.anchor_b_y);
+
+                    Float4 dvx = vbx - wb * rby - vax + wa * ray;
+                    Float4 dvy = vby + wb * rbx - vay - wa * rax;
+                    Float4 vn = dvx * nx + dvy * ny;
+
+                    // Accumulated impulses may only push, never pull
+                    Float4 old_impulse = load4(point.normal_impulse);
+                    Float4 impulse = max4(old_impulse - load4(point.normal_mass) * (vn - load4(point.bias)), zero);
+                    store4(point.normal_impulse, impulse);
+                    Float4 lambda = impulse - old_impulse;
+
+                    Float4 px = nx * lambda;
+                    Float4 py = ny * lambda;
+                    vax = vax - ma * px;
+                    vay = vay - ma * py;
+                    wa = wa - ia * (rax * py - ray * px);
+                    vbx = vbx + mb * px;
+                    vby = vby + mb * py;
+                    wb = wb + ib * (rbx * py - rby * px);
+                }
+
+                scatter_velocities(bodies, batch.body_a, vax, vay, wa);
+                scatter_velocities(bodies, batch.body_b, vbx, vby, wb);
+            });
+        }
+
+        // Keep the impulses for warm starting the next step
+        for(const ContactBatch& batch : batches) {
+            for(uint32_t lane = 0; lane < k_lanes; lane++) {
+                if(batch.manifolds[lane] == k_no_manifold) continue;
+
+                ContactManifold& manifold = manifolds[batch.manifolds[lane]];
+                for(uint32_t p = 0; p < manifold.point_count; p++) {
+                    manifold.points[p].normal_impulse = batch.points[p].normal_impulse[lane];
+                    manifold.points[p].tangent_impulse = batch.points[p].tangent_impulse[lane];
+                }
+            }
+        }
+    }
+
+    void ContactSolver::color(const ContactManifold* manifolds, uint32_t manifold_count, const uint32_t* solver_indices, uint32_t body_count) {
+        PAO_PROFILE_FUNCTION();
+
+        const uint32_t all_colors = (1u << k_max_colors) - 1;
+        uint32_t color_counts[k_max_colors + 1] = {};
+
+        // Greedy, each contact takes the lowest color neither body has yet
+        body_colors.assign(body_count, 0);
+        manifold_colors.resize(manifold_count);
+        for(uint32_t i = 0; i < manifold_count; i++) {
+            uint32_t a = solver_indices[manifolds[i].a];
+            uint32_t b = solver_indices[manifolds[i].b];
+            uint32_t used = body_colors[a] | body_colors[b];
+            uint32_t free = ~used & all_colors;
+
+            uint32_t color = k_max_colors;
+            if(free != 0) {
+                color = count_trailing_zeros(free);
+                // The static body shares every color
+                if(a != 0) body_colors[a] |= 1u << color;
+                if(b != 0) body_colors[b] |= 1u << color;
+            }
+            manifold_colors[i] = static_cast<uint8_t>(color);
+            color_counts[color]++;
+        }
+
+        color_starts.resize(k_max_colors + 2);
+        uint32_t batch_count = 0;
+        for(uint32_t color = 0; color <= k_max_colors; color++) {
+            color_starts[color] = batch_count;
+            if(color == k_max_colors) {
+                batch_count += color_counts[color];
+            } else {
+                batch_count += (color_counts[color] + k_lanes - 1) / k_lanes;
+                if(color_counts[color] > 0) stats.color_count++;
+            }
+        }
+        color_starts[k_max_colors + 1] = batch_count;
+        stats.overflow_count = color_counts[k_max_colors];
+
+        batches.resize(batch_count);
+        for(ContactBatch& batch : batches) {
+            for(uint32_t lane = 0; lane < k_lanes; lane++) {
+                batch.manifolds[lane] = k_no_manifold;
+            }
+        }
+
+        // Fill in manifold order, so the batches only depend on the input
+        uint32_t color_fill[k_max_colors + 1] = {};
+        for(uint32_t i = 0; i < manifold_count; i++) {
+            uint32_t color = manifold_colors[i];
+            uint32_t slot = color_fill[color]++;
+            if(color == k_max_colors) {
+                batches[color_starts[color] + slot].manifolds[0] = i;
+            } else {
+                batches[color_starts[color] + slot / k_lanes].manifolds[slot % k_lanes] = i;
+            }
+        }
+    }
+
+    void ContactSolver::prepare(uint32_t index, const ContactManifold* manifolds, const uint32_t* solver_indices, const SolverBody* bodies, float inv_dt) {
+        ContactBatch& batch = batches[index];
+
+        for(uint32_t lane = 0; lane < k_lanes; lane++) {
+            uint32_t manifold_index = batch.manifolds[lane];
+            if(manifold_index == k_no_manifold) {
+                // Massless and pointless, the lane computes zero impulses
+                batch.body_a[lane] = 0;
+                batch.body_b[lane] = 0;
+                batch.normal_x[lane] = 0.0f;
+                batch.normal_y[lane] = 0.0f;
+                batch.friction[lane] = 0.0f;
+                batch.inv_mass_a[lane] = 0.0f;
+                batch.inv_inertia_a[lane] = 0.0f;
+                batch.inv_mass_b[lane] = 0.0f;
+                batch.inv_inertia_b[lane] = 0.0f;
+                for(uint32_t p = 0; p < 2; p++) {
+                    ContactBatchPoint& point = batch.points[p];
+                    point.anchor_a_x[lane] = 0.0f;
+                    point.anchor_a_y[lane] = 0.0f;
+                    point.anchor_b_x[lane] = 0.0f;
+                    point.anchor_b_y[lane] = 0.0f;
+                    point.normal_mass[lane] = 0.0f;
+                    point.tangent_mass[lane] = 0.0f;
+                    point.bias[lane] = 0.0f;
+                    point.normal_impulse[lane] = 0.0f;
+                    point.tangent_impulse[lane] = 0.0f;
+                }
+                continue;
+            }
+
+            const ContactManifold& manifold = manifolds[manifold_index];
+            uint32_t a = solver_indices[manifold.a];
+            uint32_t b = solver_indices[manifold.b];
+            const SolverBody& body_a = bodies[a];
+            const SolverBody& body_b = bodies[b];
+            glm::vec2 normal = manifold.normal;
+            glm::vec2 tangent = {normal.y, -normal.x};
+
+            batch.body_a[lane] = a;
+            batch.body_b[lane] = b;
+            batch.normal_x[lane] = normal.x;
+            batch.normal_y[lane] = normal.y;
+            batch.friction[lane] = manifold.friction;
+            batch.inv_mass_a[lane] = body_a.inv_mass;
+            batch.inv_inertia_a[lane] = body_a.inv_inertia;
+            batch.inv_mass_b[lane] = body_b.inv_mass;
+            batch.inv_inertia_b[lane] = body_b.inv_inertia;
+
+            for(uint32_t p = 0; p < 2; p++) {
+                ContactBatchPoint& point = batch.points[p];
+                if(p >= manifold.point_count) {
+                    point.anchor_a_x[lane] = 0.0f;
+                    point.anchor_a_y[lane] = 0.0f;
+                    point.anchor_b_x[lane] = 0.0f;
+                    point.anchor_b_y[lane] = 0.0f;
+                    point.normal_mass[lane] = 0.0f;
+                    point.tangent_mass[lane] = 0.0f;
+                    point.bias[lane] = 0.0f;
+                    point.normal_impulse[lane] = 0.0f;
+                    point.tangent_impulse[lane] = 0.0f;
+                    continue;
+                }
+
+                const ContactPoint& contact = manifold.points[p];
+                glm::vec2 ra = contact.anchor_a;
+                glm::vec2 rb = contact.anchor_b;
+                point.anchor_a_x[lane] = ra.x;
+                point.anchor_a_y[lane] = ra.y;
+                point.anchor_b_x[lane] = rb.x;
+                point.anchor_b_y[lane] = rb.y;
+
+                float rna = cross(ra, normal);
+                float rnb = cross(rb, normal);
+                float normal_k = body_a.inv_mass + body_b.inv_mass + body_a.inv_inertia * rna * rna + body_b.inv_inertia * rnb * rnb;
+                point.normal_mass[lane] = normal_k > 0.0f ? 1.0f / normal_k : 0.0f;
+
+                float rta = cross(ra, tangent);
+                float rtb = cross(rb, tangent);
+                float tangent_k = body_a.inv_mass + body_b.inv_mass + body_a.inv_inertia * rta * rta + body_b.inv_inertia * rtb * rtb;
+                point.tangent_mass[lane] = tangent_k > 0.0f ? 1.0f / tangent_k : 0.0f;
+
+                // A speculative point lets the bodies close the gap this step
+                // but no further, overlapping ones are pushed apart over a few steps
+                float bias;
+                if(contact.separation > 0.0f) {
+                    bias = -contact.separation * inv_dt;
+                } else {
+                    bias = settings.baumgarte * inv_dt * std::max(-(contact.separation + settings.linear_slop), 0.0f);
+                }
+
+                glm::vec2 relative_velocity = glm::vec2{body_b.vx - body_b.w * rb.y, body_b.vy + body_b.w * rb.x}
+                                            - glm::vec2{body_a.vx - body_a.w * ra.y, body_a.vy + body_a.w * ra.x};
+                float approach = glm::dot(relative_velocity, normal);
+                if(approach < -settings.restitution_threshold) {
+                    bias = std::max(bias, -manifold.restitution * approach);
+                }
+                point.bias[lane] = bias;
+
+                point.normal_impulse[lane] = contact.normal_impulse;
+                point.tangent_impulse[lane] = contact.tangent_impulse;
+            }
+        }
+    }
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "../Core/Core.h"
+#include "Collision.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    /// Velocity and mass of a body while it's being solved. Index 0 of the
+    /// solver's body array stands in for every static body: zero velocity,
+    /// zero inverse mass, and it's never written.
+    ///
+    struct alignas(16) SolverBody {
+        float vx;
+        float vy;
+        float w;
+        float padding;
+        float inv_mass;
+        float inv_inertia;
+        float padding2[2];
+    };
+
+    /// `velocity_iterations`: Passes over every contact per step
+    /// `baumgarte`: Fraction of the overlap pushed apart per step
+    /// `linear_slop`: Overlap allowed to remain, keeps resting contacts from jittering
+    /// `restitution_threshold`: Closing speed below which contacts don't bounce
+    /// `min_batches_per_job`: Below this many batches of a color per job, the
+    ///     color is solved on the calling thread
+    struct PAOPU_API ContactSolverSettings {
+        uint32_t velocity_iterations{8};
+        float baumgarte{0.2f};
+        float linear_slop{0.01f};
+        float restitution_threshold{1.0f};
+        uint32_t min_batches_per_job{64};
+    };
+
+    /// What the last `solve` did
+    ///
+    /// `color_count`: Colors used, each a pass that waits for the one before
+    /// `overflow_count`: Contacts that didn't fit in any color, solved one at a time
+    struct PAOPU_API ContactSolverStats {
+        uint32_t contact_count{0};
+        uint32_t batch_count{0};
+        uint32_t color_count{0};
+        uint32_t overflow_count{0};
+    };
+
+    /// Sequential impulse solver for contact manifolds, parallel and four wide.
+    ///
+    /// Contacts are graph colored so no two of one color share a dynamic body,
+    /// then each color is cut into batches of four that are solved together
+    /// with SSE. Batches of one color never touch the same body, so they run
+    /// on the job system without locks, and the result doesn't depend on the
+    /// number of workers. Static bodies don't count towards the coloring, so a
+    /// pile resting on the ground still only needs a handful of colors.
+    class PAOPU_API ContactSolver {
+
+        public:
+            static const uint32_t k_lanes = 4;
+            static const uint32_t k_max_colors = 24;
+
+            inline void set_settings(const ContactSolverSettings& settings) { this->settings = settings; }
+            inline const ContactSolverSettings& get_settings() const { return settings; }
+
+            /// Applies the impulses that keep `manifolds` from overlapping to
+            /// `bodies`, starting from the impulses already stored in them
+            /// (warm starting) and storing the final ones back.
+            ///
+            /// `solver_indices`: Index into `bodies` of each body handle, 0 for static
+            void solve(ContactManifold* manifolds, uint32_t manifold_count, const uint32_t* solver_indices,
+                        SolverBody* bodies, uint32_t body_count, float dt);
+
+            inline const ContactSolverStats& get_stats() const { return stats; }
+
+        private:
+            struct ContactBatchPoint {
+                alignas(16) float anchor_a_x[k_lanes];
+                alignas(16) float anchor_a_y[k_lanes];
+                alignas(16) float anchor_b_x[k_lanes];
+                alignas(16) float anchor_b_y[k_lanes];
+                alignas(16) float normal_mass[k_lanes];
+                alignas(16) float tangent_mass[k_lanes];
+                alignas(16) float bias[k_lanes];
+                alignas(16) float normal_impulse[k_lanes];
+                alignas(16) float tangent_impulse[k_lanes];
+            };
+
+            /// Four manifolds side by side, unused lanes point at the static body
+            struct ContactBatch {
+                alignas(16) uint32_t body_a[k_lanes];
+                alignas(16) uint32_t body_b[k_lanes];
+                alignas(16) float normal_x[k_lanes];
+                alignas(16) float normal_y[k_lanes];
+                alignas(16) float friction[k_lanes];
+                alignas(16) float inv_mass_a[k_lanes];
+                alignas(16) float inv_inertia_a[k_lanes];
+                alignas(16) float inv_mass_b[k_lanes];
+                alignas(16) float inv_inertia_b[k_lanes];
+                ContactBatchPoint points[2];
+                uint32_t manifolds[k_lanes];
+            };
+
+            /// Assigns every manifold a color and fills `batches`
+            void color(const ContactManifold* manifolds, uint32_t manifold_count, const uint32_t* solver_indices, uint32_t body_count);
+
+            /// Fills batch `index` from its manifolds
+            void prepare(uint32_t index, const ContactManifold* manifolds, const uint32_t* solver_indices, const SolverBody* bodies, float inv_dt);
+
+            /// Runs `function` over the batches of every color in turn, a color's
+            /// batches in parallel when there are enough
+            template<typename F>
+            void for_each_color(const F& function);
+
+        private:
+            ContactSolverSettings settings;
+            ContactSolverStats stats;
+
+            // Colors each solver body already has a contact in
+            std::vector<uint32_t> body_colors;
+            std::vector<uint8_t> manifold_colors;
+            std::vector<ContactBatch> batches;
+            // `k_max_colors + 2` offsets into `batches`, the overflow color last.
+            // Overflow batches hold one contact each.
+            std::vector<uint32_t> color_starts;
+    };
+
+}
@@ -0,0 +1,537 @@
+#include "PhysicsWorld.h"
+
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include "../Core/Time.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace Paopu {
+
+    static const uint32_t k_no_island = ~0u;
+    static const uint64_t k_no_contact_key = ~0ull;
+    static const uint32_t k_min_bodies_per_job = 1024;
+
+    static inline uint64_t get_contact_key(BodyHandle a, BodyHandle b) {
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    static inline uint64_t hash_contact_key(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        return key;
+    }
+
+    static inline glm::vec2 get_rotation(float angle) {
+        return {std::cos(angle), std::sin(angle)};
+    }
+
+    void PhysicsWorld::set_settings(const PhysicsSettings& new_settings) {
+        broadphase.set_settings(new_settings.broadphase);
+        solver.set_settings(new_settings.solver);
+        settings = new_settings;
+    }
+
+    BodyHandle PhysicsWorld::create_body(const BodyDesc& desc) {
+        const Shape2D& shape = desc.shape;
+        if(shape.type == ShapeType::Box ? (shape.half_extents.x <= 0.0f || shape.half_extents.y <= 0.0f) : shape.radius <= 0.0f) {
+            throw std::runtime_error("[Physics][World]: Shapes need a positive size!");
+        }
+        if(desc.type == BodyType::Dynamic && desc.density <= 0.0f) {
+            throw std::runtime_error("[Physics][World]: Dynamic bodies need a positive density!");
+        }
+
+        BodyHandle handle;
+        if(!free_bodies.empty()) {
+            handle = free_bodies.back();
+            free_bodies.pop_back();
+        } else {
+            handle = static_cast<BodyHandle>(bodies.size());
+            bodies.emplace_back();
+            solver_indices.push_back(0);
+        }
+
+        Body& body = bodies[handle];
+        body.shape = shape;
+        body.pose.position = desc.position;
+        body.pose.rotation = get_rotation(desc.angle);
+        body.angle = desc.angle;
+        body.friction = desc.friction;
+        body.restitution = desc.restitution;
+        body.sleep_time = 0.0f;
+        body.island = k_no_island;
+        body.type = desc.type;
+        body.alive = true;
+        body.awake = desc.type == BodyType::Dynamic;
+
+        if(desc.type == BodyType::Dynamic) {
+            float mass;
+            float inertia;
+            if(shape.type == ShapeType::Box) {
+                glm::vec2 h = shape.half_extents;
+                mass = desc.density * 4.0f * h.x * h.y;
+                inertia = mass * (h.x * h.x + h.y * h.y) / 3.0f;
+            } else {
+                mass = desc.density * 3.14159265f * shape.radius * shape.radius;
+                inertia = 0.5f * mass * shape.radius * shape.radius;
+            }
+            body.inv_mass = 1.0f / mass;
+            body.inv_inertia = desc.fixed_rotation ? 0.0f : 1.0f / inertia;
+            body.linear_velocity = desc.linear_velocity;
+            body.angular_velocity = desc.fixed_rotation ? 0.0f : desc.angular_velocity;
+        } else {
+            body.inv_mass = 0.0f;
+            body.inv_inertia = 0.0f;
+            body.linear_velocity = {0.0f, 0.0f};
+            body.angular_velocity = 0.0f;
+        }
+
+        body.collider = broadphase.create(get_collider_bounds(body.shape, body.pose));
+        if(body.collider >= collider_bodies.size()) {
+            collider_bodies.resize(body.collider + 1, k_no_body);
+        }
+        collider_bodies[body.collider] = handle;
+
+        body_count++;
+        return handle;
+    }
+
+    void PhysicsWorld::destroy_body(BodyHandle handle) {
+        Body& body = get_body(handle);
+
+        // Whatever rested on it has to fall
+        if(body.type == BodyType::Dynamic && !body.awake) {
+            wake_island(body.island);
+        } else if(body.type == BodyType::Static) {
+            std::vector<ColliderHandle> touching;
+            broadphase.query(broadphase.get_bounds(body.collider), touching);
+            for(ColliderHandle collider : touching) {
+                wake(collider_bodies[collider]);
+            }
+        }
+
+        broadphase.destroy(body.collider);
+        collider_bodies[body.collider] = k_no_body;
+        body.alive = false;
+        destroyed_bodies.push_back(handle);
+        body_count--;
+    }
+
+    Aabb2D PhysicsWorld::get_collider_bounds(const Shape2D& shape, const Pose2D& pose) const {
+        Aabb2D bounds = compute_bounds(shape, pose);
+        glm::vec2 margin{settings.speculative_distance * 0.5f};
+        return Aabb2D{bounds.min - margin, bounds.max + margin};
+    }
+
+    PhysicsWorld::Body& PhysicsWorld::get_body(BodyHandle handle) {
+        if(handle >= bodies.size() || !bodies[handle].alive) {
+            throw std::runtime_error("[Physics][World]: Body doesn't exist!");
+        }
+        return bodies[handle];
+    }
+
+    const PhysicsWorld::Body& PhysicsWorld::get_body(BodyHandle handle) const {
+        if(handle >= bodies.size() || !bodies[handle].alive) {
+            throw std::runtime_error("[Physics][World]: Body doesn't exist!");
+        }
+        return bodies[handle];
+    }
+
+    glm::vec2 PhysicsWorld::get_position(BodyHandle handle) const {
+        return get_body(handle).pose.position;
+    }
+
+    float PhysicsWorld::get_angle(BodyHandle handle) const {
+        return get_body(handle).angle;
+    }
+
+    glm::vec2 PhysicsWorld::get_linear_velocity(BodyHandle handle) const {
+        return get_body(handle).linear_velocity;
+    }
+
+    float PhysicsWorld::get_angular_velocity(BodyHandle handle) const {
+        return get_body(handle).angular_velocity;
+    }
+
+    bool PhysicsWorld::is_awake(BodyHandle handle) const {
+        return get_body(handle).awake;
+    }
+
+    void PhysicsWorld::set_transform(BodyHandle handle, glm::vec2 position, float angle) {
+        Body& body = get_body(handle);
+
+        if(body.type == BodyType::Static) {
+            // Nothing else wakes bodies resting against static ones, check
+            // both where it was and where it goes
+            std::vector<ColliderHandle> touching;
+            broadphase.query(broadphase.get_bounds(body.collider), touching);
+            Pose2D pose{position, get_rotation(angle)};
+            broadphase.query(get_collider_bounds(body.shape, pose), touching);
+            for(ColliderHandle collider : touching) {
+                if(collider_bodies[collider] != handle) {
+                    wake(collider_bodies[collider]);
+                }
+            }
+        } else {
+            wake(handle);
+        }
+
+        body.pose.position = position;
+        body.pose.rotation = get_rotation(angle);
+        body.angle = angle;
+        body.sleep_time = 0.0f;
+        broadphase.set_bounds(body.collider, get_collider_bounds(body.shape, body.pose));
+    }
+
+    void PhysicsWorld::set_linear_velocity(BodyHandle handle, glm::vec2 velocity) {
+        Body& body = get_body(handle);
+        if(body.type == BodyType::Static) return;
+
+        wake(handle);
+        body.linear_velocity = velocity;
+        body.sleep_time = 0.0f;
+    }
+
+    void PhysicsWorld::set_angular_velocity(BodyHandle handle, float velocity) {
+        Body& body = get_body(handle);
+        if(body.type == BodyType::Static || body.inv_inertia == 0.0f) return;
+
+        wake(handle);
+        body.angular_velocity = velocity;
+        body.sleep_time = 0.0f;
+    }
+
+    void PhysicsWorld::apply_linear_impulse(BodyHandle handle, glm::vec2 impulse, glm::vec2 point) {
+        Body& body = get_body(handle);
+        if(body.type == BodyType::Static) return;
+
+        wake(handle);
+        glm::vec2 offset = point - body.pose.position;
+        body.linear_velocity += body.inv_mass * impulse;
+        body.angular_velocity += body.inv_inertia * (offset.x * impulse.y - offset.y * impulse.x);
+        body.sleep_time = 0.0f;
+    }
+
+    void PhysicsWorld::wake(BodyHandle handle) {
+        Body& body = get_body(handle);
+        if(body.type == BodyType::Dynamic && !body.awake) {
+            wake_island(body.island);
+        }
+    }
+
+    void PhysicsWorld::wake_island(uint32_t island) {
+        for(BodyHandle handle : sleeping_islands[island]) {
+            Body& body = bodies[handle];
+            if(body.alive && body.island == island) {
+                body.awake = true;
+                body.sleep_time = 0.0f;
+                body.island = k_no_island;
+            }
+        }
+        sleeping_islands[island].clear();
+        free_islands.push_back(island);
+    }
+
+    void PhysicsWorld::step(float dt) {
+        PAO_PROFILE_FUNCTION();
+        if(dt <= 0.0f) return;
+
+        stats = PhysicsStats{};
+        stats.body_count = body_count;
+
+        uint64_t start_ns = get_time_ns();
+        find_candidates();
+        uint64_t broadphase_ns = get_time_ns();
+        collide_candidates();
+        gather_solver_bodies(dt);
+        uint64_t narrowphase_ns = get_time_ns();
+
+        solver.solve(manifolds.data(), static_cast<uint32_t>(manifolds.size()), solver_indices.data(),
+                     solver_bodies.data(), static_cast<uint32_t>(solver_bodies.size()), dt);
+        uint64_t solve_ns = get_time_ns();
+
+        integrate(dt);
+        uint64_t integrate_ns = get_time_ns();
+        update_islands();
+        uint64_t island_ns = get_time_ns();
+
+        free_bodies.insert(free_bodies.end(), destroyed_bodies.begin(), destroyed_bodies.end());
+        destroyed_bodies.clear();
+
+        const ContactSolverStats& solver_stats = solver.get_stats();
+        stats.contact_count = static_cast<uint32_t>(manifolds.size());
+        stats.color_count = solver_stats.color_count;
+        stats.overflow_count = solver_stats.overflow_count;
+        stats.broadphase_ns = broadphase_ns - start_ns;
+        stats.narrowphase_ns = narrowphase_ns - broadphase_ns;
+        stats.solve_ns = solve_ns - narrowphase_ns;
+        stats.integrate_ns = integrate_ns - solve_ns;
+        stats.island_ns = island_ns - integrate_ns;
+    }
+
+    void PhysicsWorld::find_candidates() {
+        PAO_PROFILE_FUNCTION();
+
+        broadphase.update();
+        const std::vector<ColliderPair>& pairs = broadphase.get_pairs();
+        stats.pair_count = static_cast<uint32_t>(pairs.size());
+
+        // Wake first, so the woken islands' own contacts are collided this step too
+        for(const ColliderPair& pair : pairs) {
+            const Body& a = bodies[collider_bodies[pair.a]];
+            const Body& b = bodies[collider_bodies[pair.b]];
+            bool active_a = a.type == BodyType::Dynamic && a.awake;
+            bool active_b = b.type == BodyType::Dynamic && b.awake;
+            if(active_a && b.type == BodyType::Dynamic && !b.awake) {
+                wake_island(b.island);
+            } else if(active_b && a.type == BodyType::Dynamic && !a.awake) {
+                wake_island(a.island);
+            }
+        }
+
+        candidate_manifolds.clear();
+        for(const ColliderPair& pair : pairs) {
+            BodyHandle a = collider_bodies[pair.a];
+            BodyHandle b = collider_bodies[pair.b];
+            const Body& body_a = bodies[a];
+            const Body& body_b = bodies[b];
+
+            // Static and sleeping bodies don't move each other
+            bool active_a = body_a.type == BodyType::Dynamic && body_a.awake;
+            bool active_b = body_b.type == BodyType::Dynamic && body_b.awake;
+            if(!active_a && !active_b) continue;
+
+            bool swap = body_a.shape.type > body_b.shape.type || (body_a.shape.type == body_b.shape.type && a > b);
+            ContactManifold manifold;
+            manifold.a = swap ? b : a;
+            manifold.b = swap ? a : b;
+            candidate_manifolds.push_back(manifold);
+        }
+    }
+
+    void PhysicsWorld::collide_candidates() {
+        PAO_PROFILE_FUNCTION();
+
+        std::swap(manifolds, previous_manifolds);
+        build_contact_cache();
+
+        auto collide_range = [this](uint32_t begin, uint32_t end) {
+            for(uint32_t i = begin; i < end; i++) {
+                ContactManifold& manifold = candidate_manifolds[i];
+                const Body& a = bodies[manifold.a];
+                const Body& b = bodies[manifold.b];
+
+                collide(a.shape, a.pose, b.shape, b.pose, settings.speculative_distance, manifold);
+                if(manifold.point_count == 0) continue;
+
+                manifold.friction = std::sqrt(a.friction * b.friction);
+                manifold.restitution = std::max(a.restitution, b.restitution);
+
+                // Points that touch with the same features as last step keep their impulses
+                uint32_t cached = find_cached_contact(get_contact_key(manifold.a, manifold.b));
+                if(cached == ~0u) continue;
+
+                const ContactManifold& previous = previous_manifolds[cached];
+                for(uint32_t p = 0; p < manifold.point_count; p++) {
+                    for(uint32_t q = 0; q < previous.point_count; q++) {
+                        if(previous.points[q].id == manifold.points[p].id) {
+                            manifold.points[p].normal_impulse = previous.points[q].normal_impulse;
+                            manifold.points[p].tangent_impulse = previous.points[q].tangent_impulse;
+                            break;
+                        }
+                    }
+                }
+            }
+        };
+
+        uint32_t count = static_cast<uint32_t>(candidate_manifolds.size());
+        if(JobSystem::get_worker_count() > 1 && count >= settings.min_pairs_per_job * 2) {
+            JobSystem::parallel_for(count, collide_range, settings.min_pairs_per_job);
+        } else {
+            collide_range(0, count);
+        }
+
+        manifolds.clear();
+        for(const ContactManifold& manifold : candidate_manifolds) {
+            if(manifold.point_count > 0) {
+                manifolds.push_back(manifold);
+            }
+        }
+    }
+
+    void PhysicsWorld::build_contact_cache() {
+        uint32_t count = static_cast<uint32_t>(previous_manifolds.size());
+        uint32_t capacity = 16;
+        while(capacity < count * 2) capacity *= 2;
+
+        cache_keys.assign(capacity, k_no_contact_key);
+        cache_indices.resize(capacity);
+        uint32_t mask = capacity - 1;
+        for(uint32_t i = 0; i < count; i++) {
+            uint64_t key = get_contact_key(previous_manifolds[i].a, previous_manifolds[i].b);
+            uint32_t slot = static_cast<uint32_t>(hash_contact_key(key)) & mask;
+            while(cache_keys[slot] != k_no_contact_key) {
+                slot = (slot + 1) & mask;
+            }
+            cache_keys[slot] = key;
+            cache_indices[slot] = i;
+        }
+    }
+
+    uint32_t PhysicsWorld::find_cached_contact(uint64_t key) const {
+        uint32_t mask = static_cast<uint32_t>(cache_keys.size()) - 1;
+        uint32_t slot = static_cast<uint32_t>(hash_contact_key(key)) & mask;
+        while(cache_keys[slot] != k_no_contact_key) {
+            if(cache_keys[slot] == key) return cache_indices[slot];
+            slot = (slot + 1) & mask;
+        }
+        return ~0u;
+    }
+
+    void PhysicsWorld::gather_solver_bodies(float dt) {
+        PAO_PROFILE_FUNCTION();
+
+        awake_bodies.clear();
+        for(BodyHandle handle = 0; handle < bodies.size(); handle++) {
+            const Body& body = bodies[handle];
+            if(body.alive && body.type == BodyType::Dynamic && body.awake) {
+                awake_bodies.push_back(handle);
+                solver_indices[handle] = static_cast<uint32_t>(awake_bodies.size());
+            } else {
+                solver_indices[handle] = 0;
+            }
+        }
+        stats.awake_body_count = static_cast<uint32_t>(awake_bodies.size());
+
+        solver_bodies.resize(awake_bodies.size() + 1);
+        solver_bodies[0] = SolverBody{};
+        for(uint32_t i = 0; i < awake_bodies.size(); i++) {
+            const Body& body = bodies[awake_bodies[i]];
+            glm::vec2 velocity = body.linear_velocity + settings.gravity * dt;
+
+            SolverBody& solver_body = solver_bodies[i + 1];
+            solver_body = SolverBody{};
+            solver_body.vx = velocity.x;
+            solver_body.vy = velocity.y;
+            solver_body.w = body.angular_velocity;
+            solver_body.inv_mass = body.inv_mass;
+            solver_body.inv_inertia = body.inv_inertia;
+        }
+    }
+
+    void PhysicsWorld::integrate(float dt) {
+        PAO_PROFILE_FUNCTION();
+
+        float sleep_linear = settings.sleep_linear_velocity * settings.sleep_linear_velocity;
+        float sleep_angular = settings.sleep_angular_velocity;
+        bool allow_sleep = settings.allow_sleep;
+
+        auto integrate_range = [&](uint32_t begin, uint32_t end) {
+            for(uint32_t i = begin; i < end; i++) {
+                Body& body = bodies[awake_bodies[i]];
+                const SolverBody& solver_body = solver_bodies[i + 1];
+
+                body.linear_velocity = {solver_body.vx, solver_body.vy};
+                body.angular_velocity = solver_body.w;
+                body.pose.position += body.linear_velocity * dt;
+                body.angle += body.angular_velocity * dt;
+                body.pose.rotation = get_rotation(body.angle);
+
+                // Distinct colliders, setting bounds from several threads is fine
+                broadphase.set_bounds(body.collider, get_collider_bounds(body.shape, body.pose));
+
+                bool resting = glm::dot(body.linear_velocity, body.linear_velocity) <= sleep_linear
+                            && std::fabs(body.angular_velocity) <= sleep_angular;
+                body.sleep_time = allow_sleep && resting ? body.sleep_time + dt : 0.0f;
+            }
+        };
+
+        uint32_t count = static_cast<uint32_t>(awake_bodies.size());
+        if(JobSystem::get_worker_count() > 1 && count >= k_min_bodies_per_job * 2) {
+            JobSystem::parallel_for(count, integrate_range, k_min_bodies_per_job);
+        } else {
+            integrate_range(0, count);
+        }
+    }
+
+    void PhysicsWorld::update_islands() {
+        PAO_PROFILE_FUNCTION();
+
+        uint32_t count = static_cast<uint32_t>(awake_bodies.size());
+        island_parents.resize(count + 1);
+        for(uint32_t i = 0; i <= count; i++) {
+            island_parents[i] = i;
+        }
+
+        auto find = [this](uint32_t index) {
+            while(island_parents[index] != index) {
+                island_parents[index] = island_parents[island_parents[index]];
+                index = island_parents[index];
+            }
+            return index;
+        };
+
+        // Static bodies don't join islands, a pile on the ground is one island
+        // and two piles on the same ground are two
+        for(const ContactManifold& manifold : manifolds) {
+            uint32_t a = solver_indices[manifold.a];
+            uint32_t b = solver_indices[manifold.b];
+            if(a == 0 || b == 0) continue;
+
+            uint32_t root_a = find(a);
+            uint32_t root_b = find(b);
+            if(root_a != root_b) {
+                island_parents[std::max(root_a, root_b)] = std::min(root_a, root_b);
+            }
+        }
+
+        island_sizes.assign(count + 1, 0);
+        island_sleep_times.assign(count + 1, std::numeric_limits<float>::max());
+        for(uint32_t i = 1; i <= count; i++) {
+            uint32_t root = find(i);
+            island_parents[i] = root;
+            island_sizes[root]++;
+            island_sleep_times[root] = std::min(island_sleep_times[root], bodies[awake_bodies[i - 1]].sleep_time);
+        }
+
+        for(uint32_t i = 1; i <= count; i++) {
+            if(island_parents[i] == i) {
+                stats.island_count++;
+                stats.largest_island = std::max(stats.largest_island, island_sizes[i]);
+            }
+        }
+
+        if(!settings.allow_sleep) return;
+
+        // Islands only sleep as a whole, once every body in them has rested long enough
+        island_ids.assign(count + 1, k_no_island);
+        for(uint32_t i = 1; i <= count; i++) {
+            uint32_t root = island_parents[i];
+            if(island_sleep_times[root] < settings.time_to_sleep) continue;
+
+            if(island_ids[root] == k_no_island) {
+                if(!free_islands.empty()) {
+                    island_ids[root] = free_islands.back();
+                    free_islands.pop_back();
+                } else {
+                    island_ids[root] = static_cast<uint32_t>(sleeping_islands.size());
+                    sleeping_islands.emplace_back();
+                }
+            }
+
+            BodyHandle handle = awake_bodies[i - 1];
+            Body& body = bodies[handle];
+            body.awake = false;
+            body.island = island_ids[root];
+            body.linear_velocity = {0.0f, 0.0f};
+            body.angular_velocity = 0.0f;
+            body.sleep_time = 0.0f;
+            sleeping_islands[body.island].push_back(handle);
+        }
+    }
+
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include "../Core/Core.h"
+#include "Broadphase.h"
+#include "Collision.h"
+#include "ContactSolver.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    /// `Static` bodies never move on their own and have infinite mass
+    ///
+    ///
+    enum class BodyType : uint8_t {
+        Static = 0,
+        Dynamic = 1
+    };
+
+    /// Everything needed to create a body. `angle` is in radians.
+    ///
+    /// `density`: Mass per unit area, dynamic bodies only
+    /// `fixed_rotation`: Never rotates, e.g. a character
+    struct PAOPU_API BodyDesc {
+        BodyType type{BodyType::Dynamic};
+        Shape2D shape{};
+        glm::vec2 position{0.0f, 0.0f};
+        float angle{0.0f};
+        glm::vec2 linear_velocity{0.0f, 0.0f};
+        float angular_velocity{0.0f};
+        float density{1.0f};
+        float friction{0.6f};
+        float restitution{0.0f};
+        bool fixed_rotation{false};
+    };
+
+    /// `solver`: See ContactSolver.h
+    /// `broadphase`: See Broadphase.h
+    /// `speculative_distance`: Gap up to which contacts are kept before the
+    ///     shapes touch. A resting body hovers around zero separation; without
+    ///     this its contact points would come and go from step to step.
+    /// `allow_sleep`: Islands that stay below the sleep velocities for
+    ///     `time_to_sleep` seconds stop being simulated until something
+    ///     touches them
+    /// `min_pairs_per_job`: Below this many pairs per job, contacts are
+    ///     found on the calling thread
+    struct PAOPU_API PhysicsSettings {
+        glm::vec2 gravity{0.0f, -10.0f};
+        ContactSolverSettings solver{};
+        BroadphaseSettings broadphase{};
+        float speculative_distance{0.02f};
+        bool allow_sleep{true};
+        float sleep_linear_velocity{0.05f};
+        float sleep_angular_velocity{0.05f};
+        float time_to_sleep{0.5f};
+        uint32_t min_pairs_per_job{1024};
+    };
+
+    /// What the last `step` did, times in nanoseconds
+    ///
+    /// `island_count`: Groups of awake bodies touching each other, directly
+    ///     or through others
+    struct PAOPU_API PhysicsStats {
+        uint32_t body_count{0};
+        uint32_t awake_body_count{0};
+        uint32_t pair_count{0};
+        uint32_t contact_count{0};
+        uint32_t island_count{0};
+        uint32_t largest_island{0};
+        uint32_t color_count{0};
+        uint32_t overflow_count{0};
+        uint64_t broadphase_ns{0};
+        uint64_t narrowphase_ns{0};
+        uint64_t solve_ns{0};
+        uint64_t integrate_ns{0};
+        uint64_t island_ns{0};
+    };
+
+    /// 2D rigid bodies, boxes and circles, stepped with a fixed timestep.
+    ///
+    /// A step finds pairs with the Broadphase, builds contact manifolds on the
+    /// job system and solves them with the ContactSolver, warm started from
+    /// the matching contacts of the step before. Bodies are then integrated
+    /// in parallel and grouped into islands of touching bodies; islands that
+    /// came to rest fall asleep and cost nothing until an awake body touches
+    /// them.
+    ///
+    /// A single pile is one big island, so the solver parallelizes within
+    /// islands by coloring contacts rather than handing out whole islands.
+    /// The Application steps its world every Tick.
+    class PAOPU_API PhysicsWorld {
+
+        public:
+            void set_settings(const PhysicsSettings& settings);
+            inline const PhysicsSettings& get_settings() const { return settings; }
+
+            BodyHandle create_body(const BodyDesc& desc);
+            void destroy_body(BodyHandle handle);
+
+            /// Advances every awake body by `dt` seconds
+            ///
+            ///
+            void step(float dt);
+
+            glm::vec2 get_position(BodyHandle handle) const;
+            float get_angle(BodyHandle handle) const;
+            glm::vec2 get_linear_velocity(BodyHandle handle) const;
+            float get_angular_velocity(BodyHandle handle) const;
+            bool is_awake(BodyHandle handle) const;
+
+            /// Teleports a body, waking what it was resting on or in
+            ///
+            ///
+            void set_transform(BodyHandle handle, glm::vec2 position, float angle);
+
+            void set_linear_velocity(BodyHandle handle, glm::vec2 velocity);
+            void set_angular_velocity(BodyHandle handle, float velocity);
+
+            /// Applies `impulse` at the world point `point`, waking the body
+            ///
+            ///
+            void apply_linear_impulse(BodyHandle handle, glm::vec2 impulse, glm::vec2 point);
+
+            /// Wakes the body and the island it sleeps in
+            ///
+            ///
+            void wake(BodyHandle handle);
+
+            /// Contacts solved by the last step, with the impulses that were applied
+            ///
+            ///
+            inline const std::vector<ContactManifold>& get_contacts() const { return manifolds; }
+            inline const PhysicsStats& get_stats() const { return stats; }
+            inline uint32_t get_body_count() const { return body_count; }
+
+        private:
+            struct Body {
+                Shape2D shape;
+                Pose2D pose;
+                float angle;
+                glm::vec2 linear_velocity;
+                float angular_velocity;
+                float inv_mass;
+                float inv_inertia;
+                float friction;
+                float restitution;
+                float sleep_time;
+                ColliderHandle collider;
+                // Sleeping island, ~0u while awake
+                uint32_t island;
+                BodyType type;
+                bool alive;
+                bool awake;
+            };
+
+            /// Shape bounds grown by half the speculative distance
+            Aabb2D get_collider_bounds(const Shape2D& shape, const Pose2D& pose) const;
+
+            /// Looks up a live body, throwing for dead handles
+            Body& get_body(BodyHandle handle);
+            const Body& get_body(BodyHandle handle) const;
+
+            /// Finds overlapping pairs, waking sleeping islands that awake
+            /// bodies ran into, and keeps the pairs with an awake body
+            void find_candidates();
+
+            /// Collides the candidates and warm starts them from last step's contacts
+            void collide_candidates();
+
+            /// Dense solver bodies for every awake body, with gravity applied
+            void gather_solver_bodies(float dt);
+
+            /// Moves awake bodies by their solved velocities
+            void integrate(float dt);
+
+            /// Groups awake bodies into islands and puts resting ones to sleep
+            void update_islands();
+
+            void wake_island(uint32_t island);
+
+            /// Rebuilds the lookup of last step's contacts by body pair
+            void build_contact_cache();
+
+            /// Index into `previous_manifolds` of the pair's contact, or ~0u
+            uint32_t find_cached_contact(uint64_t key) const;
+
+        private:
+            PhysicsSettings settings;
+            Broadphase broadphase;
+            ContactSolver solver;
+
+            std::vector<Body> bodies;
+            // Body of each broadphase collider
+            std::vector<BodyHandle> collider_bodies;
+            std::vector<BodyHandle> free_bodies;
+            // Destroyed this step; only reused after the next step so last
+            // step's contacts can't be matched to a new body
+            std::vector<BodyHandle> destroyed_bodies;
+            uint32_t body_count{0};
+
+            // Pairs to collide, `a` has the lower shape type. Those that touch
+            // are packed into `manifolds`.
+            std::vector<ContactManifold> candidate_manifolds;
+            std::vector<ContactManifold> manifolds;
+            std::vector<ContactManifold> previous_manifolds;
+            // Open addressing table of (a, b) keys into `previous_manifolds`
+            std::vector<uint64_t> cache_keys;
+            std::vector<uint32_t> cache_indices;
+
+            // Awake bodies in solver order, solver index i + 1
+            std::vector<BodyHandle> awake_bodies;
+            // Indexed by body handle, 0 for static and sleeping bodies
+            std::vector<uint32_t> solver_indices;
+            std::vector<SolverBody> solver_bodies;
+
+            // Union-find over solver indices, the rest indexed by root
+            std::vector<uint32_t> island_parents;
+            std::vector<uint32_t> island_sizes;
+            std::vector<float> island_sleep_times;
+            std::vector<uint32_t> island_ids;
+            std::vector<std::vector<BodyHandle>> sleeping_islands;
+            std::vector<uint32_t> free_islands;
+
+            PhysicsStats stats;
+    };
+
+}
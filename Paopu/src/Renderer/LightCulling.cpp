@@ -0,0 +1,90 @@
+#include "LightCulling.h"
+
+#include "../Core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Paopu {
+
+    void LightTileGrid::cull(const Light2D* lights, uint32_t count, const SpriteCamera& camera, uint32_t width, uint32_t height) {
+        PAO_PROFILE_FUNCTION();
+
+        tile_count_x = get_light_tile_count(width);
+        tile_count_y = get_light_tile_count(height);
+        overflow_count = 0;
+        tiles.resize(static_cast<size_t>(tile_count_x) * tile_count_y * k_light_tile_stride);
+        row_offsets.assign(tile_count_y + 1, 0);
+        spans.clear();
+
+        // Clip space to pixels, and how many pixels one unit of light radius covers
+        const glm::vec2 extent(static_cast<float>(width), static_cast<float>(height));
+        const glm::vec2 pixels_per_unit = glm::abs(camera.scale) * 0.5f * extent;
+        const bool visible = pixels_per_unit.x > 0.0f && pixels_per_unit.y > 0.0f;
+
+        const float tile_size = static_cast<float>(k_light_tile_size);
+        for(uint32_t index = 0; visible && index < count; index++) {
+            const Light2D& light = lights[index];
+            if(!(light.radius > 0.0f)) continue;
+
+            glm::vec2 center = ((light.position * camera.scale + camera.offset) * 0.5f + 0.5f) * extent;
+            glm::vec2 radius = light.radius * pixels_per_unit;
+            if(center.x + radius.x < 0.0f || center.x - radius.x > extent.x
+                || center.y + radius.y < 0.0f || center.y - radius.y > extent.y) continue;
+
+            int32_t first_y = std::max(static_cast<int32_t>(std::floor((center.y - radius.y) / tile_size)), 0);
+            int32_t last_y = std::min(static_cast<int32_t>(std::floor((center.y + radius.y) / tile_size)), static_cast<int32_t>(tile_count_y) - 1);
+
+            for(int32_t y = first_y; y <= last_y; y++) {
+                // Distance from the center to the row, in light units, and
+                // how far the light reaches along it from there
+                float row_min = y * tile_size;
+                float row_max = row_min + tile_size;
+                float dy = (center.y - std::min(std::max(center.y, row_min), row_max)) / pixels_per_unit.y;
+                float reach = light.radius * light.radius - dy * dy;
+                if(reach < 0.0f) continue;
+                float half_width = std::sqrt(reach) * pixels_per_unit.x;
+
+                int32_t first_x = std::max(static_cast<int32_t>(std::floor((center.x - half_width) / tile_size)), 0);
+                int32_t last_x = std::min(static_cast<int32_t>(std::floor((center.x + half_width) / tile_size)), static_cast<int32_t>(tile_count_x) - 1);
+                if(first_x > last_x) continue;
+
+                spans.push_back({static_cast<uint16_t>(y), static_cast<uint16_t>(first_x), static_cast<uint16_t>(last_x), index});
+                row_offsets[y + 1]++;
+            }
+        }
+
+        // Counting sort by row, stable so every list stays in light order
+        for(uint32_t y = 0; y < tile_count_y; y++) {
+            row_offsets[y + 1] += row_offsets[y];
+        }
+        sorted_spans.resize(spans.size());
+        for(const Span& span : spans) {
+            sorted_spans[row_offsets[span.row]++] = span;
+        }
+
+        // `row_offsets[y]` is now where row y + 1 starts
+        uint32_t span_index = 0;
+        for(uint32_t y = 0; y < tile_count_y; y++) {
+            uint32_t* row = &tiles[static_cast<size_t>(y) * tile_count_x * k_light_tile_stride];
+            for(uint32_t x = 0; x < tile_count_x; x++) {
+                row[x * k_light_tile_stride] = 0;
+            }
+
+            for(; span_index < row_offsets[y]; span_index++) {
+                const Span& span = sorted_spans[span_index];
+                uint32_t* tile = row + span.first_x * k_light_tile_stride;
+                for(uint32_t x = span.first_x; x <= span.last_x; x++, tile += k_light_tile_stride) {
+                    uint32_t light_count = tile[0];
+                    if(light_count == k_max_lights_per_tile) {
+                        overflow_count++;
+                        continue;
+                    }
+                    tile[1 + light_count] = span.light;
+                    tile[0] = light_count + 1;
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "../Core/Core.h"
+#include "SpriteInstance.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    // Screen tiles are this many pixels on a side, one workgroup each in
+    // LightCulling.comp
+    static const uint32_t k_light_tile_size = 16;
+    // A tile's list is a count followed by this many light indices, lights
+    // past it are dropped
+    static const uint32_t k_max_lights_per_tile = 255;
+    static const uint32_t k_light_tile_stride = k_max_lights_per_tile + 1;
+
+    /// A point or spot light in the same space as the sprites. The layout
+    /// matches `Light2D` in LightCulling.comp and LitSpriteShader.frag.
+    ///
+    /// `radius`: Distance at which the light fades out completely
+    /// `height`: Above the sprite plane, the flatter the light the more its
+    ///     intensity falls off with distance
+    /// `direction`: Where a spot light points, normalized
+    /// `cos_inner`, `cos_outer`: Cosines of the spot cone's half angles, full
+    ///     intensity inside the inner one and none outside the outer one.
+    ///     Both at -1 makes a point light.
+    struct PAOPU_API Light2D {
+        glm::vec2 position{0.0f, 0.0f};
+        float radius{128.0f};
+        float height{32.0f};
+        glm::vec3 color{1.0f, 1.0f, 1.0f};
+        float intensity{1.0f};
+        glm::vec2 direction{1.0f, 0.0f};
+        float cos_inner{-1.0f};
+        float cos_outer{-1.0f};
+    };
+
+    static_assert(sizeof(Light2D) == 48, "Light2D must match the shaders' std430 layout");
+
+    /// Uniform block shared by LightCulling.comp and LitSpriteShader.frag,
+    /// std140. Pushed to the uniform ring once per frame.
+    ///
+    struct PAOPU_API LightingParams {
+        glm::vec2 camera_scale{1.0f, 1.0f};
+        glm::vec2 camera_offset{0.0f, 0.0f};
+        glm::vec2 extent{0.0f, 0.0f};
+        uint32_t tile_count_x{0};
+        uint32_t tile_count_y{0};
+        glm::vec4 ambient{0.0f, 0.0f, 0.0f, 0.0f};
+        uint32_t light_count{0};
+        uint32_t padding[3]{};
+    };
+
+    static_assert(sizeof(LightingParams) == 64, "LightingParams must match the shaders' std140 layout");
+
+    /// Tiles needed to cover `pixels` along one axis
+    ///
+    ///
+    inline uint32_t get_light_tile_count(uint32_t pixels) {
+        return (pixels + k_light_tile_size - 1) / k_light_tile_size;
+    }
+
+    /// Bins lights into screen tiles on the CPU with the same test and
+    /// output layout as LightCulling.comp, a count and then the light
+    /// indices for every tile. It is the reference the GPU pass is checked
+    /// against and what the lighting benchmark measures without a device.
+    ///
+    /// Lights are scattered rather than gathered: for each row of tiles a
+    /// light reaches, the span of tiles whose closest point is inside its
+    /// radius is worked out directly, so no tile is tested one by one. The
+    /// spans are then sorted by row and written a row at a time, which keeps
+    /// the writes inside one row's lists instead of all over the grid.
+    class PAOPU_API LightTileGrid {
+
+        public:
+            /// Bins `count` lights for a `width` x `height` target seen
+            /// through `camera`, see SpriteCamera
+            ///
+            void cull(const Light2D* lights, uint32_t count, const SpriteCamera& camera, uint32_t width, uint32_t height);
+
+            inline uint32_t get_tile_count_x() const { return tile_count_x; }
+            inline uint32_t get_tile_count_y() const { return tile_count_y; }
+
+            /// Lights touching a tile, and their indices
+            ///
+            ///
+            inline uint32_t get_light_count(uint32_t tile_x, uint32_t tile_y) const { return tiles[(tile_y * tile_count_x + tile_x) * k_light_tile_stride]; }
+            inline const uint32_t* get_lights(uint32_t tile_x, uint32_t tile_y) const { return &tiles[(tile_y * tile_count_x + tile_x) * k_light_tile_stride + 1]; }
+
+            /// Whole grid as LightCulling.comp writes it
+            ///
+            ///
+            inline const std::vector<uint32_t>& get_tiles() const { return tiles; }
+
+            /// Light indices dropped because a tile was full
+            ///
+            ///
+            inline uint32_t get_overflow_count() const { return overflow_count; }
+
+        private:
+            /// Tiles `first_x` to `last_x` of a row a light reaches
+            struct Span {
+                uint16_t row;
+                uint16_t first_x;
+                uint16_t last_x;
+                uint32_t light;
+            };
+
+            std::vector<uint32_t> tiles;
+            std::vector<Span> spans;
+            std::vector<Span> sorted_spans;
+            // Where each row's spans start in `sorted_spans`
+            std::vector<uint32_t> row_offsets;
+            uint32_t tile_count_x{0};
+            uint32_t tile_count_y{0};
+            uint32_t overflow_count{0};
+    };
+
+}
@@ -0,0 +1,36 @@
+#include "PostProcess.h"
+
+#include <algorithm>
+
+namespace Paopu {
+
+    uint32_t get_bloom_mip_count(uint32_t width, uint32_t height, uint32_t downscale) {
+        uint32_t size = std::min(width, height) >> downscale;
+        uint32_t count = 0;
+        while(count < k_max_bloom_mips && size >= k_min_bloom_mip_size) {
+            size >>= 1;
+            count++;
+        }
+        // Even a tiny target gets the one mip the composite reads
+        return std::max(count, 1u);
+    }
+
+    void build_identity_grading_lut(uint32_t size, std::vector<uint8_t>& texels) {
+        texels.resize(static_cast<size_t>(size) * size * size * 4);
+
+        const float scale = size > 1 ? 255.0f / (size - 1) : 0.0f;
+        uint8_t* texel = texels.data();
+        for(uint32_t b = 0; b < size; b++) {
+            for(uint32_t g = 0; g < size; g++) {
+                for(uint32_t r = 0; r < size; r++) {
+                    texel[0] = static_cast<uint8_t>(r * scale + 0.5f);
+                    texel[1] = static_cast<uint8_t>(g * scale + 0.5f);
+                    texel[2] = static_cast<uint8_t>(b * scale + 0.5f);
+                    texel[3] = 255;
+                    texel += 4;
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    // Most mips the bloom chain goes down, and the smallest side a mip can have
+    static const uint32_t k_max_bloom_mips = 6;
+    static const uint32_t k_min_bloom_mip_size = 8;
+    // Side of the identity grading LUT post processing starts with
+    static const uint32_t k_default_grading_lut_size = 32;
+
+    enum class PostTonemap : uint32_t {
+        None = 0,
+        Reinhard,
+        Aces
+    };
+
+    /// What the post stack does to a frame, see Renderer::enable_post_processing.
+    /// Effects are off at their zero value and cost nothing but a branch.
+    ///
+    /// `exposure`: Scene colors are scaled by it before tonemapping
+    /// `bloom_intensity`: How much of the blurred highlights are added back,
+    ///     0 skips the bloom passes
+    /// `bloom_threshold`, `bloom_knee`: Brightness bloom starts at, and the
+    ///     width of the soft ramp around it
+    /// `bloom_radius`: Spread of each upsample, 1 is a one texel tent
+    /// `bloom_downscale`: The chain starts at half resolution at 1, at
+    ///     quarter resolution at 2
+    /// `lut_strength`: Blend towards the color grading LUT, see
+    ///     Renderer::set_color_grading_lut
+    /// `vignette_radius`, `vignette_softness`: Distance from the center,
+    ///     in screen heights, the vignette is fully dark at, and how far
+    ///     inside of that it starts
+    /// `crt_curvature`: Barrel distortion of a CRT screen
+    /// `crt_scanlines`, `crt_mask`: Darkening of every other row and of
+    ///     the other two channels of each RGB column triad
+    /// `pixel_size`: Output pixels per pixel of the scene, for pixel art
+    /// `posterize_levels`: Levels per channel the output is quantized to
+    struct PAOPU_API PostSettings {
+        float exposure{1.0f};
+
+        float bloom_intensity{0.5f};
+        float bloom_threshold{1.0f};
+        float bloom_knee{0.5f};
+        float bloom_radius{1.0f};
+        uint32_t bloom_downscale{1};
+
+        PostTonemap tonemap{PostTonemap::Aces};
+        float lut_strength{0.0f};
+
+        float vignette_intensity{0.0f};
+        float vignette_radius{0.75f};
+        float vignette_softness{0.45f};
+
+        float crt_curvature{0.0f};
+        float crt_scanlines{0.0f};
+        float crt_mask{0.0f};
+
+        uint32_t pixel_size{1};
+        uint32_t posterize_levels{0};
+    };
+
+    /// Uniform block of the post passes, std140. Pushed to the uniform ring
+    /// once per frame.
+    ///
+    struct PAOPU_API PostParams {
+        glm::vec2 extent{0.0f, 0.0f};
+        glm::vec2 inverse_extent{0.0f, 0.0f};
+        // Of the first bloom mip
+        glm::vec2 bloom_texel{0.0f, 0.0f};
+        float exposure{1.0f};
+        float bloom_intensity{0.0f};
+        float bloom_threshold{1.0f};
+        float bloom_knee{0.5f};
+        uint32_t tonemap{0};
+        float lut_strength{0.0f};
+        float lut_size{1.0f};
+        float vignette_intensity{0.0f};
+        float vignette_radius{0.0f};
+        float vignette_softness{0.0f};
+        float crt_curvature{0.0f};
+        float crt_scanlines{0.0f};
+        float crt_mask{0.0f};
+        float pixel_size{1.0f};
+        uint32_t posterize_levels{0};
+        // Set when the target stores what it's given, the shader then
+        // encodes sRGB itself
+        uint32_t encode_srgb{0};
+        uint32_t padding[2]{};
+    };
+
+    static_assert(sizeof(PostParams) == 96, "PostParams must match the shaders' std140 layout");
+
+    /// Push constant block of BloomDownsample.comp and BloomUpsample.comp,
+    /// one dispatch per mip
+    ///
+    struct PAOPU_API BloomPassConstants {
+        glm::vec2 source_texel{0.0f, 0.0f};
+        glm::uvec2 target_size{0, 0};
+        // Set on the first downsample, which thresholds the scene
+        uint32_t prefilter{0};
+        float radius{1.0f};
+        uint32_t padding[2]{};
+    };
+
+    /// Mips in the bloom chain of a `width` x `height` scene, the first one
+    /// `downscale` times halved
+    ///
+    PAOPU_API uint32_t get_bloom_mip_count(uint32_t width, uint32_t height, uint32_t downscale);
+
+    /// Fills `texels` with a `size` cubed RGBA8 LUT that leaves colors as
+    /// they are, red varying fastest, then green, then blue
+    ///
+    PAOPU_API void build_identity_grading_lut(uint32_t size, std::vector<uint8_t>& texels);
+
+}
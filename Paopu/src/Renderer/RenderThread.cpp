@@ -0,0 +1,135 @@
+#include "RenderThread.h"
+#include "../Core/Profiler.h"
+#include "../Core/Time.h"
+
+#include <algorithm>
+
+namespace Paopu {
+
+    RenderThread::~RenderThread() {
+        stop();
+    }
+
+    void RenderThread::start(uint32_t latency_frames, RenderSnapshotFn render, void* user_data) {
+        this->render = render;
+        this->user_data = user_data;
+        snapshot_count = std::min(latency_frames, k_max_latency_frames) + 1;
+
+        submitted = 0;
+        rendered = 0;
+        stopping = false;
+        error = nullptr;
+        stats = RenderThreadStats{};
+
+        if(snapshot_count > 1) {
+            thread = std::thread(&RenderThread::thread_loop, this);
+        }
+    }
+
+    void RenderThread::stop() {
+        if(!thread.joinable()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        submitted_condition.notify_one();
+        thread.join();
+    }
+
+    RenderSnapshot& RenderThread::begin_snapshot() {
+        if(!thread.joinable()) return snapshots[0];
+
+        uint64_t wait_start_ns = get_time_ns();
+        {
+            PAO_PROFILE_SCOPE("Wait for render thread");
+            std::unique_lock<std::mutex> lock(mutex);
+            rendered_condition.wait(lock, [this]() { return submitted - rendered < snapshot_count || error; });
+            stats.frame_wait_ns += get_time_ns() - wait_start_ns;
+        }
+        check_error();
+
+        // Only the frame thread changes `submitted`, reading it unlocked is fine
+        return snapshots[submitted % snapshot_count];
+    }
+
+    void RenderThread::submit_snapshot() {
+        if(!thread.joinable()) {
+            uint64_t render_start_ns = get_time_ns();
+            render(snapshots[0], user_data);
+            stats.render_ns += get_time_ns() - render_start_ns;
+            stats.frames++;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            submitted++;
+        }
+        submitted_condition.notify_one();
+    }
+
+    void RenderThread::wait_idle() {
+        if(!thread.joinable()) return;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rendered_condition.wait(lock, [this]() { return rendered == submitted || error; });
+        }
+        check_error();
+    }
+
+    RenderThreadStats RenderThread::get_stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    void RenderThread::check_error() {
+        std::exception_ptr thrown;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            thrown = error;
+        }
+        if(thrown) {
+            std::rethrow_exception(thrown);
+        }
+    }
+
+    void RenderThread::thread_loop() {
+        PAO_PROFILE_THREAD("Render");
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while(true) {
+            uint64_t wait_start_ns = get_time_ns();
+            // Whatever is queued is still drawn when stopping
+            submitted_condition.wait(lock, [this]() { return rendered < submitted || stopping; });
+            if(rendered == submitted) return;
+
+            uint64_t render_start_ns = get_time_ns();
+            stats.render_wait_ns += render_start_ns - wait_start_ns;
+            const RenderSnapshot& snapshot = snapshots[rendered % snapshot_count];
+            lock.unlock();
+
+            std::exception_ptr thrown;
+            try {
+                PAO_PROFILE_SCOPE("Render snapshot");
+                render(snapshot, user_data);
+            } catch (...) {
+                thrown = std::current_exception();
+            }
+
+            lock.lock();
+            stats.render_ns += get_time_ns() - render_start_ns;
+            stats.frames++;
+            rendered++;
+            // Sticks, the frame thread rethrows it from then on
+            error = thrown;
+            lock.unlock();
+            rendered_condition.notify_one();
+
+            if(thrown) return;
+            lock.lock();
+        }
+    }
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include "../Core/Core.h"
+#include "LightCulling.h"
+#include "PostProcess.h"
+#include "SpriteInstance.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Paopu {
+
+    /// Everything the render thread needs to draw one frame, written by the
+    /// frame thread and read-only once submitted. Snapshots are reused, so
+    /// `sprites` and `lights` stop allocating once they have grown to the scene.
+    ///
+    /// `camera`: Used when `has_camera` is set, pixel coordinates otherwise
+    /// `lights`, `ambient`: Light the sprites when `has_lighting` is set, see
+    ///     Renderer::enable_lighting. The first such frame turns lighting on.
+    /// `post_settings`: Draws the frame through the post stack when
+    ///     `has_post_processing` is set, see Renderer::enable_post_processing.
+    ///     The first such frame builds the stack.
+    struct PAOPU_API RenderSnapshot {
+        uint64_t frame{0};
+        double frame_time{0.0};
+        double interpolation{0.0};
+        bool has_camera{false};
+        SpriteCamera camera{};
+        std::vector<SpriteInstance> sprites;
+        bool has_lighting{false};
+        std::vector<Light2D> lights;
+        glm::vec3 ambient{0.0f};
+        bool has_post_processing{false};
+        PostSettings post_settings{};
+    };
+
+    /// Draws a submitted snapshot. Runs on the render thread.
+    using RenderSnapshotFn = void(*)(const RenderSnapshot& snapshot, void* user_data);
+
+    /// Time both sides spent waiting on each other, in nanoseconds. A frame
+    /// thread that waits is render bound, a render thread that waits is
+    /// simulation bound.
+    ///
+    struct PAOPU_API RenderThreadStats {
+        uint64_t frames{0};
+        uint64_t frame_wait_ns{0};
+        uint64_t render_wait_ns{0};
+        uint64_t render_ns{0};
+    };
+
+    /// Renders snapshots on a thread of its own, so frame N+1 is simulated
+    /// while frame N is recorded and submitted.
+    ///
+    /// Snapshots form a ring of `latency_frames + 1`: with a latency of 1 they
+    /// are double buffered and the simulation runs at most one frame ahead, 2
+    /// triple buffers them for more slack at the cost of another frame of
+    /// latency. `begin_snapshot` blocks while every snapshot is still queued
+    /// or being drawn, which is what bounds the latency. A latency of 0 runs
+    /// no thread and draws each snapshot as it's submitted.
+    ///
+    class PAOPU_API RenderThread {
+
+        public:
+            static const uint32_t k_max_latency_frames = 2;
+
+            RenderThread() = default;
+            ~RenderThread();
+
+            RenderThread(const RenderThread&) = delete;
+            RenderThread& operator=(const RenderThread&) = delete;
+
+            /// `latency_frames` is clamped to `k_max_latency_frames`
+            ///
+            ///
+            void start(uint32_t latency_frames, RenderSnapshotFn render, void* user_data);
+
+            /// Drains the queued snapshots and joins the thread. Safe to call
+            /// more than once.
+            ///
+            void stop();
+
+            /// The snapshot to fill for the next frame. Waits until the render
+            /// thread is done with it, and rethrows anything the render thread threw.
+            ///
+            RenderSnapshot& begin_snapshot();
+
+            /// Queues the snapshot from `begin_snapshot` for rendering
+            ///
+            ///
+            void submit_snapshot();
+
+            /// Returns once every submitted snapshot has been drawn, e.g. before
+            /// touching the renderer from the frame thread
+            ///
+            void wait_idle();
+
+            inline uint32_t get_latency_frames() const { return snapshot_count - 1; }
+            RenderThreadStats get_stats() const;
+
+        private:
+            /// Draws queued snapshots in order until stopped
+            ///
+            ///
+            void thread_loop();
+
+            /// Rethrows what the render thread threw, on the frame thread
+            ///
+            ///
+            void check_error();
+
+        private:
+            RenderSnapshot snapshots[k_max_latency_frames + 1];
+            uint32_t snapshot_count{1};
+
+            RenderSnapshotFn render{nullptr};
+            void* user_data{nullptr};
+
+            // Snapshots submitted and drawn so far, the ring index is the count
+            // modulo `snapshot_count`. Both are guarded by `mutex`.
+            uint64_t submitted{0};
+            uint64_t rendered{0};
+            bool stopping{false};
+            std::exception_ptr error;
+
+            mutable std::mutex mutex;
+            // Signaled when a snapshot is submitted or the thread should stop
+            std::condition_variable submitted_condition;
+            // Signaled when a snapshot was drawn
+            std::condition_variable rendered_condition;
+            std::thread thread;
+
+            // Guarded by `mutex`, both threads add to it
+            RenderThreadStats stats;
+    };
+
+}
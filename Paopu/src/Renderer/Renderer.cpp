@@ -2,10 +2,44 @@
 #include "../Core/Window.h"
 #include "VulkanBackend/Swapchain.h"
 #include <stdexcept>
+#include <algorithm>
 #include <cstring>
+#include <cstddef>
 #include <set>
 
 namespace Paopu {
+
+    // Uniform bytes each frame can push, and the largest block
+    static const VkDeviceSize k_uniform_frame_size = 1024 * 1024;
+    static const VkDeviceSize k_uniform_block_range = 1024;
+
+    // See SpriteInstance.h
+    static const PaopuPushConstant<SpriteCamera> k_sprite_camera{VK_SHADER_STAGE_VERTEX_BIT, 0};
+
+    // Sprites are drawn into it once post processing is enabled, the bloom
+    // chain and the intermediate output share it
+    static const VkFormat k_scene_format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    // See PostProcess.h
+    static const PaopuPushConstant<BloomPassConstants> k_bloom_pass{VK_SHADER_STAGE_COMPUTE_BIT, 0};
+    // Invocations along each side of a post workgroup
+    static const uint32_t k_post_group_size = 8;
+
+    /// Formats that encode sRGB when they're written
+    static bool is_srgb_format(VkFormat format) {
+        switch(format) {
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /// Workgroups needed to cover `pixels` along one axis
+    static uint32_t get_post_group_count(uint32_t pixels) {
+        return (pixels + k_post_group_size - 1) / k_post_group_size;
+    }
  
     /// Creates the debug messenger
     VkResult CreateDebugUtilsMessengerEXT(  VkInstance instance,
@@ -39,26 +73,98 @@ namespace Paopu {
     }
 
     void Renderer::free_renderer() {
+        vkDeviceWaitIdle(device->logical_device);
+
+        for(uint32_t i = 0; i < k_max_frames_in_flight; i++) {
+            FrameResources& frame = frames[i];
+            // See Buffer.h
+            for(PaopuBuffer* buffer : {&frame.instance_buffer, &frame.light_buffer, &frame.light_tile_buffer}) {
+                if(buffer->buffer != VK_NULL_HANDLE) {
+                    free_buffer(device->logical_device, buffer);
+                }
+            }
+            free_retired_textures(i);
 
-        vkDestroyPipelineLayout(device->logical_device, pipeline_layout, nullptr);
+            vkDestroyQueryPool(device->logical_device, frame.timestamp_pool, get_host_allocator());
+            vkDestroyFence(device->logical_device, frame.fence, get_host_allocator());
+            if(frame.image_available != VK_NULL_HANDLE) {
+                vkDestroySemaphore(device->logical_device, frame.image_available, get_host_allocator());
+            }
+            frames[i] = FrameResources{};
+        }
 
-        // See Swapchain.h
-        free_swapchain(device->logical_device, swapchain);
+        // See Texture.h
+        for(PaopuTexture& texture : textures) {
+            if(texture.image != VK_NULL_HANDLE) {
+                free_texture(device->logical_device, &texture);
+            }
+        }
+        for(TextureUpload& upload : texture_uploads) {
+            free_buffer(device->logical_device, &upload.staging);
+        }
+        textures.clear();
+        texture_uploads.clear();
+
+        // See RenderImage.h
+        free_post_targets();
+        if(grading_lut.image != VK_NULL_HANDLE) {
+            free_render_image(device->logical_device, &grading_lut);
+        }
+
+        // See Uniforms.h
+        free_uniform_ring(device->logical_device, &uniform_ring);
+        // See Descriptors.h
+        descriptor_allocator.free();
+        descriptor_layouts.free();
+
+        vkDestroyCommandPool(device->logical_device, command_pool, get_host_allocator());
+
+        vkDestroyPipeline(device->logical_device, pipeline, get_host_allocator());
+        vkDestroyPipelineLayout(device->logical_device, pipeline_layout, get_host_allocator());
+        if(lit_pipeline_layout != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device->logical_device, lit_pipeline, get_host_allocator());
+            vkDestroyPipelineLayout(device->logical_device, lit_pipeline_layout, get_host_allocator());
+            vkDestroyPipeline(device->logical_device, culling_pipeline, get_host_allocator());
+            vkDestroyPipelineLayout(device->logical_device, culling_pipeline_layout, get_host_allocator());
+        }
+        if(post_pipeline_layout != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device->logical_device, bloom_downsample_pipeline, get_host_allocator());
+            vkDestroyPipeline(device->logical_device, bloom_upsample_pipeline, get_host_allocator());
+            vkDestroyPipeline(device->logical_device, composite_pipeline, get_host_allocator());
+            vkDestroyPipelineLayout(device->logical_device, post_pipeline_layout, get_host_allocator());
+            vkDestroySampler(device->logical_device, post_sampler, get_host_allocator());
+        }
+
+        if(headless) {
+            // See Offscreen.h
+            free_offscreen_target(device->logical_device, &offscreen_target);
+        } else {
+            for(size_t i = 0; i < swapchain_framebuffers.size(); i++) {
+                vkDestroyFramebuffer(device->logical_device, swapchain_framebuffers[i], get_host_allocator());
+                vkDestroySemaphore(device->logical_device, render_finished[i], get_host_allocator());
+            }
+            // See Swapchain.h
+            free_swapchain(device->logical_device, swapchain);
+        }
+        vkDestroyRenderPass(device->logical_device, render_pass, get_host_allocator());
         delete swapchain;
 
         // See Device.h
         free_device(device);
         delete device;
+        device = nullptr;
 
         if(k_enable_validation_layers) {
-            DestroyDebugUtilsMessengerEXT(instance, debug_messenger, nullptr);
+            DestroyDebugUtilsMessengerEXT(instance, debug_messenger, get_host_allocator());
         }
 
-        vkDestroySurfaceKHR(instance, surface, nullptr);
-        vkDestroyInstance(instance, nullptr);
+        if(surface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(instance, surface, get_host_allocator());
+        }
+        vkDestroyInstance(instance, get_host_allocator());
     }
 
-    std::vector<char> Renderer::read_shader(const std::string& file_name) {
+    void Renderer::read_shader(const std::string& file_name, std::vector<uint8_t>& buffer) {
         std::ifstream file(file_name, std::ios::ate | std::ios::binary);
 
         if(!file.is_open()) {
@@ -66,14 +172,34 @@ namespace Paopu {
         }
 
         size_t file_size = (size_t)file.tellg();
-        std::vector<char> buffer(file_size);
+        buffer.resize(file_size);
 
         file.seekg(0);
-        file.read(buffer.data(), file_size);
+        file.read(reinterpret_cast<char*>(buffer.data()), file_size);
 
         file.close();
+    }
+
+    AssetView Renderer::load_shader(const char* name, std::vector<uint8_t>& buffer) {
+        if(asset_archive != nullptr) {
+            std::string archive_name = std::string("Shaders/") + name;
+            const AssetArchiveEntry* entry = asset_archive->find(hash_asset_name(archive_name.c_str()));
+            if(entry == nullptr) {
+                throw std::runtime_error("[Renderer][Vulkan]: " + archive_name + " is missing from the asset archive!");
+            }
+            if(entry->compression == AssetCompression::None) {
+                return asset_archive->get_view(entry->id);
+            }
 
-        return buffer;
+            buffer.resize(static_cast<size_t>(entry->size));
+            if(!asset_archive->read(*entry, buffer.data())) {
+                throw std::runtime_error("[Renderer][Vulkan]: " + archive_name + " in the asset archive is corrupt!");
+            }
+            return {buffer.data(), buffer.size()};
+        }
+
+        read_shader(std::string("Paopu/src/Renderer/Shaders/SPVs/") + name, buffer);
+        return {buffer.data(), buffer.size()};
     }
 
     // --------------------------------------------------------------------
@@ -81,6 +207,7 @@ namespace Paopu {
     // --------------------------------------------------------------------
 
     void Renderer::init_backend(PaopuWindow* window) {
+        this->window = window;
         device = new PaopuDevice();
         swapchain = new PaopuSwapchain();
         create_instance();
@@ -88,8 +215,1160 @@ namespace Paopu {
         create_surface(window);
         select_physical_device();
         create_logical_device();
+        query_texture_formats();
         create_swapchain(window);
-        create_pipeline();
+        create_image_views();
+        create_render_pass(swapchain->image_format, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        create_pipeline(swapchain->extent);
+        create_framebuffers();
+        create_frame_resources();
+    }
+
+    void Renderer::init_headless(uint32_t width, uint32_t height) {
+        headless = true;
+        surface = VK_NULL_HANDLE;
+        device = new PaopuDevice();
+
+        create_instance();
+        setup_debug_messenger();
+        select_physical_device();
+        create_logical_device();
+        query_texture_formats();
+
+        offscreen_target.format = VK_FORMAT_R8G8B8A8_UNORM;
+        offscreen_target.extent = {width, height};
+
+        // The target is copied to a buffer after the pass, so leave it ready
+        // to be transferred from.
+        create_render_pass(offscreen_target.format, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        // See Offscreen.h
+        build_offscreen_target(device, render_pass, &offscreen_target);
+        create_pipeline(offscreen_target.extent);
+        create_frame_resources();
+    }
+
+    void Renderer::create_frame_resources() {
+        QueueFamilyIndices indices = find_queue_families(device->physical_device, surface);
+
+        VkCommandPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        pool_info.queueFamilyIndex = indices.graphics_family.value();
+
+        if(vkCreateCommandPool(device->logical_device, &pool_info, get_host_allocator(), &command_pool) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Command pool creation failed!");
+        }
+
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = command_pool;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+
+        VkFenceCreateInfo fence_info{};
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VkSemaphoreCreateInfo semaphore_info{};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        // Two timestamps, begin and end, per pass
+        VkQueryPoolCreateInfo query_info{};
+        query_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        query_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        query_info.queryCount = k_max_gpu_passes * 2;
+
+        for(FrameResources& frame : frames) {
+            if(vkAllocateCommandBuffers(device->logical_device, &alloc_info, &frame.command_buffer) != VK_SUCCESS) {
+                throw std::runtime_error("[Renderer][Vulkan]: Command buffer allocation failed!");
+            }
+
+            if(vkCreateFence(device->logical_device, &fence_info, get_host_allocator(), &frame.fence) != VK_SUCCESS) {
+                throw std::runtime_error("[Renderer][Vulkan]: Frame fence creation failed!");
+            }
+
+            if(!headless && vkCreateSemaphore(device->logical_device, &semaphore_info, get_host_allocator(), &frame.image_available) != VK_SUCCESS) {
+                throw std::runtime_error("[Renderer][Vulkan]: Frame semaphore creation failed!");
+            }
+
+            if(vkCreateQueryPool(device->logical_device, &query_info, get_host_allocator(), &frame.timestamp_pool) != VK_SUCCESS) {
+                throw std::runtime_error("[Renderer][Vulkan]: Timestamp query pool creation failed!");
+            }
+        }
+        command_buffer = frames[frame_index].command_buffer;
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device->physical_device, &properties);
+        timestamp_period = properties.limits.timestampPeriod;
+
+        // A frame's sets and uniforms are only released once its fence has
+        // signaled, so each frame in flight gets pools and a ring region
+        PaopuDescriptorAllocatorSettings descriptor_settings;
+        descriptor_settings.frame_count = k_max_frames_in_flight;
+        descriptor_layouts.init(device->logical_device);
+        descriptor_allocator.init(device->logical_device, descriptor_settings);
+
+        // See Uniforms.h
+        build_uniform_ring(device, k_uniform_frame_size, descriptor_settings.frame_count, k_uniform_block_range, &uniform_ring);
+
+        // Bound once per pass, blocks are picked with the dynamic offset
+        VkDescriptorSetLayoutBinding uniform_binding{};
+        uniform_binding.binding = 0;
+        uniform_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        uniform_binding.descriptorCount = 1;
+        uniform_binding.stageFlags = VK_SHADER_STAGE_ALL;
+        uniform_layout = descriptor_layouts.get_layout(&uniform_binding, 1);
+
+        PaopuDescriptorWriter uniform_writer;
+        uniform_writer.write_buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, uniform_ring.buffer.buffer, 0, uniform_ring.range);
+        uniform_set = descriptor_allocator.get_persistent(uniform_layout, uniform_writer);
+    }
+
+    void Renderer::reserve_instances(uint32_t count) {
+        FrameResources& frame = frames[frame_index];
+        if(count <= frame.instance_capacity) return;
+
+        // Grow geometrically so stress scenes settle after a few frames
+        uint32_t new_capacity = frame.instance_capacity == 0 ? 1024 : frame.instance_capacity;
+        while(new_capacity < count) {
+            new_capacity *= 2;
+        }
+
+        if(frame.instance_buffer.buffer != VK_NULL_HANDLE) {
+            free_buffer(device->logical_device, &frame.instance_buffer);
+        }
+
+        // See Buffer.h
+        create_buffer(device, sizeof(SpriteInstance) * new_capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.instance_buffer);
+        frame.instance_capacity = new_capacity;
+    }
+
+    void Renderer::enable_lighting() {
+        if(lit_pipeline_layout != VK_NULL_HANDLE) return;
+
+        // Both passes see the lights and the tile lists, see LightCulling.h
+        VkDescriptorSetLayoutBinding lighting_bindings[2]{};
+        lighting_bindings[0].binding = 0;
+        lighting_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        lighting_bindings[0].descriptorCount = 1;
+        lighting_bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        lighting_bindings[1] = lighting_bindings[0];
+        lighting_bindings[1].binding = 1;
+        lighting_layout = descriptor_layouts.get_layout(lighting_bindings, 2);
+
+        // Set 0 is the uniform ring holding LightingParams
+        VkDescriptorSetLayout set_layouts[] = {uniform_layout, lighting_layout};
+        VkPushConstantRange camera_range = k_sprite_camera.get_range();
+
+        VkPipelineLayoutCreateInfo layout_info{};
+        layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layout_info.setLayoutCount = 2;
+        layout_info.pSetLayouts = set_layouts;
+
+        if(vkCreatePipelineLayout(device->logical_device, &layout_info, get_host_allocator(), &culling_pipeline_layout) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Light culling pipeline layout creation failed!");
+        }
+
+        layout_info.pushConstantRangeCount = 1;
+        layout_info.pPushConstantRanges = &camera_range;
+
+        if(vkCreatePipelineLayout(device->logical_device, &layout_info, get_host_allocator(), &lit_pipeline_layout) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Lit sprite pipeline layout creation failed!");
+        }
+
+        culling_pipeline = create_compute_pipeline("LightCulling.comp.spv", culling_pipeline_layout);
+
+        // The sprite pipelines are rebuilt with the lit one next to them
+        vkDeviceWaitIdle(device->logical_device);
+        vkDestroyPipeline(device->logical_device, pipeline, get_host_allocator());
+        vkDestroyPipelineLayout(device->logical_device, pipeline_layout, get_host_allocator());
+        create_pipeline(headless ? offscreen_target.extent : swapchain->extent);
+    }
+
+    VkPipeline Renderer::create_compute_pipeline(const char* shader_name, VkPipelineLayout layout) {
+        std::vector<uint8_t> comp_buffer;
+        VkShaderModule comp_shader_module = create_shader_module(load_shader(shader_name, comp_buffer));
+
+        VkComputePipelineCreateInfo pipeline_info{};
+        pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipeline_info.stage.module = comp_shader_module;
+        pipeline_info.stage.pName = "main";
+        pipeline_info.layout = layout;
+
+        VkPipeline compute_pipeline;
+        if(vkCreateComputePipelines(device->logical_device, VK_NULL_HANDLE, 1, &pipeline_info, get_host_allocator(), &compute_pipeline) != VK_SUCCESS) {
+            throw std::runtime_error(std::string("[Renderer][Vulkan]: Compute pipeline creation failed for ") + shader_name + "!");
+        }
+        vkDestroyShaderModule(device->logical_device, comp_shader_module, get_host_allocator());
+        return compute_pipeline;
+    }
+
+    void Renderer::set_lights(const Light2D* lights, uint32_t count, glm::vec3 ambient) {
+        this->lights.assign(lights, lights + count);
+        this->ambient = ambient;
+    }
+
+    void Renderer::reserve_lights(uint32_t count) {
+        FrameResources& frame = frames[frame_index];
+        // Bound even without lights
+        count = std::max(count, 1u);
+        if(count <= frame.light_capacity) return;
+
+        uint32_t new_capacity = frame.light_capacity == 0 ? 256 : frame.light_capacity;
+        while(new_capacity < count) {
+            new_capacity *= 2;
+        }
+
+        if(frame.light_buffer.buffer != VK_NULL_HANDLE) {
+            free_buffer(device->logical_device, &frame.light_buffer);
+        }
+
+        // See Buffer.h
+        create_buffer(device, sizeof(Light2D) * new_capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.light_buffer);
+        frame.light_capacity = new_capacity;
+    }
+
+    void Renderer::reserve_light_tiles(VkExtent2D extent) {
+        FrameResources& frame = frames[frame_index];
+        uint32_t tile_count_x = get_light_tile_count(extent.width);
+        uint32_t tile_count_y = get_light_tile_count(extent.height);
+        if(tile_count_x == frame.light_tile_count_x && tile_count_y == frame.light_tile_count_y) return;
+
+        if(frame.light_tile_buffer.buffer != VK_NULL_HANDLE) {
+            free_buffer(device->logical_device, &frame.light_tile_buffer);
+        }
+
+        // Only ever touched by the GPU. A copy per frame, so one frame's
+        // culling doesn't overwrite the lists the previous one still reads.
+        VkDeviceSize size = sizeof(uint32_t) * k_light_tile_stride * tile_count_x * tile_count_y;
+        create_buffer(device, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &frame.light_tile_buffer);
+        frame.light_tile_count_x = tile_count_x;
+        frame.light_tile_count_y = tile_count_y;
+    }
+
+    void Renderer::record_light_culling(const SpriteCamera& camera, VkExtent2D extent) {
+        FrameResources& frame = frames[frame_index];
+
+        LightingParams params;
+        params.camera_scale = camera.scale;
+        params.camera_offset = camera.offset;
+        params.extent = glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+        params.tile_count_x = frame.light_tile_count_x;
+        params.tile_count_y = frame.light_tile_count_y;
+        params.ambient = glm::vec4(ambient, 0.0f);
+        params.light_count = static_cast<uint32_t>(lights.size());
+        uint32_t params_offset = push_uniforms(params);
+
+        // From this frame's pools, so resized buffers are picked up as they are
+        VkDescriptorSet lighting_set = descriptor_allocator.allocate(lighting_layout);
+        lighting_writer.clear();
+        lighting_writer.write_buffer(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.light_buffer.buffer, 0, VK_WHOLE_SIZE);
+        lighting_writer.write_buffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.light_tile_buffer.buffer, 0, VK_WHOLE_SIZE);
+        lighting_writer.update(device->logical_device, lighting_set);
+
+        VkDescriptorSet sets[] = {uniform_set, lighting_set};
+
+        uint32_t pass = begin_gpu_pass("light_culling");
+
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, culling_pipeline);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, culling_pipeline_layout, 0, 2, sets, 1, &params_offset);
+        // One workgroup per tile
+        vkCmdDispatch(command_buffer, frame.light_tile_count_x, frame.light_tile_count_y, 1);
+
+        end_gpu_pass(pass);
+
+        // The sprite pass reads the lists the dispatch wrote
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lit_pipeline_layout, 0, 2, sets, 1, &params_offset);
+    }
+
+    void Renderer::enable_post_processing(const PostSettings& settings) {
+        post_settings = settings;
+        if(post_layout != VK_NULL_HANDLE) return;
+
+        // Bilinear, clamped at the edges, for the scene, the bloom mips and the LUT
+        VkSamplerCreateInfo sampler_info{};
+        sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        sampler_info.magFilter = VK_FILTER_LINEAR;
+        sampler_info.minFilter = VK_FILTER_LINEAR;
+        sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+
+        if(vkCreateSampler(device->logical_device, &sampler_info, get_host_allocator(), &post_sampler) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Post processing sampler creation failed!");
+        }
+
+        // Two images read, one written and the grading LUT. Each pass binds
+        // the ones its shader uses.
+        VkDescriptorSetLayoutBinding post_bindings[4]{};
+        for(uint32_t i = 0; i < 4; i++) {
+            post_bindings[i].binding = i;
+            post_bindings[i].descriptorType = i == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            post_bindings[i].descriptorCount = 1;
+            post_bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+        post_layout = descriptor_layouts.get_layout(post_bindings, 4);
+
+        // Set 0 is the uniform ring holding PostParams
+        VkDescriptorSetLayout set_layouts[] = {uniform_layout, post_layout};
+        VkPushConstantRange bloom_range = k_bloom_pass.get_range();
+
+        VkPipelineLayoutCreateInfo layout_info{};
+        layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layout_info.setLayoutCount = 2;
+        layout_info.pSetLayouts = set_layouts;
+        layout_info.pushConstantRangeCount = 1;
+        layout_info.pPushConstantRanges = &bloom_range;
+
+        if(vkCreatePipelineLayout(device->logical_device, &layout_info, get_host_allocator(), &post_pipeline_layout) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Post processing pipeline layout creation failed!");
+        }
+
+        bloom_downsample_pipeline = create_compute_pipeline("BloomDownsample.comp.spv", post_pipeline_layout);
+        bloom_upsample_pipeline = create_compute_pipeline("BloomUpsample.comp.spv", post_pipeline_layout);
+
+        // Colors are left alone until a LUT is set
+        build_identity_grading_lut(k_default_grading_lut_size, grading_lut_texels);
+        grading_lut_size = k_default_grading_lut_size;
+        grading_lut_dirty = true;
+
+        // Sprites are drawn into the HDR scene target from now on
+        vkDeviceWaitIdle(device->logical_device);
+        vkDestroyRenderPass(device->logical_device, render_pass, get_host_allocator());
+        create_render_pass(k_scene_format, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        if(headless) {
+            // The composite writes the offscreen target, or blits into it,
+            // and nothing draws to it anymore
+            post_output_direct = can_write_post_output(offscreen_target.format, VK_IMAGE_USAGE_STORAGE_BIT);
+            // See Offscreen.h
+            free_offscreen_target(device->logical_device, &offscreen_target);
+            offscreen_target.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | (post_output_direct ? VK_IMAGE_USAGE_STORAGE_BIT : VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+            build_offscreen_target(device, VK_NULL_HANDLE, &offscreen_target);
+
+            vkDestroyPipeline(device->logical_device, pipeline, get_host_allocator());
+            vkDestroyPipelineLayout(device->logical_device, pipeline_layout, get_host_allocator());
+            if(lit_pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(device->logical_device, lit_pipeline, get_host_allocator());
+            }
+            create_pipeline(offscreen_target.extent);
+        } else {
+            // Rebuilt before the next frame, with a format the composite can
+            // store to if there is one
+            swapchain_out_of_date = true;
+        }
+    }
+
+    void Renderer::set_color_grading_lut(const uint8_t* texels, uint32_t size) {
+        if(size < 2) {
+            throw std::runtime_error("[Renderer]: A color grading LUT needs at least two texels a side!");
+        }
+        grading_lut_texels.assign(texels, texels + static_cast<size_t>(size) * size * size * 4);
+        grading_lut_size = size;
+        grading_lut_dirty = true;
+    }
+
+    bool Renderer::can_write_post_output(VkFormat format, VkImageUsageFlags supported_usage) const {
+        // The composite stores without a format qualifier, whatever the
+        // image's channel order is
+        if(!has_storage_write_without_format || (supported_usage & VK_IMAGE_USAGE_STORAGE_BIT) == 0) return false;
+
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(device->physical_device, format, &properties);
+        return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+    }
+
+    void Renderer::reserve_post_targets(VkExtent2D extent) {
+        // How the composite writes its output is only known once the
+        // swapchain is, its pipeline follows
+        if(composite_pipeline == VK_NULL_HANDLE || composite_direct != post_output_direct) {
+            if(composite_pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(device->logical_device, composite_pipeline, get_host_allocator());
+            }
+            composite_pipeline = create_compute_pipeline(post_output_direct ? "PostCompositeDirect.comp.spv" : "PostComposite.comp.spv", post_pipeline_layout);
+            composite_direct = post_output_direct;
+        }
+
+        uint32_t downscale = std::clamp(post_settings.bloom_downscale, 1u, 2u);
+        bool has_output = post_output.image != VK_NULL_HANDLE;
+        if(scene_target.image != VK_NULL_HANDLE && scene_target.extent.width == extent.width && scene_target.extent.height == extent.height
+            && downscale == bloom_downscale && has_output != post_output_direct) return;
+
+        // Every frame in flight draws through them, rare enough to just wait
+        vkDeviceWaitIdle(device->logical_device);
+        free_post_targets();
+
+        // See RenderImage.h
+        scene_target.format = k_scene_format;
+        scene_target.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        scene_target.extent = extent;
+        build_render_image(device, &scene_target);
+
+        VkFramebufferCreateInfo framebuffer_info{};
+        framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebuffer_info.renderPass = render_pass;
+        framebuffer_info.attachmentCount = 1;
+        framebuffer_info.pAttachments = &scene_target.view;
+        framebuffer_info.width = extent.width;
+        framebuffer_info.height = extent.height;
+        framebuffer_info.layers = 1;
+
+        if(vkCreateFramebuffer(device->logical_device, &framebuffer_info, get_host_allocator(), &scene_framebuffer) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Scene framebuffer creation failed!");
+        }
+
+        // Written as storage and sampled by the next pass, see PostProcess.h
+        bloom_chain.format = k_scene_format;
+        bloom_chain.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        bloom_chain.extent = {std::max(extent.width >> downscale, 1u), std::max(extent.height >> downscale, 1u)};
+        bloom_chain.mip_count = get_bloom_mip_count(extent.width, extent.height, downscale);
+        build_render_image(device, &bloom_chain);
+        bloom_downscale = downscale;
+
+        if(!post_output_direct) {
+            post_output.format = k_scene_format;
+            post_output.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            post_output.extent = extent;
+            build_render_image(device, &post_output);
+        }
+    }
+
+    void Renderer::free_post_targets() {
+        if(scene_framebuffer != VK_NULL_HANDLE) {
+            vkDestroyFramebuffer(device->logical_device, scene_framebuffer, get_host_allocator());
+            scene_framebuffer = VK_NULL_HANDLE;
+        }
+        // See RenderImage.h
+        if(scene_target.image != VK_NULL_HANDLE) {
+            free_render_image(device->logical_device, &scene_target);
+        }
+        if(bloom_chain.image != VK_NULL_HANDLE) {
+            free_render_image(device->logical_device, &bloom_chain);
+        }
+        if(post_output.image != VK_NULL_HANDLE) {
+            free_render_image(device->logical_device, &post_output);
+        }
+    }
+
+    void Renderer::record_grading_lut_upload() {
+        if(!grading_lut_dirty) return;
+        grading_lut_dirty = false;
+
+        // Frames in flight may still sample the old one
+        if(grading_lut.image != VK_NULL_HANDLE && grading_lut.depth != grading_lut_size) {
+            vkDeviceWaitIdle(device->logical_device);
+            free_render_image(device->logical_device, &grading_lut);
+        }
+        if(grading_lut.image == VK_NULL_HANDLE) {
+            grading_lut.format = VK_FORMAT_R8G8B8A8_UNORM;
+            grading_lut.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            grading_lut.extent = {grading_lut_size, grading_lut_size};
+            grading_lut.depth = grading_lut_size;
+            build_render_image(device, &grading_lut);
+        }
+
+        // See Buffer.h
+        PaopuBuffer staging;
+        create_buffer(device, grading_lut_texels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &staging);
+        memcpy(staging.mapped, grading_lut_texels.data(), grading_lut_texels.size());
+        // Freed once the frame is done with it
+        frames[frame_index].retired_staging.push_back(staging);
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = grading_lut.image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+        // After the composites of earlier frames are done sampling it
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {grading_lut_size, grading_lut_size, grading_lut_size};
+        vkCmdCopyBufferToImage(command_buffer, staging.buffer, grading_lut.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    void Renderer::record_bloom_pass(uint32_t source_binding, VkImageView source, VkImageLayout source_layout, VkExtent2D source_extent,
+                                        uint32_t target_mip, uint32_t params_offset) {
+        VkExtent2D target_extent = get_render_image_mip_extent(bloom_chain, target_mip);
+
+        // From this frame's pools, like every other per-frame set
+        VkDescriptorSet post_set = descriptor_allocator.allocate(post_layout);
+        post_writer.clear();
+        post_writer.write_image(source_binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, source, post_sampler, source_layout);
+        post_writer.write_image(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, bloom_chain.mip_views[target_mip], VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL);
+        post_writer.update(device->logical_device, post_set);
+
+        VkDescriptorSet sets[] = {uniform_set, post_set};
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, post_pipeline_layout, 0, 2, sets, 1, &params_offset);
+
+        BloomPassConstants constants;
+        constants.source_texel = glm::vec2(1.0f / source_extent.width, 1.0f / source_extent.height);
+        constants.target_size = glm::uvec2(target_extent.width, target_extent.height);
+        constants.prefilter = source_binding == 0 && target_mip == 0 ? 1 : 0;
+        constants.radius = post_settings.bloom_radius;
+        k_bloom_pass.push(command_buffer, post_pipeline_layout, constants);
+
+        vkCmdDispatch(command_buffer, get_post_group_count(target_extent.width), get_post_group_count(target_extent.height), 1);
+
+        // The next mip reads what this one wrote
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    void Renderer::record_post_processing(VkImage target, VkImageView target_view, VkFormat target_format, VkExtent2D extent) {
+        const bool bloom = post_settings.bloom_intensity > 0.0f;
+        VkExtent2D bloom_extent = get_render_image_mip_extent(bloom_chain, 0);
+
+        PostParams params;
+        params.extent = glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+        params.inverse_extent = 1.0f / params.extent;
+        params.bloom_texel = glm::vec2(1.0f / bloom_extent.width, 1.0f / bloom_extent.height);
+        params.exposure = post_settings.exposure;
+        params.bloom_intensity = post_settings.bloom_intensity;
+        params.bloom_threshold = post_settings.bloom_threshold;
+        params.bloom_knee = post_settings.bloom_knee;
+        params.tonemap = static_cast<uint32_t>(post_settings.tonemap);
+        params.lut_strength = post_settings.lut_strength;
+        params.lut_size = static_cast<float>(grading_lut.depth);
+        params.vignette_intensity = post_settings.vignette_intensity;
+        params.vignette_radius = post_settings.vignette_radius;
+        params.vignette_softness = post_settings.vignette_softness;
+        params.crt_curvature = post_settings.crt_curvature;
+        params.crt_scanlines = post_settings.crt_scanlines;
+        params.crt_mask = post_settings.crt_mask;
+        params.pixel_size = static_cast<float>(std::max(post_settings.pixel_size, 1u));
+        params.posterize_levels = post_settings.posterize_levels;
+        // The blit into an sRGB target encodes too, so this holds both ways
+        params.encode_srgb = is_srgb_format(target_format) ? 0 : 1;
+        uint32_t params_offset = push_uniforms(params);
+
+        // Every bloom mip is written before it's read, what they held is
+        // dropped. The previous frame's passes have to be done with them.
+        VkImageMemoryBarrier image_barrier{};
+        image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        image_barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.image = bloom_chain.image;
+        image_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        image_barrier.subresourceRange.levelCount = bloom_chain.mip_count;
+        image_barrier.subresourceRange.layerCount = 1;
+        image_barrier.srcAccessMask = 0;
+        image_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+        if(bloom) {
+            uint32_t pass = begin_gpu_pass("bloom");
+
+            // Down the chain, the first mip thresholds the scene
+            vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, bloom_downsample_pipeline);
+            record_bloom_pass(0, scene_target.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, extent, 0, params_offset);
+            for(uint32_t mip = 1; mip < bloom_chain.mip_count; mip++) {
+                record_bloom_pass(0, bloom_chain.mip_views[mip - 1], VK_IMAGE_LAYOUT_GENERAL,
+                                    get_render_image_mip_extent(bloom_chain, mip - 1), mip, params_offset);
+            }
+
+            // And back up, each mip adding the blurred one below it
+            vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, bloom_upsample_pipeline);
+            for(uint32_t mip = bloom_chain.mip_count - 1; mip > 0; mip--) {
+                record_bloom_pass(1, bloom_chain.mip_views[mip], VK_IMAGE_LAYOUT_GENERAL,
+                                    get_render_image_mip_extent(bloom_chain, mip), mip - 1, params_offset);
+            }
+
+            end_gpu_pass(pass);
+        }
+
+        uint32_t pass = begin_gpu_pass("post");
+
+        // The composite overwrites every pixel. Its stage is the one the
+        // swapchain image's acquire is waited on in, and the intermediate
+        // output was last read by the previous frame's blit.
+        image_barrier.image = post_output_direct ? target : post_output.image;
+        image_barrier.subresourceRange.levelCount = 1;
+        image_barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+        VkDescriptorSet post_set = descriptor_allocator.allocate(post_layout);
+        post_writer.clear();
+        post_writer.write_image(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, scene_target.view, post_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        post_writer.write_image(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, bloom_chain.mip_views[0], post_sampler, VK_IMAGE_LAYOUT_GENERAL);
+        post_writer.write_image(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, post_output_direct ? target_view : post_output.view,
+                                VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL);
+        post_writer.write_image(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, grading_lut.view, post_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        post_writer.update(device->logical_device, post_set);
+
+        VkDescriptorSet sets[] = {uniform_set, post_set};
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, composite_pipeline);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, post_pipeline_layout, 0, 2, sets, 1, &params_offset);
+        vkCmdDispatch(command_buffer, get_post_group_count(extent.width), get_post_group_count(extent.height), 1);
+
+        // Presented, or copied back when headless
+        VkImageLayout final_layout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        VkPipelineStageFlags final_stage = headless ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        VkAccessFlags final_access = headless ? VK_ACCESS_TRANSFER_READ_BIT : 0;
+
+        image_barrier.image = target;
+        if(post_output_direct) {
+            image_barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+            image_barrier.newLayout = final_layout;
+            image_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            image_barrier.dstAccessMask = final_access;
+            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, final_stage,
+                                    0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+        } else {
+            // One more round trip: the target can't be stored to, so the
+            // output is blitted over, converting its format on the way
+            VkImageMemoryBarrier blit_barriers[2] = {image_barrier, image_barrier};
+            blit_barriers[0].image = post_output.image;
+            blit_barriers[0].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+            blit_barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            blit_barriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            blit_barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            blit_barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            blit_barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            blit_barriers[1].srcAccessMask = 0;
+            blit_barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                    0, 0, nullptr, 0, nullptr, 2, blit_barriers);
+
+            VkImageBlit region{};
+            region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.srcSubresource.layerCount = 1;
+            region.srcOffsets[1] = {static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1};
+            region.dstSubresource = region.srcSubresource;
+            region.dstOffsets[1] = region.srcOffsets[1];
+            vkCmdBlitImage(command_buffer, post_output.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, target, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            1, &region, VK_FILTER_NEAREST);
+
+            image_barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            image_barrier.newLayout = final_layout;
+            image_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            image_barrier.dstAccessMask = final_access;
+            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, final_stage,
+                                    0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+        }
+
+        end_gpu_pass(pass);
+    }
+
+    void Renderer::wait_for_frame(uint32_t index) {
+        FrameResources& frame = frames[index];
+        if(frame.in_flight) {
+            vkWaitForFences(device->logical_device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+            vkResetFences(device->logical_device, 1, &frame.fence);
+            collect_gpu_timings(index);
+            frame.in_flight = false;
+        }
+        free_retired_textures(index);
+    }
+
+    void Renderer::collect_gpu_timings(uint32_t index) {
+        const FrameResources& frame = frames[index];
+        if(frame.gpu_pass_count == 0) return;
+
+        uint64_t timestamps[k_max_gpu_passes * 2];
+        VkResult result = vkGetQueryPoolResults(device->logical_device, frame.timestamp_pool, 0, frame.gpu_pass_count * 2,
+                                sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+        if(result != VK_SUCCESS) return;
+
+        stats.gpu_pass_count = frame.gpu_pass_count;
+        for(uint32_t i = 0; i < frame.gpu_pass_count; i++) {
+            uint64_t ticks = timestamps[i * 2 + 1] - timestamps[i * 2];
+            stats.gpu_passes[i].name = frame.gpu_pass_names[i];
+            stats.gpu_passes[i].milliseconds = static_cast<double>(ticks) * timestamp_period / 1000000.0;
+        }
+    }
+
+    uint32_t Renderer::begin_gpu_pass(const char* name) {
+        FrameResources& frame = frames[frame_index];
+        uint32_t pass = frame.gpu_pass_count++;
+        frame.gpu_pass_names[pass] = name;
+        vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.timestamp_pool, pass * 2);
+        return pass;
+    }
+
+    void Renderer::end_gpu_pass(uint32_t pass) {
+        vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frames[frame_index].timestamp_pool, pass * 2 + 1);
+    }
+
+    void Renderer::draw_sprites(const SpriteInstance* sprites, uint32_t count, const SpriteCamera* camera) {
+        // The next frame's command buffer and buffers are reused, so the GPU
+        // has to be done with what was recorded into them last time. The
+        // frames after it can still be in flight.
+        uint32_t previous_frame = frame_index;
+        frame_index = (frame_index + 1) % k_max_frames_in_flight;
+        wait_for_frame(frame_index);
+
+        // Nothing is touched before there's an image to draw to, so a skipped
+        // frame leaves no trace
+        if(!headless && !acquire_swapchain_image()) {
+            frame_index = previous_frame;
+            return;
+        }
+
+        FrameResources& frame = frames[frame_index];
+        command_buffer = frame.command_buffer;
+        // Whatever this frame allocated last time is free again
+        descriptor_allocator.begin_frame(frame_index);
+        begin_uniform_frame(&uniform_ring, frame_index);
+
+        VkExtent2D extent = headless ? offscreen_target.extent : swapchain->extent;
+
+        // With post processing sprites are drawn into the scene target, which
+        // the post passes then read
+        const bool post = post_layout != VK_NULL_HANDLE;
+        if(post) reserve_post_targets(extent);
+        VkFramebuffer framebuffer = post ? scene_framebuffer : headless ? offscreen_target.framebuffer : swapchain_framebuffers[swapchain_image];
+
+        reserve_instances(count);
+        update_texture_residency(sprites, count);
+        if(count > 0) {
+            memcpy(frame.instance_buffer.mapped, sprites, sizeof(SpriteInstance) * count);
+        }
+
+        // The lights and tiles are this frame's own too
+        const bool lit = lit_pipeline != VK_NULL_HANDLE;
+        if(lit) {
+            reserve_lights(static_cast<uint32_t>(lights.size()));
+            reserve_light_tiles(extent);
+            if(!lights.empty()) {
+                memcpy(frame.light_buffer.mapped, lights.data(), sizeof(Light2D) * lights.size());
+            }
+        }
+
+        // Pixel coordinates with the origin in the top left corner
+        SpriteCamera pixel_camera{};
+        pixel_camera.scale = {2.0f / extent.width, 2.0f / extent.height};
+        pixel_camera.offset = {-1.0f, -1.0f};
+        if(camera == nullptr) camera = &pixel_camera;
+
+        stats.draw_calls = 0;
+        stats.instances = count;
+        stats.lights = lit ? static_cast<uint32_t>(lights.size()) : 0;
+        frame.gpu_pass_count = 0;
+
+        vkResetCommandBuffer(command_buffer, 0);
+
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if(vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Failed to begin recording the frame!");
+        }
+
+        vkCmdResetQueryPool(command_buffer, frame.timestamp_pool, 0, k_max_gpu_passes * 2);
+
+        // Copies have to land outside the render pass
+        record_texture_updates();
+        if(post) record_grading_lut_upload();
+
+        // Before the render pass too, the lit sprites read its tile lists
+        if(lit) record_light_culling(*camera, extent);
+
+        uint32_t pass = begin_gpu_pass("sprites");
+
+        VkClearValue clear_color{};
+        clear_color.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+
+        VkRenderPassBeginInfo pass_info{};
+        pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        pass_info.renderPass = render_pass;
+        pass_info.framebuffer = framebuffer;
+        pass_info.renderArea.offset = {0, 0};
+        pass_info.renderArea.extent = extent;
+        pass_info.clearValueCount = 1;
+        pass_info.pClearValues = &clear_color;
+
+        vkCmdBeginRenderPass(command_buffer, &pass_info, VK_SUBPASS_CONTENTS_INLINE);
+
+        if(count > 0) {
+            VkDeviceSize offset = 0;
+            vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lit ? lit_pipeline : pipeline);
+            k_sprite_camera.push(command_buffer, lit ? lit_pipeline_layout : pipeline_layout, *camera);
+            vkCmdBindVertexBuffers(command_buffer, 0, 1, &frame.instance_buffer.buffer, &offset);
+            // Six vertices per quad, generated from gl_VertexIndex
+            vkCmdDraw(command_buffer, 6, count, 0, 0);
+            stats.draw_calls++;
+        }
+
+        vkCmdEndRenderPass(command_buffer);
+        end_gpu_pass(pass);
+
+        if(post && headless) {
+            record_post_processing(offscreen_target.image, offscreen_target.image_view, offscreen_target.format, extent);
+        } else if(post) {
+            record_post_processing(swapchain->images[swapchain_image], swapchain->image_views[swapchain_image], swapchain->image_format, extent);
+        }
+
+        if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Failed to record the frame!");
+        }
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffer;
+
+        // The image can only be written once the presentation engine let go
+        // of it, by the render pass or, with post processing, the composite
+        // or the blit after it
+        VkPipelineStageFlags wait_stage = post ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        if(!headless) {
+            submit_info.waitSemaphoreCount = 1;
+            submit_info.pWaitSemaphores = &frame.image_available;
+            submit_info.pWaitDstStageMask = &wait_stage;
+            submit_info.signalSemaphoreCount = 1;
+            submit_info.pSignalSemaphores = &render_finished[swapchain_image];
+        }
+
+        if(vkQueueSubmit(device->graphics_queue, 1, &submit_info, frame.fence) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Failed to submit the frame!");
+        }
+        frame.in_flight = true;
+
+        if(headless) return;
+
+        VkPresentInfoKHR present_info{};
+        present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        present_info.waitSemaphoreCount = 1;
+        present_info.pWaitSemaphores = &render_finished[swapchain_image];
+        present_info.swapchainCount = 1;
+        present_info.pSwapchains = &swapchain->swapchain;
+        present_info.pImageIndices = &swapchain_image;
+
+        VkResult result = vkQueuePresentKHR(device->present_queue, &present_info);
+        if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+            swapchain_out_of_date = true;
+        } else if(result != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Failed to present the frame!");
+        }
+    }
+
+    void Renderer::read_back_target(std::vector<uint8_t>& pixels) {
+        // Oldest first, so the timings left in the stats are the last frame's
+        for(uint32_t i = 1; i <= k_max_frames_in_flight; i++) {
+            wait_for_frame((frame_index + i) % k_max_frames_in_flight);
+        }
+        FrameResources& frame = frames[frame_index];
+        command_buffer = frame.command_buffer;
+
+        VkExtent2D extent = offscreen_target.extent;
+        VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+        PaopuBuffer readback;
+        create_buffer(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &readback);
+
+        vkResetCommandBuffer(command_buffer, 0);
+
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(command_buffer, &begin_info);
+
+        // The render pass already left the image in TRANSFER_SRC_OPTIMAL
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {extent.width, extent.height, 1};
+
+        vkCmdCopyImageToBuffer(command_buffer, offscreen_target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &region);
+        vkEndCommandBuffer(command_buffer);
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffer;
+
+        vkQueueSubmit(device->graphics_queue, 1, &submit_info, frame.fence);
+        vkWaitForFences(device->logical_device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(device->logical_device, 1, &frame.fence);
+
+        pixels.resize(static_cast<size_t>(size));
+        memcpy(pixels.data(), readback.mapped, pixels.size());
+
+        free_buffer(device->logical_device, &readback);
+    }
+
+    // --------------------------------------------------------------------
+    //                            - Textures -
+    // --------------------------------------------------------------------
+
+    TextureHandle Renderer::create_texture(VkFormat format, const ResidentTextureDesc& desc) {
+        TextureHandle handle = texture_residency.add_texture(desc);
+        if(handle >= textures.size()) {
+            textures.resize(handle + 1);
+        }
+
+        textures[handle] = PaopuTexture{};
+        textures[handle].format = format;
+        textures[handle].first_mip = desc.mip_count;
+        return handle;
+    }
+
+    TextureHandle Renderer::create_texture(const TranscodedTexture& texture) {
+        const TextureFormatInfo& info = get_texture_format_info(texture.format);
+
+        ResidentTextureDesc desc;
+        desc.width = texture.width;
+        desc.height = texture.height;
+        desc.mip_count = texture.mip_count;
+        desc.block_width = info.block_width;
+        desc.block_height = info.block_height;
+        desc.block_bytes = info.block_bytes;
+
+        VkFormat format = static_cast<VkFormat>(texture.srgb ? info.vk_srgb_format : info.vk_format);
+        return create_texture(format, desc);
+    }
+
+    void Renderer::destroy_texture(TextureHandle handle) {
+        if(!texture_residency.is_valid(handle)) return;
+
+        // The handle can be reused right away, so nothing staged for it may survive
+        for(size_t i = 0; i < texture_uploads.size();) {
+            if(texture_uploads[i].texture == handle) {
+                frames[frame_index].retired_staging.push_back(texture_uploads[i].staging);
+                texture_uploads[i] = texture_uploads.back();
+                texture_uploads.pop_back();
+            } else {
+                i++;
+            }
+        }
+
+        if(textures[handle].image != VK_NULL_HANDLE) {
+            frames[frame_index].retired_textures.push_back(textures[handle]);
+        }
+        textures[handle] = PaopuTexture{};
+        texture_residency.remove_texture(handle);
+    }
+
+    void Renderer::upload_texture_mip(TextureHandle handle, uint32_t mip, const void* data, size_t size) {
+        if(!texture_residency.is_loading(handle, mip)) {
+            throw std::runtime_error("[Renderer][Vulkan]: Uploaded a texture mip that wasn't requested!");
+        }
+        if(size != texture_residency.get_mip_bytes(handle, mip)) {
+            throw std::runtime_error("[Renderer][Vulkan]: Texture mip upload has the wrong size!");
+        }
+
+        TextureUpload upload;
+        upload.texture = handle;
+        upload.mip = mip;
+
+        // See Buffer.h
+        create_buffer(device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &upload.staging);
+        memcpy(upload.staging.mapped, data, size);
+        texture_uploads.push_back(upload);
+    }
+
+    void Renderer::query_texture_formats() {
+        supported_texture_formats = 0;
+
+        VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        for(uint32_t i = 0; i < k_texture_format_count; i++) {
+            VkFormatProperties unorm;
+            VkFormatProperties srgb;
+            vkGetPhysicalDeviceFormatProperties(device->physical_device, static_cast<VkFormat>(k_texture_formats[i].vk_format), &unorm);
+            vkGetPhysicalDeviceFormatProperties(device->physical_device, static_cast<VkFormat>(k_texture_formats[i].vk_srgb_format), &srgb);
+
+            // Color textures are sRGB, data textures aren't, so both have to work
+            if((unorm.optimalTilingFeatures & required) == required && (srgb.optimalTilingFeatures & required) == required) {
+                supported_texture_formats |= get_texture_format_bit(static_cast<TextureFormat>(i));
+            }
+        }
+    }
+
+    void Renderer::update_texture_budget() {
+        RendererMemoryStats memory = query_memory_stats();
+        if(memory.heap_count == 0) return;
+
+        // Textures land in the largest device local heap
+        uint32_t heap_index = 0;
+        for(uint32_t heap = 0; heap < memory.heap_count; heap++) {
+            if(memory.heaps[heap].device_local && (!memory.heaps[heap_index].device_local || memory.heaps[heap].size > memory.heaps[heap_index].size)) {
+                heap_index = heap;
+            }
+        }
+
+        const GpuHeapUsage& heap = memory.heaps[heap_index];
+        uint64_t allowed = static_cast<uint64_t>(static_cast<double>(heap.budget) * texture_residency.get_settings().budget_fraction);
+
+        // The heap's usage includes our own textures, the rest belongs to everything else
+        uint64_t ours = texture_residency.get_stats().resident_bytes;
+        uint64_t others = heap.usage > ours ? heap.usage - ours : 0;
+        uint64_t budget = allowed > others ? allowed - others : 0;
+
+        texture_residency.set_budget(std::min(budget, texture_memory_limit));
+    }
+
+    void Renderer::update_texture_residency(const SpriteInstance* sprites, uint32_t count) {
+        texture_loads.clear();
+        texture_evictions.clear();
+        if(texture_residency.get_stats().texture_count == 0) return;
+
+        texture_residency.report_sprites(sprites, count);
+        update_texture_budget();
+        texture_residency.update(texture_loads, texture_evictions);
+    }
+
+    void Renderer::record_texture_updates() {
+        for(const ResidencyRequest& eviction : texture_evictions) {
+            // A texture losing several mips is moved once, the rest are no-ops
+            uint32_t first_mip = texture_residency.get_resident_mip(eviction.texture);
+            if(textures[eviction.texture].first_mip != first_mip) {
+                reallocate_texture(eviction.texture, first_mip, nullptr, 0);
+            }
+        }
+
+        for(TextureUpload& upload : texture_uploads) {
+            if(reallocate_texture(upload.texture, upload.mip, &upload.staging, upload.mip)) {
+                texture_residency.complete_load(upload.texture, upload.mip);
+            } else {
+                // Out of device memory: stay within what fit until now
+                texture_memory_limit = texture_residency.get_stats().resident_bytes;
+                texture_residency.fail_load(upload.texture, upload.mip);
+            }
+            frames[frame_index].retired_staging.push_back(upload.staging);
+        }
+        texture_uploads.clear();
+    }
+
+    bool Renderer::reallocate_texture(TextureHandle handle, uint32_t first_mip, const PaopuBuffer* upload, uint32_t upload_mip) {
+        PaopuTexture& old_texture = textures[handle];
+        const ResidentTextureDesc& desc = texture_residency.get_desc(handle);
+
+        PaopuTexture texture;
+        texture.format = old_texture.format;
+        texture.first_mip = first_mip;
+        texture.mip_count = desc.mip_count - first_mip;
+
+        if(texture.mip_count == 0) {
+            if(old_texture.image != VK_NULL_HANDLE) {
+                frames[frame_index].retired_textures.push_back(old_texture);
+            }
+            textures[handle] = texture;
+            return true;
+        }
+
+        texture.extent = {std::max(desc.width >> first_mip, 1u), std::max(desc.height >> first_mip, 1u)};
+        // See Texture.h
+        if(!build_texture(device, &texture)) {
+            return false;
+        }
+
+        bool has_old = old_texture.image != VK_NULL_HANDLE;
+
+        VkImageMemoryBarrier barriers[2]{};
+        barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[0].srcAccessMask = 0;
+        barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].image = texture.image;
+        barriers[0].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.mip_count, 0, 1};
+
+        barriers[1] = barriers[0];
+        barriers[1].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barriers[1].image = old_texture.image;
+        barriers[1].subresourceRange.levelCount = old_texture.mip_count;
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                                0, nullptr, 0, nullptr, has_old ? 2 : 1, barriers);
+
+        // Levels both images hold, by absolute mip
+        if(has_old) {
+            VkImageCopy regions[k_max_texture_mips];
+            uint32_t region_count = 0;
+
+            for(uint32_t mip = std::max(first_mip, old_texture.first_mip); mip < desc.mip_count; mip++) {
+                VkImageCopy& region = regions[region_count++];
+                region = {};
+                region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - old_texture.first_mip, 0, 1};
+                region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - first_mip, 0, 1};
+                region.extent = get_mip_extent(texture.extent, mip - first_mip);
+            }
+
+            vkCmdCopyImage(command_buffer, old_texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                            texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, region_count, regions);
+        }
+
+        if(upload != nullptr && upload_mip >= first_mip) {
+            VkBufferImageCopy region{};
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, upload_mip - first_mip, 0, 1};
+            region.imageExtent = get_mip_extent(texture.extent, upload_mip - first_mip);
+
+            vkCmdCopyBufferToImage(command_buffer, upload->buffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        }
+
+        barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                                0, nullptr, 0, nullptr, 1, barriers);
+
+        if(has_old) {
+            frames[frame_index].retired_textures.push_back(old_texture);
+        }
+        textures[handle] = texture;
+        return true;
+    }
+
+    void Renderer::free_retired_textures(uint32_t index) {
+        FrameResources& frame = frames[index];
+        for(PaopuTexture& texture : frame.retired_textures) {
+            free_texture(device->logical_device, &texture);
+        }
+        for(PaopuBuffer& staging : frame.retired_staging) {
+            free_buffer(device->logical_device, &staging);
+        }
+        frame.retired_textures.clear();
+        frame.retired_staging.clear();
     }
 
     bool Renderer::check_validation_layer_support() {
@@ -124,13 +1403,32 @@ namespace Paopu {
         uint32_t glfw_extension_count = 0;
         const char** glfw_extensions;
 
-        glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+        std::vector<const char*> extensions;
 
-        std::vector<const char*> extensions(glfw_extensions, glfw_extensions + glfw_extension_count);
+        // Without a window we don't need any of the surface extensions
+        if(!headless) {
+            glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+            extensions.assign(glfw_extensions, glfw_extensions + glfw_extension_count);
+        }
 
         if(k_enable_validation_layers) {
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
         }
+
+        // Needed to query VK_EXT_memory_budget on a 1.0 instance
+        uint32_t available_count = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &available_count, nullptr);
+        std::vector<VkExtensionProperties> available(available_count);
+        vkEnumerateInstanceExtensionProperties(nullptr, &available_count, available.data());
+
+        has_properties2 = false;
+        for(const auto& extension : available) {
+            if(strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) {
+                extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+                has_properties2 = true;
+                break;
+            }
+        }
         
         return extensions;
     }
@@ -176,10 +1474,14 @@ namespace Paopu {
             create_info.pNext = nullptr;
         }
 
-        if(vkCreateInstance(&create_info, NULL, &instance) != VK_SUCCESS) {
+        if(vkCreateInstance(&create_info, get_host_allocator(), &instance) != VK_SUCCESS) {
             throw std::runtime_error("[Renderer][Vulkan]: Failed to create Vulkan Instance!");
         }
 
+        if(has_properties2) {
+            get_memory_properties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR) vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+        }
+
     
     }
 
@@ -227,7 +1529,13 @@ namespace Paopu {
             queue_create_infos.push_back(queue_create_info);
         }
 
+        VkPhysicalDeviceFeatures supported_features;
+        vkGetPhysicalDeviceFeatures(device->physical_device, &supported_features);
+
+        // Lets the post stack store straight into swapchain images, see can_write_post_output
         VkPhysicalDeviceFeatures device_features{};
+        device_features.shaderStorageImageWriteWithoutFormat = supported_features.shaderStorageImageWriteWithoutFormat;
+        has_storage_write_without_format = supported_features.shaderStorageImageWriteWithoutFormat == VK_TRUE;
 
         VkDeviceCreateInfo create_info{};
         create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -237,8 +1545,19 @@ namespace Paopu {
 
         create_info.pEnabledFeatures = &device_features;
 
-        create_info.enabledExtensionCount = static_cast<uint32_t>(s_device_extensions.size());
-        create_info.ppEnabledExtensionNames = s_device_extensions.data();
+        // Headless devices never create a swapchain
+        std::vector<const char*> extensions;
+        if(!headless) {
+            extensions.assign(s_device_extensions.begin(), s_device_extensions.end());
+        }
+
+        has_memory_budget = get_memory_properties2 != nullptr && check_device_extension(device->physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if(has_memory_budget) {
+            extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+
+        create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        create_info.ppEnabledExtensionNames = extensions.data();
 
         if(k_enable_validation_layers)	{
             create_info.enabledLayerCount = static_cast<uint32_t>(validation_layers.size());
@@ -247,7 +1566,7 @@ namespace Paopu {
             create_info.enabledLayerCount = 0;
         }
 
-        if(vkCreateDevice(device->physical_device, &create_info, nullptr, &device->logical_device) != VK_SUCCESS) {
+        if(vkCreateDevice(device->physical_device, &create_info, get_host_allocator(), &device->logical_device) != VK_SUCCESS) {
             throw std::runtime_error("[Renderer][Vulkan]: Failed to create logical device!");
         }
 
@@ -256,8 +1575,43 @@ namespace Paopu {
 
     }
 
+    RendererMemoryStats Renderer::query_memory_stats() const {
+        RendererMemoryStats memory;
+        memory.host = get_host_memory_stats();
+        if(device == nullptr || device->physical_device == VK_NULL_HANDLE) {
+            return memory;
+        }
+
+        VkPhysicalDeviceMemoryProperties properties;
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+        budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        if(has_memory_budget) {
+            VkPhysicalDeviceMemoryProperties2KHR properties2{};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+            properties2.pNext = &budget;
+            get_memory_properties2(device->physical_device, &properties2);
+            properties = properties2.memoryProperties;
+        } else {
+            vkGetPhysicalDeviceMemoryProperties(device->physical_device, &properties);
+        }
+
+        memory.has_budget = has_memory_budget;
+        memory.heap_count = properties.memoryHeapCount;
+        for(uint32_t heap = 0; heap < properties.memoryHeapCount; heap++) {
+            GpuHeapUsage& usage = memory.heaps[heap];
+            usage.size = properties.memoryHeaps[heap].size;
+            usage.device_local = (properties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            // Without the extension the whole heap is the best budget we know of
+            usage.budget = has_memory_budget ? budget.heapBudget[heap] : usage.size;
+            usage.usage = has_memory_budget ? budget.heapUsage[heap] : 0;
+        }
+
+        return memory;
+    }
+
     void Renderer::create_surface(PaopuWindow* window) {
-        if(glfwCreateWindowSurface(instance, window->glfw_window, nullptr, &surface) != VK_SUCCESS) {
+        if(glfwCreateWindowSurface(instance, window->glfw_window, get_host_allocator(), &surface) != VK_SUCCESS) {
             throw std::runtime_error("[Renderer][Vulkan]: Failed to create a window surface!");
         }
     }
@@ -270,8 +1624,32 @@ namespace Paopu {
         VkSurfaceFormatKHR surface_format = select_swap_surface_format(swapchain_support.formats);
         // See Swapchain.h
         VkPresentModeKHR present_mode = select_swap_present_mode(swapchain_support.present_modes);
-        // See Swapchain.h
-        VkExtent2D extent = select_swap_extent(window, swapchain_support.capabilities);
+        // See Swapchain.h. This runs on the render thread, so the window's
+        // size is the one its event thread published, see Window.h
+        VkExtent2D extent = select_swap_extent(get_framebuffer_extent(window), swapchain_support.capabilities);
+
+        VkImageUsageFlags image_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        if(post_layout != VK_NULL_HANDLE) {
+            // The composite writes the image itself when it can. sRGB formats
+            // rarely can be stored to, so a UNORM one in the same color space
+            // is looked for and the composite encodes sRGB instead.
+            VkImageUsageFlags supported_usage = swapchain_support.capabilities.supportedUsageFlags;
+            post_output_direct = false;
+            for(const auto& available_format : swapchain_support.formats) {
+                if(available_format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR && !is_srgb_format(available_format.format)
+                    && can_write_post_output(available_format.format, supported_usage)) {
+                    surface_format = available_format;
+                    post_output_direct = true;
+                    break;
+                }
+            }
+
+            // Otherwise its output is blitted over
+            image_usage = post_output_direct ? VK_IMAGE_USAGE_STORAGE_BIT : VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            if((supported_usage & image_usage) == 0) {
+                throw std::runtime_error("[Renderer][Vulkan]: The surface can't be written by the post processing passes!");
+            }
+        }
 
         uint32_t image_count = swapchain_support.capabilities.minImageCount + 1;
         if(swapchain_support.capabilities.maxImageCount > 0 && image_count > swapchain_support.capabilities.maxImageCount) {
@@ -289,7 +1667,7 @@ namespace Paopu {
         // Specifies the amount of layers that each imag consists of
         create_info.imageArrayLayers = 1;
         // Specifies what kind of operations the images in the swapchain will be used for
-        create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        create_info.imageUsage = image_usage;
 
         QueueFamilyIndices indices = find_queue_families(device->physical_device, surface);
         uint32_t queue_family_indices[] = {indices.graphics_family.value(), indices.present_family.value()};
@@ -323,7 +1701,7 @@ namespace Paopu {
 
         create_info.oldSwapchain = VK_NULL_HANDLE;
 
-        if(vkCreateSwapchainKHR(device->logical_device, &create_info, nullptr, &swapchain->swapchain) != VK_SUCCESS) {
+        if(vkCreateSwapchainKHR(device->logical_device, &create_info, get_host_allocator(), &swapchain->swapchain) != VK_SUCCESS) {
             throw std::runtime_error("[Renderer][Vulkan]: Swapchain creation failed!");
         }
 
@@ -363,21 +1741,187 @@ namespace Paopu {
             create_info.subresourceRange.baseArrayLayer = 0;
             create_info.subresourceRange.layerCount = 1;
 
-            if(vkCreateImageView(device->logical_device, &create_info, nullptr, &swapchain->image_views[i]) != VK_SUCCESS) {
+            if(vkCreateImageView(device->logical_device, &create_info, get_host_allocator(), &swapchain->image_views[i]) != VK_SUCCESS) {
                 throw std::runtime_error("[Renderer][Vulkan]: Image view creation failed!");
             }
 
         }
     }
 
-    void Renderer::create_pipeline() {
-        auto vert_shader_code = read_shader("Paopu/src/Renderer/Shaders/SPVs/SpriteShader.vert.spv");
-        auto frag_shader_code = read_shader("Paopu/src/Renderer/Shaders/SPVs/SpriteShader.frag.spv");
+    void Renderer::create_framebuffers() {
+        swapchain_framebuffers.resize(swapchain->image_views.size());
+        render_finished.resize(swapchain->image_views.size());
+
+        VkSemaphoreCreateInfo semaphore_info{};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        for(size_t i = 0; i < swapchain->image_views.size(); i++) {
+            if(vkCreateSemaphore(device->logical_device, &semaphore_info, get_host_allocator(), &render_finished[i]) != VK_SUCCESS) {
+                throw std::runtime_error("[Renderer][Vulkan]: Frame semaphore creation failed!");
+            }
+
+            // Nothing draws to the image, see reserve_post_targets
+            swapchain_framebuffers[i] = VK_NULL_HANDLE;
+            if(post_layout != VK_NULL_HANDLE) continue;
+
+            VkFramebufferCreateInfo create_info{};
+            create_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            create_info.renderPass = render_pass;
+            create_info.attachmentCount = 1;
+            create_info.pAttachments = &swapchain->image_views[i];
+            create_info.width = swapchain->extent.width;
+            create_info.height = swapchain->extent.height;
+            create_info.layers = 1;
+
+            if(vkCreateFramebuffer(device->logical_device, &create_info, get_host_allocator(), &swapchain_framebuffers[i]) != VK_SUCCESS) {
+                throw std::runtime_error("[Renderer][Vulkan]: Swapchain framebuffer creation failed!");
+            }
+        }
+    }
+
+    bool Renderer::recreate_swapchain() {
+        VkSurfaceCapabilitiesKHR capabilities;
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device->physical_device, surface, &capabilities);
+        // Minimized, there is nothing to draw to until it comes back. Some
+        // surfaces leave the extent to us, then only the window knows.
+        VkExtent2D framebuffer_extent = get_framebuffer_extent(window);
+        if(capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0) return false;
+        if(capabilities.currentExtent.width == UINT32_MAX && (framebuffer_extent.width == 0 || framebuffer_extent.height == 0)) return false;
+
+        vkDeviceWaitIdle(device->logical_device);
+
+        for(size_t i = 0; i < swapchain_framebuffers.size(); i++) {
+            vkDestroyFramebuffer(device->logical_device, swapchain_framebuffers[i], get_host_allocator());
+            vkDestroySemaphore(device->logical_device, render_finished[i], get_host_allocator());
+        }
+        // See Swapchain.h
+        free_swapchain(device->logical_device, swapchain);
+        // The viewport is baked into the pipeline
+        vkDestroyPipeline(device->logical_device, pipeline, get_host_allocator());
+        vkDestroyPipelineLayout(device->logical_device, pipeline_layout, get_host_allocator());
+        if(lit_pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device->logical_device, lit_pipeline, get_host_allocator());
+        }
+
+        create_swapchain(window);
+        create_image_views();
+        create_pipeline(swapchain->extent);
+        create_framebuffers();
+
+        swapchain_out_of_date = false;
+        return true;
+    }
+
+    bool Renderer::acquire_swapchain_image() {
+        if(swapchain_out_of_date && !recreate_swapchain()) return false;
+
+        VkResult result = vkAcquireNextImageKHR(device->logical_device, swapchain->swapchain, UINT64_MAX, frames[frame_index].image_available,
+                                                VK_NULL_HANDLE, &swapchain_image);
+        if(result == VK_ERROR_OUT_OF_DATE_KHR) {
+            // Nothing was signaled, try again with a new swapchain next frame
+            swapchain_out_of_date = true;
+            return false;
+        }
+        if(result == VK_SUBOPTIMAL_KHR) {
+            // Still presentable, this frame goes out as is
+            swapchain_out_of_date = true;
+        } else if(result != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Failed to acquire a swapchain image!");
+        }
+        return true;
+    }
+
+    void Renderer::create_render_pass(VkFormat format, VkImageLayout final_layout) {
+        VkAttachmentDescription color_attachment{};
+        color_attachment.format = format;
+        color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        color_attachment.finalLayout = final_layout;
+
+        VkAttachmentReference color_attachment_ref{};
+        color_attachment_ref.attachment = 0;
+        color_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &color_attachment_ref;
+
+        VkSubpassDependency dependencies[2]{};
+        // The layout transition waits for the stage the acquire semaphore is
+        // waited on in, and for the post passes of the previous frame, which
+        // may still be sampling the scene target
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies[0].srcAccessMask = 0;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        // Make the color writes visible to the copy that reads the target back,
+        // or the post passes sampling it
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        VkRenderPassCreateInfo create_info{};
+        create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        create_info.attachmentCount = 1;
+        create_info.pAttachments = &color_attachment;
+        create_info.subpassCount = 1;
+        create_info.pSubpasses = &subpass;
+        create_info.dependencyCount = 2;
+        create_info.pDependencies = dependencies;
+
+        if(vkCreateRenderPass(device->logical_device, &create_info, get_host_allocator(), &render_pass) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Render pass creation failed!");
+        }
+    }
+
+    void Renderer::create_pipeline(VkExtent2D extent) {
+        std::vector<uint8_t> vert_buffer;
+        std::vector<uint8_t> frag_buffer;
+        AssetView vert_shader_code = load_shader("SpriteShader.vert.spv", vert_buffer);
+        AssetView frag_shader_code = load_shader("SpriteShader.frag.spv", frag_buffer);
 
         // printf("Vertex Shader Buffer Size: %zu", vert_shader_code.size());
         VkShaderModule vert_shader_module = create_shader_module(vert_shader_code);
         VkShaderModule frag_shader_module = create_shader_module(frag_shader_code);
 
+        VkPushConstantRange camera_range = k_sprite_camera.get_range();
+
+        VkPipelineLayoutCreateInfo pipeline_layout_info{};
+        pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipeline_layout_info.setLayoutCount = 0;
+        pipeline_layout_info.pushConstantRangeCount = 1;
+        pipeline_layout_info.pPushConstantRanges = &camera_range;
+
+        if(vkCreatePipelineLayout(device->logical_device, &pipeline_layout_info, get_host_allocator(), &pipeline_layout) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][VULKAN]: Render Pipeline Layout creation failed!");
+        }
+
+        pipeline = create_sprite_pipeline(extent, vert_shader_module, frag_shader_module, pipeline_layout);
+
+        // Same vertex stage, shaded with the lights binned for the pixel's tile
+        if(lit_pipeline_layout != VK_NULL_HANDLE) {
+            std::vector<uint8_t> lit_buffer;
+            VkShaderModule lit_shader_module = create_shader_module(load_shader("LitSpriteShader.frag.spv", lit_buffer));
+            lit_pipeline = create_sprite_pipeline(extent, vert_shader_module, lit_shader_module, lit_pipeline_layout);
+            vkDestroyShaderModule(device->logical_device, lit_shader_module, get_host_allocator());
+        }
+
+        vkDestroyShaderModule(device->logical_device, frag_shader_module, get_host_allocator());
+        vkDestroyShaderModule(device->logical_device, vert_shader_module, get_host_allocator());
+    }
+
+    VkPipeline Renderer::create_sprite_pipeline(VkExtent2D extent, VkShaderModule vert_shader_module, VkShaderModule frag_shader_module, VkPipelineLayout layout) {
         VkPipelineShaderStageCreateInfo vert_shader_stage_info{};
         vert_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         vert_shader_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -399,15 +1943,29 @@ namespace Paopu {
         vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
         // Bindings: Spacing between data and whether the data is per-vertex or per-instance
-        vertex_input_info.vertexBindingDescriptionCount = 0;
-        // vertex_input_info.pVertexBindingDescriptions = nullptr;
+        // The quad's corners come from gl_VertexIndex, so the only binding is the
+        // per-instance SpriteInstance array.
+        VkVertexInputBindingDescription instance_binding{};
+        instance_binding.binding = 0;
+        instance_binding.stride = sizeof(SpriteInstance);
+        instance_binding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+        vertex_input_info.vertexBindingDescriptionCount = 1;
+        vertex_input_info.pVertexBindingDescriptions = &instance_binding;
         
         // Attribute Descriptions: 
         //      - Type of the attributes passed to the vertex shader
         //      - which binding to load them from 
         //      - which offset
-        vertex_input_info.vertexAttributeDescriptionCount = 0;
-        // vertex_input_info.pVertexAttributeDescriptions = nullptr;
+        VkVertexInputAttributeDescription instance_attributes[5]{};
+        instance_attributes[0] = {0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, basis)};
+        instance_attributes[1] = {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(SpriteInstance, translation)};
+        instance_attributes[2] = {2, 0, VK_FORMAT_R32_UINT, offsetof(SpriteInstance, texture_index)};
+        instance_attributes[3] = {3, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, uv_rect)};
+        instance_attributes[4] = {4, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, color)};
+
+        vertex_input_info.vertexAttributeDescriptionCount = 5;
+        vertex_input_info.pVertexAttributeDescriptions = instance_attributes;
 
         // Describes what kind of geometry will be drawn from the vertices and 
         // if primitive restart should be enabled.
@@ -421,8 +1979,8 @@ namespace Paopu {
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
-        viewport.width = (float)swapchain->extent.width;
-        viewport.height = (float)swapchain->extent.height;
+        viewport.width = (float)extent.width;
+        viewport.height = (float)extent.height;
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
 
@@ -430,7 +1988,7 @@ namespace Paopu {
         // discarded by the rasterizer
         VkRect2D scissor{};
         scissor.offset = {0, 0};
-        scissor.extent = swapchain->extent;
+        scissor.extent = extent;
 
         VkPipelineViewportStateCreateInfo viewport_state_info{};
         viewport_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -458,7 +2016,8 @@ namespace Paopu {
         rasterizer_info.polygonMode = VK_POLYGON_MODE_FILL;
         // Thickness of the lines in terms of number of fragments.
         rasterizer_info.lineWidth = 1.0f;
-        rasterizer_info.cullMode = VK_CULL_MODE_BACK_BIT;
+        // Sprites are flipped with negative scales, so both windings are drawn
+        rasterizer_info.cullMode = VK_CULL_MODE_NONE;
         rasterizer_info.frontFace = VK_FRONT_FACE_CLOCKWISE;
         rasterizer_info.depthBiasEnable = VK_FALSE;
         // rasterizer_info.depthBiasConstantFactor = 0.0f;
@@ -483,7 +2042,14 @@ namespace Paopu {
                                                 VK_COLOR_COMPONENT_G_BIT |
                                                 VK_COLOR_COMPONENT_B_BIT |
                                                 VK_COLOR_COMPONENT_A_BIT;
-        color_blend_attachment.blendEnable = VK_FALSE;
+        // Standard alpha blending for sprites
+        color_blend_attachment.blendEnable = VK_TRUE;
+        color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+        color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
         // Global color blending settings
         VkPipelineColorBlendStateCreateInfo color_blend_info{};
@@ -497,28 +2063,35 @@ namespace Paopu {
         color_blend_info.blendConstants[2] = 0.0f;
         color_blend_info.blendConstants[3] = 0.0f;
 
-        VkPipelineLayoutCreateInfo pipeline_layout_info{};
-        pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipeline_layout_info.setLayoutCount = 0;
-        pipeline_layout_info.pushConstantRangeCount = 0;
-
-        if(vkCreatePipelineLayout(device->logical_device, &pipeline_layout_info, nullptr, &pipeline_layout) != VK_SUCCESS) {
-            std::runtime_error("[Renderer][VULKAN]: Render Pipeline Layout creation failed!");
+        VkGraphicsPipelineCreateInfo pipeline_info{};
+        pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipeline_info.stageCount = 2;
+        pipeline_info.pStages = shader_stages;
+        pipeline_info.pVertexInputState = &vertex_input_info;
+        pipeline_info.pInputAssemblyState = &input_assembly_info;
+        pipeline_info.pViewportState = &viewport_state_info;
+        pipeline_info.pRasterizationState = &rasterizer_info;
+        pipeline_info.pMultisampleState = &multisampling_info;
+        pipeline_info.pColorBlendState = &color_blend_info;
+        pipeline_info.layout = layout;
+        pipeline_info.renderPass = render_pass;
+        pipeline_info.subpass = 0;
+
+        VkPipeline sprite_pipeline;
+        if(vkCreateGraphicsPipelines(device->logical_device, VK_NULL_HANDLE, 1, &pipeline_info, get_host_allocator(), &sprite_pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("[Renderer][Vulkan]: Sprite pipeline creation failed!");
         }
-
-        vkDestroyShaderModule(device->logical_device, frag_shader_module, nullptr);
-        vkDestroyShaderModule(device->logical_device, vert_shader_module, nullptr);
-        
+        return sprite_pipeline;
     }
 
-    VkShaderModule Renderer::create_shader_module(const std::vector<char>& shader_code) {
+    VkShaderModule Renderer::create_shader_module(const AssetView& shader_code) {
         VkShaderModuleCreateInfo create_info{};
         create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        create_info.codeSize = shader_code.size();
-        create_info.pCode = reinterpret_cast<const uint32_t*>(shader_code.data());
+        create_info.codeSize = shader_code.size;
+        create_info.pCode = reinterpret_cast<const uint32_t*>(shader_code.data);
 
         VkShaderModule shader_module;
-        if(vkCreateShaderModule(device->logical_device, &create_info, nullptr, &shader_module) != VK_SUCCESS) {
+        if(vkCreateShaderModule(device->logical_device, &create_info, get_host_allocator(), &shader_module) != VK_SUCCESS) {
             throw std::runtime_error("[Renderer][Vulkan]: Shader Module creation failed!");
         }
 
@@ -532,7 +2105,7 @@ namespace Paopu {
         VkDebugUtilsMessengerCreateInfoEXT create_info;
         populate_debug_messenger_create_info(create_info);
         
-        if(CreateDebugUtilsMessengerEXT(instance, &create_info, nullptr, &debug_messenger) != VK_SUCCESS) {
+        if(CreateDebugUtilsMessengerEXT(instance, &create_info, get_host_allocator(), &debug_messenger) != VK_SUCCESS) {
             throw std::runtime_error("[Renderer][Vulkan]: Failed to setup debug messenger!");
         }
     }
@@ -7,6 +7,19 @@
 //#include <Vulkan/vulkan.h>
 
 #include "VulkanBackend/Device.h"
+#include "VulkanBackend/Buffer.h"
+#include "VulkanBackend/Descriptors.h"
+#include "VulkanBackend/Offscreen.h"
+#include "VulkanBackend/RenderImage.h"
+#include "VulkanBackend/Texture.h"
+#include "VulkanBackend/Uniforms.h"
+#include "VulkanBackend/HostAllocator.h"
+#include "LightCulling.h"
+#include "PostProcess.h"
+#include "SpriteInstance.h"
+#include "TextureResidency.h"
+#include "../Assets/AssetArchive.h"
+#include "../Assets/TextureTranscoder.h"
 
 #include <vector>
 #include <iostream>
@@ -17,6 +30,50 @@ namespace Paopu {
     // Forward Declarations 
     struct PaopuWindow;
     
+    static const uint32_t k_max_gpu_passes = 8;
+    // Frames recorded ahead of the GPU. Each has its own copy of everything
+    // the CPU writes while the others are still being drawn.
+    static const uint32_t k_max_frames_in_flight = 2;
+
+    /// GPU time spent in a single pass of the last completed frame
+    ///
+    ///
+    struct PAOPU_API GpuPassTiming {
+        const char* name{""};
+        double milliseconds{0.0};
+    };
+
+    /// Counters for the last frame the renderer recorded
+    ///
+    ///
+    struct PAOPU_API RendererStats {
+        uint32_t draw_calls{0};
+        uint32_t instances{0};
+        uint32_t lights{0};
+        uint32_t gpu_pass_count{0};
+        GpuPassTiming gpu_passes[k_max_gpu_passes];
+    };
+
+    /// One Vulkan memory heap. `budget` and `usage` come from VK_EXT_memory_budget
+    /// and cover the whole process, `budget` is the heap size without it.
+    ///
+    struct PAOPU_API GpuHeapUsage {
+        uint64_t size{0};
+        uint64_t budget{0};
+        uint64_t usage{0};
+        bool device_local{false};
+    };
+
+    /// Host memory the driver allocated through the renderer, and GPU heap usage
+    ///
+    ///
+    struct PAOPU_API RendererMemoryStats {
+        HostMemoryStats host;
+        uint32_t heap_count{0};
+        GpuHeapUsage heaps[VK_MAX_MEMORY_HEAPS];
+        bool has_budget{false};
+    };
+
 
     class PAOPU_API Renderer {
 
@@ -29,12 +86,146 @@ namespace Paopu {
             ///
             void init_backend(PaopuWindow* window);
 
+            /// Initializes the backend without a window or swapchain. Frames are
+            /// rendered into an offscreen target of `width` x `height`.
+            ///
+            void init_headless(uint32_t width, uint32_t height);
+
+            /// Records and submits a frame that draws `count` sprites into the
+            /// offscreen target, or the next swapchain image, which is presented.
+            /// Waits on the frame `k_max_frames_in_flight` back before
+            /// recording into its resources. Without a `camera`
+            /// sprites are placed in pixels from the target's top left corner.
+            ///
+            void draw_sprites(const SpriteInstance* sprites, uint32_t count, const SpriteCamera* camera = nullptr);
+
+            /// Builds the light culling pass and the lit sprite pipeline. From
+            /// then on every frame bins the lights from `set_lights` into
+            /// screen tiles with a compute pass, and each sprite pixel is lit
+            /// by the lights of its tile only. Needs LightCulling.comp.spv and
+            /// LitSpriteShader.frag.spv.
+            void enable_lighting();
+
+            /// Lights for the next `draw_sprites`, in the sprites' space. They
+            /// are copied. `ambient` reaches every sprite. Call it from the
+            /// thread that draws; Application takes them from the RenderSnapshot.
+            void set_lights(const Light2D* lights, uint32_t count, glm::vec3 ambient = glm::vec3(0.0f));
+
+            /// Builds the post stack. From then on sprites are drawn into an
+            /// HDR target, bloom is blurred down a half or quarter resolution
+            /// mip chain, and a single compute pass applies every per-pixel
+            /// effect on its way into the swapchain image, or the offscreen
+            /// target. Where that image can't be written by a shader the pass
+            /// writes an intermediate image that is blitted over instead.
+            /// Needs the Bloom and PostComposite SPIR-V.
+            void enable_post_processing(const PostSettings& settings = PostSettings());
+
+            /// Takes effect with the next `draw_sprites`
+            ///
+            ///
+            inline void set_post_settings(const PostSettings& settings) { post_settings = settings; }
+            inline const PostSettings& get_post_settings() const { return post_settings; }
+
+            /// Replaces the color grading LUT with `size` cubed RGBA8 texels,
+            /// red varying fastest, then green, then blue. They are copied and
+            /// uploaded at the start of the next frame. See `lut_strength`.
+            ///
+            void set_color_grading_lut(const uint8_t* texels, uint32_t size);
+
+            /// True when the post stack writes the final image in place,
+            /// false when it goes through the intermediate image and a blit
+            ///
+            inline bool is_post_output_direct() const { return post_output_direct; }
+
+            /// Waits for every frame in flight and copies the offscreen target into `pixels`
+            /// as tightly packed RGBA8 rows.
+            ///
+            void read_back_target(std::vector<uint8_t>& pixels);
+
+            inline const RendererStats& get_stats() const { return stats; }
+
+            /// Archive shaders are loaded from instead of the loose files. Must
+            /// be set before the backend is initialized and outlive the renderer.
+            ///
+            inline void set_asset_archive(const AssetArchive* archive) { asset_archive = archive; }
+
+            /// Current host allocations by scope and per-heap GPU usage. Heap
+            /// usage is only reported where VK_EXT_memory_budget is supported.
+            ///
+            RendererMemoryStats query_memory_stats() const;
+
+            /// Registers a texture whose mips are streamed in and out within the
+            /// memory budget. `format` must match the block layout in `desc`.
+            /// Nothing is resident until its tail mips are uploaded.
+            ///
+            TextureHandle create_texture(VkFormat format, const ResidentTextureDesc& desc);
+
+            /// Registers a texture transcoded for this device, see TextureTranscoder.
+            /// Its mips are uploaded from `texture` as usual, when requested.
+            ///
+            TextureHandle create_texture(const TranscodedTexture& texture);
+
+            void destroy_texture(TextureHandle texture);
+
+            /// Mips the residency manager asked for in the last `draw_sprites`.
+            /// Answer each with `upload_texture_mip`, or `fail_load` on the
+            /// residency manager if its data can't be had.
+            ///
+            inline const std::vector<ResidencyRequest>& get_texture_loads() const { return texture_loads; }
+
+            /// Stages mip `mip` of `texture`, `size` bytes packed tightly. It is
+            /// copied in, and the texture's image grows to hold it, at the start
+            /// of the next frame.
+            ///
+            void upload_texture_mip(TextureHandle texture, uint32_t mip, const void* data, size_t size);
+
+            /// The budget the residency manager works with is refreshed every
+            /// frame, see `update_texture_budget`
+            ///
+            inline TextureResidency& get_texture_residency() { return texture_residency; }
+            inline const PaopuTexture& get_texture(TextureHandle texture) const { return textures[texture]; }
+
+            /// TextureFormats the device can sample with linear filtering, a
+            /// mask of get_texture_format_bit for TextureTranscoder::set_supported_formats
+            ///
+            inline uint32_t get_supported_texture_formats() const { return supported_texture_formats; }
+
+            /// Set layouts for passes and materials, shared by content
+            ///
+            ///
+            inline PaopuDescriptorLayoutCache& get_descriptor_layouts() { return descriptor_layouts; }
+
+            /// Sets for the frame being recorded, released when its frame index
+            /// comes around again, and persistent sets cached by what they hold
+            ///
+            inline PaopuDescriptorAllocator& get_descriptor_allocator() { return descriptor_allocator; }
+
+            /// Copies `data` into this frame's uniform ring. Bind `get_uniform_set`
+            /// with the returned dynamic offset to read it. Valid until the
+            /// same frame index starts again.
+            ///
+            template<typename T>
+            inline uint32_t push_uniforms(const T& data) { return push_uniform(&uniform_ring, data); }
+
+            /// Layout of the set the uniform ring is read through: binding 0,
+            /// a UNIFORM_BUFFER_DYNAMIC seen by every stage
+            ///
+            inline VkDescriptorSetLayout get_uniform_set_layout() const { return uniform_layout; }
+            inline VkDescriptorSet get_uniform_set() const { return uniform_set; }
+            inline const PaopuUniformRing& get_uniform_ring() const { return uniform_ring; }
+
             void free_renderer();
         private:
+            /// Reads a loose SPIR-V file into `buffer`
             ///
             ///
+            void read_shader(const std::string& file_name, std::vector<uint8_t>& buffer);
+
+            /// The SPIR-V of shader `name`, from the asset archive if one is set
+            /// (straight from its mapping unless compressed) or the loose files.
+            /// `buffer` holds the code when it has to be read or decompressed.
             ///
-            std::vector<char> read_shader(const std::string& file_name);
+            AssetView load_shader(const char* name, std::vector<uint8_t>& buffer);
 
             
  
@@ -116,6 +307,11 @@ namespace Paopu {
             ///
             void create_logical_device();
 
+            /// Asks the device which TextureFormats it can sample, see
+            /// `get_supported_texture_formats`
+            ///
+            void query_texture_formats();
+
             /// Create a windows surface
             ///
             ///
@@ -131,24 +327,265 @@ namespace Paopu {
             ///
             void create_image_views();
 
+            /// Creates the render pass that sprites are drawn in. `final_layout` is
+            /// the layout the color attachment is left in once the pass ends.
+            /// Copies and compute shaders can read it after the pass.
+            void create_render_pass(VkFormat format, VkImageLayout final_layout);
+
+            /// Creates a framebuffer, and the semaphore presenting it waits on,
+            /// for each swapchain image. With post processing sprites are drawn
+            /// into the scene target instead, and only the semaphores are made.
+            void create_framebuffers();
+
+            /// Rebuilds the swapchain and everything sized by it once it no longer
+            /// matches the window. Returns false while the window has no area.
             ///
+            bool recreate_swapchain();
+
+            /// Acquires the swapchain image the frame draws into, rebuilding the
+            /// swapchain if needed. Returns false if the frame has to be skipped.
             ///
+            bool acquire_swapchain_image();
+
+            /// Creates the sprite pipeline for `render_pass`. Sprites are drawn as
+            /// instanced quads, one SpriteInstance per instance.
             ///
-            void create_pipeline();
+            void create_pipeline(VkExtent2D extent);
 
+            /// Creates a pipeline drawing sprites with `frag_shader_module` into
+            /// `render_pass`, see `create_pipeline`
             ///
+            VkPipeline create_sprite_pipeline(VkExtent2D extent, VkShaderModule vert_shader_module, VkShaderModule frag_shader_module, VkPipelineLayout layout);
+
+            /// A compute pipeline running `shader_name` with `layout`
+            ///
+            ///
+            VkPipeline create_compute_pipeline(const char* shader_name, VkPipelineLayout layout);
+
+            /// Grows the current frame's light buffer so it can hold at least
+            /// `count` lights
+            ///
+            void reserve_lights(uint32_t count);
+
+            /// Makes sure the current frame's tile list buffer covers `extent`
+            ///
+            ///
+            void reserve_light_tiles(VkExtent2D extent);
+
+            /// Records the compute pass binning this frame's lights into tiles,
+            /// and the barrier that makes the lists visible to the sprite pass.
+            /// Leaves both descriptor sets bound for the graphics pipeline too.
+            void record_light_culling(const SpriteCamera& camera, VkExtent2D extent);
+
+            /// Whether the post stack can store into images of `format` with
+            /// `supported_usage` straight from PostCompositeDirect.comp
+            ///
+            bool can_write_post_output(VkFormat format, VkImageUsageFlags supported_usage) const;
+
+            /// Remakes the scene target, its framebuffer, the bloom chain and
+            /// the intermediate output if `extent` or the bloom downscale
+            /// changed since they were made
+            void reserve_post_targets(VkExtent2D extent);
+
+            void free_post_targets();
+
+            /// Records the staged grading LUT's copy into the frame
+            ///
+            ///
+            void record_grading_lut_upload();
+
+            /// Records one bloom dispatch writing mip `target_mip`, reading
+            /// `source` through binding `source_binding`: 0 going down the
+            /// chain, 1 coming back up. Ends with the barrier the next one needs.
+            void record_bloom_pass(uint32_t source_binding, VkImageView source, VkImageLayout source_layout, VkExtent2D source_extent,
+                                    uint32_t target_mip, uint32_t params_offset);
+
+            /// Records the bloom chain and the composite into `target`, which
+            /// is left ready to be presented, or copied from when headless
+            ///
+            void record_post_processing(VkImage target, VkImageView target_view, VkFormat target_format, VkExtent2D extent);
+
+            /// Creates the command pool, and for every frame in flight its
+            /// command buffer, fence, semaphore and the timestamp query pool
+            /// used for GPU pass timings. Then the descriptor allocator and
+            /// the uniform ring, with a region per frame.
+            void create_frame_resources();
+
+            /// Waits until the GPU is done with frame `index`, collects its
+            /// timings and frees what was retired while it was recorded
+            ///
+            void wait_for_frame(uint32_t index);
+
+            /// Collects the GPU timestamps written by frame `index`
+            ///
+            ///
+            void collect_gpu_timings(uint32_t index);
+
+            /// Writes the timestamp a pass of the current frame starts at,
+            /// returns the pass for `end_gpu_pass`
+            ///
+            uint32_t begin_gpu_pass(const char* name);
+
+            void end_gpu_pass(uint32_t pass);
+
+            /// Grows the current frame's instance buffer so it can hold at
+            /// least `count` sprites
             ///
+            void reserve_instances(uint32_t count);
+
+            /// Hands textures the share of the largest device local heap's
+            /// budget that isn't used by anything else. Without VK_EXT_memory_budget
+            /// the heap size is all we know, so set `budget_cap` on those devices.
+            ///
+            void update_texture_budget();
+
+            /// Feeds this frame's sprites to the residency manager and collects
+            /// its loads and evictions
+            ///
+            void update_texture_residency(const SpriteInstance* sprites, uint32_t count);
+
+            /// Records the staged uploads and evictions into the frame, moving
+            /// each changed texture into a new image with its new mip range
+            ///
+            void record_texture_updates();
+
+            /// Moves `texture` into an image holding mips `first_mip` onwards,
+            /// copying what both have from the old image and `upload` from its
+            /// staging buffer. Returns false if the image couldn't be allocated.
             ///
-            VkShaderModule create_shader_module(const std::vector<char>& shader_code);
+            bool reallocate_texture(TextureHandle texture, uint32_t first_mip, const PaopuBuffer* upload, uint32_t upload_mip);
+
+            /// Frees the textures and staging buffers retired while frame
+            /// `index` was the current one. The GPU has to be done with it.
+            ///
+            void free_retired_textures(uint32_t index);
+
+            ///
+            ///
+            ///
+            VkShaderModule create_shader_module(const AssetView& shader_code);
             
 
         private:
             VkInstance instance;
             VkSurfaceKHR surface;
             VkDebugUtilsMessengerEXT debug_messenger;
-            PaopuDevice* device;
-            PaopuSwapchain* swapchain;
-            VkPipelineLayout pipeline_layout;
+            PaopuDevice* device{nullptr};
+            PaopuSwapchain* swapchain{nullptr};
+            PaopuWindow* window{nullptr};
+            std::vector<VkFramebuffer> swapchain_framebuffers;
+            // One per swapchain image, presenting waits on them
+            std::vector<VkSemaphore> render_finished;
+            uint32_t swapchain_image{0};
+            bool swapchain_out_of_date{false};
+            VkRenderPass render_pass{VK_NULL_HANDLE};
+            VkPipelineLayout pipeline_layout{VK_NULL_HANDLE};
+            VkPipeline pipeline{VK_NULL_HANDLE};
+
+            /// What a frame in flight records into and writes, reused once
+            /// its fence has signaled
+            struct FrameResources {
+                VkCommandBuffer command_buffer{VK_NULL_HANDLE};
+                VkFence fence{VK_NULL_HANDLE};
+                bool in_flight{false};
+                // Signaled once the acquired image can be drawn to
+                VkSemaphore image_available{VK_NULL_HANDLE};
+
+                PaopuBuffer instance_buffer;
+                uint32_t instance_capacity{0};
+                PaopuBuffer light_buffer;
+                uint32_t light_capacity{0};
+                // Written by the culling pass, see LightCulling.h
+                PaopuBuffer light_tile_buffer;
+                uint32_t light_tile_count_x{0};
+                uint32_t light_tile_count_y{0};
+
+                // Begin and end of each pass, named as they were recorded
+                VkQueryPool timestamp_pool{VK_NULL_HANDLE};
+                uint32_t gpu_pass_count{0};
+                const char* gpu_pass_names[k_max_gpu_passes]{};
+
+                // Released once the frame is done with them
+                std::vector<PaopuTexture> retired_textures;
+                std::vector<PaopuBuffer> retired_staging;
+            };
+
+            VkCommandPool command_pool{VK_NULL_HANDLE};
+            FrameResources frames[k_max_frames_in_flight];
+            // The frame being recorded, or the last one submitted between frames
+            uint32_t frame_index{0};
+            // The current frame's, everything is recorded into it
+            VkCommandBuffer command_buffer{VK_NULL_HANDLE};
+
+            PaopuDescriptorLayoutCache descriptor_layouts;
+            PaopuDescriptorAllocator descriptor_allocator;
+            PaopuUniformRing uniform_ring;
+            VkDescriptorSetLayout uniform_layout{VK_NULL_HANDLE};
+            VkDescriptorSet uniform_set{VK_NULL_HANDLE};
+
+            // Only created once lighting is enabled
+            VkDescriptorSetLayout lighting_layout{VK_NULL_HANDLE};
+            VkPipelineLayout lit_pipeline_layout{VK_NULL_HANDLE};
+            VkPipeline lit_pipeline{VK_NULL_HANDLE};
+            VkPipelineLayout culling_pipeline_layout{VK_NULL_HANDLE};
+            VkPipeline culling_pipeline{VK_NULL_HANDLE};
+            std::vector<Light2D> lights;
+            glm::vec3 ambient{0.0f};
+            PaopuDescriptorWriter lighting_writer;
+
+            // Only created once post processing is enabled
+            PostSettings post_settings;
+            VkDescriptorSetLayout post_layout{VK_NULL_HANDLE};
+            VkPipelineLayout post_pipeline_layout{VK_NULL_HANDLE};
+            VkPipeline bloom_downsample_pipeline{VK_NULL_HANDLE};
+            VkPipeline bloom_upsample_pipeline{VK_NULL_HANDLE};
+            VkPipeline composite_pipeline{VK_NULL_HANDLE};
+            // Whether `composite_pipeline` stores to the final image
+            bool composite_direct{false};
+            VkSampler post_sampler{VK_NULL_HANDLE};
+            // Sprites are drawn into it, in HDR
+            PaopuRenderImage scene_target;
+            VkFramebuffer scene_framebuffer{VK_NULL_HANDLE};
+            PaopuRenderImage bloom_chain;
+            uint32_t bloom_downscale{0};
+            // Only when the final image can't be stored to, it is blitted over
+            PaopuRenderImage post_output;
+            bool post_output_direct{false};
+            PaopuRenderImage grading_lut;
+            std::vector<uint8_t> grading_lut_texels;
+            uint32_t grading_lut_size{0};
+            bool grading_lut_dirty{false};
+            PaopuDescriptorWriter post_writer;
+
+            float timestamp_period{1.0f};
+
+            PaopuOffscreenTarget offscreen_target;
+
+            /// A mip waiting for the next frame to copy it in
+            struct TextureUpload {
+                TextureHandle texture{k_no_texture};
+                uint32_t mip{0};
+                PaopuBuffer staging;
+            };
+
+            TextureResidency texture_residency;
+            // Indexed by TextureHandle
+            std::vector<PaopuTexture> textures;
+            std::vector<ResidencyRequest> texture_loads;
+            std::vector<ResidencyRequest> texture_evictions;
+            std::vector<TextureUpload> texture_uploads;
+            // Lowered to what was resident whenever a texture allocation fails
+            uint64_t texture_memory_limit{~0ull};
+            uint32_t supported_texture_formats{0};
+
+            RendererStats stats;
+            bool headless{false};
+            const AssetArchive* asset_archive{nullptr};
+
+            bool has_properties2{false};
+            bool has_storage_write_without_format{false};
+            bool has_memory_budget{false};
+            PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_memory_properties2{nullptr};
 
             const std::vector<const char*> validation_layers = {
                 "VK_LAYER_KHRONOS_validation"
@@ -0,0 +1,76 @@
+#version 450
+
+// See LightCulling.h
+const uint k_tile_size = 16;
+const uint k_max_lights_per_tile = 255;
+const uint k_light_tile_stride = k_max_lights_per_tile + 1;
+
+struct Light2D {
+    vec2 position;
+    float radius;
+    float height;
+    vec3 color;
+    float intensity;
+    vec2 direction;
+    float cos_inner;
+    float cos_outer;
+};
+
+layout(set = 0, binding = 0) uniform LightingParams {
+    vec2 camera_scale;
+    vec2 camera_offset;
+    vec2 extent;
+    uint tile_count_x;
+    uint tile_count_y;
+    vec4 ambient;
+    uint light_count;
+} params;
+
+layout(std430, set = 1, binding = 0) readonly buffer Lights {
+    Light2D lights[];
+};
+
+// Written by LightCulling.comp
+layout(std430, set = 1, binding = 1) readonly buffer TileLights {
+    uint tile_lights[];
+};
+
+layout(location = 0) out vec4 out_color;
+layout(location = 0) in vec4 frag_color;
+layout(location = 1) in vec2 frag_uv;
+layout(location = 2) flat in uint frag_texture_index;
+
+void main() {
+    // Back from the pixel to the sprites' space, see SpriteCamera
+    vec2 clip = gl_FragCoord.xy / params.extent * 2.0 - 1.0;
+    vec2 world = (clip - params.camera_offset) / params.camera_scale;
+
+    // No textures are bound yet, so there's no normal map
+    // either and sprites are lit as if they face the camera
+    const vec3 normal = vec3(0.0, 0.0, 1.0);
+
+    uvec2 tile = uvec2(gl_FragCoord.xy) / k_tile_size;
+    uint base = (tile.y * params.tile_count_x + tile.x) * k_light_tile_stride;
+    uint count = tile_lights[base];
+
+    // Only the lights binned into this pixel's tile, however many the scene has
+    vec3 light = params.ambient.rgb;
+    for(uint i = 0; i < count; i++) {
+        Light2D source = lights[tile_lights[base + 1 + i]];
+
+        vec2 to_pixel = world - source.position;
+        float from_light = length(to_pixel);
+        float falloff = clamp(1.0 - from_light / source.radius, 0.0, 1.0);
+        falloff *= falloff;
+
+        if(source.cos_outer > -1.0) {
+            float cos_angle = dot(to_pixel / max(from_light, 0.0001), source.direction);
+            falloff *= smoothstep(source.cos_outer, max(source.cos_inner, source.cos_outer + 0.0001), cos_angle);
+        }
+
+        vec3 to_light = normalize(vec3(-to_pixel, source.height));
+        light += source.color * (source.intensity * falloff * max(dot(normal, to_light), 0.0));
+    }
+
+    out_color = vec4(frag_color.rgb * light, frag_color.a);
+}
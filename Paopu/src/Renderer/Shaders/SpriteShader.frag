@@ -1,8 +1,11 @@
 #version 450
 
 layout(location = 0) out vec4 out_color;
-layout(location = 0) in vec3 frag_color;
+layout(location = 0) in vec4 frag_color;
+layout(location = 1) in vec2 frag_uv;
+layout(location = 2) flat in uint frag_texture_index;
 
 void main() {
-    out_color = vec4(frag_color, 1.0);
-}
\ No newline at end of file
+    // No textures are bound yet, sprites are drawn as tinted quads
+    out_color = frag_color;
+}
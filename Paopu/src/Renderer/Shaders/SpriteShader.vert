@@ -1,20 +1,37 @@
 #version 450
 
-vec2 positions[3] = vec2[](
-    vec2(0.0, -0.5),
+// See SpriteInstance.h
+layout(location = 0) in vec4 in_basis;
+layout(location = 1) in vec3 in_translation_depth;
+layout(location = 2) in uint in_texture_index;
+layout(location = 3) in vec4 in_uv_rect;
+layout(location = 4) in vec4 in_color;
+
+layout(push_constant) uniform SpriteCamera {
+    vec2 scale;
+    vec2 offset;
+} camera;
+
+// Two triangles making up a unit quad centered on the origin
+vec2 corners[6] = vec2[](
+    vec2(-0.5, -0.5),
+    vec2(0.5, -0.5),
+    vec2(0.5, 0.5),
+    vec2(-0.5, -0.5),
     vec2(0.5, 0.5),
     vec2(-0.5, 0.5)
 );
 
-vec3 colors[3] = vec3[](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
-
-layout(location = 0) out vec3 frag_color;
+layout(location = 0) out vec4 frag_color;
+layout(location = 1) out vec2 frag_uv;
+layout(location = 2) flat out uint frag_texture_index;
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    frag_color = colors[gl_VertexIndex];
-}
\ No newline at end of file
+    vec2 corner = corners[gl_VertexIndex];
+    vec2 world = mat2(in_basis.xy, in_basis.zw) * corner + in_translation_depth.xy;
+
+    gl_Position = vec4(world * camera.scale + camera.offset, in_translation_depth.z, 1.0);
+    frag_color = in_color;
+    frag_uv = mix(in_uv_rect.xy, in_uv_rect.zw, corner + 0.5);
+    frag_texture_index = in_texture_index;
+}
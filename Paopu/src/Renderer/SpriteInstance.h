@@ -0,0 +1,40 @@
+#pragma once
+#include "../Core/Core.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace Paopu {
+
+    /// Per-instance vertex data for a single sprite quad. The layout matches
+    /// the instance attributes of SpriteShader.vert, so arrays of these are
+    /// copied straight into the instance buffer.
+    ///
+    /// `basis`: 2x2 linear part of the sprite's world transform, column-major
+    ///     (x axis in .xy, y axis in .zw). The sprite's size is folded in.
+    /// `translation`: World position of the sprite's center, in pixels
+    /// `depth`: Written to gl_Position.z
+    /// `texture_index`: Index into the bound texture array
+    /// `uv_rect`: (u0, v0, u1, v1) of the sprite's frame
+    /// `color`: Tint multiplied with the sampled texel
+    struct PAOPU_API SpriteInstance {
+        glm::vec4 basis{1.0f, 0.0f, 0.0f, 1.0f};
+        glm::vec2 translation{0.0f, 0.0f};
+        float depth{0.0f};
+        uint32_t texture_index{0};
+        glm::vec4 uv_rect{0.0f, 0.0f, 1.0f, 1.0f};
+        glm::vec4 color{1.0f, 1.0f, 1.0f, 1.0f};
+    };
+
+    static_assert(sizeof(SpriteInstance) == 64, "SpriteInstance must match the shader's instance layout");
+
+    /// Push constant block of SpriteShader.vert. Maps pixel coordinates
+    /// into clip space: `clip = position * scale + offset`.
+    ///
+    struct PAOPU_API SpriteCamera {
+        glm::vec2 scale{1.0f, 1.0f};
+        glm::vec2 offset{0.0f, 0.0f};
+    };
+
+}
@@ -0,0 +1,250 @@
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Paopu {
+
+    void TextureResidency::set_settings(const ResidencySettings& residency_settings) {
+        settings = residency_settings;
+        set_budget(budget_limit);
+    }
+
+    void TextureResidency::set_budget(uint64_t bytes) {
+        budget_limit = bytes;
+        budget = settings.budget_cap > 0 ? std::min(bytes, settings.budget_cap) : bytes;
+    }
+
+    TextureHandle TextureResidency::add_texture(const ResidentTextureDesc& desc) {
+        if(desc.mip_count == 0 || desc.mip_count > k_max_texture_mips) {
+            throw std::runtime_error("[Renderer][Residency]: Textures need between 1 and 16 mips!");
+        }
+
+        TextureHandle handle;
+        if(!free_handles.empty()) {
+            handle = free_handles.back();
+            free_handles.pop_back();
+        } else {
+            handle = static_cast<TextureHandle>(textures.size());
+            textures.emplace_back();
+        }
+
+        ResidentTexture& texture = textures[handle];
+        texture = ResidentTexture{};
+        texture.desc = desc;
+        texture.desc.tail_mips = std::min(std::max(desc.tail_mips, 1u), desc.mip_count);
+        texture.resident_mip = desc.mip_count;
+        texture.needed_mip = desc.mip_count - 1;
+        texture.alive = true;
+
+        for(uint32_t mip = 0; mip < desc.mip_count; mip++) {
+            uint64_t width = std::max(desc.width >> mip, 1u);
+            uint64_t height = std::max(desc.height >> mip, 1u);
+            uint64_t blocks = ((width + desc.block_width - 1) / desc.block_width) * ((height + desc.block_height - 1) / desc.block_height);
+            texture.mip_bytes[mip] = blocks * desc.block_bytes;
+        }
+
+        // New textures go to the front so their tails load soon
+        link_front(handle);
+        texture_count++;
+        return handle;
+    }
+
+    void TextureResidency::remove_texture(TextureHandle handle) {
+        if(!is_valid(handle)) return;
+        ResidentTexture& texture = textures[handle];
+
+        for(uint32_t mip = texture.resident_mip; mip < texture.desc.mip_count; mip++) {
+            resident_bytes -= texture.mip_bytes[mip];
+        }
+        if(texture.loading_mip != k_no_mip) {
+            pending_bytes -= texture.mip_bytes[texture.loading_mip];
+        }
+
+        unlink(handle);
+        texture.alive = false;
+        free_handles.push_back(handle);
+        texture_count--;
+    }
+
+    void TextureResidency::mark_used(TextureHandle handle, uint32_t mip) {
+        ResidentTexture& texture = textures[handle];
+
+        if(texture.used_frame != frame) {
+            texture.used_frame = frame;
+            texture.needed_mip = mip;
+            if(lru_head != handle) {
+                unlink(handle);
+                link_front(handle);
+            }
+        } else {
+            texture.needed_mip = std::min(texture.needed_mip, mip);
+        }
+    }
+
+    void TextureResidency::report_sprites(const SpriteInstance* sprites, uint32_t count) {
+        for(uint32_t i = 0; i < count; i++) {
+            const SpriteInstance& sprite = sprites[i];
+            if(!is_valid(sprite.texture_index)) continue;
+
+            const ResidentTextureDesc& desc = textures[sprite.texture_index].desc;
+
+            // Texels of the sprite's frame per pixel it covers, on whichever axis is
+            // minified more
+            float width = std::sqrt(sprite.basis.x * sprite.basis.x + sprite.basis.y * sprite.basis.y);
+            float height = std::sqrt(sprite.basis.z * sprite.basis.z + sprite.basis.w * sprite.basis.w);
+            float texels_x = desc.width * std::abs(sprite.uv_rect.z - sprite.uv_rect.x);
+            float texels_y = desc.height * std::abs(sprite.uv_rect.w - sprite.uv_rect.y);
+
+            uint32_t mip = desc.mip_count - 1;
+            if(width > 0.0f && height > 0.0f) {
+                float ratio = std::max(texels_x / width, texels_y / height);
+                // ilogb is floor(log2) for anything above 1
+                mip = ratio > 1.0f ? std::min(static_cast<uint32_t>(std::ilogb(ratio)), mip) : 0;
+            }
+
+            mark_used(sprite.texture_index, mip);
+        }
+    }
+
+    void TextureResidency::update(std::vector<ResidencyRequest>& loads, std::vector<ResidencyRequest>& evictions) {
+        TextureHandle cursor = lru_tail;
+
+        // The budget shrank below what's resident. Mips nobody needs go first,
+        // then the finest needed ones of the least recently used textures.
+        if(resident_bytes + pending_bytes > budget && !make_room(0, k_no_texture, cursor, evictions)) {
+            for(TextureHandle handle = lru_tail; handle != k_no_texture && resident_bytes + pending_bytes > budget; handle = textures[handle].prev) {
+                ResidentTexture& texture = textures[handle];
+                if(texture.loading_mip != k_no_mip) continue;
+
+                while(resident_bytes + pending_bytes > budget && texture.resident_mip < get_tail_mip(texture)) {
+                    evict_mip(handle, evictions);
+                }
+            }
+        }
+
+        // Most recently used first, one level at a time so every texture
+        // sharpens a step before any gets its full resolution
+        uint32_t issued = 0;
+        for(TextureHandle handle = lru_head; handle != k_no_texture && issued < settings.max_loads_per_update; handle = textures[handle].next) {
+            ResidentTexture& texture = textures[handle];
+            if(texture.loading_mip != k_no_mip || texture.resident_mip <= get_wanted_mip(texture)) continue;
+
+            uint32_t mip = texture.resident_mip - 1;
+            uint64_t bytes = texture.mip_bytes[mip];
+            if(!make_room(bytes, handle, cursor, evictions)) continue;
+
+            texture.loading_mip = mip;
+            pending_bytes += bytes;
+            loads.push_back({handle, mip});
+            load_count++;
+            issued++;
+        }
+
+        frame++;
+    }
+
+    void TextureResidency::complete_load(TextureHandle handle, uint32_t mip) {
+        if(!is_valid(handle)) return;
+        ResidentTexture& texture = textures[handle];
+        if(texture.loading_mip != mip) return;
+
+        pending_bytes -= texture.mip_bytes[mip];
+        resident_bytes += texture.mip_bytes[mip];
+        texture.resident_mip = mip;
+        texture.loading_mip = k_no_mip;
+    }
+
+    void TextureResidency::fail_load(TextureHandle handle, uint32_t mip) {
+        if(!is_valid(handle)) return;
+        ResidentTexture& texture = textures[handle];
+        if(texture.loading_mip != mip) return;
+
+        pending_bytes -= texture.mip_bytes[mip];
+        texture.loading_mip = k_no_mip;
+    }
+
+    uint32_t TextureResidency::get_resident_mip(TextureHandle handle) const {
+        return textures[handle].resident_mip;
+    }
+
+    uint64_t TextureResidency::get_mip_bytes(TextureHandle handle, uint32_t mip) const {
+        return textures[handle].mip_bytes[mip];
+    }
+
+    ResidencyStats TextureResidency::get_stats() const {
+        ResidencyStats stats;
+        stats.budget = budget;
+        stats.resident_bytes = resident_bytes;
+        stats.pending_bytes = pending_bytes;
+        stats.texture_count = texture_count;
+        stats.loads = load_count;
+        stats.evictions = eviction_count;
+        return stats;
+    }
+
+    uint32_t TextureResidency::get_wanted_mip(const ResidentTexture& texture) const {
+        uint32_t tail = get_tail_mip(texture);
+        if(texture.used_frame == 0 || frame - texture.used_frame > settings.keep_frames) {
+            return tail;
+        }
+        return std::min(texture.needed_mip, tail);
+    }
+
+    void TextureResidency::link_front(TextureHandle handle) {
+        ResidentTexture& texture = textures[handle];
+        texture.prev = k_no_texture;
+        texture.next = lru_head;
+
+        if(lru_head != k_no_texture) {
+            textures[lru_head].prev = handle;
+        } else {
+            lru_tail = handle;
+        }
+        lru_head = handle;
+    }
+
+    void TextureResidency::unlink(TextureHandle handle) {
+        ResidentTexture& texture = textures[handle];
+
+        if(texture.prev != k_no_texture) {
+            textures[texture.prev].next = texture.next;
+        } else {
+            lru_head = texture.next;
+        }
+
+        if(texture.next != k_no_texture) {
+            textures[texture.next].prev = texture.prev;
+        } else {
+            lru_tail = texture.prev;
+        }
+
+        texture.prev = k_no_texture;
+        texture.next = k_no_texture;
+    }
+
+    void TextureResidency::evict_mip(TextureHandle handle, std::vector<ResidencyRequest>& evictions) {
+        ResidentTexture& texture = textures[handle];
+
+        resident_bytes -= texture.mip_bytes[texture.resident_mip];
+        evictions.push_back({handle, texture.resident_mip});
+        texture.resident_mip++;
+        eviction_count++;
+    }
+
+    bool TextureResidency::make_room(uint64_t bytes, TextureHandle skip, TextureHandle& cursor, std::vector<ResidencyRequest>& evictions) {
+        while(resident_bytes + pending_bytes + bytes > budget) {
+            if(cursor == k_no_texture) return false;
+
+            ResidentTexture& texture = textures[cursor];
+            if(cursor != skip && texture.loading_mip == k_no_mip && texture.resident_mip < get_wanted_mip(texture)) {
+                evict_mip(cursor, evictions);
+            } else {
+                cursor = texture.prev;
+            }
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include "../Core/Core.h"
+#include "SpriteInstance.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    using TextureHandle = uint32_t;
+
+    static const TextureHandle k_no_texture = ~0u;
+    static const uint32_t k_max_texture_mips = 16;
+
+    /// `width`, `height`: Size of mip 0 in texels
+    /// `mip_count`: Levels in the full chain, at most k_max_texture_mips
+    /// `block_width`, `block_height`, `block_bytes`: Texel block of the format,
+    ///     1x1 and 4 bytes for RGBA8, 4x4 and 8 or 16 bytes for BC formats
+    /// `tail_mips`: Smallest levels that always stay resident, so there is
+    ///     something to sample while finer mips stream in
+    struct PAOPU_API ResidentTextureDesc {
+        uint32_t width{1};
+        uint32_t height{1};
+        uint32_t mip_count{1};
+        uint32_t block_width{1};
+        uint32_t block_height{1};
+        uint32_t block_bytes{4};
+        uint32_t tail_mips{1};
+    };
+
+    /// `budget_cap`: Bytes textures may use at most, 0 for no cap. Devices
+    ///     without VK_EXT_memory_budget rely on it, see Renderer::update_texture_budget
+    /// `budget_fraction`: Share of the heap's budget the renderer hands to
+    ///     textures, leaving headroom for everything else
+    /// `max_loads_per_update`: Mip loads requested per `update`
+    /// `keep_frames`: Frames a texture's mips count as needed after it was last
+    ///     seen, so sprites briefly off screen aren't evicted and reloaded
+    struct PAOPU_API ResidencySettings {
+        uint64_t budget_cap{0};
+        float budget_fraction{0.8f};
+        uint32_t max_loads_per_update{8};
+        uint32_t keep_frames{30};
+    };
+
+    /// `mip` of `texture` should be loaded, or was evicted
+    ///
+    ///
+    struct PAOPU_API ResidencyRequest {
+        TextureHandle texture{k_no_texture};
+        uint32_t mip{0};
+    };
+
+    struct PAOPU_API ResidencyStats {
+        uint64_t budget{0};
+        uint64_t resident_bytes{0};
+        // Bytes of loads requested but not completed yet
+        uint64_t pending_bytes{0};
+        uint32_t texture_count{0};
+        uint64_t loads{0};
+        uint64_t evictions{0};
+    };
+
+    /// Decides which texture mips are resident within a memory budget.
+    ///
+    /// Each texture keeps a contiguous range of mips resident, from its finest
+    /// resident level down to the smallest. Usage feedback (`mark_used`, or
+    /// `report_sprites` for a frame's sprites) says which level each texture
+    /// needs on screen. `update` then requests the next finer mip for the most
+    /// recently used textures that need one, as long as it fits the budget,
+    /// and evicts the finest mips of the least recently used textures to make
+    /// room or when the budget shrinks.
+    ///
+    /// Mips a texture still needs are only evicted when the budget can't be met
+    /// otherwise, so a budget that fits the visible set never thrashes.
+    ///
+    /// This is the policy only, the renderer carries out the requests. Loads
+    /// are reported back with `complete_load` or `fail_load`.
+    class PAOPU_API TextureResidency {
+
+        public:
+            void set_settings(const ResidencySettings& settings);
+            inline const ResidencySettings& get_settings() const { return settings; }
+
+            /// Bytes textures may use from now on, limited by `budget_cap`.
+            /// Unlimited until set. Evictions happen in the next `update`.
+            ///
+            void set_budget(uint64_t budget);
+
+            /// Registers a texture with nothing resident. Its tail mips are
+            /// requested by the next `update`s.
+            ///
+            TextureHandle add_texture(const ResidentTextureDesc& desc);
+
+            /// Forgets `texture`, its resident and pending bytes are released
+            ///
+            ///
+            void remove_texture(TextureHandle texture);
+
+            /// Notes that `texture` was used this frame and needs mips down to
+            /// `mip` (0 is the full resolution)
+            ///
+            void mark_used(TextureHandle texture, uint32_t mip);
+
+            /// Marks the textures of `count` sprites as used, each at the mip
+            /// matching its size on screen. Sprites are in pixels, see SpriteInstance.
+            ///
+            void report_sprites(const SpriteInstance* sprites, uint32_t count);
+
+            /// Ends the frame: appends the mips to load to `loads` (most
+            /// recently used first) and the mips evicted to `evictions`. Every
+            /// load must be answered with `complete_load` or `fail_load`.
+            ///
+            void update(std::vector<ResidencyRequest>& loads, std::vector<ResidencyRequest>& evictions);
+
+            void complete_load(TextureHandle texture, uint32_t mip);
+
+            /// The load is dropped and will be requested again later
+            ///
+            ///
+            void fail_load(TextureHandle texture, uint32_t mip);
+
+            /// Finest resident mip of `texture`, its mip count if nothing is resident
+            ///
+            ///
+            uint32_t get_resident_mip(TextureHandle texture) const;
+
+            /// Whether `mip` of `texture` was requested and not completed yet
+            ///
+            ///
+            inline bool is_loading(TextureHandle texture, uint32_t mip) const { return is_valid(texture) && textures[texture].loading_mip == mip; }
+
+            uint64_t get_mip_bytes(TextureHandle texture, uint32_t mip) const;
+            inline const ResidentTextureDesc& get_desc(TextureHandle texture) const { return textures[texture].desc; }
+            inline bool is_valid(TextureHandle texture) const { return texture < textures.size() && textures[texture].alive; }
+
+            ResidencyStats get_stats() const;
+
+        private:
+            static constexpr uint32_t k_no_mip = ~0u;
+
+            struct ResidentTexture {
+                ResidentTextureDesc desc;
+                uint64_t mip_bytes[k_max_texture_mips];
+                // Finest resident level, desc.mip_count when nothing is
+                uint32_t resident_mip{0};
+                // Level being loaded, k_no_mip if none
+                uint32_t loading_mip{k_no_mip};
+                // Finest level needed as of `used_frame`
+                uint32_t needed_mip{0};
+                uint64_t used_frame{0};
+
+                // LRU list, most recently used at `lru_head`
+                TextureHandle prev{k_no_texture};
+                TextureHandle next{k_no_texture};
+                bool alive{false};
+            };
+
+            /// Level `texture` should have resident: what it needs if it was seen
+            /// within `keep_frames`, otherwise just its tail
+            ///
+            uint32_t get_wanted_mip(const ResidentTexture& texture) const;
+            inline uint32_t get_tail_mip(const ResidentTexture& texture) const { return texture.desc.mip_count - texture.desc.tail_mips; }
+
+            void link_front(TextureHandle handle);
+            void unlink(TextureHandle handle);
+
+            void evict_mip(TextureHandle handle, std::vector<ResidencyRequest>& evictions);
+
+            /// Evicts mips nobody needs, least recently used first, until
+            /// `bytes` more fit the budget. `cursor` walks from the LRU end and
+            /// carries over between calls in one update. Returns whether they fit.
+            ///
+            bool make_room(uint64_t bytes, TextureHandle skip, TextureHandle& cursor, std::vector<ResidencyRequest>& evictions);
+
+        private:
+            ResidencySettings settings;
+            uint64_t budget{~0ull};
+            uint64_t budget_limit{~0ull};
+            uint64_t resident_bytes{0};
+            uint64_t pending_bytes{0};
+            uint64_t frame{1};
+            uint64_t load_count{0};
+            uint64_t eviction_count{0};
+
+            std::vector<ResidentTexture> textures;
+            std::vector<TextureHandle> free_handles;
+            uint32_t texture_count{0};
+            TextureHandle lru_head{k_no_texture};
+            TextureHandle lru_tail{k_no_texture};
+    };
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "../../Core/Core.h"
+#include "Device.h"
+#include "HostAllocator.h"
+
+#include <stdexcept>
+
+namespace Paopu {
+
+	/// A Vulkan buffer and the memory that backs it. Host visible buffers
+	/// are persistently mapped into `mapped`.
+	///
+	struct PAOPU_API PaopuBuffer {
+		VkBuffer buffer{VK_NULL_HANDLE};
+		VkDeviceMemory memory{VK_NULL_HANDLE};
+		VkDeviceSize size{0};
+		void* mapped{nullptr};
+	};
+
+	/// Finds a memory type on `physical_device` that is allowed by `type_filter`
+	/// and has all of the requested `properties`.
+	///
+	inline PAOPU_API uint32_t find_memory_type(VkPhysicalDevice physical_device, uint32_t type_filter, VkMemoryPropertyFlags properties) {
+		VkPhysicalDeviceMemoryProperties memory_properties;
+		vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+		for(uint32_t i = 0; i < memory_properties.memoryTypeCount; i++) {
+			if((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties) {
+				return i;
+			}
+		}
+
+		throw std::runtime_error("[Renderer][Vulkan]: Failed to find a suitable memory type!");
+	}
+
+	/// Creates a buffer of `size` bytes. If `properties` contains
+	/// VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT the buffer stays mapped until freed.
+	///
+	inline PAOPU_API void create_buffer(PaopuDevice* device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, PaopuBuffer* buffer) {
+		VkBufferCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		create_info.size = size;
+		create_info.usage = usage;
+		create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if(vkCreateBuffer(device->logical_device, &create_info, get_host_allocator(), &buffer->buffer) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Buffer creation failed!");
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(device->logical_device, buffer->buffer, &requirements);
+
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = requirements.size;
+		alloc_info.memoryTypeIndex = find_memory_type(device->physical_device, requirements.memoryTypeBits, properties);
+
+		if(vkAllocateMemory(device->logical_device, &alloc_info, get_host_allocator(), &buffer->memory) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Buffer memory allocation failed!");
+		}
+
+		vkBindBufferMemory(device->logical_device, buffer->buffer, buffer->memory, 0);
+		buffer->size = size;
+
+		if(properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+			vkMapMemory(device->logical_device, buffer->memory, 0, size, 0, &buffer->mapped);
+		}
+	}
+
+	///
+	///
+	///
+	inline PAOPU_API void free_buffer(VkDevice logical_device, PaopuBuffer* buffer) {
+		if(buffer->mapped != nullptr) {
+			vkUnmapMemory(logical_device, buffer->memory);
+		}
+		vkDestroyBuffer(logical_device, buffer->buffer, get_host_allocator());
+		vkFreeMemory(logical_device, buffer->memory, get_host_allocator());
+		*buffer = PaopuBuffer{};
+	}
+
+}
@@ -0,0 +1,327 @@
+#include "Descriptors.h"
+
+#include "HostAllocator.h"
+#include "../../Core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace Paopu {
+
+	/// Appends the bytes of `value` to a cache key. Only plain fields and
+	/// handles go in, so there's no padding to compare.
+	template<typename T>
+	static inline void append_key(std::vector<uint8_t>& key, const T& value) {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+		key.insert(key.end(), bytes, bytes + sizeof(T));
+	}
+
+	uint32_t PaopuContentIndex::find(const std::vector<uint8_t>& key, uint64_t hash) const {
+		auto head = heads.find(hash);
+		if(head == heads.end()) return k_no_content;
+
+		for(uint32_t i = head->second; i != k_no_content; i = entries[i].next) {
+			const Entry& entry = entries[i];
+			if(entry.key_size == key.size() && memcmp(&keys[entry.key_offset], key.data(), key.size()) == 0) {
+				return entry.value;
+			}
+		}
+		return k_no_content;
+	}
+
+	void PaopuContentIndex::insert(const std::vector<uint8_t>& key, uint64_t hash, uint32_t value) {
+		Entry entry;
+		entry.key_offset = keys.size();
+		entry.key_size = key.size();
+		entry.value = value;
+		entry.next = k_no_content;
+
+		uint32_t index = static_cast<uint32_t>(entries.size());
+		auto head = heads.find(hash);
+		if(head != heads.end()) {
+			entry.next = head->second;
+			head->second = index;
+		} else {
+			heads.emplace(hash, index);
+		}
+
+		keys.insert(keys.end(), key.begin(), key.end());
+		entries.push_back(entry);
+	}
+
+	void PaopuContentIndex::clear() {
+		heads.clear();
+		entries.clear();
+		keys.clear();
+	}
+
+	uint64_t PaopuContentIndex::hash(const std::vector<uint8_t>& key) {
+		// FNV-1a, like hash_asset_name
+		uint64_t hash = 14695981039346656037ull;
+		for(uint8_t byte : key) {
+			hash = (hash ^ byte) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	void PaopuDescriptorLayoutCache::init(VkDevice logical_device) {
+		this->logical_device = logical_device;
+	}
+
+	VkDescriptorSetLayout PaopuDescriptorLayoutCache::get_layout(const VkDescriptorSetLayoutBinding* bindings, uint32_t binding_count) {
+		// Sorted, so the order bindings are listed in doesn't matter
+		sorted.assign(bindings, bindings + binding_count);
+		std::sort(sorted.begin(), sorted.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+			return a.binding < b.binding;
+		});
+
+		key.clear();
+		for(const VkDescriptorSetLayoutBinding& binding : sorted) {
+			append_key(key, binding.binding);
+			append_key(key, binding.descriptorType);
+			append_key(key, binding.descriptorCount);
+			append_key(key, binding.stageFlags);
+			uint32_t sampler_count = binding.pImmutableSamplers != nullptr ? binding.descriptorCount : 0;
+			append_key(key, sampler_count);
+			for(uint32_t i = 0; i < sampler_count; i++) {
+				append_key(key, binding.pImmutableSamplers[i]);
+			}
+		}
+
+		uint64_t hash = PaopuContentIndex::hash(key);
+		uint32_t found = index.find(key, hash);
+		if(found != k_no_content) return layouts[found];
+
+		VkDescriptorSetLayoutCreateInfo layout_info{};
+		layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layout_info.bindingCount = binding_count;
+		layout_info.pBindings = sorted.data();
+
+		VkDescriptorSetLayout layout;
+		if(vkCreateDescriptorSetLayout(logical_device, &layout_info, get_host_allocator(), &layout) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Descriptor set layout creation failed!");
+		}
+
+		index.insert(key, hash, static_cast<uint32_t>(layouts.size()));
+		layouts.push_back(layout);
+		return layout;
+	}
+
+	void PaopuDescriptorLayoutCache::free() {
+		for(VkDescriptorSetLayout layout : layouts) {
+			vkDestroyDescriptorSetLayout(logical_device, layout, get_host_allocator());
+		}
+		layouts.clear();
+		index.clear();
+	}
+
+	PaopuDescriptorWriter& PaopuDescriptorWriter::write_buffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+		Write write;
+		write.binding = binding;
+		write.array_element = 0;
+		write.type = type;
+		write.info = static_cast<uint32_t>(buffer_infos.size());
+		write.image = false;
+		writes.push_back(write);
+		buffer_infos.push_back({buffer, offset, range});
+
+		append_key(key, binding);
+		append_key(key, type);
+		append_key(key, buffer);
+		append_key(key, offset);
+		append_key(key, range);
+		return *this;
+	}
+
+	PaopuDescriptorWriter& PaopuDescriptorWriter::write_image(uint32_t binding, VkDescriptorType type, VkImageView view, VkSampler sampler,
+																VkImageLayout layout, uint32_t array_element) {
+		Write write;
+		write.binding = binding;
+		write.array_element = array_element;
+		write.type = type;
+		write.info = static_cast<uint32_t>(image_infos.size());
+		write.image = true;
+		writes.push_back(write);
+		image_infos.push_back({sampler, view, layout});
+
+		append_key(key, binding);
+		append_key(key, array_element);
+		append_key(key, type);
+		append_key(key, view);
+		append_key(key, sampler);
+		append_key(key, layout);
+		return *this;
+	}
+
+	void PaopuDescriptorWriter::update(VkDevice logical_device, VkDescriptorSet set) {
+		// The infos are only pointed to once they've stopped moving
+		vk_writes.resize(writes.size());
+		for(size_t i = 0; i < writes.size(); i++) {
+			const Write& write = writes[i];
+			VkWriteDescriptorSet& vk_write = vk_writes[i];
+			vk_write = VkWriteDescriptorSet{};
+			vk_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			vk_write.dstSet = set;
+			vk_write.dstBinding = write.binding;
+			vk_write.dstArrayElement = write.array_element;
+			vk_write.descriptorCount = 1;
+			vk_write.descriptorType = write.type;
+			if(write.image) {
+				vk_write.pImageInfo = &image_infos[write.info];
+			} else {
+				vk_write.pBufferInfo = &buffer_infos[write.info];
+			}
+		}
+
+		vkUpdateDescriptorSets(logical_device, static_cast<uint32_t>(vk_writes.size()), vk_writes.data(), 0, nullptr);
+	}
+
+	void PaopuDescriptorWriter::clear() {
+		writes.clear();
+		buffer_infos.clear();
+		image_infos.clear();
+		key.clear();
+	}
+
+	void PaopuDescriptorAllocator::init(VkDevice logical_device, const PaopuDescriptorAllocatorSettings& settings) {
+		this->logical_device = logical_device;
+		this->settings = settings;
+		this->settings.frame_count = std::max(settings.frame_count, 1u);
+		this->settings.sets_per_pool = std::max(settings.sets_per_pool, 1u);
+		this->settings.max_sets_per_pool = std::max(settings.max_sets_per_pool, this->settings.sets_per_pool);
+		next_pool_sets = this->settings.sets_per_pool;
+
+		frames.clear();
+		frames.resize(this->settings.frame_count);
+		frame_index = 0;
+		stats = PaopuDescriptorStats{};
+	}
+
+	void PaopuDescriptorAllocator::begin_frame(uint32_t frame_index) {
+		// Wrapping the index around would hand out pools a frame still in
+		// flight is reading from
+		if(frame_index >= settings.frame_count) {
+			throw std::runtime_error("[Renderer][Vulkan]: Descriptor allocator has fewer frames than are in flight!");
+		}
+		this->frame_index = frame_index;
+		reset(frames[this->frame_index]);
+		stats.frame_sets = 0;
+	}
+
+	VkDescriptorSet PaopuDescriptorAllocator::allocate(VkDescriptorSetLayout layout) {
+		VkDescriptorSet set = allocate_from(frames[frame_index], layout);
+		stats.frame_sets++;
+		return set;
+	}
+
+	VkDescriptorSet PaopuDescriptorAllocator::get_persistent(VkDescriptorSetLayout layout, PaopuDescriptorWriter& writer) {
+		const std::vector<uint8_t>& contents = writer.get_key();
+		key.clear();
+		append_key(key, layout);
+		key.insert(key.end(), contents.begin(), contents.end());
+
+		uint64_t hash = PaopuContentIndex::hash(key);
+		uint32_t found = persistent_index.find(key, hash);
+		if(found != k_no_content) {
+			stats.persistent_hits++;
+			return persistent_sets[found];
+		}
+
+		VkDescriptorSet set = allocate_from(persistent, layout);
+		writer.update(logical_device, set);
+
+		persistent_index.insert(key, hash, static_cast<uint32_t>(persistent_sets.size()));
+		persistent_sets.push_back(set);
+		stats.persistent_sets++;
+		return set;
+	}
+
+	void PaopuDescriptorAllocator::reset_persistent() {
+		reset(persistent);
+		persistent_sets.clear();
+		persistent_index.clear();
+		stats.persistent_sets = 0;
+	}
+
+	void PaopuDescriptorAllocator::free() {
+		for(PoolList& list : frames) {
+			for(VkDescriptorPool pool : list.pools) {
+				vkDestroyDescriptorPool(logical_device, pool, get_host_allocator());
+			}
+		}
+		for(VkDescriptorPool pool : persistent.pools) {
+			vkDestroyDescriptorPool(logical_device, pool, get_host_allocator());
+		}
+		frames.clear();
+		persistent = PoolList{};
+		persistent_sets.clear();
+		persistent_index.clear();
+		stats = PaopuDescriptorStats{};
+	}
+
+	VkDescriptorSet PaopuDescriptorAllocator::allocate_from(PoolList& list, VkDescriptorSetLayout layout) {
+		VkDescriptorSetAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		alloc_info.descriptorSetCount = 1;
+		alloc_info.pSetLayouts = &layout;
+
+		for(bool fresh = false; ; ) {
+			if(list.current == list.pools.size()) {
+				list.pools.push_back(create_pool(next_pool_sets));
+				next_pool_sets = std::min(next_pool_sets * 2, settings.max_sets_per_pool);
+				fresh = true;
+			}
+
+			alloc_info.descriptorPool = list.pools[list.current];
+			VkDescriptorSet set;
+			VkResult result = vkAllocateDescriptorSets(logical_device, &alloc_info, &set);
+			if(result == VK_SUCCESS) return set;
+
+			if(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+				throw std::runtime_error("[Renderer][Vulkan]: Descriptor set allocation failed!");
+			}
+			// An empty pool that can't hold it never will
+			if(fresh) {
+				throw std::runtime_error("[Renderer][Vulkan]: Descriptor set doesn't fit in a pool, raise the pool ratios!");
+			}
+			list.current++;
+		}
+	}
+
+	VkDescriptorPool PaopuDescriptorAllocator::create_pool(uint32_t set_count) {
+		PAO_PROFILE_FUNCTION();
+
+		std::vector<VkDescriptorPoolSize> sizes;
+		sizes.reserve(settings.ratios.size());
+		for(const PaopuDescriptorPoolRatio& ratio : settings.ratios) {
+			uint32_t count = static_cast<uint32_t>(std::ceil(ratio.per_set * set_count));
+			if(count > 0) sizes.push_back({ratio.type, count});
+		}
+
+		VkDescriptorPoolCreateInfo pool_info{};
+		pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		pool_info.maxSets = set_count;
+		pool_info.poolSizeCount = static_cast<uint32_t>(sizes.size());
+		pool_info.pPoolSizes = sizes.data();
+
+		VkDescriptorPool pool;
+		if(vkCreateDescriptorPool(logical_device, &pool_info, get_host_allocator(), &pool) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Descriptor pool creation failed!");
+		}
+		stats.pool_count++;
+		return pool;
+	}
+
+	void PaopuDescriptorAllocator::reset(PoolList& list) {
+		// Only the pools that were allocated from have anything to release
+		uint32_t used = std::min(list.current + 1, static_cast<uint32_t>(list.pools.size()));
+		for(uint32_t i = 0; i < used; i++) {
+			vkResetDescriptorPool(logical_device, list.pools[i], 0);
+		}
+		stats.pool_resets += used;
+		list.current = 0;
+	}
+
+}
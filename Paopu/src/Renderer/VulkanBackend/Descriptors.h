@@ -0,0 +1,228 @@
+#pragma once
+
+#include "../../Core/Core.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Paopu {
+
+	static const uint32_t k_no_content = ~0u;
+
+	/// Indices keyed by a byte string. Keys are found by their FNV-1a hash
+	/// and then compared, so two contents that collide never share an entry.
+	///
+	class PAOPU_API PaopuContentIndex {
+
+		public:
+			/// The value stored for `key`, or k_no_content
+			///
+			///
+			uint32_t find(const std::vector<uint8_t>& key, uint64_t hash) const;
+
+			void insert(const std::vector<uint8_t>& key, uint64_t hash, uint32_t value);
+
+			void clear();
+
+			static uint64_t hash(const std::vector<uint8_t>& key);
+
+		private:
+			struct Entry {
+				size_t key_offset;
+				size_t key_size;
+				uint32_t value;
+				// Next entry with the same hash
+				uint32_t next;
+			};
+
+			// First entry of each hash
+			std::unordered_map<uint64_t, uint32_t> heads;
+			std::vector<Entry> entries;
+			std::vector<uint8_t> keys;
+	};
+
+	/// Descriptor set layouts by their bindings. Asking twice for the same
+	/// bindings, in any order, hands back the same layout, so passes and
+	/// materials can describe what they bind without creating duplicates.
+	///
+	class PAOPU_API PaopuDescriptorLayoutCache {
+
+		public:
+			void init(VkDevice logical_device);
+
+			/// The layout with `bindings`, created the first time it's asked
+			/// for. Immutable samplers are part of the content.
+			///
+			VkDescriptorSetLayout get_layout(const VkDescriptorSetLayoutBinding* bindings, uint32_t binding_count);
+
+			/// Destroys every layout, which must no longer be in use
+			///
+			///
+			void free();
+
+			inline uint32_t get_layout_count() const { return static_cast<uint32_t>(layouts.size()); }
+
+		private:
+			VkDevice logical_device{VK_NULL_HANDLE};
+			std::vector<VkDescriptorSetLayout> layouts;
+			PaopuContentIndex index;
+
+			std::vector<VkDescriptorSetLayoutBinding> sorted;
+			std::vector<uint8_t> key;
+	};
+
+	/// Descriptors a pool holds of one type, per set it's sized for
+	///
+	///
+	struct PAOPU_API PaopuDescriptorPoolRatio {
+		VkDescriptorType type;
+		float per_set;
+	};
+
+	/// `frame_count`: Frames that can be in flight at once, each gets its
+	///     own pools. The renderer passes k_max_frames_in_flight.
+	/// `sets_per_pool`: Sets the first pool holds. Pools created after it
+	///     double in size up to `max_sets_per_pool`.
+	/// `ratios`: Mix of descriptors a pool holds, per set
+	struct PAOPU_API PaopuDescriptorAllocatorSettings {
+		uint32_t frame_count{1};
+		uint32_t sets_per_pool{64};
+		uint32_t max_sets_per_pool{4096};
+		std::vector<PaopuDescriptorPoolRatio> ratios = {
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f},
+			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+			{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f},
+			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+			{VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f}
+		};
+	};
+
+	/// Counters since the allocator was initialized, besides `frame_sets`
+	///
+	///
+	struct PAOPU_API PaopuDescriptorStats {
+		uint32_t pool_count{0};
+		// Allocated for the current frame
+		uint32_t frame_sets{0};
+		uint32_t persistent_sets{0};
+		uint64_t persistent_hits{0};
+		uint64_t pool_resets{0};
+	};
+
+	/// The contents of a descriptor set, one descriptor per write. Also the
+	/// key persistent sets are cached by.
+	///
+	class PAOPU_API PaopuDescriptorWriter {
+
+		public:
+			PaopuDescriptorWriter& write_buffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+
+			PaopuDescriptorWriter& write_image(uint32_t binding, VkDescriptorType type, VkImageView view, VkSampler sampler,
+												VkImageLayout layout, uint32_t array_element = 0);
+
+			/// Writes everything into `set`
+			///
+			///
+			void update(VkDevice logical_device, VkDescriptorSet set);
+
+			void clear();
+
+			inline const std::vector<uint8_t>& get_key() const { return key; }
+
+		private:
+			struct Write {
+				uint32_t binding;
+				uint32_t array_element;
+				VkDescriptorType type;
+				// Into `buffer_infos` or `image_infos`
+				uint32_t info;
+				bool image;
+			};
+
+			std::vector<Write> writes;
+			std::vector<VkDescriptorBufferInfo> buffer_infos;
+			std::vector<VkDescriptorImageInfo> image_infos;
+			std::vector<VkWriteDescriptorSet> vk_writes;
+			std::vector<uint8_t> key;
+	};
+
+	/// Hands out descriptor sets from pools that are reset whole, never
+	/// freed set by set.
+	///
+	/// Each frame in flight owns a list of pools. Sets come from the first
+	/// pool with room; when one runs out the next is used, and a new one,
+	/// twice the size of the last, is created only when the list is used up.
+	/// `begin_frame` resets the pools the frame touched last time with
+	/// vkResetDescriptorPool, so once a scene has settled a frame allocates
+	/// out of pools that already exist and nothing fragments.
+	///
+	/// Sets that don't change from frame to frame, like a material's
+	/// textures, come from `get_persistent` instead: they live in pools
+	/// that are never reset and are cached by their layout and contents, so
+	/// asking for the same set again is a hash lookup.
+	class PAOPU_API PaopuDescriptorAllocator {
+
+		public:
+			void init(VkDevice logical_device, const PaopuDescriptorAllocatorSettings& settings = PaopuDescriptorAllocatorSettings());
+
+			/// Starts frame `frame_index`, releasing every set it allocated
+			/// the last time around. The GPU has to be done with that frame.
+			/// Throws if the index is past `frame_count`.
+			void begin_frame(uint32_t frame_index);
+
+			/// A set of `layout` for the current frame, valid until the frame
+			/// begins again. Throws if the layout holds more than a pool does.
+			///
+			VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+			/// A set of `layout` holding what `writer` describes, created and
+			/// written the first time it's asked for. Valid until `free` or
+			/// `reset_persistent`.
+			///
+			VkDescriptorSet get_persistent(VkDescriptorSetLayout layout, PaopuDescriptorWriter& writer);
+
+			/// Drops every persistent set. Needed once something they point to
+			/// is destroyed, and the GPU has to be done with them.
+			///
+			void reset_persistent();
+
+			void free();
+
+			inline const PaopuDescriptorStats& get_stats() const { return stats; }
+
+		private:
+			/// Pools sets are allocated from in turn. Everything before
+			/// `current` ran out of room.
+			struct PoolList {
+				std::vector<VkDescriptorPool> pools;
+				uint32_t current{0};
+			};
+
+			VkDescriptorSet allocate_from(PoolList& list, VkDescriptorSetLayout layout);
+			VkDescriptorPool create_pool(uint32_t set_count);
+			void reset(PoolList& list);
+
+			VkDevice logical_device{VK_NULL_HANDLE};
+			PaopuDescriptorAllocatorSettings settings;
+			// Sets the next pool created holds
+			uint32_t next_pool_sets{0};
+
+			std::vector<PoolList> frames;
+			uint32_t frame_index{0};
+
+			PoolList persistent;
+			std::vector<VkDescriptorSet> persistent_sets;
+			PaopuContentIndex persistent_index;
+			std::vector<uint8_t> key;
+
+			PaopuDescriptorStats stats;
+	};
+
+}
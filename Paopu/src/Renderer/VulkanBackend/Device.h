@@ -1,14 +1,14 @@
 #pragma once
 #include "../../Core/Core.h"
 #include "Swapchain.h"
+#include "HostAllocator.h"
 //#define GLFW_INCLUDE_VULKAN
 //#include <GLFW/glfw3.h>
-#include <Vulkan/vulkan.h>
+#include <vulkan/vulkan.h>
 
+#include <cstring>
 #include <vector>
-#include <set>
 #include <optional>
-#include <string>
 
 namespace Paopu {
 	
@@ -44,7 +44,7 @@ namespace Paopu {
 	///
 	///
 	inline PAOPU_API void free_device(PaopuDevice* device) {
-		vkDestroyDevice(device->logical_device, nullptr);
+		vkDestroyDevice(device->logical_device, get_host_allocator());
 	}
     
 	///
@@ -65,11 +65,16 @@ namespace Paopu {
 				indices.graphics_family = i;
 			}
 
-			VkBool32 present_support = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+			// Headless devices never present, so the graphics family stands in
+			if(surface == VK_NULL_HANDLE) {
+				indices.present_family = indices.graphics_family;
+			} else {
+				VkBool32 present_support = false;
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
 
-			if(present_support) {
-				indices.present_family = i;
+				if(present_support) {
+					indices.present_family = i;
+				}
 			}
 
 			if(indices.is_complete()) {
@@ -82,6 +87,25 @@ namespace Paopu {
 		return indices;
 	}
 
+	/// Whether `device` supports the device extension `name`
+	///
+	///
+	inline PAOPU_API bool check_device_extension(VkPhysicalDevice device, const char* name) {
+		uint32_t extension_count;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, nullptr);
+
+		std::vector<VkExtensionProperties> available_extensions(extension_count);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, available_extensions.data());
+
+		for(const auto& extension : available_extensions) {
+			if(strcmp(name, extension.extensionName) == 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	///
 	///
 	///
@@ -92,13 +116,21 @@ namespace Paopu {
 		std::vector<VkExtensionProperties> available_extensions(extension_count);
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, available_extensions.data());
 
-		std::set<std::string> required_extensions(s_device_extensions.begin(), s_device_extensions.end());
+		for(const char* required : s_device_extensions) {
+			bool found = false;
+			for(const auto& extension : available_extensions) {
+				if(strcmp(required, extension.extensionName) == 0) {
+					found = true;
+					break;
+				}
+			}
 
-		for(const auto& extension : available_extensions) {
-			required_extensions.erase(extension.extensionName);
+			if(!found) {
+				return false;
+			}
 		}
 
-		return required_extensions.empty();
+		return true;
 	}
 
 	///
@@ -106,6 +138,12 @@ namespace Paopu {
 	///
 	inline PAOPU_API bool is_device_suitable(VkPhysicalDevice device, VkSurfaceKHR& surface) {
 		QueueFamilyIndices indices = find_queue_families(device, surface);
+
+		// Headless rendering only needs a graphics queue
+		if(surface == VK_NULL_HANDLE) {
+			return indices.is_complete();
+		}
+
 		bool extensions_supported = check_device_extension_support(device);
 
 		bool swapchain_adaquate = false;
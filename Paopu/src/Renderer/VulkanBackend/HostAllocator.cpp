@@ -0,0 +1,193 @@
+#include "HostAllocator.h"
+
+#include "../../Memory/LinearArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace Paopu {
+
+	struct CommandArena;
+
+	/// Stored right before every pointer handed to the driver
+	struct alignas(16) HostAllocationHeader {
+		uint64_t size;
+		// Set for command-scope allocations
+		CommandArena* arena;
+		// Bytes from the start of the underlying allocation to the user pointer
+		uint32_t offset;
+		uint32_t scope;
+	};
+
+	struct HostScopeCounters {
+		std::atomic<uint64_t> live_bytes{0};
+		std::atomic<uint64_t> live_count{0};
+		std::atomic<uint64_t> peak_bytes{0};
+		std::atomic<uint64_t> total_count{0};
+	};
+
+	/// Arena for one thread's command-scope allocations. Reset on the next
+	/// allocation once every previous one was freed.
+	struct CommandArena {
+		LinearArena arena{64 * 1024};
+		std::atomic<uint32_t> outstanding{0};
+	};
+
+	/// Frees the thread's arena on exit, unless the driver still holds some of
+	/// it, in which case it is leaked rather than freed under the driver
+	struct CommandArenaOwner {
+		CommandArena* arena{nullptr};
+		~CommandArenaOwner() {
+			if(arena != nullptr && arena->outstanding.load(std::memory_order_acquire) == 0) {
+				delete arena;
+			}
+		}
+	};
+
+	static HostScopeCounters s_scopes[k_host_scope_count];
+	static HostScopeCounters s_internal[k_host_scope_count];
+	static thread_local CommandArenaOwner t_command_arena;
+
+	static const size_t k_min_alignment = 16;
+
+	static inline uint32_t clamp_scope(VkSystemAllocationScope scope) {
+		return std::min<uint32_t>(static_cast<uint32_t>(scope), k_host_scope_count - 1);
+	}
+
+	static void count_allocation(HostScopeCounters& counters, uint64_t size) {
+		uint64_t live = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+		counters.live_count.fetch_add(1, std::memory_order_relaxed);
+		counters.total_count.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t peak = counters.peak_bytes.load(std::memory_order_relaxed);
+		while(live > peak && !counters.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+	}
+
+	static void count_free(HostScopeCounters& counters, uint64_t size) {
+		counters.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+		counters.live_count.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	static inline HostAllocationHeader* get_header(void* memory) {
+		return reinterpret_cast<HostAllocationHeader*>(static_cast<uint8_t*>(memory) - sizeof(HostAllocationHeader));
+	}
+
+	static void* VKAPI_CALL host_allocate(void* /*user_data*/, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+		if(size == 0) return nullptr;
+
+		alignment = std::max(alignment, k_min_alignment);
+		// The header sits in the `prefix` bytes in front of the user pointer
+		size_t prefix = std::max(alignment, sizeof(HostAllocationHeader));
+		uint32_t scope_index = clamp_scope(scope);
+
+		uint8_t* base;
+		uint8_t* memory;
+		CommandArena* command_arena = nullptr;
+
+		if(scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) {
+			if(t_command_arena.arena == nullptr) {
+				t_command_arena.arena = new CommandArena();
+			}
+			command_arena = t_command_arena.arena;
+			if(command_arena->outstanding.load(std::memory_order_acquire) == 0) {
+				command_arena->arena.reset();
+			}
+			command_arena->outstanding.fetch_add(1, std::memory_order_relaxed);
+
+			base = static_cast<uint8_t*>(command_arena->arena.allocate(prefix + size, alignment));
+			memory = base + prefix;
+		} else {
+			base = static_cast<uint8_t*>(std::malloc(prefix + size + alignment));
+			if(base == nullptr) return nullptr;
+
+			uintptr_t aligned = (reinterpret_cast<uintptr_t>(base) + prefix + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+			memory = reinterpret_cast<uint8_t*>(aligned);
+		}
+
+		HostAllocationHeader* header = get_header(memory);
+		header->size = size;
+		header->arena = command_arena;
+		header->offset = static_cast<uint32_t>(memory - base);
+		header->scope = scope_index;
+
+		count_allocation(s_scopes[scope_index], size);
+		return memory;
+	}
+
+	static void VKAPI_CALL host_free(void* /*user_data*/, void* memory) {
+		if(memory == nullptr) return;
+
+		HostAllocationHeader* header = get_header(memory);
+		count_free(s_scopes[header->scope], header->size);
+
+		if(header->arena != nullptr) {
+			header->arena->outstanding.fetch_sub(1, std::memory_order_release);
+		} else {
+			std::free(static_cast<uint8_t*>(memory) - header->offset);
+		}
+	}
+
+	static void* VKAPI_CALL host_reallocate(void* user_data, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+		if(original == nullptr) {
+			return host_allocate(user_data, size, alignment, scope);
+		}
+		if(size == 0) {
+			host_free(user_data, original);
+			return nullptr;
+		}
+
+		void* memory = host_allocate(user_data, size, alignment, scope);
+		if(memory == nullptr) return nullptr;
+
+		memcpy(memory, original, std::min<uint64_t>(size, get_header(original)->size));
+		host_free(user_data, original);
+		return memory;
+	}
+
+	static void VKAPI_CALL host_internal_allocation(void* /*user_data*/, size_t size, VkInternalAllocationType /*type*/, VkSystemAllocationScope scope) {
+		count_allocation(s_internal[clamp_scope(scope)], size);
+	}
+
+	static void VKAPI_CALL host_internal_free(void* /*user_data*/, size_t size, VkInternalAllocationType /*type*/, VkSystemAllocationScope scope) {
+		count_free(s_internal[clamp_scope(scope)], size);
+	}
+
+	static const VkAllocationCallbacks s_host_allocator = {
+		nullptr,
+		host_allocate,
+		host_reallocate,
+		host_free,
+		host_internal_allocation,
+		host_internal_free
+	};
+
+	const VkAllocationCallbacks* get_host_allocator() {
+		return &s_host_allocator;
+	}
+
+	static HostScopeStats read_counters(const HostScopeCounters& counters) {
+		HostScopeStats stats;
+		stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+		stats.live_count = counters.live_count.load(std::memory_order_relaxed);
+		stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+		stats.total_count = counters.total_count.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	HostMemoryStats get_host_memory_stats() {
+		HostMemoryStats stats;
+		for(uint32_t scope = 0; scope < k_host_scope_count; scope++) {
+			stats.scopes[scope] = read_counters(s_scopes[scope]);
+			stats.internal[scope] = read_counters(s_internal[scope]);
+		}
+		return stats;
+	}
+
+	const char* get_host_scope_name(uint32_t scope) {
+		static const char* const k_names[k_host_scope_count] = {"command", "object", "cache", "device", "instance"};
+		return scope < k_host_scope_count ? k_names[scope] : "unknown";
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../../Core/Core.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+namespace Paopu {
+
+	// One per VkSystemAllocationScope
+	static const uint32_t k_host_scope_count = 5;
+
+	/// Driver host memory of one VkSystemAllocationScope
+	///
+	///
+	struct PAOPU_API HostScopeStats {
+		uint64_t live_bytes{0};
+		uint64_t live_count{0};
+		uint64_t peak_bytes{0};
+		uint64_t total_count{0};
+	};
+
+	/// Everything the Vulkan driver allocated on the host through
+	/// `get_host_allocator`, by scope. `internal` is memory the driver allocated
+	/// itself and only reported (executable code, mostly).
+	///
+	struct PAOPU_API HostMemoryStats {
+		HostScopeStats scopes[k_host_scope_count];
+		HostScopeStats internal[k_host_scope_count];
+	};
+
+	/// Allocation callbacks passed to every Vulkan create/destroy call.
+	///
+	/// Allocations are tagged with their VkSystemAllocationScope and counted.
+	/// Command-scope allocations only live for the duration of one Vulkan call,
+	/// so they come from a per-thread LinearArena that is reset whenever none
+	/// of them are left, instead of the heap.
+	PAOPU_API const VkAllocationCallbacks* get_host_allocator();
+
+	PAOPU_API HostMemoryStats get_host_memory_stats();
+
+	/// "command", "object", "cache", "device" or "instance"
+	///
+	///
+	PAOPU_API const char* get_host_scope_name(uint32_t scope);
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../../Core/Core.h"
+#include "Buffer.h"
+
+#include <stdexcept>
+
+namespace Paopu {
+
+	/// A color target that is rendered to instead of a swapchain image.
+	/// Used for headless runs where there is no window to present to.
+	///
+	/// `usage`: How the target is written and read, drawn to and copied
+	///     from by default
+	struct PAOPU_API PaopuOffscreenTarget {
+		VkImage image{VK_NULL_HANDLE};
+		VkDeviceMemory memory{VK_NULL_HANDLE};
+		VkImageView image_view{VK_NULL_HANDLE};
+		VkFramebuffer framebuffer{VK_NULL_HANDLE};
+		VkFormat format{VK_FORMAT_R8G8B8A8_UNORM};
+		VkExtent2D extent{};
+		VkImageUsageFlags usage{VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+	};
+
+	/// Creates the image, view and framebuffer of an offscreen target. No
+	/// framebuffer is made without a `render_pass`, for targets that are
+	/// never drawn to.
+	inline PAOPU_API void build_offscreen_target(PaopuDevice* device, VkRenderPass render_pass, PaopuOffscreenTarget* target) {
+		VkImageCreateInfo image_info{};
+		image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		image_info.imageType = VK_IMAGE_TYPE_2D;
+		image_info.format = target->format;
+		image_info.extent = {target->extent.width, target->extent.height, 1};
+		image_info.mipLevels = 1;
+		image_info.arrayLayers = 1;
+		image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		image_info.usage = target->usage;
+		image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if(vkCreateImage(device->logical_device, &image_info, get_host_allocator(), &target->image) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Offscreen image creation failed!");
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(device->logical_device, target->image, &requirements);
+
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = requirements.size;
+		alloc_info.memoryTypeIndex = find_memory_type(device->physical_device, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if(vkAllocateMemory(device->logical_device, &alloc_info, get_host_allocator(), &target->memory) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Offscreen image memory allocation failed!");
+		}
+		vkBindImageMemory(device->logical_device, target->image, target->memory, 0);
+
+		VkImageViewCreateInfo view_info{};
+		view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		view_info.image = target->image;
+		view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		view_info.format = target->format;
+		view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		view_info.subresourceRange.levelCount = 1;
+		view_info.subresourceRange.layerCount = 1;
+
+		if(vkCreateImageView(device->logical_device, &view_info, get_host_allocator(), &target->image_view) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Offscreen image view creation failed!");
+		}
+
+		if(render_pass == VK_NULL_HANDLE) {
+			target->framebuffer = VK_NULL_HANDLE;
+			return;
+		}
+
+		VkFramebufferCreateInfo framebuffer_info{};
+		framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebuffer_info.renderPass = render_pass;
+		framebuffer_info.attachmentCount = 1;
+		framebuffer_info.pAttachments = &target->image_view;
+		framebuffer_info.width = target->extent.width;
+		framebuffer_info.height = target->extent.height;
+		framebuffer_info.layers = 1;
+
+		if(vkCreateFramebuffer(device->logical_device, &framebuffer_info, get_host_allocator(), &target->framebuffer) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Offscreen framebuffer creation failed!");
+		}
+	}
+
+	///
+	///
+	///
+	inline PAOPU_API void free_offscreen_target(VkDevice logical_device, PaopuOffscreenTarget* target) {
+		vkDestroyFramebuffer(logical_device, target->framebuffer, get_host_allocator());
+		vkDestroyImageView(logical_device, target->image_view, get_host_allocator());
+		vkDestroyImage(logical_device, target->image, get_host_allocator());
+		vkFreeMemory(logical_device, target->memory, get_host_allocator());
+	}
+
+}
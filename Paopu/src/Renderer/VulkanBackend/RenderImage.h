@@ -0,0 +1,111 @@
+#pragma once
+
+#include "../../Core/Core.h"
+#include "Buffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace Paopu {
+
+	/// An image the renderer reads and writes itself, like a pass's target
+	/// or a lookup table. Besides the view of every mip it has a view per
+	/// mip, which is what storage writes and single mip reads bind.
+	///
+	/// `depth`: Above 1 makes a 3D image
+	struct PAOPU_API PaopuRenderImage {
+		VkImage image{VK_NULL_HANDLE};
+		VkDeviceMemory memory{VK_NULL_HANDLE};
+		VkImageView view{VK_NULL_HANDLE};
+		std::vector<VkImageView> mip_views;
+		VkFormat format{VK_FORMAT_R16G16B16A16_SFLOAT};
+		VkImageUsageFlags usage{VK_IMAGE_USAGE_SAMPLED_BIT};
+		VkExtent2D extent{};
+		uint32_t depth{1};
+		uint32_t mip_count{1};
+	};
+
+	/// Size of mip `mip` of `image`
+	///
+	///
+	inline PAOPU_API VkExtent2D get_render_image_mip_extent(const PaopuRenderImage& image, uint32_t mip) {
+		return {std::max(image.extent.width >> mip, 1u), std::max(image.extent.height >> mip, 1u)};
+	}
+
+	/// Creates the image and views of `image` from its format, usage, extent
+	/// and mip count, in device local memory
+	///
+	inline PAOPU_API void build_render_image(PaopuDevice* device, PaopuRenderImage* image) {
+		const bool volume = image->depth > 1;
+
+		VkImageCreateInfo image_info{};
+		image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		image_info.imageType = volume ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+		image_info.format = image->format;
+		image_info.extent = {image->extent.width, image->extent.height, image->depth};
+		image_info.mipLevels = image->mip_count;
+		image_info.arrayLayers = 1;
+		image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		image_info.usage = image->usage;
+		image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if(vkCreateImage(device->logical_device, &image_info, get_host_allocator(), &image->image) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Render image creation failed!");
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(device->logical_device, image->image, &requirements);
+
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = requirements.size;
+		alloc_info.memoryTypeIndex = find_memory_type(device->physical_device, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if(vkAllocateMemory(device->logical_device, &alloc_info, get_host_allocator(), &image->memory) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Render image memory allocation failed!");
+		}
+		vkBindImageMemory(device->logical_device, image->image, image->memory, 0);
+
+		VkImageViewCreateInfo view_info{};
+		view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		view_info.image = image->image;
+		view_info.viewType = volume ? VK_IMAGE_VIEW_TYPE_3D : VK_IMAGE_VIEW_TYPE_2D;
+		view_info.format = image->format;
+		view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		view_info.subresourceRange.levelCount = image->mip_count;
+		view_info.subresourceRange.layerCount = 1;
+
+		if(vkCreateImageView(device->logical_device, &view_info, get_host_allocator(), &image->view) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Render image view creation failed!");
+		}
+
+		image->mip_views.resize(image->mip_count);
+		view_info.subresourceRange.levelCount = 1;
+		for(uint32_t mip = 0; mip < image->mip_count; mip++) {
+			view_info.subresourceRange.baseMipLevel = mip;
+			if(vkCreateImageView(device->logical_device, &view_info, get_host_allocator(), &image->mip_views[mip]) != VK_SUCCESS) {
+				throw std::runtime_error("[Renderer][Vulkan]: Render image view creation failed!");
+			}
+		}
+	}
+
+	///
+	///
+	///
+	inline PAOPU_API void free_render_image(VkDevice logical_device, PaopuRenderImage* image) {
+		for(VkImageView mip_view : image->mip_views) {
+			vkDestroyImageView(logical_device, mip_view, get_host_allocator());
+		}
+		image->mip_views.clear();
+		vkDestroyImageView(logical_device, image->view, get_host_allocator());
+		vkDestroyImage(logical_device, image->image, get_host_allocator());
+		vkFreeMemory(logical_device, image->memory, get_host_allocator());
+		image->image = VK_NULL_HANDLE;
+		image->memory = VK_NULL_HANDLE;
+		image->view = VK_NULL_HANDLE;
+	}
+
+}
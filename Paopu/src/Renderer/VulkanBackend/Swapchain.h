@@ -2,6 +2,7 @@
 
 #include "../../Core/Core.h"
 #include "../../Core/Window.h"
+#include "HostAllocator.h"
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -29,9 +30,9 @@ namespace Paopu {
     ///
     inline PAOPU_API void free_swapchain(VkDevice logical_device, PaopuSwapchain* swapchain) {
         for(auto image_view : swapchain->image_views) {
-            vkDestroyImageView(logical_device, image_view, nullptr);
+            vkDestroyImageView(logical_device, image_view, get_host_allocator());
         }
-        vkDestroySwapchainKHR(logical_device, swapchain->swapchain, nullptr);
+        vkDestroySwapchainKHR(logical_device, swapchain->swapchain, get_host_allocator());
     }
 
     ///
@@ -116,20 +117,16 @@ namespace Paopu {
         return VK_PRESENT_MODE_FIFO_KHR;
     }
 
-    /// Resolution of images in the swapchain
+    /// Resolution of images in the swapchain. `framebuffer_extent` is only
+    /// used where the surface leaves the size to us; it's the size the
+    /// window's event thread published, see `get_framebuffer_extent`, since
+    /// GLFW can't be asked from the render thread.
     ///
-    ///
-    inline PAOPU_API VkExtent2D select_swap_extent(PaopuWindow* window, const VkSurfaceCapabilitiesKHR& capabilities) {
+    inline PAOPU_API VkExtent2D select_swap_extent(VkExtent2D framebuffer_extent, const VkSurfaceCapabilitiesKHR& capabilities) {
         if(capabilities.currentExtent.width != UINT32_MAX) {
             return capabilities.currentExtent;
         } else {
-            int width, height;
-            glfwGetFramebufferSize(window->glfw_window, &width, &height);
-
-            VkExtent2D actual_extent = {
-                static_cast<uint32_t>(width),
-                static_cast<uint32_t>(height)
-            };
+            VkExtent2D actual_extent = framebuffer_extent;
 
             actual_extent.width = std::max(capabilities.minImageExtent.width, 
                                     std::min(capabilities.maxImageExtent.width, actual_extent.width));
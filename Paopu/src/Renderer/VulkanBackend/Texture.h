@@ -0,0 +1,106 @@
+#pragma once
+
+#include "../../Core/Core.h"
+#include "Buffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Paopu {
+
+	/// A sampled 2D image holding the mips of a texture from `first_mip` to
+	/// the end of its chain. Changing which mips are resident means creating
+	/// a new image and copying the shared levels over, see TextureResidency.h.
+	///
+	struct PAOPU_API PaopuTexture {
+		VkImage image{VK_NULL_HANDLE};
+		VkDeviceMemory memory{VK_NULL_HANDLE};
+		VkImageView image_view{VK_NULL_HANDLE};
+		VkFormat format{VK_FORMAT_R8G8B8A8_UNORM};
+		// Size of `first_mip`
+		VkExtent2D extent{};
+		uint32_t first_mip{0};
+		uint32_t mip_count{0};
+	};
+
+	/// Size of level `mip` of an image whose first level is `extent`
+	///
+	///
+	inline PAOPU_API VkExtent3D get_mip_extent(VkExtent2D extent, uint32_t mip) {
+		return {std::max(extent.width >> mip, 1u), std::max(extent.height >> mip, 1u), 1};
+	}
+
+	/// Creates the image and view of `texture` from its format, extent and
+	/// mip count. Returns false when the device is out of memory so the
+	/// caller can shrink its budget, throws on anything else.
+	///
+	inline PAOPU_API bool build_texture(PaopuDevice* device, PaopuTexture* texture) {
+		VkImageCreateInfo image_info{};
+		image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		image_info.imageType = VK_IMAGE_TYPE_2D;
+		image_info.format = texture->format;
+		image_info.extent = {texture->extent.width, texture->extent.height, 1};
+		image_info.mipLevels = texture->mip_count;
+		image_info.arrayLayers = 1;
+		image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		image_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		VkResult result = vkCreateImage(device->logical_device, &image_info, get_host_allocator(), &texture->image);
+		if(result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+			texture->image = VK_NULL_HANDLE;
+			return false;
+		} else if(result != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Texture image creation failed!");
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(device->logical_device, texture->image, &requirements);
+
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = requirements.size;
+		alloc_info.memoryTypeIndex = find_memory_type(device->physical_device, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		result = vkAllocateMemory(device->logical_device, &alloc_info, get_host_allocator(), &texture->memory);
+		if(result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+			vkDestroyImage(device->logical_device, texture->image, get_host_allocator());
+			texture->image = VK_NULL_HANDLE;
+			texture->memory = VK_NULL_HANDLE;
+			return false;
+		} else if(result != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Texture memory allocation failed!");
+		}
+		vkBindImageMemory(device->logical_device, texture->image, texture->memory, 0);
+
+		VkImageViewCreateInfo view_info{};
+		view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		view_info.image = texture->image;
+		view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		view_info.format = texture->format;
+		view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		view_info.subresourceRange.levelCount = texture->mip_count;
+		view_info.subresourceRange.layerCount = 1;
+
+		if(vkCreateImageView(device->logical_device, &view_info, get_host_allocator(), &texture->image_view) != VK_SUCCESS) {
+			throw std::runtime_error("[Renderer][Vulkan]: Texture image view creation failed!");
+		}
+
+		return true;
+	}
+
+	///
+	///
+	///
+	inline PAOPU_API void free_texture(VkDevice logical_device, PaopuTexture* texture) {
+		vkDestroyImageView(logical_device, texture->image_view, get_host_allocator());
+		vkDestroyImage(logical_device, texture->image, get_host_allocator());
+		vkFreeMemory(logical_device, texture->memory, get_host_allocator());
+		texture->image = VK_NULL_HANDLE;
+		texture->memory = VK_NULL_HANDLE;
+		texture->image_view = VK_NULL_HANDLE;
+	}
+
+}
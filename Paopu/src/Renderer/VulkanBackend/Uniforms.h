@@ -0,0 +1,129 @@
+#pragma once
+
+#include "../../Core/Core.h"
+#include "Buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Paopu {
+
+	/// A push constant block of type `T` at `offset`, seen by `stages`.
+	/// Declared once per pipeline layout, it describes its range when the
+	/// layout is created and pushes the block when a draw is recorded, so
+	/// the two can't drift apart.
+	///
+	template<typename T>
+	struct PaopuPushConstant {
+		static_assert(sizeof(T) % 4 == 0, "Push constant blocks are made of 4 byte words");
+		// The minimum every device supports
+		static_assert(sizeof(T) <= 128, "Push constant block is larger than devices have to support");
+
+		VkShaderStageFlags stages;
+		uint32_t offset;
+
+		inline VkPushConstantRange get_range() const {
+			return {stages, offset, static_cast<uint32_t>(sizeof(T))};
+		}
+
+		inline void push(VkCommandBuffer command_buffer, VkPipelineLayout layout, const T& data) const {
+			vkCmdPushConstants(command_buffer, layout, stages, offset, static_cast<uint32_t>(sizeof(T)), &data);
+		}
+	};
+
+	/// Per-frame uniform data in one persistently mapped, host coherent buffer.
+	///
+	/// The buffer is split into a region per frame in flight. A frame's
+	/// uniforms are pushed one after another into its region, each block
+	/// starting on the device's offset alignment, and are read through a
+	/// single UNIFORM_BUFFER_DYNAMIC descriptor bound with the block's
+	/// offset. Pushing is a pointer bump and a memcpy; nothing is created or
+	/// written to a descriptor per draw.
+	///
+	struct PAOPU_API PaopuUniformRing {
+		PaopuBuffer buffer;
+		// Bytes each frame can push
+		VkDeviceSize frame_size{0};
+		// What the descriptor sees past a block's offset
+		VkDeviceSize range{0};
+		VkDeviceSize alignment{1};
+		uint32_t frame_count{0};
+
+		// The current frame's region, and the next free byte in it
+		VkDeviceSize frame_start{0};
+		VkDeviceSize frame_end{0};
+		VkDeviceSize head{0};
+		// Most bytes any finished frame pushed
+		VkDeviceSize peak{0};
+	};
+
+	/// Creates a ring with `frame_size` bytes for each of `frame_count`
+	/// frames. Blocks pushed to it can be up to `range` bytes.
+	///
+	inline PAOPU_API void build_uniform_ring(PaopuDevice* device, VkDeviceSize frame_size, uint32_t frame_count, VkDeviceSize range, PaopuUniformRing* ring) {
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device->physical_device, &properties);
+
+		ring->alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+		ring->range = std::min<VkDeviceSize>(range, properties.limits.maxUniformBufferRange);
+		// Every region starts aligned, and the last block of one can still
+		// be read in full
+		ring->frame_size = (std::max(frame_size, ring->range) + ring->alignment - 1) / ring->alignment * ring->alignment;
+		ring->frame_count = std::max(frame_count, 1u);
+
+		// See Buffer.h
+		create_buffer(device, ring->frame_size * ring->frame_count, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+						VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &ring->buffer);
+
+		ring->head = 0;
+		ring->frame_start = 0;
+		ring->frame_end = ring->frame_size;
+		ring->peak = 0;
+	}
+
+	/// Moves the ring to the region of `frame_index`, dropping what that
+	/// frame pushed last time. The GPU has to be done with the frame. Throws
+	/// if the ring was built with fewer frames, as a frame in flight would
+	/// share the region.
+	inline PAOPU_API void begin_uniform_frame(PaopuUniformRing* ring, uint32_t frame_index) {
+		if(frame_index >= ring->frame_count) {
+			throw std::runtime_error("[Renderer][Vulkan]: Uniform ring has fewer frames than are in flight!");
+		}
+		ring->peak = std::max(ring->peak, ring->head - ring->frame_start);
+		ring->frame_start = ring->frame_size * frame_index;
+		ring->head = ring->frame_start;
+		ring->frame_end = ring->frame_start + ring->frame_size;
+	}
+
+	/// Copies `size` bytes into the current frame and returns the dynamic
+	/// offset to bind them with. Throws if the frame is out of room.
+	///
+	inline PAOPU_API uint32_t push_uniform(PaopuUniformRing* ring, const void* data, size_t size) {
+		VkDeviceSize offset = (ring->head + ring->alignment - 1) / ring->alignment * ring->alignment;
+		// The descriptor reads `range` bytes from the offset, which have to be in the buffer
+		if(size > ring->range || offset + std::max<VkDeviceSize>(size, ring->range) > ring->frame_end) {
+			throw std::runtime_error("[Renderer][Vulkan]: Uniform ring is out of room for this frame!");
+		}
+
+		memcpy(static_cast<uint8_t*>(ring->buffer.mapped) + offset, data, size);
+		ring->head = offset + size;
+		return static_cast<uint32_t>(offset);
+	}
+
+	template<typename T>
+	inline uint32_t push_uniform(PaopuUniformRing* ring, const T& data) {
+		return push_uniform(ring, &data, sizeof(T));
+	}
+
+	///
+	///
+	///
+	inline PAOPU_API void free_uniform_ring(VkDevice logical_device, PaopuUniformRing* ring) {
+		if(ring->buffer.buffer != VK_NULL_HANDLE) {
+			free_buffer(logical_device, &ring->buffer);
+		}
+		*ring = PaopuUniformRing{};
+	}
+
+}
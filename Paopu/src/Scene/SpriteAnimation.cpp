@@ -0,0 +1,290 @@
+#include "SpriteAnimation.h"
+
+#include "../Core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PAO_ANIMATION_SSE
+#endif
+
+namespace Paopu {
+
+    // Frame end of a sprite that will never change frame again
+    static const float k_never = std::numeric_limits<float>::infinity();
+    static const uint32_t k_not_started = ~0u;
+
+    SpriteClipHandle SpriteAnimator::add_clip(const SpriteClipDesc& desc) {
+        if(desc.frames == nullptr || desc.frame_count == 0) {
+            throw std::runtime_error("[Scene][Animation]: Clip has no frames!");
+        }
+
+        Clip clip;
+        clip.first_frame = static_cast<uint32_t>(frame_ends.size());
+        clip.frame_count = desc.frame_count;
+        clip.loop = desc.loop;
+
+        float end = 0.0f;
+        for(uint32_t i = 0; i < desc.frame_count; i++) {
+            const SpriteFrame& frame = desc.frames[i];
+            if(!(frame.duration >= 0.0f)) {
+                throw std::runtime_error("[Scene][Animation]: Frame duration can't be negative!");
+            }
+            end += frame.duration;
+
+            frame_uv_rects.push_back(frame.uv_rect);
+            frame_textures.push_back(frame.texture_index);
+            frame_ends.push_back(end);
+            frame_last.push_back(i + 1 == desc.frame_count ? 1 : 0);
+            frame_first_events.push_back(static_cast<uint32_t>(clip_events.size()));
+            frame_event_counts.push_back(0);
+
+            for(uint32_t event = 0; event < desc.event_count; event++) {
+                if(desc.events[event].frame == i) {
+                    clip_events.push_back(desc.events[event].id);
+                    frame_event_counts.back()++;
+                }
+            }
+        }
+        clip.duration = end;
+
+        clips.push_back(clip);
+        return static_cast<SpriteClipHandle>(clips.size() - 1);
+    }
+
+    SpriteAnimationHandle SpriteAnimator::play(SpriteClipHandle clip, uint32_t instance_index, float speed, float start_time) {
+        if(clip >= clips.size()) {
+            throw std::runtime_error("[Scene][Animation]: Clip doesn't exist!");
+        }
+
+        SpriteAnimationHandle handle;
+        if(!free_handles.empty()) {
+            handle = free_handles.back();
+            free_handles.pop_back();
+        } else {
+            handle = static_cast<SpriteAnimationHandle>(records.size());
+            records.emplace_back();
+        }
+
+        uint32_t slot = static_cast<uint32_t>(handles.size());
+        handles.push_back(handle);
+        times.push_back(0.0f);
+        speeds.push_back(std::max(speed, 0.0f));
+        current_frame_ends.push_back(0.0f);
+        current_frames.push_back(k_not_started);
+        current_clips.push_back(clip);
+        instance_indices.push_back(instance_index);
+
+        records[handle].slot = slot;
+        records[handle].alive = true;
+
+        restart(slot, clip, start_time);
+        return handle;
+    }
+
+    void SpriteAnimator::stop(SpriteAnimationHandle handle) {
+        AnimationRecord& record = records[handle];
+        if(!record.alive) return;
+
+        uint32_t slot = record.slot;
+        uint32_t last = static_cast<uint32_t>(handles.size()) - 1;
+        if(slot != last) {
+            handles[slot] = handles[last];
+            times[slot] = times[last];
+            speeds[slot] = speeds[last];
+            current_frame_ends[slot] = current_frame_ends[last];
+            current_frames[slot] = current_frames[last];
+            current_clips[slot] = current_clips[last];
+            instance_indices[slot] = instance_indices[last];
+            records[handles[slot]].slot = slot;
+        }
+
+        handles.pop_back();
+        times.pop_back();
+        speeds.pop_back();
+        current_frame_ends.pop_back();
+        current_frames.pop_back();
+        current_clips.pop_back();
+        instance_indices.pop_back();
+
+        record.alive = false;
+        free_handles.push_back(handle);
+    }
+
+    void SpriteAnimator::set_clip(SpriteAnimationHandle handle, SpriteClipHandle clip, float start_time) {
+        if(clip >= clips.size()) {
+            throw std::runtime_error("[Scene][Animation]: Clip doesn't exist!");
+        }
+        restart(records[handle].slot, clip, start_time);
+    }
+
+    void SpriteAnimator::set_speed(SpriteAnimationHandle handle, float speed) {
+        speeds[records[handle].slot] = std::max(speed, 0.0f);
+    }
+
+    float SpriteAnimator::get_time(SpriteAnimationHandle handle) const {
+        uint32_t slot = records[handle].slot;
+        // Finished clips keep counting, but stay on their last frame
+        return std::min(times[slot], clips[current_clips[slot]].duration);
+    }
+
+    bool SpriteAnimator::is_finished(SpriteAnimationHandle handle) const {
+        return current_frame_ends[records[handle].slot] == k_never;
+    }
+
+    void SpriteAnimator::set_instance_buffer(SpriteInstance* instances, uint32_t count) {
+        this->instances = instances;
+        instance_count = count;
+        instances_stale = true;
+    }
+
+    uint32_t SpriteAnimator::update(float dt) {
+        PAO_PROFILE_FUNCTION();
+        events.clear();
+
+        const uint32_t count = static_cast<uint32_t>(handles.size());
+        const float step = std::max(dt, 0.0f);
+        if(ended_slots.size() < count) ended_slots.resize(count);
+
+        // Almost every sprite is still inside its frame, which is one compare.
+        // The few that aren't are collected without a branch per sprite.
+        uint32_t* ended = ended_slots.data();
+        uint32_t ended_count = 0;
+        uint32_t slot = 0;
+
+    #ifdef PAO_ANIMATION_SSE
+        const __m128 steps = _mm_set1_ps(step);
+        for(; slot + 4 <= count; slot += 4) {
+            __m128 time = _mm_add_ps(_mm_loadu_ps(&times[slot]), _mm_mul_ps(_mm_loadu_ps(&speeds[slot]), steps));
+            _mm_storeu_ps(&times[slot], time);
+
+            int mask = _mm_movemask_ps(_mm_cmpge_ps(time, _mm_loadu_ps(&current_frame_ends[slot])));
+            for(uint32_t lane = 0; lane < 4; lane++) {
+                ended[ended_count] = slot + lane;
+                ended_count += (mask >> lane) & 1;
+            }
+        }
+    #endif
+
+        // Whatever doesn't fill a batch, or everything without SSE
+        for(; slot < count; slot++) {
+            times[slot] += speeds[slot] * step;
+            ended[ended_count] = slot;
+            ended_count += times[slot] >= current_frame_ends[slot] ? 1 : 0;
+        }
+
+        uint32_t changed = 0;
+        for(uint32_t i = 0; i < ended_count; i++) {
+            if(advance(ended[i])) {
+                write_instance(ended[i]);
+                changed++;
+            }
+        }
+
+        if(instances_stale) {
+            for(uint32_t i = 0; i < count; i++) {
+                if(current_frames[i] != k_not_started) write_instance(i);
+            }
+            instances_stale = false;
+        }
+
+        return changed;
+    }
+
+    bool SpriteAnimator::advance(uint32_t slot) {
+        const uint32_t previous = current_frames[slot];
+        uint32_t frame = previous;
+        float time = times[slot];
+
+        if(frame == k_not_started) {
+            frame = clips[current_clips[slot]].first_frame;
+            if(frame_event_counts[frame] > 0) fire_events(slot, frame);
+        }
+
+        // Where this update started walking, a wrap that reaches it again
+        // has been through every frame of the clip
+        const uint32_t lap_start = frame;
+        const bool lap_start_fired = previous == k_not_started;
+
+        while(time >= frame_ends[frame]) {
+            if(!frame_last[frame]) {
+                frame++;
+                if(frame_event_counts[frame] > 0) fire_events(slot, frame);
+                continue;
+            }
+
+            // Played past the end of the clip, which is the only time the
+            // clip itself is looked at
+            const Clip& clip = clips[current_clips[slot]];
+            if(!clip.loop || !(clip.duration > 0.0f)) {
+                times[slot] = clip.duration;
+                current_frames[slot] = frame;
+                current_frame_ends[slot] = k_never;
+                return frame != previous;
+            }
+
+            time -= clip.duration;
+            frame = clip.first_frame;
+
+            const float lap_start_time = lap_start == clip.first_frame ? 0.0f : frame_ends[lap_start - 1];
+            if(time >= lap_start_time) {
+                // A whole lap or more in one step. Everything after the
+                // start frame already fired, so fire the frames up to it
+                // and fold the remaining laps away, which lands on a frame
+                // without firing anything twice
+                const uint32_t end = lap_start_fired ? lap_start : lap_start + 1;
+                for(uint32_t skipped = frame; skipped < end; skipped++) {
+                    if(frame_event_counts[skipped] > 0) fire_events(slot, skipped);
+                }
+
+                time = std::fmod(time, clip.duration);
+                while(time >= frame_ends[frame]) frame++;
+                times[slot] = time;
+                break;
+            }
+
+            times[slot] = time;
+            if(frame_event_counts[frame] > 0) fire_events(slot, frame);
+        }
+
+        current_frames[slot] = frame;
+        current_frame_ends[slot] = frame_ends[frame];
+        return frame != previous;
+    }
+
+    void SpriteAnimator::restart(uint32_t slot, SpriteClipHandle clip, float start_time) {
+        const Clip& data = clips[clip];
+        float time = std::max(start_time, 0.0f);
+        if(time >= data.duration) {
+            time = data.loop && data.duration > 0.0f ? std::fmod(time, data.duration) : data.duration;
+        }
+
+        current_clips[slot] = clip;
+        times[slot] = time;
+        current_frames[slot] = k_not_started;
+        // Anything is past this, so the next update enters the start frame
+        current_frame_ends[slot] = -k_never;
+    }
+
+    void SpriteAnimator::fire_events(uint32_t slot, uint32_t frame) {
+        uint32_t first = frame_first_events[frame];
+        for(uint32_t event = 0; event < frame_event_counts[frame]; event++) {
+            events.push_back({handles[slot], clip_events[first + event]});
+        }
+    }
+
+    void SpriteAnimator::write_instance(uint32_t slot) {
+        uint32_t index = instance_indices[slot];
+        if(instances == nullptr || index >= instance_count) return;
+
+        uint32_t frame = current_frames[slot];
+        SpriteInstance& instance = instances[index];
+        instance.uv_rect = frame_uv_rects[frame];
+        instance.texture_index = frame_textures[frame];
+    }
+
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include "../Core/Core.h"
+#include "../Renderer/SpriteInstance.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    /// One frame of a clip
+    ///
+    /// `uv_rect`: (u0, v0, u1, v1) in the sprite sheet, see SpriteInstance
+    /// `texture_index`: Sprite sheet the frame is in
+    /// `duration`: Seconds the frame shows for
+    struct PAOPU_API SpriteFrame {
+        glm::vec4 uv_rect{0.0f, 0.0f, 1.0f, 1.0f};
+        uint32_t texture_index{0};
+        float duration{0.1f};
+    };
+
+    /// Fires `id` whenever a sprite playing the clip enters `frame`, e.g. a
+    /// footstep sound
+    ///
+    struct PAOPU_API SpriteClipEvent {
+        uint32_t frame{0};
+        uint32_t id{0};
+    };
+
+    /// `frames` and `events` are copied when the clip is added
+    ///
+    /// `loop`: Wrap around to the first frame at the end, otherwise stop on
+    ///     the last one
+    struct PAOPU_API SpriteClipDesc {
+        const SpriteFrame* frames{nullptr};
+        uint32_t frame_count{0};
+        const SpriteClipEvent* events{nullptr};
+        uint32_t event_count{0};
+        bool loop{true};
+    };
+
+    using SpriteClipHandle = uint32_t;
+    using SpriteAnimationHandle = uint32_t;
+
+    static const SpriteAnimationHandle k_no_sprite_animation = ~0u;
+
+    /// An event a sprite hit during the last update
+    ///
+    ///
+    struct PAOPU_API SpriteAnimationEvent {
+        SpriteAnimationHandle animation{k_no_sprite_animation};
+        uint32_t id{0};
+    };
+
+    /// Plays flipbook clips on many sprites at once.
+    ///
+    /// Clips are immutable once added and live in shared flat arrays, so a
+    /// thousand sprites running the same walk cycle read the same frames.
+    /// Each playing sprite is a few SoA floats: its time in the clip, its
+    /// speed and the time its current frame ends. An update advances every
+    /// sprite four at a time with SSE and compares against the frame ends,
+    /// collecting the sprites that crossed into a new frame without
+    /// branching. Only those then step to their next frame, fire its events
+    /// and write its UV rect and texture into the SpriteInstance array set
+    /// with `set_instance_buffer`.
+    ///
+    /// Pair with a TransformHierarchy writing the same instances: it owns
+    /// `basis` and `translation`, this owns `uv_rect` and `texture_index`.
+    class PAOPU_API SpriteAnimator {
+
+        public:
+            /// Throws if the clip has no frames, or a frame a negative duration
+            ///
+            ///
+            SpriteClipHandle add_clip(const SpriteClipDesc& desc);
+
+            /// Starts `clip` on `instances[instance_index]`, `start_time` seconds
+            /// in. The instance gets its first frame on the next update.
+            ///
+            SpriteAnimationHandle play(SpriteClipHandle clip, uint32_t instance_index, float speed = 1.0f, float start_time = 0.0f);
+
+            /// Removes the animation, the instance keeps its last frame
+            ///
+            ///
+            void stop(SpriteAnimationHandle handle);
+
+            /// Switches to another clip from `start_time`, e.g. walk to jump
+            ///
+            ///
+            void set_clip(SpriteAnimationHandle handle, SpriteClipHandle clip, float start_time = 0.0f);
+
+            /// Playback rate, 0 pauses. Negative rates are clamped to 0.
+            ///
+            ///
+            void set_speed(SpriteAnimationHandle handle, float speed);
+
+            /// Seconds into the clip as of the last update
+            ///
+            ///
+            float get_time(SpriteAnimationHandle handle) const;
+
+            /// Whether a clip that doesn't loop reached its last frame
+            ///
+            ///
+            bool is_finished(SpriteAnimationHandle handle) const;
+
+            /// Where animations write their frames. Rewrites every instance on
+            /// the next update, so call it again whenever the array moves.
+            ///
+            void set_instance_buffer(SpriteInstance* instances, uint32_t count);
+
+            /// Advances every animation by `dt` seconds. Returns how many
+            /// instances changed frame.
+            ///
+            uint32_t update(float dt);
+
+            /// Events fired by the last update, in the order each sprite hit them
+            ///
+            ///
+            inline const std::vector<SpriteAnimationEvent>& get_events() const { return events; }
+
+            inline uint32_t get_animation_count() const { return static_cast<uint32_t>(handles.size()); }
+            inline uint32_t get_clip_count() const { return static_cast<uint32_t>(clips.size()); }
+
+        private:
+            struct Clip {
+                uint32_t first_frame;
+                uint32_t frame_count;
+                float duration;
+                bool loop;
+            };
+
+            struct AnimationRecord {
+                uint32_t slot{0};
+                bool alive{false};
+            };
+
+            /// Moves a sprite that reached the end of its frame to the frame
+            /// containing its time. Returns false if it didn't actually change.
+            bool advance(uint32_t slot);
+
+            /// Puts a sprite before the first frame of its clip at `start_time`,
+            /// so the next update enters whichever frame that is
+            void restart(uint32_t slot, SpriteClipHandle clip, float start_time);
+
+            void fire_events(uint32_t slot, uint32_t frame);
+            void write_instance(uint32_t slot);
+
+            // Frames of every clip back to back
+            std::vector<glm::vec4> frame_uv_rects;
+            std::vector<uint32_t> frame_textures;
+            // When each frame ends, in seconds from the start of its clip
+            std::vector<float> frame_ends;
+            // Whether each frame is the last of its clip
+            std::vector<uint8_t> frame_last;
+            // Range of `clip_events` fired by each frame
+            std::vector<uint32_t> frame_first_events;
+            std::vector<uint32_t> frame_event_counts;
+            std::vector<uint32_t> clip_events;
+            std::vector<Clip> clips;
+
+            // Playing sprites, SoA
+            std::vector<float> times;
+            std::vector<float> speeds;
+            std::vector<float> current_frame_ends;
+            // Index into the frame arrays, k_not_started before the first update
+            std::vector<uint32_t> current_frames;
+            std::vector<SpriteClipHandle> current_clips;
+            std::vector<uint32_t> instance_indices;
+            std::vector<SpriteAnimationHandle> handles;
+
+            std::vector<AnimationRecord> records;
+            std::vector<SpriteAnimationHandle> free_handles;
+
+            std::vector<SpriteAnimationEvent> events;
+            // Slots that crossed a frame end during the current update
+            std::vector<uint32_t> ended_slots;
+
+            SpriteInstance* instances{nullptr};
+            uint32_t instance_count{0};
+            bool instances_stale{false};
+    };
+
+}
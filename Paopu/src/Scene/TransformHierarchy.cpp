@@ -0,0 +1,427 @@
+#include "TransformHierarchy.h"
+
+#include "../Core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PAO_TRANSFORM_SSE
+#endif
+
+namespace Paopu {
+
+    // Element order of the local/world arrays of a level
+    enum AffineElement : uint32_t { k_a = 0, k_b, k_c, k_d, k_tx, k_ty, k_affine_elements };
+
+    /// world = parent * local for one node. `parent`, `local` and `world` hold
+    /// the six affine elements.
+    static inline void compose(const float* parent, const float* local, float* world) {
+        world[k_a] = parent[k_a] * local[k_a] + parent[k_c] * local[k_b];
+        world[k_b] = parent[k_b] * local[k_a] + parent[k_d] * local[k_b];
+        world[k_c] = parent[k_a] * local[k_c] + parent[k_c] * local[k_d];
+        world[k_d] = parent[k_b] * local[k_c] + parent[k_d] * local[k_d];
+        world[k_tx] = parent[k_a] * local[k_tx] + parent[k_c] * local[k_ty] + parent[k_tx];
+        world[k_ty] = parent[k_b] * local[k_tx] + parent[k_d] * local[k_ty] + parent[k_ty];
+    }
+
+    void TransformHierarchy::compose_local(const Transform2D& local, float* out) {
+        float cos_r = std::cos(local.rotation);
+        float sin_r = std::sin(local.rotation);
+        out[k_a] = cos_r * local.scale.x;
+        out[k_b] = sin_r * local.scale.x;
+        out[k_c] = -sin_r * local.scale.y;
+        out[k_d] = cos_r * local.scale.y;
+        out[k_tx] = local.position.x;
+        out[k_ty] = local.position.y;
+    }
+
+    TransformHandle TransformHierarchy::create(const Transform2D& local, TransformHandle parent) {
+        uint32_t level_index = 0;
+        if(parent != k_no_transform) {
+            if(parent >= records.size() || !records[parent].alive) {
+                throw std::runtime_error("[Scene][Transform]: Parent transform doesn't exist!");
+            }
+            level_index = records[parent].level + 1;
+            records[parent].child_count++;
+        }
+
+        TransformHandle handle;
+        if(!free_handles.empty()) {
+            handle = free_handles.back();
+            free_handles.pop_back();
+        } else {
+            handle = static_cast<TransformHandle>(records.size());
+            records.emplace_back();
+        }
+
+        float matrix[k_affine_elements];
+        compose_local(local, matrix);
+        insert(level_index, handle, parent, matrix);
+        node_count++;
+        return handle;
+    }
+
+    void TransformHierarchy::destroy(TransformHandle handle) {
+        NodeRecord& record = records[handle];
+        if(!record.alive) return;
+        if(record.child_count > 0) {
+            throw std::runtime_error("[Scene][Transform]: Destroying a transform that still has children!");
+        }
+
+        TransformHandle parent = get_parent(handle);
+        if(parent != k_no_transform) {
+            records[parent].child_count--;
+        }
+
+        remove(handle);
+        record.alive = false;
+        free_handles.push_back(handle);
+        node_count--;
+    }
+
+    void TransformHierarchy::set_local(TransformHandle handle, const Transform2D& local) {
+        const NodeRecord& record = records[handle];
+        Level& level = levels[record.level];
+
+        float matrix[k_affine_elements];
+        compose_local(local, matrix);
+        for(uint32_t element = 0; element < k_affine_elements; element++) {
+            level.local[element][record.slot] = matrix[element];
+        }
+        mark_dirty(record.level, record.slot);
+    }
+
+    void TransformHierarchy::set_parent(TransformHandle handle, TransformHandle parent) {
+        // Re-parenting under our own subtree would make a cycle
+        for(TransformHandle ancestor = parent; ancestor != k_no_transform; ancestor = get_parent(ancestor)) {
+            if(ancestor == handle) {
+                throw std::runtime_error("[Scene][Transform]: Can't parent a transform to its own child!");
+            }
+        }
+
+        TransformHandle old_parent = get_parent(handle);
+        if(old_parent == parent) return;
+
+        if(old_parent != k_no_transform) records[old_parent].child_count--;
+        if(parent != k_no_transform) records[parent].child_count++;
+
+        uint32_t old_level = records[handle].level;
+        uint32_t new_level = parent == k_no_transform ? 0 : records[parent].level + 1;
+
+        if(old_level == new_level) {
+            levels[old_level].parents[records[handle].slot] = parent;
+            if(parent != k_no_transform) {
+                levels[old_level].parent_slots[records[handle].slot] = records[parent].slot;
+            }
+            mark_dirty(old_level, records[handle].slot);
+            return;
+        }
+
+        // The whole subtree changes depth. Collect it level by level, parents
+        // before children, then move every node down or up by the same amount.
+        std::vector<TransformHandle> subtree{handle};
+        std::vector<uint8_t> in_subtree(records.size(), 0);
+        in_subtree[handle] = 1;
+        for(uint32_t level_index = old_level + 1; level_index < levels.size(); level_index++) {
+            const Level& level = levels[level_index];
+            for(uint32_t slot = 0; slot < level.size(); slot++) {
+                if(in_subtree[level.parents[slot]]) {
+                    in_subtree[level.handles[slot]] = 1;
+                    subtree.push_back(level.handles[slot]);
+                }
+            }
+        }
+
+        for(TransformHandle node : subtree) {
+            const NodeRecord record = records[node];
+            const Level& level = levels[record.level];
+
+            float matrix[k_affine_elements];
+            for(uint32_t element = 0; element < k_affine_elements; element++) {
+                matrix[element] = level.local[element][record.slot];
+            }
+            TransformHandle node_parent = node == handle ? parent : level.parents[record.slot];
+            int32_t instance_index = level.instance_indices[record.slot];
+            glm::vec2 sprite_size = level.sprite_sizes[record.slot];
+
+            remove(node);
+            uint32_t target_level = record.level + new_level - old_level;
+            uint32_t slot = insert(target_level, node, node_parent, matrix);
+            levels[target_level].instance_indices[slot] = instance_index;
+            levels[target_level].sprite_sizes[slot] = sprite_size;
+        }
+    }
+
+    TransformHandle TransformHierarchy::get_parent(TransformHandle handle) const {
+        const NodeRecord& record = records[handle];
+        return levels[record.level].parents[record.slot];
+    }
+
+    Affine2D TransformHierarchy::get_world(TransformHandle handle) const {
+        const NodeRecord& record = records[handle];
+        const Level& level = levels[record.level];
+
+        Affine2D world;
+        world.a = level.world[k_a][record.slot];
+        world.b = level.world[k_b][record.slot];
+        world.c = level.world[k_c][record.slot];
+        world.d = level.world[k_d][record.slot];
+        world.tx = level.world[k_tx][record.slot];
+        world.ty = level.world[k_ty][record.slot];
+        return world;
+    }
+
+    void TransformHierarchy::set_instance_buffer(SpriteInstance* instances, uint32_t count) {
+        this->instances = instances;
+        instance_count = count;
+
+        for(uint32_t level_index = 0; level_index < levels.size(); level_index++) {
+            const Level& level = levels[level_index];
+            for(uint32_t slot = 0; slot < level.size(); slot++) {
+                if(level.instance_indices[slot] != k_no_instance) {
+                    mark_dirty(level_index, slot);
+                }
+            }
+        }
+    }
+
+    void TransformHierarchy::bind_sprite(TransformHandle handle, uint32_t instance_index, glm::vec2 size) {
+        const NodeRecord& record = records[handle];
+        levels[record.level].instance_indices[record.slot] = static_cast<int32_t>(instance_index);
+        levels[record.level].sprite_sizes[record.slot] = size;
+        mark_dirty(record.level, record.slot);
+    }
+
+    void TransformHierarchy::unbind_sprite(TransformHandle handle) {
+        const NodeRecord& record = records[handle];
+        levels[record.level].instance_indices[record.slot] = k_no_instance;
+    }
+
+    uint32_t TransformHierarchy::update() {
+        PAO_PROFILE_FUNCTION();
+        uint32_t updated = 0;
+        for(uint32_t level_index = 0; level_index < levels.size(); level_index++) {
+            Level& level = levels[level_index];
+            bool parents_changed = level_index > 0 && levels[level_index - 1].any_changed;
+
+            // Nothing here or above moved, this level is exactly as it was
+            if(level.dirty_count == 0 && !parents_changed) {
+                level.any_changed = false;
+                continue;
+            }
+
+            updated += update_level(level_index);
+        }
+        return updated;
+    }
+
+    uint32_t TransformHierarchy::update_level(uint32_t level_index) {
+        Level& level = levels[level_index];
+        const Level* parent_level = level_index > 0 ? &levels[level_index - 1] : nullptr;
+        const bool parents_changed = parent_level != nullptr && parent_level->any_changed;
+        const uint32_t count = level.size();
+        uint32_t updated = 0;
+
+        if(parent_level != nullptr && !level.parent_slots_valid) {
+            for(uint32_t slot = 0; slot < count; slot++) {
+                level.parent_slots[slot] = records[level.parents[slot]].slot;
+            }
+            level.parent_slots_valid = true;
+        }
+
+        std::fill(level.changed.begin(), level.changed.end(), 0);
+        level.any_changed = false;
+
+        auto needs_update = [&](uint32_t slot, uint32_t& parent_slot) {
+            bool need = level.dirty[slot] != 0;
+            if(parent_level != nullptr) {
+                parent_slot = level.parent_slots[slot];
+                need = need || (parents_changed && parent_level->changed[parent_slot]);
+            }
+            return need;
+        };
+
+        uint32_t slot = 0;
+    #ifdef PAO_TRANSFORM_SSE
+        for(; slot + 4 <= count; slot += 4) {
+            uint32_t parent_slots[4] = {0, 0, 0, 0};
+            uint32_t needs = 0;
+            for(uint32_t lane = 0; lane < 4; lane++) {
+                needs |= static_cast<uint32_t>(needs_update(slot + lane, parent_slots[lane])) << lane;
+            }
+            if(needs == 0) continue;
+
+            // Lanes that don't need it recompute to the same values, it's
+            // cheaper than splitting the batch
+            __m128 local[k_affine_elements];
+            for(uint32_t element = 0; element < k_affine_elements; element++) {
+                local[element] = _mm_loadu_ps(&level.local[element][slot]);
+            }
+
+            if(parent_level == nullptr) {
+                for(uint32_t element = 0; element < k_affine_elements; element++) {
+                    _mm_storeu_ps(&level.world[element][slot], local[element]);
+                }
+            } else {
+                __m128 parent[k_affine_elements];
+                for(uint32_t element = 0; element < k_affine_elements; element++) {
+                    const float* source = parent_level->world[element].data();
+                    parent[element] = _mm_set_ps(source[parent_slots[3]], source[parent_slots[2]], source[parent_slots[1]], source[parent_slots[0]]);
+                }
+
+                __m128 a = _mm_add_ps(_mm_mul_ps(parent[k_a], local[k_a]), _mm_mul_ps(parent[k_c], local[k_b]));
+                __m128 b = _mm_add_ps(_mm_mul_ps(parent[k_b], local[k_a]), _mm_mul_ps(parent[k_d], local[k_b]));
+                __m128 c = _mm_add_ps(_mm_mul_ps(parent[k_a], local[k_c]), _mm_mul_ps(parent[k_c], local[k_d]));
+                __m128 d = _mm_add_ps(_mm_mul_ps(parent[k_b], local[k_c]), _mm_mul_ps(parent[k_d], local[k_d]));
+                __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(parent[k_a], local[k_tx]), _mm_mul_ps(parent[k_c], local[k_ty])), parent[k_tx]);
+                __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(parent[k_b], local[k_tx]), _mm_mul_ps(parent[k_d], local[k_ty])), parent[k_ty]);
+
+                _mm_storeu_ps(&level.world[k_a][slot], a);
+                _mm_storeu_ps(&level.world[k_b][slot], b);
+                _mm_storeu_ps(&level.world[k_c][slot], c);
+                _mm_storeu_ps(&level.world[k_d][slot], d);
+                _mm_storeu_ps(&level.world[k_tx][slot], tx);
+                _mm_storeu_ps(&level.world[k_ty][slot], ty);
+            }
+
+            for(uint32_t lane = 0; lane < 4; lane++) {
+                if(needs & (1u << lane)) {
+                    level.changed[slot + lane] = 1;
+                    write_instance(level, slot + lane);
+                    updated++;
+                }
+            }
+            level.any_changed = true;
+        }
+    #endif
+
+        // Whatever doesn't fill a batch, or everything without SSE
+        for(; slot < count; slot++) {
+            uint32_t parent_slot = 0;
+            if(!needs_update(slot, parent_slot)) continue;
+
+            float local[k_affine_elements];
+            float world[k_affine_elements];
+            for(uint32_t element = 0; element < k_affine_elements; element++) {
+                local[element] = level.local[element][slot];
+            }
+
+            if(parent_level == nullptr) {
+                std::copy(local, local + k_affine_elements, world);
+            } else {
+                float parent[k_affine_elements];
+                for(uint32_t element = 0; element < k_affine_elements; element++) {
+                    parent[element] = parent_level->world[element][parent_slot];
+                }
+                compose(parent, local, world);
+            }
+
+            for(uint32_t element = 0; element < k_affine_elements; element++) {
+                level.world[element][slot] = world[element];
+            }
+            level.changed[slot] = 1;
+            level.any_changed = true;
+            write_instance(level, slot);
+            updated++;
+        }
+
+        std::fill(level.dirty.begin(), level.dirty.end(), 0);
+        level.dirty_count = 0;
+        return updated;
+    }
+
+    void TransformHierarchy::write_instance(const Level& level, uint32_t slot) {
+        int32_t index = level.instance_indices[slot];
+        if(instances == nullptr || index == k_no_instance || static_cast<uint32_t>(index) >= instance_count) return;
+
+        glm::vec2 size = level.sprite_sizes[slot];
+        SpriteInstance& instance = instances[index];
+        instance.basis = glm::vec4(level.world[k_a][slot] * size.x, level.world[k_b][slot] * size.x,
+                                   level.world[k_c][slot] * size.y, level.world[k_d][slot] * size.y);
+        instance.translation = glm::vec2(level.world[k_tx][slot], level.world[k_ty][slot]);
+    }
+
+    uint32_t TransformHierarchy::insert(uint32_t level_index, TransformHandle handle, TransformHandle parent, const float* local) {
+        if(level_index >= levels.size()) {
+            levels.resize(level_index + 1);
+        }
+
+        Level& level = levels[level_index];
+        uint32_t slot = level.size();
+        level.handles.push_back(handle);
+        level.parents.push_back(parent);
+        level.parent_slots.push_back(parent != k_no_transform ? records[parent].slot : 0);
+        for(uint32_t element = 0; element < k_affine_elements; element++) {
+            level.local[element].push_back(local[element]);
+            level.world[element].push_back(local[element]);
+        }
+        level.instance_indices.push_back(k_no_instance);
+        level.sprite_sizes.push_back(glm::vec2(1.0f));
+        level.dirty.push_back(0);
+        level.changed.push_back(0);
+
+        NodeRecord& record = records[handle];
+        record.level = level_index;
+        record.slot = slot;
+        record.alive = true;
+
+        mark_dirty(level_index, slot);
+        return slot;
+    }
+
+    void TransformHierarchy::remove(TransformHandle handle) {
+        const NodeRecord& record = records[handle];
+        Level& level = levels[record.level];
+        uint32_t slot = record.slot;
+        uint32_t last = level.size() - 1;
+
+        if(level.dirty[slot]) {
+            level.dirty_count--;
+        }
+
+        if(slot != last) {
+            TransformHandle moved = level.handles[last];
+            level.handles[slot] = moved;
+            level.parents[slot] = level.parents[last];
+            level.parent_slots[slot] = level.parent_slots[last];
+            for(uint32_t element = 0; element < k_affine_elements; element++) {
+                level.local[element][slot] = level.local[element][last];
+                level.world[element][slot] = level.world[element][last];
+            }
+            level.instance_indices[slot] = level.instance_indices[last];
+            level.sprite_sizes[slot] = level.sprite_sizes[last];
+            level.dirty[slot] = level.dirty[last];
+            level.changed[slot] = level.changed[last];
+            records[moved].slot = slot;
+
+            // The moved node's children now point at a stale slot
+            if(record.level + 1 < levels.size()) {
+                levels[record.level + 1].parent_slots_valid = false;
+            }
+        }
+
+        level.handles.pop_back();
+        level.parents.pop_back();
+        level.parent_slots.pop_back();
+        for(uint32_t element = 0; element < k_affine_elements; element++) {
+            level.local[element].pop_back();
+            level.world[element].pop_back();
+        }
+        level.instance_indices.pop_back();
+        level.sprite_sizes.pop_back();
+        level.dirty.pop_back();
+        level.changed.pop_back();
+    }
+
+    void TransformHierarchy::mark_dirty(uint32_t level_index, uint32_t slot) {
+        Level& level = levels[level_index];
+        if(!level.dirty[slot]) {
+            level.dirty[slot] = 1;
+            level.dirty_count++;
+        }
+    }
+
+}
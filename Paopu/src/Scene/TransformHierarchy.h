@@ -0,0 +1,149 @@
+#pragma once
+#include "../Core/Core.h"
+#include "../Renderer/SpriteInstance.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Paopu {
+
+    /// Position, rotation (radians) and scale of a node relative to its parent
+    ///
+    ///
+    struct PAOPU_API Transform2D {
+        glm::vec2 position{0.0f, 0.0f};
+        float rotation{0.0f};
+        glm::vec2 scale{1.0f, 1.0f};
+    };
+
+    /// 2D affine matrix, column-major like SpriteInstance::basis:
+    /// `p' = (a, b) * p.x + (c, d) * p.y + (tx, ty)`
+    ///
+    struct PAOPU_API Affine2D {
+        float a{1.0f}, b{0.0f}, c{0.0f}, d{1.0f};
+        float tx{0.0f}, ty{0.0f};
+    };
+
+    using TransformHandle = uint32_t;
+
+    static const TransformHandle k_no_transform = ~0u;
+
+    /// World transforms for parent/child hierarchies, recomputed only where
+    /// something changed.
+    ///
+    /// Nodes are stored in one flat SoA array per depth, so parents are always
+    /// finished before their children and an update is a linear sweep, level
+    /// by level. Changing a node's local transform marks it dirty; a level is
+    /// skipped outright when none of its nodes are dirty and nothing in the
+    /// level above changed, so static scenery costs nothing. Dirty nodes are
+    /// composed with their parents four at a time with SSE.
+    ///
+    /// Nodes bound to a sprite write their world transform straight into the
+    /// SpriteInstance array set with `set_instance_buffer`, only when it changes.
+    class PAOPU_API TransformHierarchy {
+
+        public:
+            TransformHandle create(const Transform2D& local, TransformHandle parent = k_no_transform);
+
+            /// Children must be destroyed (or re-parented) first
+            ///
+            ///
+            void destroy(TransformHandle handle);
+
+            void set_local(TransformHandle handle, const Transform2D& local);
+
+            /// Moves `handle` and its subtree under `parent`, or to the root with
+            /// k_no_transform
+            ///
+            void set_parent(TransformHandle handle, TransformHandle parent);
+
+            TransformHandle get_parent(TransformHandle handle) const;
+
+            /// World transform as of the last `update`
+            ///
+            ///
+            Affine2D get_world(TransformHandle handle) const;
+
+            /// Where bound nodes write their transforms. Rewrites every bound node
+            /// on the next update, so call it again whenever the array moves.
+            ///
+            void set_instance_buffer(SpriteInstance* instances, uint32_t count);
+
+            /// Makes `handle` write its world transform, scaled by `size`, into
+            /// `instances[instance_index]` whenever it changes
+            ///
+            void bind_sprite(TransformHandle handle, uint32_t instance_index, glm::vec2 size);
+
+            void unbind_sprite(TransformHandle handle);
+
+            /// Recomputes everything that changed since the last call. Returns how
+            /// many nodes were recomputed.
+            ///
+            uint32_t update();
+
+            inline uint32_t get_node_count() const { return node_count; }
+            inline uint32_t get_depth() const { return static_cast<uint32_t>(levels.size()); }
+
+        private:
+            static constexpr int32_t k_no_instance = -1;
+
+            /// All nodes at one depth, SoA
+            struct Level {
+                std::vector<TransformHandle> handles;
+                std::vector<TransformHandle> parents;
+                // Slot of each parent in the level above, rebuilt after that level
+                // moves nodes around
+                std::vector<uint32_t> parent_slots;
+                bool parent_slots_valid{true};
+
+                // Local and world affine matrices, one array per element
+                std::vector<float> local[6];
+                std::vector<float> world[6];
+
+                std::vector<int32_t> instance_indices;
+                std::vector<glm::vec2> sprite_sizes;
+
+                std::vector<uint8_t> dirty;
+                // Recomputed during the current update, read by the next level
+                std::vector<uint8_t> changed;
+
+                uint32_t dirty_count{0};
+                bool any_changed{false};
+
+                inline uint32_t size() const { return static_cast<uint32_t>(handles.size()); }
+            };
+
+            struct NodeRecord {
+                uint32_t level{0};
+                uint32_t slot{0};
+                uint32_t child_count{0};
+                bool alive{false};
+            };
+
+            /// Appends a node to `level_index` with its local matrix, returns its slot
+            uint32_t insert(uint32_t level_index, TransformHandle handle, TransformHandle parent, const float* local);
+
+            /// Swap-removes a node from its level
+            void remove(TransformHandle handle);
+
+            void mark_dirty(uint32_t level_index, uint32_t slot);
+
+            /// Returns how many nodes of the level were recomputed
+            uint32_t update_level(uint32_t level_index);
+
+            void write_instance(const Level& level, uint32_t slot);
+
+            static void compose_local(const Transform2D& local, float* out);
+
+            std::vector<Level> levels;
+            std::vector<NodeRecord> records;
+            std::vector<TransformHandle> free_handles;
+            uint32_t node_count{0};
+
+            SpriteInstance* instances{nullptr};
+            uint32_t instance_count{0};
+    };
+
+}
@@ -0,0 +1,142 @@
+#include <Scene/SpriteAnimation.h>
+
+#include "BenchMicro.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_animated_sprites = 100000;
+    static const uint32_t k_animation_clips = 64;
+    static const uint32_t k_animation_frames = 600;
+
+    /// What the animator replaces: every sprite keeps its own timer and
+    /// frame list and searches it every frame
+    struct NaiveAnimation {
+        std::vector<Paopu::SpriteFrame> frames;
+        float time{0.0f};
+        float speed{1.0f};
+    };
+
+    /// Whether the last update fired each of the `count` events of a clip
+    /// with one event per frame exactly once
+    static bool events_fire_once(const Paopu::SpriteAnimator& animator, uint32_t count) {
+        std::vector<uint32_t> fired(count, 0);
+        for(const Paopu::SpriteAnimationEvent& event : animator.get_events()) {
+            if(event.id >= count) return false;
+            fired[event.id]++;
+        }
+        return std::all_of(fired.begin(), fired.end(), [](uint32_t times) { return times == 1; });
+    }
+
+    /// 100k sprites playing 64 clips of 4 to 12 frames at 8 to 24 frames per
+    /// second and random speeds, one update per 60 Hz frame
+    void run_animation_benchmark(MicroReport& report) {
+        std::mt19937 random(11);
+
+        Paopu::SpriteAnimator animator;
+        std::vector<std::vector<Paopu::SpriteFrame>> clip_frames(k_animation_clips);
+        std::vector<Paopu::SpriteClipHandle> clips;
+        for(uint32_t clip = 0; clip < k_animation_clips; clip++) {
+            uint32_t frame_count = 4 + random() % 9;
+            float duration = 1.0f / static_cast<float>(8 + random() % 17);
+            for(uint32_t frame = 0; frame < frame_count; frame++) {
+                Paopu::SpriteFrame sprite_frame;
+                sprite_frame.uv_rect = glm::vec4(frame / 16.0f, clip / 64.0f, (frame + 1) / 16.0f, (clip + 1) / 64.0f);
+                sprite_frame.texture_index = clip % 4;
+                sprite_frame.duration = duration;
+                clip_frames[clip].push_back(sprite_frame);
+            }
+
+            // A footstep on the first frame of every cycle
+            Paopu::SpriteClipEvent event{0, clip};
+            clips.push_back(animator.add_clip({clip_frames[clip].data(), frame_count, &event, 1, clip % 8 != 0}));
+        }
+
+        std::vector<Paopu::SpriteInstance> instances(k_animated_sprites);
+        std::vector<NaiveAnimation> naive(k_animated_sprites);
+        animator.set_instance_buffer(instances.data(), k_animated_sprites);
+        std::uniform_real_distribution<float> speed(0.5f, 1.5f);
+        for(uint32_t i = 0; i < k_animated_sprites; i++) {
+            uint32_t clip = random() % k_animation_clips;
+            naive[i].frames = clip_frames[clip];
+            naive[i].speed = speed(random);
+            animator.play(clips[clip], i, naive[i].speed, static_cast<float>(random() % 1000) / 1000.0f);
+        }
+        animator.update(0.0f);
+
+        const float dt = 1.0f / 60.0f;
+        double total_ms = 0.0;
+        double max_ms = 0.0;
+        uint64_t changed = 0;
+        uint64_t events = 0;
+        for(uint32_t frame = 0; frame < k_animation_frames; frame++) {
+            Clock::time_point start = Clock::now();
+            changed += animator.update(dt);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            total_ms += ms;
+            max_ms = std::max(max_ms, ms);
+            events += animator.get_events().size();
+        }
+        report.add("update_ms", total_ms / k_animation_frames);
+        report.add("max_update_ms", max_ms);
+        report.add("ns_per_sprite", total_ms * 1e6 / k_animation_frames / k_animated_sprites);
+        report.add("frame_changes_per_update", static_cast<double>(changed) / k_animation_frames);
+        report.add("events_per_update", static_cast<double>(events) / k_animation_frames);
+
+        Clock::time_point start = Clock::now();
+        for(uint32_t frame = 0; frame < k_animation_frames; frame++) {
+            for(uint32_t i = 0; i < k_animated_sprites; i++) {
+                NaiveAnimation& animation = naive[i];
+                animation.time += animation.speed * dt;
+
+                float cycle = 0.0f;
+                for(const Paopu::SpriteFrame& sprite_frame : animation.frames) cycle += sprite_frame.duration;
+                if(animation.time >= cycle) animation.time -= cycle;
+
+                float end = 0.0f;
+                for(const Paopu::SpriteFrame& sprite_frame : animation.frames) {
+                    end += sprite_frame.duration;
+                    if(animation.time < end) {
+                        instances[i].uv_rect = sprite_frame.uv_rect;
+                        instances[i].texture_index = sprite_frame.texture_index;
+                        break;
+                    }
+                }
+            }
+        }
+        report.add("naive_update_ms", std::chrono::duration<double, std::milli>(Clock::now() - start).count() / k_animation_frames);
+
+        // A hitch long enough to pass several frames, and several laps of the
+        // clip, still fires each frame's event once
+        {
+            const uint32_t k_event_frames = 4;
+            Paopu::SpriteFrame frames[k_event_frames];
+            Paopu::SpriteClipEvent frame_events[k_event_frames];
+            for(uint32_t frame = 0; frame < k_event_frames; frame++) {
+                frames[frame].duration = 0.1f;
+                frame_events[frame] = {frame, frame};
+            }
+
+            Paopu::SpriteAnimator hitch_animator;
+            Paopu::SpriteInstance instance;
+            hitch_animator.set_instance_buffer(&instance, 1);
+            hitch_animator.play(hitch_animator.add_clip({frames, k_event_frames, frame_events, k_event_frames, true}), 0);
+            hitch_animator.update(0.05f);
+
+            // Into the last frame, then around the clip five times and on
+            // to the first frame
+            hitch_animator.update(0.25f);
+            bool correct = hitch_animator.get_events().size() == 3;
+            hitch_animator.update(2.15f);
+            correct = correct && events_fire_once(hitch_animator, k_event_frames);
+            report.add("multi_frame_events_correct", correct ? 1.0 : 0.0);
+        }
+    }
+
+}
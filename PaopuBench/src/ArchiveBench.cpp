@@ -0,0 +1,138 @@
+#include <Assets/AssetArchive.h>
+
+#include "BenchMicro.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_asset_count = 512;
+    static const size_t k_asset_size = 64 * 1024;
+
+    /// Texture-like bytes: smooth gradients with some noise, so LZ4 has
+    /// something to find but can't collapse it
+    static void fill_asset(std::vector<uint8_t>& data, uint32_t seed) {
+        std::mt19937 random(seed);
+        for(size_t i = 0; i < data.size(); i++) {
+            data[i] = static_cast<uint8_t>((i / 64 + seed) + (random() % 4 == 0 ? random() % 16 : 0));
+        }
+    }
+
+    /// Loading the same assets as loose files through ifstream, from a mapped
+    /// archive without copying, and LZ4 compressed from the archive. Files are
+    /// read once first so every variant is measured from the page cache.
+    void run_archive_benchmark(MicroReport& report) {
+        const std::string k_loose_dir = "paopu_bench_assets";
+        const std::string k_raw_path = "paopu_bench_raw.pak";
+        const std::string k_lz4_path = "paopu_bench_lz4.pak";
+
+        std::filesystem::create_directories(k_loose_dir);
+        Paopu::AssetArchiveWriter raw_writer;
+        Paopu::AssetArchiveWriter lz4_writer;
+
+        std::vector<uint8_t> data(k_asset_size);
+        std::vector<std::string> names;
+        for(uint32_t i = 0; i < k_asset_count; i++) {
+            fill_asset(data, i);
+            names.push_back("Textures/asset_" + std::to_string(i) + ".bin");
+
+            std::ofstream file(k_loose_dir + "/asset_" + std::to_string(i) + ".bin", std::ios::binary);
+            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+            raw_writer.add(names.back(), data.data(), data.size(), false);
+            lz4_writer.add(names.back(), data.data(), data.size(), true);
+        }
+        raw_writer.write(k_raw_path);
+        lz4_writer.write(k_lz4_path);
+
+        // Keeps the reads from being optimized out
+        uint64_t checksum = 0;
+
+        // Loose files: an open, a read and a copy per asset
+        std::vector<char> buffer;
+        for(uint32_t pass = 0; pass < 2; pass++) {
+            Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < k_asset_count; i++) {
+                std::ifstream file(k_loose_dir + "/asset_" + std::to_string(i) + ".bin", std::ios::ate | std::ios::binary);
+                buffer.resize(static_cast<size_t>(file.tellg()));
+                file.seekg(0);
+                file.read(buffer.data(), buffer.size());
+                checksum += static_cast<uint8_t>(buffer[i % buffer.size()]);
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if(pass == 1) report.add("loose_us_per_asset", seconds * 1e6 / k_asset_count);
+        }
+
+        std::vector<Paopu::AssetId> ids;
+        for(const std::string& name : names) {
+            ids.push_back(Paopu::hash_asset_name(name.c_str()));
+        }
+
+        // Mapped: a lookup, then the bytes are used in place. Every page is
+        // touched so the cost of reading the data is included.
+        Clock::time_point start = Clock::now();
+        Paopu::AssetArchive raw_archive;
+        raw_archive.open(k_raw_path);
+        report.add("open_us", std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+        for(uint32_t pass = 0; pass < 2; pass++) {
+            start = Clock::now();
+            for(Paopu::AssetId id : ids) {
+                Paopu::AssetView view = raw_archive.get_view(id);
+                for(size_t offset = 0; offset < view.size; offset += 4096) {
+                    checksum += view.data[offset];
+                }
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if(pass == 1) report.add("mapped_us_per_asset", seconds * 1e6 / k_asset_count);
+        }
+
+        start = Clock::now();
+        const uint32_t k_lookups = 1000000;
+        for(uint32_t i = 0; i < k_lookups; i++) {
+            checksum += raw_archive.find(ids[i % k_asset_count])->size;
+        }
+        report.add("lookup_ns", std::chrono::duration<double, std::nano>(Clock::now() - start).count() / k_lookups);
+
+        // Compressed: decoded into a reused buffer
+        Paopu::AssetArchive lz4_archive;
+        lz4_archive.open(k_lz4_path);
+
+        uint64_t stored_bytes = 0;
+        for(uint32_t i = 0; i < lz4_archive.get_entry_count(); i++) {
+            stored_bytes += lz4_archive.get_entries()[i].stored_size;
+        }
+        report.add("lz4_ratio", static_cast<double>(stored_bytes) / (static_cast<double>(k_asset_count) * k_asset_size));
+
+        std::pmr::vector<uint8_t> decoded;
+        for(uint32_t pass = 0; pass < 2; pass++) {
+            start = Clock::now();
+            for(Paopu::AssetId id : ids) {
+                Paopu::AssetView view = lz4_archive.load(id, decoded);
+                checksum += view.data[view.size / 2];
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if(pass == 1) {
+                report.add("lz4_us_per_asset", seconds * 1e6 / k_asset_count);
+                report.add("lz4_decode_mb_per_s", static_cast<double>(k_asset_count) * k_asset_size / seconds / (1024.0 * 1024.0));
+            }
+        }
+
+        raw_archive.close();
+        lz4_archive.close();
+        std::filesystem::remove_all(k_loose_dir);
+        std::remove(k_raw_path.c_str());
+        std::remove(k_lz4_path.c_str());
+
+        if(checksum == 0) printf("[Bench]: Archive checksum was 0\n");
+    }
+
+}
@@ -0,0 +1,178 @@
+#include <Assets/AssetArchive.h>
+#include <Audio/AudioMixer.h>
+#include <Memory/AllocationTracker.h>
+
+#include "BenchMicro.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_audio_clip_count = 16;
+    static const uint32_t k_audio_clip_frames = 48000;
+    static const uint32_t k_audio_voice_counts[] = {64, 256, 512};
+    // Seconds of output mixed per voice count
+    static const double k_audio_mix_seconds = 2.0;
+    static const double k_audio_realtime_seconds = 2.0;
+    static const uint32_t k_audio_realtime_voices = 256;
+    static const uint32_t k_audio_music_seconds = 30;
+
+    /// Noisy chirps, a quarter mono at 48 kHz so they skip resampling, the
+    /// rest mono and stereo at 44.1 and 22.05 kHz
+    static void create_clips(std::vector<Paopu::AudioClip>& clips) {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+
+        std::vector<float> left(k_audio_clip_frames);
+        std::vector<float> right(k_audio_clip_frames);
+        for(uint32_t i = 0; i < k_audio_clip_count; i++) {
+            const uint32_t rates[] = {48000, 44100, 22050, 44100};
+            uint32_t sample_rate = rates[i % 4];
+            uint32_t channel_count = i % 4 == 3 ? 2 : 1;
+
+            float frequency = 110.0f * (1.0f + i);
+            for(uint32_t frame = 0; frame < k_audio_clip_frames; frame++) {
+                float t = static_cast<float>(frame) / sample_rate;
+                left[frame] = 0.3f * std::sin(6.2831853f * frequency * t * (1.0f + t)) + noise(random);
+                right[frame] = 0.3f * std::sin(6.2831853f * frequency * 1.5f * t) + noise(random);
+            }
+
+            const float* channels[] = {left.data(), right.data()};
+            clips[i].set_samples(channels, channel_count, k_audio_clip_frames, sample_rate);
+        }
+    }
+
+    static void play_voices(Paopu::AudioMixer& mixer, const std::vector<Paopu::AudioClip>& clips, uint32_t count, std::vector<Paopu::AudioVoiceHandle>& handles) {
+        handles.clear();
+        for(uint32_t i = 0; i < count; i++) {
+            Paopu::AudioVoiceDesc desc;
+            desc.gain = 0.5f / std::sqrt(static_cast<float>(count));
+            desc.pan = static_cast<float>(i % 17) / 8.0f - 1.0f;
+            // Every other voice is pitched, so it resamples even at 48 kHz
+            desc.pitch = i % 2 == 0 ? 1.0f : 0.75f + 0.5f * static_cast<float>(i % 13) / 13.0f;
+            desc.loop = true;
+            handles.push_back(mixer.play(clips[i % k_audio_clip_count], desc));
+        }
+    }
+
+    /// A stereo ADPCM music track packed into an archive, the way a game
+    /// would ship it
+    static void write_music_archive(const std::string& path) {
+        const uint32_t sample_rate = 44100;
+        const uint32_t frame_count = sample_rate * k_audio_music_seconds;
+
+        std::vector<int16_t> samples(static_cast<size_t>(frame_count) * 2);
+        for(uint32_t frame = 0; frame < frame_count; frame++) {
+            float t = static_cast<float>(frame) / sample_rate;
+            float chord = std::sin(6.2831853f * 220.0f * t) + std::sin(6.2831853f * 277.2f * t) + std::sin(6.2831853f * 329.6f * t);
+            samples[frame * 2] = static_cast<int16_t>(8000.0f * chord);
+            samples[frame * 2 + 1] = static_cast<int16_t>(8000.0f * chord * std::cos(t));
+        }
+
+        std::vector<uint8_t> wav = Paopu::encode_wav(samples.data(), frame_count, 2, sample_rate, Paopu::AudioEncoding::ImaAdpcm);
+        Paopu::AssetArchiveWriter writer;
+        // Streams read straight from the mapping, so they're stored as they are
+        writer.add("Music/theme.wav", wav.data(), wav.size(), false);
+        writer.write(path);
+    }
+
+    /// Mixing throughput with the render function called back to back, then
+    /// a null device pulling in realtime with music streaming while the game
+    /// thread keeps moving voices around, for underruns and starvation.
+    void run_audio_benchmark(MicroReport& report) {
+        std::vector<Paopu::AudioClip> clips(k_audio_clip_count);
+        create_clips(clips);
+
+        std::vector<Paopu::AudioVoiceHandle> handles;
+        std::vector<float> output;
+
+        for(uint32_t voice_count : k_audio_voice_counts) {
+            Paopu::AudioMixerSettings settings;
+            settings.max_voices = voice_count;
+            Paopu::AudioMixer mixer;
+            mixer.init(settings);
+            play_voices(mixer, clips, voice_count, handles);
+
+            const uint32_t period_frames = settings.format.period_frames;
+            const uint32_t period_count = static_cast<uint32_t>(k_audio_mix_seconds * settings.format.sample_rate / period_frames);
+            output.resize(static_cast<size_t>(period_frames) * 2);
+
+            // The first period executes the play commands
+            mixer.render(output.data(), period_frames);
+
+            Paopu::AllocationStats allocations_before = Paopu::get_allocation_stats();
+            Clock::time_point start = Clock::now();
+            for(uint32_t period = 0; period < period_count; period++) {
+                mixer.render(output.data(), period_frames);
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            Paopu::AllocationStats allocations_after = Paopu::get_allocation_stats();
+
+            double mixed_seconds = static_cast<double>(period_count) * period_frames / settings.format.sample_rate;
+            std::string name = "voices_" + std::to_string(voice_count);
+            report.add((name + "_x_realtime").c_str(), mixed_seconds / seconds);
+            report.add((name + "_ns_per_voice_frame").c_str(), seconds * 1e9 / (static_cast<double>(period_count) * period_frames * voice_count));
+            if(Paopu::k_track_allocations) {
+                report.add((name + "_render_allocations").c_str(), static_cast<double>(allocations_after.count - allocations_before.count));
+            }
+
+            mixer.shutdown();
+        }
+
+        const std::string k_archive_path = "paopu_bench_audio.pak";
+        write_music_archive(k_archive_path);
+        Paopu::AssetArchive archive;
+        archive.open(k_archive_path);
+
+        Paopu::AudioMixerSettings settings;
+        settings.max_voices = k_audio_realtime_voices + 1;
+        Paopu::AudioMixer mixer;
+        mixer.init(settings);
+
+        Paopu::AudioDeviceSettings device_settings;
+        device_settings.type = Paopu::AudioDeviceType::Null;
+        std::unique_ptr<Paopu::AudioDevice> device = Paopu::AudioDevice::create(device_settings);
+        device->start(mixer.get_format(), &Paopu::AudioMixer::render_callback, &mixer);
+
+        play_voices(mixer, clips, k_audio_realtime_voices, handles);
+        Paopu::AudioVoiceDesc music;
+        music.loop = true;
+        Paopu::AudioVoiceHandle music_voice = mixer.play_stream(archive, Paopu::hash_asset_name("Music/theme.wav"), music);
+
+        // A 60 Hz game thread panning every voice each frame
+        Clock::time_point start = Clock::now();
+        uint32_t frame = 0;
+        while(std::chrono::duration<double>(Clock::now() - start).count() < k_audio_realtime_seconds) {
+            for(uint32_t i = 0; i < handles.size(); i++) {
+                mixer.set_pan(handles[i], std::sin(0.05f * frame + i));
+            }
+            mixer.update();
+            frame++;
+            std::this_thread::sleep_for(std::chrono::microseconds(16667));
+        }
+
+        device->stop();
+        Paopu::AudioDeviceStats device_stats = device->get_stats();
+        Paopu::AudioMixerStats mixer_stats = mixer.get_stats();
+        report.add("realtime_periods", static_cast<double>(device_stats.periods));
+        report.add("realtime_underruns", static_cast<double>(device_stats.underruns));
+        report.add("realtime_render_us", device_stats.periods > 0 ? device_stats.render_ns / 1e3 / device_stats.periods : 0.0);
+        report.add("realtime_max_render_us", device_stats.max_render_ns / 1e3);
+        report.add("realtime_music_playing", mixer.is_playing(music_voice) ? 1.0 : 0.0);
+        report.add("realtime_starved_frames", static_cast<double>(mixer_stats.starved_frames));
+        report.add("realtime_dropped_commands", static_cast<double>(mixer_stats.dropped_commands));
+
+        mixer.shutdown();
+        archive.close();
+        std::remove(k_archive_path.c_str());
+    }
+
+}
@@ -0,0 +1,43 @@
+#include "BenchMicro.h"
+
+namespace Bench {
+
+    std::vector<MicroBenchmark> create_micro_benchmarks() {
+        return {
+            {"jobs", run_job_benchmark},
+            {"ecs", run_ecs_benchmark},
+            {"transforms", run_transform_benchmark},
+            {"logging", run_log_benchmark},
+            {"profiler", run_profiler_benchmark},
+            {"archive", run_archive_benchmark},
+            {"streaming", run_streaming_benchmark},
+            {"residency", run_residency_benchmark},
+            {"textures", run_texture_benchmark},
+            {"render_thread", run_render_thread_benchmark},
+            {"broadphase", run_broadphase_benchmark},
+            {"physics", run_physics_benchmark},
+            {"audio", run_audio_benchmark},
+            {"animation", run_animation_benchmark},
+            {"lighting", run_lighting_benchmark},
+        };
+    }
+
+    void write_micro_report(std::ostream& out, const std::vector<MicroReport>& reports) {
+        out << "{\n";
+        out << "  \"micro\": [\n";
+
+        for(size_t i = 0; i < reports.size(); i++) {
+            const MicroReport& report = reports[i];
+
+            out << "    {\"name\": \"" << report.name << "\"";
+            for(const MicroReport::Metric& metric : report.metrics) {
+                out << ", \"" << metric.name << "\": " << metric.value;
+            }
+            out << "}" << (i + 1 < reports.size() ? "," : "") << "\n";
+        }
+
+        out << "  ]\n";
+        out << "}\n";
+    }
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+    /// Results of a single micro benchmark, a flat list of named numbers
+    ///
+    ///
+    struct MicroReport {
+        struct Metric {
+            std::string name;
+            double value;
+        };
+
+        std::string name;
+        std::vector<Metric> metrics;
+
+        inline void add(const char* metric, double value) { metrics.push_back({metric, value}); }
+    };
+
+    /// A CPU-only benchmark of one engine system. Unlike scenes these don't
+    /// need a GPU, they run with `--micro <name|all>`.
+    ///
+    struct MicroBenchmark {
+        const char* name;
+        void (*run)(MicroReport& report);
+    };
+
+    /// Every registered micro benchmark in the order they are run
+    ///
+    ///
+    std::vector<MicroBenchmark> create_micro_benchmarks();
+
+    void write_micro_report(std::ostream& out, const std::vector<MicroReport>& reports);
+
+    // Defined in their own files
+
+    void run_job_benchmark(MicroReport& report);
+    void run_ecs_benchmark(MicroReport& report);
+    void run_transform_benchmark(MicroReport& report);
+    void run_log_benchmark(MicroReport& report);
+    void run_profiler_benchmark(MicroReport& report);
+    void run_archive_benchmark(MicroReport& report);
+    void run_streaming_benchmark(MicroReport& report);
+    void run_residency_benchmark(MicroReport& report);
+    void run_texture_benchmark(MicroReport& report);
+    void run_render_thread_benchmark(MicroReport& report);
+    void run_broadphase_benchmark(MicroReport& report);
+    void run_physics_benchmark(MicroReport& report);
+    void run_audio_benchmark(MicroReport& report);
+    void run_animation_benchmark(MicroReport& report);
+    void run_lighting_benchmark(MicroReport& report);
+
+}
@@ -0,0 +1,526 @@
+#include "BenchScenes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace Bench {
+
+    using Paopu::SpriteInstance;
+
+    /// Builds the basis of a sprite rotated by `angle` and scaled to `size`
+    static glm::vec4 make_basis(float angle, glm::vec2 size) {
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        return glm::vec4(c * size.x, s * size.x, -s * size.y, c * size.y);
+    }
+
+    // --------------------------------------------------------------------
+    //                          - Sprite Stress -
+    // --------------------------------------------------------------------
+
+    /// Lots of independently moving, rotating sprites. Measures the cost of
+    /// streaming a large instance buffer every frame.
+    class SpriteStressScene : public BenchScene {
+        public:
+            const char* get_name() const override { return "sprite_stress"; }
+
+            void setup(uint32_t width, uint32_t height) override {
+                bounds = glm::vec2(width, height);
+
+                sprites.resize(k_sprite_count);
+                for(auto& sprite : sprites) {
+                    sprite.position = {random.next_float(0.0f, bounds.x), random.next_float(0.0f, bounds.y)};
+                    sprite.velocity = {random.next_float(-120.0f, 120.0f), random.next_float(-120.0f, 120.0f)};
+                    sprite.size = random.next_float(4.0f, 16.0f);
+                    sprite.angle = random.next_float(0.0f, 6.2831853f);
+                    sprite.spin = random.next_float(-3.0f, 3.0f);
+                    sprite.color = {random.next_float(0.2f, 1.0f), random.next_float(0.2f, 1.0f), random.next_float(0.2f, 1.0f), 0.8f};
+                }
+            }
+
+            void update(float dt) override {
+                for(auto& sprite : sprites) {
+                    sprite.position += sprite.velocity * dt;
+                    sprite.angle += sprite.spin * dt;
+
+                    // Bounce off the edges of the target
+                    if(sprite.position.x < 0.0f || sprite.position.x > bounds.x) sprite.velocity.x = -sprite.velocity.x;
+                    if(sprite.position.y < 0.0f || sprite.position.y > bounds.y) sprite.velocity.y = -sprite.velocity.y;
+                }
+            }
+
+            void build(std::vector<SpriteInstance>& out) override {
+                for(const auto& sprite : sprites) {
+                    SpriteInstance instance{};
+                    instance.basis = make_basis(sprite.angle, glm::vec2(sprite.size));
+                    instance.translation = sprite.position;
+                    instance.color = sprite.color;
+                    out.push_back(instance);
+                }
+            }
+
+        private:
+            struct Sprite {
+                glm::vec2 position;
+                glm::vec2 velocity;
+                float size;
+                float angle;
+                float spin;
+                glm::vec4 color;
+            };
+
+            static const uint32_t k_sprite_count = 50000;
+
+            std::vector<Sprite> sprites;
+            glm::vec2 bounds{};
+            BenchRandom random;
+    };
+
+    // --------------------------------------------------------------------
+    //                             - Tilemap -
+    // --------------------------------------------------------------------
+
+    /// A large tile grid scrolled under a moving camera. Measures culling
+    /// the visible tile range and emitting one quad per visible tile.
+    class TilemapScene : public BenchScene {
+        public:
+            const char* get_name() const override { return "tilemap"; }
+
+            void setup(uint32_t width, uint32_t height) override {
+                view = glm::vec2(width, height);
+
+                tiles.resize(k_map_size * k_map_size);
+                for(auto& tile : tiles) {
+                    tile = static_cast<uint8_t>(random.next() % k_tile_kinds);
+                }
+            }
+
+            void update(float dt) override {
+                camera += glm::vec2(90.0f, 45.0f) * dt;
+            }
+
+            void build(std::vector<SpriteInstance>& out) override {
+                const float map_extent = k_map_size * k_tile_size;
+                glm::vec2 origin = glm::vec2(std::fmod(camera.x, map_extent - view.x), std::fmod(camera.y, map_extent - view.y));
+
+                uint32_t first_x = static_cast<uint32_t>(origin.x / k_tile_size);
+                uint32_t first_y = static_cast<uint32_t>(origin.y / k_tile_size);
+                uint32_t last_x = std::min(k_map_size - 1, static_cast<uint32_t>((origin.x + view.x) / k_tile_size));
+                uint32_t last_y = std::min(k_map_size - 1, static_cast<uint32_t>((origin.y + view.y) / k_tile_size));
+
+                for(uint32_t y = first_y; y <= last_y; y++) {
+                    for(uint32_t x = first_x; x <= last_x; x++) {
+                        uint8_t kind = tiles[y * k_map_size + x];
+
+                        SpriteInstance instance{};
+                        instance.basis = glm::vec4(k_tile_size, 0.0f, 0.0f, k_tile_size);
+                        instance.translation = glm::vec2((x + 0.5f) * k_tile_size, (y + 0.5f) * k_tile_size) - origin;
+                        // Tiles come from a 16x16 atlas
+                        float u = (kind % 16) / 16.0f;
+                        float v = (kind / 16) / 16.0f;
+                        instance.uv_rect = glm::vec4(u, v, u + 1.0f / 16.0f, v + 1.0f / 16.0f);
+                        instance.color = k_palette[kind % 4];
+                        out.push_back(instance);
+                    }
+                }
+            }
+
+        private:
+            static const uint32_t k_map_size = 512;
+            static const uint32_t k_tile_kinds = 64;
+            static constexpr float k_tile_size = 16.0f;
+            static constexpr glm::vec4 k_palette[4] = {
+                {0.20f, 0.45f, 0.20f, 1.0f},
+                {0.30f, 0.55f, 0.25f, 1.0f},
+                {0.45f, 0.40f, 0.25f, 1.0f},
+                {0.20f, 0.30f, 0.60f, 1.0f},
+            };
+
+            std::vector<uint8_t> tiles;
+            glm::vec2 camera{0.0f, 0.0f};
+            glm::vec2 view{};
+            BenchRandom random;
+    };
+
+    // --------------------------------------------------------------------
+    //                            - Particles -
+    // --------------------------------------------------------------------
+
+    /// A handful of emitters spawning and retiring short lived particles.
+    /// Measures the spawn/kill churn of a particle pool.
+    class ParticleScene : public BenchScene {
+        public:
+            const char* get_name() const override { return "particles"; }
+
+            void setup(uint32_t width, uint32_t height) override {
+                for(uint32_t i = 0; i < k_emitter_count; i++) {
+                    emitters[i] = glm::vec2(width * (i + 1.0f) / (k_emitter_count + 1.0f), height * 0.85f);
+                }
+                particles.reserve(k_max_particles);
+            }
+
+            void update(float dt) override {
+                // Retire dead particles by swapping in the last live one
+                for(size_t i = 0; i < particles.size();) {
+                    Particle& particle = particles[i];
+                    particle.age += dt;
+                    if(particle.age >= particle.lifetime) {
+                        particle = particles.back();
+                        particles.pop_back();
+                        continue;
+                    }
+
+                    particle.velocity.y += k_gravity * dt;
+                    particle.position += particle.velocity * dt;
+                    i++;
+                }
+
+                for(const auto& emitter : emitters) {
+                    for(uint32_t i = 0; i < k_spawn_per_frame && particles.size() < k_max_particles; i++) {
+                        Particle particle{};
+                        particle.position = emitter;
+                        particle.velocity = {random.next_float(-80.0f, 80.0f), random.next_float(-420.0f, -220.0f)};
+                        particle.lifetime = random.next_float(1.0f, 2.5f);
+                        particle.color = {1.0f, random.next_float(0.3f, 0.8f), 0.1f, 1.0f};
+                        particles.push_back(particle);
+                    }
+                }
+            }
+
+            void build(std::vector<SpriteInstance>& out) override {
+                for(const auto& particle : particles) {
+                    float life = 1.0f - particle.age / particle.lifetime;
+
+                    SpriteInstance instance{};
+                    instance.basis = glm::vec4(4.0f, 0.0f, 0.0f, 4.0f);
+                    instance.translation = particle.position;
+                    instance.color = glm::vec4(glm::vec3(particle.color), life);
+                    out.push_back(instance);
+                }
+            }
+
+        private:
+            struct Particle {
+                glm::vec2 position;
+                glm::vec2 velocity;
+                float age;
+                float lifetime;
+                glm::vec4 color;
+            };
+
+            static const uint32_t k_emitter_count = 4;
+            static const uint32_t k_spawn_per_frame = 100;
+            static const uint32_t k_max_particles = 40000;
+            static constexpr float k_gravity = 300.0f;
+
+            glm::vec2 emitters[k_emitter_count];
+            std::vector<Particle> particles;
+            BenchRandom random;
+    };
+
+    // --------------------------------------------------------------------
+    //                               - Text -
+    // --------------------------------------------------------------------
+
+    /// 5x7 bitmap glyphs, one byte per row with the leftmost pixel in bit 4
+    static const uint8_t k_glyph_digits[10][7] = {
+        {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},
+        {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},
+        {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},
+        {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+        {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C},
+    };
+
+    static const uint8_t k_glyph_letters[26][7] = {
+        {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}, {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E},
+        {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C},
+        {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10},
+        {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11},
+        {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C},
+        {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F},
+        {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},
+        {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10},
+        {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11},
+        {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},
+        {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04},
+        {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11},
+        {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}, {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F},
+    };
+
+    static const uint8_t k_glyph_period[7] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C};
+    static const uint8_t k_glyph_colon[7] = {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00};
+
+    /// Returns the glyph rows for `c`, or nullptr for characters that draw nothing
+    static const uint8_t* find_glyph(char c) {
+        if(c >= '0' && c <= '9') return k_glyph_digits[c - '0'];
+        if(c >= 'A' && c <= 'Z') return k_glyph_letters[c - 'A'];
+        if(c == '.') return k_glyph_period;
+        if(c == ':') return k_glyph_colon;
+        return nullptr;
+    }
+
+    /// Scrolling lines of bitmap text, one quad per lit glyph pixel. Measures
+    /// per-frame text layout of a full screen of small quads.
+    class TextScene : public BenchScene {
+        public:
+            const char* get_name() const override { return "text"; }
+
+            void setup(uint32_t width, uint32_t height) override {
+                view = glm::vec2(width, height);
+            }
+
+            void update(float dt) override {
+                scroll += 40.0f * dt;
+                frame++;
+            }
+
+            void build(std::vector<SpriteInstance>& out) override {
+                static const char* const k_lines[] = {
+                    "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG.",
+                    "PACK MY BOX WITH FIVE DOZEN LIQUOR JUGS.",
+                    "SPHINX OF BLACK QUARTZ: JUDGE MY VOW.",
+                    "0123456789 PAOPU BENCH TEXT SCENE",
+                };
+
+                const float line_height = (k_glyph_height + 2) * k_pixel_size;
+                const uint32_t line_count = static_cast<uint32_t>(view.y / line_height) + 2;
+
+                char frame_text[32];
+                snprintf(frame_text, sizeof(frame_text), "FRAME: %u", frame);
+
+                for(uint32_t line = 0; line < line_count; line++) {
+                    float y = line * line_height - std::fmod(scroll, line_height);
+                    const char* text = line == 0 ? frame_text : k_lines[(line + static_cast<uint32_t>(scroll / line_height)) % 4];
+                    glm::vec4 color = line == 0 ? glm::vec4(1.0f, 0.9f, 0.3f, 1.0f) : glm::vec4(0.9f, 0.9f, 0.9f, 1.0f);
+                    layout_line(text, glm::vec2(8.0f, y), color, out);
+                }
+            }
+
+        private:
+            void layout_line(const char* text, glm::vec2 pen, glm::vec4 color, std::vector<SpriteInstance>& out) {
+                for(const char* c = text; *c != '\0'; c++) {
+                    const uint8_t* glyph = find_glyph(*c);
+                    if(glyph != nullptr) {
+                        for(uint32_t row = 0; row < k_glyph_height; row++) {
+                            for(uint32_t column = 0; column < 5; column++) {
+                                if(!(glyph[row] & (0x10 >> column))) continue;
+
+                                SpriteInstance instance{};
+                                instance.basis = glm::vec4(k_pixel_size, 0.0f, 0.0f, k_pixel_size);
+                                instance.translation = pen + glm::vec2((column + 0.5f) * k_pixel_size, (row + 0.5f) * k_pixel_size);
+                                instance.color = color;
+                                out.push_back(instance);
+                            }
+                        }
+                    }
+                    pen.x += 6 * k_pixel_size;
+                }
+            }
+
+            static const uint32_t k_glyph_height = 7;
+            static constexpr float k_pixel_size = 3.0f;
+
+            glm::vec2 view{};
+            float scroll{0.0f};
+            uint32_t frame{0};
+    };
+
+    // --------------------------------------------------------------------
+    //                             - Lights -
+    // --------------------------------------------------------------------
+
+    /// A screen of floor tiles under `light_count` wandering point and spot
+    /// lights. Run at several light counts, it measures how the culling pass
+    /// and the lit sprite pass scale with the number of lights.
+    class LightScene : public BenchScene {
+        public:
+            explicit LightScene(uint32_t light_count) : light_count(light_count), name("lights_" + std::to_string(light_count)) {}
+
+            const char* get_name() const override { return name.c_str(); }
+
+            void setup(uint32_t width, uint32_t height) override {
+                bounds = glm::vec2(width, height);
+
+                movers.resize(light_count);
+                for(auto& mover : movers) {
+                    mover.light.position = {random.next_float(0.0f, bounds.x), random.next_float(0.0f, bounds.y)};
+                    mover.light.radius = random.next_float(48.0f, 160.0f);
+                    mover.light.height = random.next_float(16.0f, 64.0f);
+                    mover.light.color = {random.next_float(0.3f, 1.0f), random.next_float(0.3f, 1.0f), random.next_float(0.3f, 1.0f)};
+                    // Each pixel sums about light_count / 30 lights, so scaling
+                    // by the count keeps every variant as bright as the 64 light
+                    // one instead of washing out to white
+                    mover.light.intensity = 192.0f / static_cast<float>(light_count);
+                    mover.velocity = {random.next_float(-60.0f, 60.0f), random.next_float(-60.0f, 60.0f)};
+                    mover.spin = random.next_float(-2.0f, 2.0f);
+
+                    // Every fourth light is a spot
+                    if(random.next() % 4 == 0) {
+                        mover.light.cos_inner = std::cos(0.35f);
+                        mover.light.cos_outer = std::cos(0.6f);
+                    }
+                }
+            }
+
+            void update(float dt) override {
+                for(auto& mover : movers) {
+                    mover.light.position += mover.velocity * dt;
+                    mover.angle += mover.spin * dt;
+                    mover.light.direction = {std::cos(mover.angle), std::sin(mover.angle)};
+
+                    if(mover.light.position.x < 0.0f || mover.light.position.x > bounds.x) mover.velocity.x = -mover.velocity.x;
+                    if(mover.light.position.y < 0.0f || mover.light.position.y > bounds.y) mover.velocity.y = -mover.velocity.y;
+                }
+            }
+
+            void build(std::vector<SpriteInstance>& out) override {
+                // Every pixel is covered once, so the lit pass shades the whole target
+                const uint32_t columns = static_cast<uint32_t>(std::ceil(bounds.x / k_tile_size));
+                const uint32_t rows = static_cast<uint32_t>(std::ceil(bounds.y / k_tile_size));
+                for(uint32_t y = 0; y < rows; y++) {
+                    for(uint32_t x = 0; x < columns; x++) {
+                        SpriteInstance instance{};
+                        instance.basis = glm::vec4(k_tile_size, 0.0f, 0.0f, k_tile_size);
+                        instance.translation = glm::vec2((x + 0.5f) * k_tile_size, (y + 0.5f) * k_tile_size);
+                        instance.color = (x + y) % 2 == 0 ? glm::vec4(0.8f, 0.8f, 0.8f, 1.0f) : glm::vec4(0.6f, 0.6f, 0.65f, 1.0f);
+                        out.push_back(instance);
+                    }
+                }
+            }
+
+            bool is_lit() const override { return true; }
+
+            void build_lights(std::vector<Paopu::Light2D>& lights, glm::vec3& ambient) override {
+                for(const auto& mover : movers) {
+                    lights.push_back(mover.light);
+                }
+                ambient = glm::vec3(0.05f);
+            }
+
+        private:
+            struct Mover {
+                Paopu::Light2D light;
+                glm::vec2 velocity;
+                float angle{0.0f};
+                float spin;
+            };
+
+            static constexpr float k_tile_size = 32.0f;
+
+            uint32_t light_count;
+            std::string name;
+            std::vector<Mover> movers;
+            glm::vec2 bounds{};
+            BenchRandom random;
+    };
+
+    // --------------------------------------------------------------------
+    //                          - Post Processing -
+    // --------------------------------------------------------------------
+
+    /// Bright embers drifting over a dim checkered floor, drawn through the
+    /// post stack with `settings`. The embers are well above 1 so bloom has
+    /// something to pick up, the floor stays under the threshold.
+    class PostScene : public BenchScene {
+        public:
+            PostScene(const char* name, const Paopu::PostSettings& settings) : name(name), settings(settings) {}
+
+            const char* get_name() const override { return name.c_str(); }
+
+            void setup(uint32_t width, uint32_t height) override {
+                bounds = glm::vec2(width, height);
+
+                embers.resize(k_ember_count);
+                for(auto& ember : embers) {
+                    ember.position = {random.next_float(0.0f, bounds.x), random.next_float(0.0f, bounds.y)};
+                    ember.velocity = {random.next_float(-40.0f, 40.0f), random.next_float(-80.0f, -20.0f)};
+                    ember.size = random.next_float(3.0f, 12.0f);
+                    ember.color = glm::vec4(random.next_float(2.0f, 8.0f), random.next_float(0.8f, 3.0f), random.next_float(0.1f, 0.6f), 1.0f);
+                }
+            }
+
+            void update(float dt) override {
+                for(auto& ember : embers) {
+                    ember.position += ember.velocity * dt;
+                    if(ember.position.y < -ember.size) ember.position.y += bounds.y + 2.0f * ember.size;
+                    if(ember.position.x < 0.0f || ember.position.x > bounds.x) ember.velocity.x = -ember.velocity.x;
+                }
+            }
+
+            void build(std::vector<SpriteInstance>& out) override {
+                // Every pixel is covered, the post passes run over a full frame either way
+                const uint32_t columns = static_cast<uint32_t>(std::ceil(bounds.x / k_tile_size));
+                const uint32_t rows = static_cast<uint32_t>(std::ceil(bounds.y / k_tile_size));
+                for(uint32_t y = 0; y < rows; y++) {
+                    for(uint32_t x = 0; x < columns; x++) {
+                        SpriteInstance instance{};
+                        instance.basis = glm::vec4(k_tile_size, 0.0f, 0.0f, k_tile_size);
+                        instance.translation = glm::vec2((x + 0.5f) * k_tile_size, (y + 0.5f) * k_tile_size);
+                        instance.color = (x + y) % 2 == 0 ? glm::vec4(0.12f, 0.1f, 0.14f, 1.0f) : glm::vec4(0.08f, 0.07f, 0.1f, 1.0f);
+                        out.push_back(instance);
+                    }
+                }
+
+                for(const auto& ember : embers) {
+                    SpriteInstance instance{};
+                    instance.basis = glm::vec4(ember.size, 0.0f, 0.0f, ember.size);
+                    instance.translation = ember.position;
+                    instance.color = ember.color;
+                    out.push_back(instance);
+                }
+            }
+
+            const Paopu::PostSettings* get_post_settings() const override { return &settings; }
+
+        private:
+            struct Ember {
+                glm::vec2 position;
+                glm::vec2 velocity;
+                float size;
+                glm::vec4 color;
+            };
+
+            static constexpr uint32_t k_ember_count = 2000;
+            static constexpr float k_tile_size = 32.0f;
+
+            std::string name;
+            Paopu::PostSettings settings;
+            std::vector<Ember> embers;
+            glm::vec2 bounds{};
+            BenchRandom random;
+    };
+
+    std::vector<std::unique_ptr<BenchScene>> create_scenes() {
+        std::vector<std::unique_ptr<BenchScene>> scenes;
+        scenes.push_back(std::make_unique<SpriteStressScene>());
+        scenes.push_back(std::make_unique<TilemapScene>());
+        scenes.push_back(std::make_unique<ParticleScene>());
+        scenes.push_back(std::make_unique<TextScene>());
+        for(uint32_t light_count : {64u, 256u, 1024u, 4096u}) {
+            scenes.push_back(std::make_unique<LightScene>(light_count));
+        }
+
+        // The composite alone, then with bloom from half and quarter
+        // resolution, then with every effect on
+        Paopu::PostSettings post;
+        post.bloom_intensity = 0.0f;
+        scenes.push_back(std::make_unique<PostScene>("post_tonemap", post));
+        post.bloom_intensity = 0.6f;
+        scenes.push_back(std::make_unique<PostScene>("post_bloom_half", post));
+        post.bloom_downscale = 2;
+        scenes.push_back(std::make_unique<PostScene>("post_bloom_quarter", post));
+        post.bloom_downscale = 1;
+        post.lut_strength = 1.0f;
+        post.vignette_intensity = 0.8f;
+        post.crt_curvature = 0.3f;
+        post.crt_scanlines = 0.4f;
+        post.crt_mask = 0.2f;
+        post.pixel_size = 3;
+        post.posterize_levels = 16;
+        scenes.push_back(std::make_unique<PostScene>("post_full_stack", post));
+        return scenes;
+    }
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Renderer/LightCulling.h>
+#include <Renderer/PostProcess.h>
+#include <Renderer/SpriteInstance.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Bench {
+
+    /// A scripted scene the bench runs for a fixed number of frames. Scenes
+    /// must be deterministic: the same frame index always produces the same
+    /// sprites, so the final frame can be compared against a golden image.
+    ///
+    class BenchScene {
+        public:
+            virtual ~BenchScene() = default;
+
+            virtual const char* get_name() const = 0;
+
+            /// Called once before the first frame with the target's size
+            ///
+            ///
+            virtual void setup(uint32_t width, uint32_t height) = 0;
+
+            /// Advances the scene by a fixed `dt`
+            ///
+            ///
+            virtual void update(float dt) = 0;
+
+            /// Appends this frame's sprites to `sprites`
+            ///
+            ///
+            virtual void build(std::vector<Paopu::SpriteInstance>& sprites) = 0;
+
+            /// Scenes that return true are drawn with lighting enabled, see
+            /// Renderer::enable_lighting
+            ///
+            virtual bool is_lit() const { return false; }
+
+            /// Appends this frame's lights to `lights` and sets the ambient light
+            ///
+            ///
+            virtual void build_lights(std::vector<Paopu::Light2D>& /*lights*/, glm::vec3& /*ambient*/) {}
+
+            /// Scenes that return settings are drawn through the post stack,
+            /// see Renderer::enable_post_processing
+            ///
+            virtual const Paopu::PostSettings* get_post_settings() const { return nullptr; }
+    };
+
+    /// Small deterministic generator so scenes don't depend on the platform's <random>
+    ///
+    ///
+    struct BenchRandom {
+        uint32_t state{0x9E3779B9u};
+
+        inline uint32_t next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        inline float next_float(float min, float max) {
+            return min + (max - min) * ((next() & 0xFFFFFF) / 16777216.0f);
+        }
+    };
+
+    /// Creates every registered scene in the order they are run
+    ///
+    ///
+    std::vector<std::unique_ptr<BenchScene>> create_scenes();
+
+}
@@ -0,0 +1,152 @@
+#include <Physics/Broadphase.h>
+
+#include "BenchMicro.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_collider_count = 20000;
+    static const uint32_t k_broadphase_frames = 120;
+    static const float k_world_size = 6000.0f;
+    static const float k_collider_step = 1.0f / 60.0f;
+
+    struct MovingCollider {
+        glm::vec2 position;
+        glm::vec2 velocity;
+        glm::vec2 half_size;
+    };
+
+    static bool pair_less(const Paopu::ColliderPair& left, const Paopu::ColliderPair& right) {
+        return left.a < right.a || (left.a == right.a && left.b < right.b);
+    }
+
+    static bool same_pairs(std::vector<Paopu::ColliderPair> left, std::vector<Paopu::ColliderPair> right) {
+        std::sort(left.begin(), left.end(), pair_less);
+        std::sort(right.begin(), right.end(), pair_less);
+        if(left.size() != right.size()) return false;
+        for(size_t i = 0; i < left.size(); i++) {
+            if(left[i].a != right[i].a || left[i].b != right[i].b) return false;
+        }
+        return true;
+    }
+
+    /// Moves the colliders one step, bouncing off the world's edges
+    static void move_colliders(std::vector<MovingCollider>& colliders) {
+        for(MovingCollider& collider : colliders) {
+            collider.position += collider.velocity * k_collider_step;
+            for(int axis = 0; axis < 2; axis++) {
+                if(collider.position[axis] < 0.0f || collider.position[axis] > k_world_size) {
+                    collider.velocity[axis] = -collider.velocity[axis];
+                }
+            }
+        }
+    }
+
+    /// Colliders of mixed sizes drifting around a world, with both methods
+    /// fed the same motion. The last frame's pairs are checked against a
+    /// brute force test of every pair.
+    void run_broadphase_benchmark(MicroReport& report) {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> position(0.0f, k_world_size);
+        std::uniform_real_distribution<float> velocity(-80.0f, 80.0f);
+        std::uniform_real_distribution<float> half_size(4.0f, 24.0f);
+
+        std::vector<MovingCollider> colliders(k_collider_count);
+        for(MovingCollider& collider : colliders) {
+            collider.position = {position(random), position(random)};
+            collider.velocity = {velocity(random), velocity(random)};
+            collider.half_size = {half_size(random), half_size(random)};
+        }
+
+        const char* names[] = {"sap", "hash"};
+        std::vector<Paopu::ColliderPair> last_pairs[2];
+
+        for(uint32_t method = 0; method < 2; method++) {
+            std::vector<MovingCollider> moving = colliders;
+
+            Paopu::Broadphase broadphase;
+            Paopu::BroadphaseSettings settings;
+            settings.method = method == 0 ? Paopu::BroadphaseMethod::SweepAndPrune : Paopu::BroadphaseMethod::SpatialHash;
+            settings.cell_size = 48.0f;
+            broadphase.set_settings(settings);
+
+            std::vector<Paopu::ColliderHandle> handles(k_collider_count);
+            for(uint32_t i = 0; i < k_collider_count; i++) {
+                handles[i] = broadphase.create({moving[i].position - moving[i].half_size, moving[i].position + moving[i].half_size});
+            }
+
+            double update_seconds = 0.0;
+            double first_update_ms = 0.0;
+            uint64_t pairs = 0;
+            uint64_t sort_moves = 0;
+            uint32_t full_sorts = 0;
+            uint32_t grid_rebuilds = 0;
+
+            for(uint32_t frame = 0; frame < k_broadphase_frames; frame++) {
+                Clock::time_point start = Clock::now();
+                broadphase.update();
+                double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+                // The first update sorts or buckets everything from scratch
+                if(frame == 0) {
+                    first_update_ms = seconds * 1000.0;
+                } else {
+                    update_seconds += seconds;
+                    const Paopu::BroadphaseStats& stats = broadphase.get_stats();
+                    pairs += stats.pair_count;
+                    sort_moves += stats.sort_moves;
+                    full_sorts += stats.full_sort ? 1 : 0;
+                    grid_rebuilds += stats.grid_rebuilt ? 1 : 0;
+                }
+
+                if(frame + 1 < k_broadphase_frames) {
+                    move_colliders(moving);
+                    for(uint32_t i = 0; i < k_collider_count; i++) {
+                        broadphase.set_bounds(handles[i], {moving[i].position - moving[i].half_size, moving[i].position + moving[i].half_size});
+                    }
+                }
+            }
+            last_pairs[method] = broadphase.get_pairs();
+
+            if(method == 1) {
+                // Brute force over the final positions, which both methods ended on
+                std::vector<Paopu::ColliderPair> expected;
+                for(uint32_t i = 0; i < k_collider_count; i++) {
+                    glm::vec2 min_i = moving[i].position - moving[i].half_size;
+                    glm::vec2 max_i = moving[i].position + moving[i].half_size;
+                    for(uint32_t j = i + 1; j < k_collider_count; j++) {
+                        glm::vec2 min_j = moving[j].position - moving[j].half_size;
+                        glm::vec2 max_j = moving[j].position + moving[j].half_size;
+                        if(min_j.x <= max_i.x && max_j.x >= min_i.x && min_j.y <= max_i.y && max_j.y >= min_i.y) {
+                            expected.push_back({handles[i], handles[j]});
+                        }
+                    }
+                }
+                report.add("pairs_match", same_pairs(last_pairs[0], expected) && same_pairs(last_pairs[1], expected) ? 1.0 : 0.0);
+            }
+
+            uint32_t measured = k_broadphase_frames - 1;
+            char metric[64];
+            snprintf(metric, sizeof(metric), "%s_first_update_ms", names[method]);
+            report.add(metric, first_update_ms);
+            snprintf(metric, sizeof(metric), "%s_update_ms", names[method]);
+            report.add(metric, update_seconds * 1000.0 / measured);
+            snprintf(metric, sizeof(metric), "%s_pairs_per_frame", names[method]);
+            report.add(metric, static_cast<double>(pairs) / measured);
+            if(method == 0) {
+                report.add("sap_sort_moves_per_frame", static_cast<double>(sort_moves) / measured);
+                report.add("sap_full_sorts", full_sorts);
+            } else {
+                report.add("hash_grid_rebuilds", grid_rebuilds);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,89 @@
+#include "GoldenImage.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+namespace Bench {
+
+    bool write_ppm(const std::string& path, const Image& image) {
+        std::ofstream file(path, std::ios::binary);
+        if(!file.is_open()) {
+            return false;
+        }
+
+        file << "P6\n" << image.width << " " << image.height << "\n255\n";
+
+        std::vector<uint8_t> row(static_cast<size_t>(image.width) * 3);
+        for(uint32_t y = 0; y < image.height; y++) {
+            const uint8_t* src = image.pixels.data() + static_cast<size_t>(y) * image.width * 4;
+            for(uint32_t x = 0; x < image.width; x++) {
+                row[x * 3 + 0] = src[x * 4 + 0];
+                row[x * 3 + 1] = src[x * 4 + 1];
+                row[x * 3 + 2] = src[x * 4 + 2];
+            }
+            file.write(reinterpret_cast<const char*>(row.data()), row.size());
+        }
+
+        return file.good();
+    }
+
+    bool read_ppm(const std::string& path, Image& image) {
+        std::ifstream file(path, std::ios::binary);
+        if(!file.is_open()) {
+            return false;
+        }
+
+        std::string magic;
+        uint32_t max_value = 0;
+        file >> magic >> image.width >> image.height >> max_value;
+        if(magic != "P6" || max_value != 255) {
+            return false;
+        }
+        // Single whitespace byte between the header and the pixel data
+        file.get();
+
+        std::vector<uint8_t> row(static_cast<size_t>(image.width) * 3);
+        image.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+
+        for(uint32_t y = 0; y < image.height; y++) {
+            file.read(reinterpret_cast<char*>(row.data()), row.size());
+            uint8_t* dst = image.pixels.data() + static_cast<size_t>(y) * image.width * 4;
+            for(uint32_t x = 0; x < image.width; x++) {
+                dst[x * 4 + 0] = row[x * 3 + 0];
+                dst[x * 4 + 1] = row[x * 3 + 1];
+                dst[x * 4 + 2] = row[x * 3 + 2];
+                dst[x * 4 + 3] = 255;
+            }
+        }
+
+        return file.good();
+    }
+
+    ImageDiff compare_images(const Image& actual, const Image& golden, uint32_t tolerance) {
+        ImageDiff diff{};
+        diff.sizes_match = actual.width == golden.width && actual.height == golden.height;
+        if(!diff.sizes_match) {
+            diff.differing_ratio = 1.0;
+            return diff;
+        }
+
+        const size_t pixel_count = static_cast<size_t>(actual.width) * actual.height;
+        for(size_t i = 0; i < pixel_count; i++) {
+            uint32_t pixel_delta = 0;
+            for(size_t c = 0; c < 3; c++) {
+                int delta = std::abs(static_cast<int>(actual.pixels[i * 4 + c]) - static_cast<int>(golden.pixels[i * 4 + c]));
+                pixel_delta = std::max(pixel_delta, static_cast<uint32_t>(delta));
+            }
+
+            diff.max_channel_delta = std::max(diff.max_channel_delta, pixel_delta);
+            if(pixel_delta > tolerance) {
+                diff.differing_pixels++;
+            }
+        }
+
+        diff.differing_ratio = pixel_count > 0 ? static_cast<double>(diff.differing_pixels) / pixel_count : 0.0;
+        return diff;
+    }
+
+}
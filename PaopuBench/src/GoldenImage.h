@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+    /// An RGBA8 image, rows tightly packed from the top
+    ///
+    ///
+    struct Image {
+        uint32_t width{0};
+        uint32_t height{0};
+        std::vector<uint8_t> pixels;
+    };
+
+    /// Result of comparing a frame against its golden image
+    ///
+    /// `differing_pixels`: Pixels where any channel differs by more than the tolerance
+    /// `max_channel_delta`: Largest single channel difference found
+    struct ImageDiff {
+        bool sizes_match{false};
+        uint64_t differing_pixels{0};
+        uint32_t max_channel_delta{0};
+        double differing_ratio{0.0};
+    };
+
+    /// Writes `image` as a binary PPM. Alpha is dropped.
+    ///
+    /// Returns false if the file could not be written.
+    bool write_ppm(const std::string& path, const Image& image);
+
+    /// Reads a binary PPM written by `write_ppm`. Alpha is set to 255.
+    ///
+    /// Returns false if the file doesn't exist or isn't a P6 image.
+    bool read_ppm(const std::string& path, Image& image);
+
+    /// Compares the RGB channels of `actual` against `golden`. A pixel differs
+    /// when any channel is off by more than `tolerance`.
+    ///
+    ImageDiff compare_images(const Image& actual, const Image& golden, uint32_t tolerance);
+
+}
@@ -0,0 +1,159 @@
+#include <Core/JobSystem.h>
+
+#include "BenchMicro.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static double elapsed_ns(Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    /// Whether each of the first `count` entries of `runs`, bumped by one
+    /// job apiece, was bumped exactly once
+    static bool runs_once(const std::unique_ptr<std::atomic<uint32_t>[]>& runs, uint32_t count) {
+        for(uint32_t i = 0; i < count; i++) {
+            if(runs[i].load(std::memory_order_relaxed) != 1) return false;
+        }
+        return true;
+    }
+
+    /// Per-job scheduling overhead of the JobSystem next to std::async, which
+    /// is what the engine would otherwise reach for. Also checks that more
+    /// jobs than a thread has slots for all run, and only once.
+    void run_job_benchmark(MicroReport& report) {
+        const uint32_t k_batch_jobs = 1024;
+        const uint32_t k_batches = 200;
+        const uint32_t k_round_trips = 10000;
+        const uint32_t k_async_round_trips = 2000;
+        const uint32_t k_async_batch = 256;
+        const uint32_t k_sum_count = 1u << 24;
+        // More than either pool of job slots holds
+        const uint32_t k_overflow_jobs = 20000;
+
+        Paopu::JobSystem::init();
+        report.add("workers", Paopu::JobSystem::get_worker_count());
+
+        // Empty jobs spawned in batches and waited on together; this is the
+        // cost parallel work pays per job.
+        {
+            Clock::time_point start = Clock::now();
+            for(uint32_t batch = 0; batch < k_batches; batch++) {
+                Paopu::JobCounter counter;
+                for(uint32_t i = 0; i < k_batch_jobs; i++) {
+                    Paopu::JobSystem::run([]() {}, &counter);
+                }
+                Paopu::JobSystem::wait(&counter);
+            }
+            report.add("job_batch_ns_per_job", elapsed_ns(start) / (k_batches * k_batch_jobs));
+        }
+
+        // One job at a time, the latency of a single fork/join
+        {
+            Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < k_round_trips; i++) {
+                Paopu::JobCounter counter;
+                Paopu::JobSystem::run([]() {}, &counter);
+                Paopu::JobSystem::wait(&counter);
+            }
+            report.add("job_round_trip_ns", elapsed_ns(start) / k_round_trips);
+        }
+
+        {
+            Clock::time_point start = Clock::now();
+            std::vector<std::future<void>> futures;
+            futures.reserve(k_async_batch);
+            const uint32_t batches = k_async_round_trips / k_async_batch;
+            for(uint32_t batch = 0; batch < batches; batch++) {
+                for(uint32_t i = 0; i < k_async_batch; i++) {
+                    futures.push_back(std::async(std::launch::async, []() {}));
+                }
+                for(std::future<void>& future : futures) {
+                    future.get();
+                }
+                futures.clear();
+            }
+            report.add("async_batch_ns_per_job", elapsed_ns(start) / (batches * k_async_batch));
+        }
+
+        {
+            Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < k_async_round_trips; i++) {
+                std::async(std::launch::async, []() {}).get();
+            }
+            report.add("async_round_trip_ns", elapsed_ns(start) / k_async_round_trips);
+        }
+
+        // A memory bound loop, serial against parallel_for
+        {
+            std::vector<float> values(k_sum_count, 1.0f);
+
+            Clock::time_point start = Clock::now();
+            double serial_sum = 0.0;
+            for(uint32_t i = 0; i < k_sum_count; i++) {
+                serial_sum += values[i];
+            }
+            double serial_ns = elapsed_ns(start);
+
+            std::vector<double> partial_sums(Paopu::JobSystem::get_worker_count(), 0.0);
+            start = Clock::now();
+            Paopu::JobSystem::parallel_for(k_sum_count, [&values, &partial_sums](uint32_t begin, uint32_t end) {
+                double sum = 0.0;
+                for(uint32_t i = begin; i < end; i++) {
+                    sum += values[i];
+                }
+                partial_sums[Paopu::JobSystem::get_worker_index()] += sum;
+            }, 4096);
+            double parallel_ns = elapsed_ns(start);
+
+            double parallel_sum = 0.0;
+            for(double sum : partial_sums) parallel_sum += sum;
+
+            report.add("parallel_for_serial_ms", serial_ns * 1e-6);
+            report.add("parallel_for_ms", parallel_ns * 1e-6);
+            report.add("parallel_for_speedup", parallel_ns > 0.0 ? serial_ns / parallel_ns : 0.0);
+            report.add("parallel_for_correct", parallel_sum == serial_sum ? 1.0 : 0.0);
+        }
+
+        // Submitted from a thread that isn't a worker, which has the
+        // smallest pool
+        {
+            std::unique_ptr<std::atomic<uint32_t>[]> runs(new std::atomic<uint32_t>[k_overflow_jobs]());
+            std::atomic<uint32_t>* slots = runs.get();
+            std::thread submitter([slots]() {
+                Paopu::JobCounter counter;
+                for(uint32_t i = 0; i < k_overflow_jobs; i++) {
+                    Paopu::JobSystem::run([slots, i]() { slots[i].fetch_add(1, std::memory_order_relaxed); }, &counter);
+                }
+                Paopu::JobSystem::wait(&counter);
+            });
+            submitter.join();
+            report.add("external_overflow_correct", runs_once(runs, k_overflow_jobs) ? 1.0 : 0.0);
+        }
+
+        // Continuations parked on a counter hold their slots until it's done
+        {
+            std::unique_ptr<std::atomic<uint32_t>[]> runs(new std::atomic<uint32_t>[k_overflow_jobs]());
+            std::atomic<uint32_t>* slots = runs.get();
+            Paopu::JobCounter dependency;
+            Paopu::JobCounter counter;
+            Paopu::JobSystem::run([]() {}, &dependency);
+            for(uint32_t i = 0; i < k_overflow_jobs; i++) {
+                Paopu::JobSystem::run_after(&dependency, [slots, i]() { slots[i].fetch_add(1, std::memory_order_relaxed); }, &counter);
+            }
+            Paopu::JobSystem::wait(&counter);
+            report.add("continuation_overflow_correct", runs_once(runs, k_overflow_jobs) ? 1.0 : 0.0);
+        }
+
+        Paopu::JobSystem::shutdown();
+    }
+
+}
@@ -0,0 +1,107 @@
+#include <Renderer/LightCulling.h>
+
+#include "BenchMicro.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_lighting_width = 1920;
+    static const uint32_t k_lighting_height = 1080;
+    static const uint32_t k_lighting_counts[] = {64, 256, 1024, 4096};
+    static const uint32_t k_lighting_iterations = 50;
+
+    /// Tiles where binning disagrees with testing every light against the
+    /// tile's closest point, which is what LightCulling.comp does
+    static uint32_t count_mismatched_tiles(const Paopu::LightTileGrid& grid, const std::vector<Paopu::Light2D>& lights, const Paopu::SpriteCamera& camera) {
+        const glm::vec2 extent(k_lighting_width, k_lighting_height);
+        const glm::vec2 pixels_per_unit = glm::abs(camera.scale) * 0.5f * extent;
+        const float tile_size = static_cast<float>(Paopu::k_light_tile_size);
+
+        uint32_t mismatched = 0;
+        for(uint32_t y = 0; y < grid.get_tile_count_y(); y++) {
+            for(uint32_t x = 0; x < grid.get_tile_count_x(); x++) {
+                glm::vec2 tile_min(x * tile_size, y * tile_size);
+                glm::vec2 tile_max = tile_min + tile_size;
+
+                uint32_t expected = 0;
+                for(const Paopu::Light2D& light : lights) {
+                    glm::vec2 center = ((light.position * camera.scale + camera.offset) * 0.5f + 0.5f) * extent;
+                    glm::vec2 delta = (glm::clamp(center, tile_min, tile_max) - center) / pixels_per_unit;
+                    expected += glm::dot(delta, delta) <= light.radius * light.radius ? 1 : 0;
+                }
+
+                // Touching a tile's edge exactly can go either way
+                uint32_t binned = grid.get_light_count(x, y);
+                uint32_t capped = std::min(expected, Paopu::k_max_lights_per_tile);
+                mismatched += binned + 1 < capped || binned > capped + 1 ? 1 : 0;
+            }
+        }
+        return mismatched;
+    }
+
+    /// Bins 64 to 4096 lights of 48 to 160 pixels into 16 pixel tiles of a
+    /// 1080p target. Besides the binning time, reports the lights each pixel
+    /// evaluates in the lit pass, which writes it once, against the blends
+    /// per pixel of drawing a quad per light, the fill the tiles replace.
+    void run_lighting_benchmark(MicroReport& report) {
+        Paopu::SpriteCamera camera;
+        camera.scale = {2.0f / k_lighting_width, 2.0f / k_lighting_height};
+        camera.offset = {-1.0f, -1.0f};
+
+        Paopu::LightTileGrid grid;
+        std::vector<Paopu::Light2D> lights;
+        for(uint32_t light_count : k_lighting_counts) {
+            std::mt19937 random(light_count);
+            std::uniform_real_distribution<float> x(0.0f, static_cast<float>(k_lighting_width));
+            std::uniform_real_distribution<float> y(0.0f, static_cast<float>(k_lighting_height));
+            std::uniform_real_distribution<float> radius(48.0f, 160.0f);
+
+            lights.resize(light_count);
+            double quad_pixels = 0.0;
+            for(Paopu::Light2D& light : lights) {
+                light.position = {x(random), y(random)};
+                light.radius = radius(random);
+
+                // What a light's quad covers on screen
+                float width = std::min(light.position.x + light.radius, static_cast<float>(k_lighting_width)) - std::max(light.position.x - light.radius, 0.0f);
+                float height = std::min(light.position.y + light.radius, static_cast<float>(k_lighting_height)) - std::max(light.position.y - light.radius, 0.0f);
+                quad_pixels += static_cast<double>(width) * height;
+            }
+
+            grid.cull(lights.data(), light_count, camera, k_lighting_width, k_lighting_height);
+            Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < k_lighting_iterations; i++) {
+                grid.cull(lights.data(), light_count, camera, k_lighting_width, k_lighting_height);
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            uint64_t tile_lights = 0;
+            uint32_t max_tile_lights = 0;
+            for(uint32_t tile_y = 0; tile_y < grid.get_tile_count_y(); tile_y++) {
+                for(uint32_t tile_x = 0; tile_x < grid.get_tile_count_x(); tile_x++) {
+                    uint32_t count = grid.get_light_count(tile_x, tile_y);
+                    tile_lights += count;
+                    max_tile_lights = std::max(max_tile_lights, count);
+                }
+            }
+            const double tile_count = static_cast<double>(grid.get_tile_count_x()) * grid.get_tile_count_y();
+            const double pixel_count = static_cast<double>(k_lighting_width) * k_lighting_height;
+
+            std::string name = "lights_" + std::to_string(light_count);
+            report.add((name + "_cull_us").c_str(), seconds * 1e6 / k_lighting_iterations);
+            report.add((name + "_lights_per_pixel").c_str(), tile_lights / tile_count);
+            report.add((name + "_max_lights_per_tile").c_str(), static_cast<double>(max_tile_lights));
+            report.add((name + "_quad_blends_per_pixel").c_str(), quad_pixels / pixel_count);
+            report.add((name + "_overflow").c_str(), static_cast<double>(grid.get_overflow_count()));
+            report.add((name + "_mismatched_tiles").c_str(), static_cast<double>(count_mismatched_tiles(grid, lights, camera)));
+        }
+    }
+
+}
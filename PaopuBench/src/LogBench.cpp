@@ -0,0 +1,67 @@
+#include <Core/Logger.h>
+
+#include "BenchMicro.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Cost of a log call on the calling thread. Text output is off so the
+    /// flusher only drains, the numbers are the ring writes alone.
+    void run_log_benchmark(MicroReport& report) {
+        const uint32_t k_message_count = 100000;
+        const uint32_t k_thread_count = 4;
+
+        Paopu::LoggerSettings settings;
+        settings.text_output = false;
+        settings.ring_size = 8 * 1024 * 1024;
+        Paopu::Logger::init(settings);
+
+        // Touch the ring once so page faults don't count
+        for(uint32_t i = 0; i < k_message_count; i++) {
+            PAO_CORE_INFO("Frame {} took {:.2f}ms", i, 16.6);
+        }
+        Paopu::Logger::flush();
+
+        Clock::time_point start = Clock::now();
+        for(uint32_t i = 0; i < k_message_count; i++) {
+            PAO_CORE_INFO("Frame {} took {:.2f}ms", i, 16.6);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        report.add("ns_per_message", seconds * 1e9 / k_message_count);
+
+        start = Clock::now();
+        for(uint32_t i = 0; i < k_message_count; i++) {
+            PAO_CORE_INFO("Loaded {} from {}", i, "textures/atlas.png");
+        }
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        report.add("ns_per_string_message", seconds * 1e9 / k_message_count);
+        Paopu::Logger::flush();
+
+        // Every thread has its own ring, so they shouldn't slow each other down
+        std::vector<std::thread> threads;
+        start = Clock::now();
+        for(uint32_t t = 0; t < k_thread_count; t++) {
+            threads.emplace_back([t, k_message_count]() {
+                for(uint32_t i = 0; i < k_message_count; i++) {
+                    PAO_CORE_INFO("Thread {} message {}", t, i);
+                }
+            });
+        }
+        for(std::thread& thread : threads) {
+            thread.join();
+        }
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        report.add("threaded_ns_per_message", seconds * 1e9 / (k_message_count * k_thread_count));
+
+        Paopu::Logger::flush();
+        report.add("dropped", static_cast<double>(Paopu::Logger::get_dropped_count()));
+
+        Paopu::Logger::init();
+    }
+
+}
@@ -0,0 +1,373 @@
+#include <Assets/AssetArchive.h>
+#include <Core/Logger.h>
+#include <Memory/AllocationTracker.h>
+#include <Memory/FrameMemory.h>
+#include <Renderer/Renderer.h>
+
+#include "BenchMicro.h"
+#include "BenchScenes.h"
+#include "GoldenImage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace Bench {
+
+    /// Command line options, see `print_usage`
+    struct BenchOptions {
+        std::string scene{"all"};
+        std::string micro{};
+        uint32_t frames{600};
+        uint32_t warmup_frames{60};
+        uint32_t width{1280};
+        uint32_t height{720};
+        std::string golden_dir{PAO_BENCH_GOLDEN_DIR};
+        std::string output_path{};
+        std::string archive_path{};
+        bool update_golden{false};
+        uint32_t tolerance{2};
+        double max_differing_ratio{0.001};
+    };
+
+    /// Everything measured for a single scene
+    struct SceneReport {
+        std::string name;
+        std::vector<double> cpu_frame_ms;
+        double gpu_pass_ms_total[Paopu::k_max_gpu_passes]{};
+        const char* gpu_pass_names[Paopu::k_max_gpu_passes]{};
+        uint32_t gpu_pass_count{0};
+        uint32_t gpu_samples{0};
+        uint64_t allocations{0};
+        uint64_t allocated_bytes{0};
+        uint64_t draw_calls{0};
+        uint64_t instances{0};
+        std::string golden_status{"skipped"};
+        ImageDiff diff{};
+        Paopu::RendererMemoryStats memory{};
+        // Most uniform bytes a frame pushed, and the regions they rotate through
+        uint64_t uniform_peak_bytes{0};
+        uint64_t uniform_frame_bytes{0};
+        uint32_t uniform_frames{0};
+    };
+
+    static void print_usage() {
+        printf("usage: paopu_bench [options]\n"
+               "  --scene <name|all>       Scene to run (default: all)\n"
+               "  --micro <name|all>       Run CPU micro benchmarks instead of scenes\n"
+               "  --frames <n>             Measured frames per scene (default: 600)\n"
+               "  --warmup <n>             Unmeasured frames before measuring (default: 60)\n"
+               "  --size <w> <h>           Offscreen target size (default: 1280 720)\n"
+               "  --golden-dir <dir>       Directory holding <scene>.ppm golden images\n"
+               "  --update-golden          Write the final frames as the new golden images,\n"
+               "                           scenes without one fail otherwise\n"
+               "  --tolerance <n>          Allowed per-channel difference (default: 2)\n"
+               "  --max-diff-ratio <r>     Allowed fraction of differing pixels (default: 0.001)\n"
+               "  --output <file>          Write the JSON report to a file instead of stdout\n"
+               "  --archive <file>         Load shaders from a packed asset archive (see paopu_pack)\n");
+    }
+
+    static bool parse_options(int argc, char** argv, BenchOptions& options) {
+        for(int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if(arg == "--scene" && has_value) options.scene = argv[++i];
+            else if(arg == "--micro" && has_value) options.micro = argv[++i];
+            else if(arg == "--frames" && has_value) options.frames = static_cast<uint32_t>(std::atoi(argv[++i]));
+            else if(arg == "--warmup" && has_value) options.warmup_frames = static_cast<uint32_t>(std::atoi(argv[++i]));
+            else if(arg == "--size" && i + 2 < argc) {
+                options.width = static_cast<uint32_t>(std::atoi(argv[++i]));
+                options.height = static_cast<uint32_t>(std::atoi(argv[++i]));
+            }
+            else if(arg == "--golden-dir" && has_value) options.golden_dir = argv[++i];
+            else if(arg == "--update-golden") options.update_golden = true;
+            else if(arg == "--tolerance" && has_value) options.tolerance = static_cast<uint32_t>(std::atoi(argv[++i]));
+            else if(arg == "--max-diff-ratio" && has_value) options.max_differing_ratio = std::atof(argv[++i]);
+            else if(arg == "--output" && has_value) options.output_path = argv[++i];
+            else if(arg == "--archive" && has_value) options.archive_path = argv[++i];
+            else {
+                print_usage();
+                return false;
+            }
+        }
+
+        return options.frames > 0 && options.width > 0 && options.height > 0;
+    }
+
+    /// Nearest-rank percentile of an already sorted sample set
+    static double percentile(const std::vector<double>& sorted, double p) {
+        if(sorted.empty()) return 0.0;
+        size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    static void run_scene(BenchScene& scene, Paopu::Renderer& renderer, const BenchOptions& options, SceneReport& report) {
+        // Every scene is stepped at the same fixed rate so runs are reproducible
+        const float k_fixed_dt = 1.0f / 60.0f;
+
+        report.name = scene.get_name();
+        report.cpu_frame_ms.reserve(options.frames);
+
+        std::vector<Paopu::SpriteInstance> sprites;
+        std::vector<Paopu::Light2D> lights;
+        glm::vec3 ambient(0.0f);
+        scene.setup(options.width, options.height);
+
+        const uint32_t total_frames = options.warmup_frames + options.frames;
+        for(uint32_t frame = 0; frame < total_frames; frame++) {
+            bool measured = frame >= options.warmup_frames;
+            // See AllocationTracker.h
+            Paopu::AllocationStats allocations_before = Paopu::get_allocation_stats();
+
+            auto start = std::chrono::steady_clock::now();
+
+            sprites.clear();
+            scene.update(k_fixed_dt);
+            scene.build(sprites);
+            if(scene.is_lit()) {
+                lights.clear();
+                scene.build_lights(lights, ambient);
+                renderer.set_lights(lights.data(), static_cast<uint32_t>(lights.size()), ambient);
+            }
+            renderer.draw_sprites(sprites.data(), static_cast<uint32_t>(sprites.size()));
+            Paopu::FrameMemory::end_frame();
+
+            auto end = std::chrono::steady_clock::now();
+
+            if(!measured) continue;
+
+            report.cpu_frame_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            Paopu::AllocationStats allocations_after = Paopu::get_allocation_stats();
+            report.allocations += allocations_after.count - allocations_before.count;
+            report.allocated_bytes += allocations_after.bytes - allocations_before.bytes;
+
+            // GPU timings trail by the frames in flight, they're collected when
+            // the renderer waits on a frame to reuse its resources.
+            const Paopu::RendererStats& stats = renderer.get_stats();
+            report.draw_calls += stats.draw_calls;
+            report.instances += stats.instances;
+            if(frame >= options.warmup_frames + Paopu::k_max_frames_in_flight) {
+                report.gpu_pass_count = stats.gpu_pass_count;
+                for(uint32_t i = 0; i < stats.gpu_pass_count; i++) {
+                    report.gpu_pass_names[i] = stats.gpu_passes[i].name;
+                    report.gpu_pass_ms_total[i] += stats.gpu_passes[i].milliseconds;
+                }
+                report.gpu_samples++;
+            }
+        }
+
+        // Host counters are process wide, `peak_bytes` covers every scene so far
+        report.memory = renderer.query_memory_stats();
+        const Paopu::PaopuUniformRing& ring = renderer.get_uniform_ring();
+        report.uniform_peak_bytes = ring.peak;
+        report.uniform_frame_bytes = ring.frame_size;
+        report.uniform_frames = ring.frame_count;
+
+        Image actual{options.width, options.height, {}};
+        renderer.read_back_target(actual.pixels);
+
+        std::string golden_path = options.golden_dir + "/" + report.name + ".ppm";
+        if(options.update_golden) {
+            report.golden_status = write_ppm(golden_path, actual) ? "updated" : "write_failed";
+            return;
+        }
+
+        // A scene without a golden image isn't checked, which counts as a
+        // failure; its frame is kept so it can be looked at and promoted
+        Image golden;
+        if(!read_ppm(golden_path, golden)) {
+            report.golden_status = "missing";
+            write_ppm(options.golden_dir + "/" + report.name + ".actual.ppm", actual);
+            return;
+        }
+
+        report.diff = compare_images(actual, golden, options.tolerance);
+        bool passed = report.diff.sizes_match && report.diff.differing_ratio <= options.max_differing_ratio;
+        report.golden_status = passed ? "passed" : "failed";
+
+        // Keep the failing frame around so it can be inspected or promoted
+        if(!passed) {
+            write_ppm(options.golden_dir + "/" + report.name + ".actual.ppm", actual);
+        }
+    }
+
+    /// Runs the micro benchmarks picked by `--micro` and writes their report
+    static int run_micro_benchmarks(const BenchOptions& options) {
+        std::vector<MicroReport> reports;
+        for(const MicroBenchmark& benchmark : create_micro_benchmarks()) {
+            if(options.micro != "all" && options.micro != benchmark.name) continue;
+
+            reports.emplace_back();
+            reports.back().name = benchmark.name;
+            benchmark.run(reports.back());
+        }
+
+        if(reports.empty()) {
+            fprintf(stderr, "[Bench]: No micro benchmark named '%s'\n", options.micro.c_str());
+            return EXIT_FAILURE;
+        }
+
+        if(options.output_path.empty()) {
+            std::ostringstream report;
+            write_micro_report(report, reports);
+            fputs(report.str().c_str(), stdout);
+        } else {
+            std::ofstream file(options.output_path);
+            write_micro_report(file, reports);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    static void write_memory(std::ostream& out, const Paopu::RendererMemoryStats& memory) {
+        out << "      \"memory\": {\n";
+        out << "        \"host\": {";
+        for(uint32_t scope = 0; scope < Paopu::k_host_scope_count; scope++) {
+            const Paopu::HostScopeStats& stats = memory.host.scopes[scope];
+            out << (scope > 0 ? ", " : "") << "\"" << Paopu::get_host_scope_name(scope) << "\": {";
+            out << "\"live_bytes\": " << stats.live_bytes;
+            out << ", \"live_count\": " << stats.live_count;
+            out << ", \"peak_bytes\": " << stats.peak_bytes;
+            out << ", \"total_count\": " << stats.total_count;
+            out << ", \"internal_bytes\": " << memory.host.internal[scope].live_bytes << "}";
+        }
+        out << "},\n";
+
+        out << "        \"has_budget\": " << (memory.has_budget ? "true" : "false") << ",\n";
+        out << "        \"heaps\": [";
+        for(uint32_t heap = 0; heap < memory.heap_count; heap++) {
+            const Paopu::GpuHeapUsage& usage = memory.heaps[heap];
+            out << (heap > 0 ? ", " : "") << "{\"size\": " << usage.size;
+            out << ", \"budget\": " << usage.budget;
+            out << ", \"usage\": " << usage.usage;
+            out << ", \"device_local\": " << (usage.device_local ? "true" : "false") << "}";
+        }
+        out << "]\n";
+        out << "      },\n";
+    }
+
+    static void write_report(std::ostream& out, const BenchOptions& options, const std::vector<SceneReport>& reports) {
+        out << "{\n";
+        out << "  \"frames\": " << options.frames << ",\n";
+        out << "  \"width\": " << options.width << ",\n";
+        out << "  \"height\": " << options.height << ",\n";
+        out << "  \"scenes\": [\n";
+
+        for(size_t i = 0; i < reports.size(); i++) {
+            const SceneReport& report = reports[i];
+
+            std::vector<double> sorted = report.cpu_frame_ms;
+            std::sort(sorted.begin(), sorted.end());
+            double mean = 0.0;
+            for(double sample : sorted) mean += sample;
+            mean = sorted.empty() ? 0.0 : mean / sorted.size();
+
+            const double frames = static_cast<double>(std::max<size_t>(1, report.cpu_frame_ms.size()));
+
+            out << "    {\n";
+            out << "      \"name\": \"" << report.name << "\",\n";
+            out << "      \"cpu_frame_ms\": {";
+            out << "\"mean\": " << mean;
+            out << ", \"p50\": " << percentile(sorted, 50.0);
+            out << ", \"p90\": " << percentile(sorted, 90.0);
+            out << ", \"p99\": " << percentile(sorted, 99.0);
+            out << ", \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << "},\n";
+
+            out << "      \"gpu_pass_ms\": {";
+            for(uint32_t pass = 0; pass < report.gpu_pass_count; pass++) {
+                double average = report.gpu_samples > 0 ? report.gpu_pass_ms_total[pass] / report.gpu_samples : 0.0;
+                out << (pass > 0 ? ", " : "") << "\"" << report.gpu_pass_names[pass] << "\": " << average;
+            }
+            out << "},\n";
+
+            out << "      \"allocations_per_frame\": " << report.allocations / frames << ",\n";
+            out << "      \"allocated_bytes_per_frame\": " << report.allocated_bytes / frames << ",\n";
+            out << "      \"draw_calls_per_frame\": " << report.draw_calls / frames << ",\n";
+            out << "      \"instances_per_frame\": " << report.instances / frames << ",\n";
+            write_memory(out, report.memory);
+            out << "      \"uniform_ring\": {\"frames\": " << report.uniform_frames;
+            out << ", \"frame_bytes\": " << report.uniform_frame_bytes;
+            out << ", \"peak_bytes\": " << report.uniform_peak_bytes << "},\n";
+            out << "      \"golden\": {\"status\": \"" << report.golden_status << "\"";
+            out << ", \"differing_pixels\": " << report.diff.differing_pixels;
+            out << ", \"differing_ratio\": " << report.diff.differing_ratio;
+            out << ", \"max_channel_delta\": " << report.diff.max_channel_delta << "}\n";
+            out << "    }" << (i + 1 < reports.size() ? "," : "") << "\n";
+        }
+
+        out << "  ]\n";
+        out << "}\n";
+    }
+
+}
+
+int main(int argc, char** argv) {
+    Bench::BenchOptions options;
+    if(!Bench::parse_options(argc, argv, options)) {
+        return EXIT_FAILURE;
+    }
+
+    Paopu::Logger::init();
+
+    if(!options.micro.empty()) {
+        return Bench::run_micro_benchmarks(options);
+    }
+
+    std::vector<Bench::SceneReport> reports;
+    bool failed = false;
+
+    try {
+        Paopu::AssetArchive archive;
+        if(!options.archive_path.empty()) {
+            archive.open(options.archive_path);
+        }
+
+        auto scenes = Bench::create_scenes();
+        for(auto& scene : scenes) {
+            if(options.scene != "all" && options.scene != scene->get_name()) continue;
+
+            // A fresh backend per scene so one scene's buffers don't skew the next
+            Paopu::Renderer renderer;
+            renderer.set_asset_archive(archive.is_open() ? &archive : nullptr);
+            renderer.init_headless(options.width, options.height);
+            if(scene->is_lit()) renderer.enable_lighting();
+            if(const Paopu::PostSettings* post = scene->get_post_settings()) renderer.enable_post_processing(*post);
+
+            reports.emplace_back();
+            Bench::run_scene(*scene, renderer, options, reports.back());
+            // Anything but a match, or a deliberate update, fails the run
+            const std::string& status = reports.back().golden_status;
+            if(status != "passed" && status != "updated") {
+                fprintf(stderr, "[Bench]: Golden image check of '%s' %s%s\n", scene->get_name(), status.c_str(),
+                        status == "missing" ? ", run with --update-golden to create it" : "");
+                failed = true;
+            }
+
+            renderer.free_renderer();
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    if(reports.empty()) {
+        fprintf(stderr, "[Bench]: No scene named '%s'\n", options.scene.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if(options.output_path.empty()) {
+        std::ostringstream report;
+        Bench::write_report(report, options, reports);
+        fputs(report.str().c_str(), stdout);
+    } else {
+        std::ofstream file(options.output_path);
+        Bench::write_report(file, options, reports);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
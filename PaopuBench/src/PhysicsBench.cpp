@@ -0,0 +1,141 @@
+#include <Core/JobSystem.h>
+#include <Physics/PhysicsWorld.h>
+
+#include "BenchMicro.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_pile_columns = 200;
+    static const uint32_t k_pile_rows = 100;
+    static const uint32_t k_pile_steps = 300;
+    // Steps at the end, once most of the pile has landed
+    static const uint32_t k_settled_steps = 60;
+    static const float k_pile_step = 1.0f / 60.0f;
+
+    struct PileResult {
+        double step_ms;
+        double settled_step_ms;
+        Paopu::PhysicsStats totals;
+        Paopu::PhysicsStats last;
+        float max_penetration;
+        std::vector<glm::vec2> positions;
+    };
+
+    /// Boxes and circles dropped into a container, every body awake so every
+    /// step pays for all of them
+    static PileResult run_pile() {
+        Paopu::PhysicsWorld world;
+        Paopu::PhysicsSettings settings;
+        settings.allow_sleep = false;
+        world.set_settings(settings);
+
+        Paopu::BodyDesc ground;
+        ground.type = Paopu::BodyType::Static;
+        ground.shape.half_extents = {130.0f, 1.0f};
+        ground.position = {0.0f, -1.0f};
+        world.create_body(ground);
+
+        Paopu::BodyDesc wall = ground;
+        wall.shape.half_extents = {1.0f, 80.0f};
+        wall.position = {-126.0f, 80.0f};
+        world.create_body(wall);
+        wall.position = {126.0f, 80.0f};
+        world.create_body(wall);
+
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+        std::vector<Paopu::BodyHandle> handles;
+        for(uint32_t row = 0; row < k_pile_rows; row++) {
+            for(uint32_t column = 0; column < k_pile_columns; column++) {
+                Paopu::BodyDesc body;
+                if((row + column) % 4 == 0) {
+                    body.shape.type = Paopu::ShapeType::Circle;
+                    body.shape.radius = 0.5f;
+                }
+                body.position = {(static_cast<float>(column) - k_pile_columns * 0.5f) * 1.2f + jitter(random), 1.0f + row * 1.1f};
+                body.angle = jitter(random) * 4.0f;
+                handles.push_back(world.create_body(body));
+            }
+        }
+
+        PileResult result{};
+        Clock::time_point start = Clock::now();
+        Clock::time_point settled_start = start;
+        for(uint32_t step = 0; step < k_pile_steps; step++) {
+            if(step == k_pile_steps - k_settled_steps) settled_start = Clock::now();
+            world.step(k_pile_step);
+
+            const Paopu::PhysicsStats& stats = world.get_stats();
+            result.totals.broadphase_ns += stats.broadphase_ns;
+            result.totals.narrowphase_ns += stats.narrowphase_ns;
+            result.totals.solve_ns += stats.solve_ns;
+            result.totals.integrate_ns += stats.integrate_ns;
+            result.totals.island_ns += stats.island_ns;
+        }
+        Clock::time_point end = Clock::now();
+
+        result.step_ms = std::chrono::duration<double, std::milli>(end - start).count() / k_pile_steps;
+        result.settled_step_ms = std::chrono::duration<double, std::milli>(end - settled_start).count() / k_settled_steps;
+        result.last = world.get_stats();
+
+        result.max_penetration = 0.0f;
+        for(const Paopu::ContactManifold& contact : world.get_contacts()) {
+            for(uint32_t p = 0; p < contact.point_count; p++) {
+                result.max_penetration = std::max(result.max_penetration, -contact.points[p].separation);
+            }
+        }
+        for(Paopu::BodyHandle handle : handles) {
+            result.positions.push_back(world.get_position(handle));
+        }
+        return result;
+    }
+
+    /// A 20k body pile stepped on one worker and then on all of them. The
+    /// solver's batches don't depend on the worker count, so both runs have
+    /// to end with bit identical positions.
+    void run_physics_benchmark(MicroReport& report) {
+        Paopu::JobSystem::init(1);
+        PileResult serial = run_pile();
+        Paopu::JobSystem::shutdown();
+
+        Paopu::JobSystem::init();
+        uint32_t workers = Paopu::JobSystem::get_worker_count();
+        PileResult parallel = run_pile();
+        Paopu::JobSystem::shutdown();
+
+        bool identical = serial.positions.size() == parallel.positions.size()
+                        && std::memcmp(serial.positions.data(), parallel.positions.data(), serial.positions.size() * sizeof(glm::vec2)) == 0;
+
+        report.add("bodies", parallel.last.body_count);
+        report.add("workers", workers);
+        report.add("serial_step_ms", serial.step_ms);
+        report.add("serial_settled_step_ms", serial.settled_step_ms);
+        report.add("parallel_step_ms", parallel.step_ms);
+        report.add("parallel_settled_step_ms", parallel.settled_step_ms);
+        report.add("speedup", serial.step_ms / parallel.step_ms);
+
+        const Paopu::PhysicsStats& totals = parallel.totals;
+        report.add("broadphase_ms", totals.broadphase_ns * 1e-6 / k_pile_steps);
+        report.add("narrowphase_ms", totals.narrowphase_ns * 1e-6 / k_pile_steps);
+        report.add("solve_ms", totals.solve_ns * 1e-6 / k_pile_steps);
+        report.add("integrate_ms", totals.integrate_ns * 1e-6 / k_pile_steps);
+        report.add("island_ms", totals.island_ns * 1e-6 / k_pile_steps);
+
+        report.add("contacts", parallel.last.contact_count);
+        report.add("colors", parallel.last.color_count);
+        report.add("overflow_contacts", parallel.last.overflow_count);
+        report.add("islands", parallel.last.island_count);
+        report.add("largest_island", parallel.last.largest_island);
+        report.add("max_penetration", parallel.max_penetration);
+        report.add("deterministic", identical ? 1.0 : 0.0);
+    }
+
+}
@@ -0,0 +1,53 @@
+#include <Core/Profiler.h>
+
+#include "BenchMicro.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Cost of a profiler zone while capturing and while idle. Uses
+    /// ProfileScope directly so it doesn't depend on PAO_PROFILE.
+    void run_profiler_benchmark(MicroReport& report) {
+        const uint32_t k_zone_count = 200000;
+        const char* k_trace_path = "paopu_bench_profile.json";
+
+        // Idle: one relaxed load per zone
+        Clock::time_point start = Clock::now();
+        for(uint32_t i = 0; i < k_zone_count; i++) {
+            Paopu::ProfileScope scope("Idle zone");
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        report.add("idle_ns_per_zone", seconds * 1e9 / k_zone_count);
+
+        // A first capture fills the buffers, they're reused by the next one so
+        // page faults don't count
+        Paopu::Profiler::request_capture(1, k_trace_path);
+        Paopu::Profiler::mark_frame();
+        for(uint32_t i = 0; i < k_zone_count; i++) {
+            Paopu::ProfileScope scope("Warmup zone");
+        }
+        Paopu::Profiler::mark_frame();
+
+        Paopu::Profiler::request_capture(1, k_trace_path);
+        Paopu::Profiler::mark_frame();
+
+        start = Clock::now();
+        for(uint32_t i = 0; i < k_zone_count; i++) {
+            Paopu::ProfileScope scope("Captured zone");
+        }
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        report.add("captured_ns_per_zone", seconds * 1e9 / k_zone_count);
+
+        start = Clock::now();
+        Paopu::Profiler::mark_frame();
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        report.add("export_ms", seconds * 1e3);
+
+        std::remove(k_trace_path);
+    }
+
+}
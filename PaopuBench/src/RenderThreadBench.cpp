@@ -0,0 +1,78 @@
+#include <Renderer/RenderThread.h>
+
+#include "BenchMicro.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_pipeline_frames = 240;
+    static const uint32_t k_pipeline_sprites = 10000;
+    // A CPU heavy scene: simulating and recording take about as long
+    static const std::chrono::microseconds k_simulate_time{1500};
+    static const std::chrono::microseconds k_record_time{1500};
+
+    /// Stands in for work that keeps a core busy
+    static void spin_for(std::chrono::microseconds duration) {
+        Clock::time_point end = Clock::now() + duration;
+        while(Clock::now() < end) {}
+    }
+
+    static void record_snapshot(const Paopu::RenderSnapshot& snapshot, void* user_data) {
+        // Touch what a renderer would read, so the snapshot has to be complete
+        float* checksum = static_cast<float*>(user_data);
+        for(const Paopu::SpriteInstance& sprite : snapshot.sprites) {
+            *checksum += sprite.translation.x;
+        }
+        spin_for(k_record_time);
+    }
+
+    /// The Application frame loop with the Vulkan recording replaced by busy
+    /// work of a fixed length, at each render latency. With a latency of 0 a
+    /// frame costs simulation plus recording, above that only the longer of
+    /// the two once the pipeline is full.
+    void run_render_thread_benchmark(MicroReport& report) {
+        double serial_frame_ms = 0.0;
+
+        for(uint32_t latency = 0; latency <= Paopu::RenderThread::k_max_latency_frames; latency++) {
+            float checksum = 0.0f;
+            Paopu::RenderThread render_thread;
+            render_thread.start(latency, record_snapshot, &checksum);
+
+            Clock::time_point start = Clock::now();
+            for(uint32_t frame = 0; frame < k_pipeline_frames; frame++) {
+                spin_for(k_simulate_time);
+
+                Paopu::RenderSnapshot& snapshot = render_thread.begin_snapshot();
+                snapshot.frame = frame;
+                snapshot.sprites.clear();
+                for(uint32_t i = 0; i < k_pipeline_sprites; i++) {
+                    Paopu::SpriteInstance sprite;
+                    sprite.translation = {static_cast<float>(i % 100), static_cast<float>(frame)};
+                    snapshot.sprites.push_back(sprite);
+                }
+                render_thread.submit_snapshot();
+            }
+            render_thread.wait_idle();
+            double frame_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / k_pipeline_frames;
+
+            Paopu::RenderThreadStats stats = render_thread.get_stats();
+            render_thread.stop();
+            if(latency == 0) serial_frame_ms = frame_ms;
+
+            char metric[64];
+            snprintf(metric, sizeof(metric), "latency%u_frame_ms", latency);
+            report.add(metric, frame_ms);
+            snprintf(metric, sizeof(metric), "latency%u_speedup", latency);
+            report.add(metric, serial_frame_ms / frame_ms);
+            snprintf(metric, sizeof(metric), "latency%u_frame_wait_ms", latency);
+            report.add(metric, stats.frame_wait_ns * 1e-6 / k_pipeline_frames);
+            snprintf(metric, sizeof(metric), "latency%u_render_wait_ms", latency);
+            report.add(metric, stats.render_wait_ns * 1e-6 / k_pipeline_frames);
+        }
+    }
+
+}
@@ -0,0 +1,103 @@
+#include <Renderer/TextureResidency.h>
+
+#include "BenchMicro.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_world_columns = 64;
+    static const uint32_t k_world_rows = 32;
+    static const float k_tile_size = 256.0f;
+    static const uint32_t k_residency_frames = 600;
+    // Close to 3 GB of full mip chains streamed through 64 MB
+    static const uint64_t k_texture_budget = 64ull * 1024 * 1024;
+
+    /// A camera panning over a world of 512x512 textures, one per tile, with
+    /// everything streamed through a budget a small fraction of the world's
+    /// size. Loads complete the frame after they are requested.
+    void run_residency_benchmark(MicroReport& report) {
+        Paopu::TextureResidency residency;
+        Paopu::ResidencySettings settings;
+        settings.max_loads_per_update = 32;
+        residency.set_settings(settings);
+        residency.set_budget(k_texture_budget);
+
+        Paopu::ResidentTextureDesc desc;
+        desc.width = 512;
+        desc.height = 512;
+        desc.mip_count = 10;
+        desc.tail_mips = 4;
+
+        std::vector<Paopu::SpriteInstance> tiles(k_world_columns * k_world_rows);
+        for(uint32_t i = 0; i < tiles.size(); i++) {
+            Paopu::SpriteInstance& tile = tiles[i];
+            tile.texture_index = residency.add_texture(desc);
+            tile.translation = {(i % k_world_columns + 0.5f) * k_tile_size, (i / k_world_columns + 0.5f) * k_tile_size};
+            tile.basis = {k_tile_size, 0.0f, 0.0f, k_tile_size};
+        }
+
+        std::vector<Paopu::SpriteInstance> visible;
+        std::vector<Paopu::ResidencyRequest> loads;
+        std::vector<Paopu::ResidencyRequest> evictions;
+
+        double report_seconds = 0.0;
+        double update_seconds = 0.0;
+        uint64_t reported = 0;
+        double peak_use = 0.0;
+
+        for(uint32_t frame = 0; frame < k_residency_frames; frame++) {
+            // Back and forth across the world, zooming in and out
+            float t = static_cast<float>(frame) / k_residency_frames;
+            float zoom = 1.0f + 0.75f * std::sin(t * 12.0f);
+            float view_width = 1920.0f / zoom;
+            float view_height = 1080.0f / zoom;
+            float x = (0.5f - 0.5f * std::cos(t * 6.2831853f)) * (k_world_columns * k_tile_size - view_width);
+            float y = 0.5f * (k_world_rows * k_tile_size - view_height);
+
+            visible.clear();
+            for(const Paopu::SpriteInstance& tile : tiles) {
+                if(tile.translation.x + k_tile_size * 0.5f < x || tile.translation.x - k_tile_size * 0.5f > x + view_width) continue;
+                if(tile.translation.y + k_tile_size * 0.5f < y || tile.translation.y - k_tile_size * 0.5f > y + view_height) continue;
+
+                // Size on screen in pixels
+                visible.push_back(tile);
+                visible.back().basis *= zoom;
+            }
+
+            for(const Paopu::ResidencyRequest& load : loads) {
+                residency.complete_load(load.texture, load.mip);
+            }
+            loads.clear();
+            evictions.clear();
+
+            Clock::time_point start = Clock::now();
+            residency.report_sprites(visible.data(), static_cast<uint32_t>(visible.size()));
+            Clock::time_point reported_at = Clock::now();
+            residency.update(loads, evictions);
+            Clock::time_point end = Clock::now();
+
+            report_seconds += std::chrono::duration<double>(reported_at - start).count();
+            update_seconds += std::chrono::duration<double>(end - reported_at).count();
+            reported += visible.size();
+
+            Paopu::ResidencyStats stats = residency.get_stats();
+            peak_use = std::max(peak_use, static_cast<double>(stats.resident_bytes + stats.pending_bytes) / stats.budget);
+        }
+
+        Paopu::ResidencyStats stats = residency.get_stats();
+        report.add("textures", static_cast<double>(stats.texture_count));
+        report.add("update_us", update_seconds * 1e6 / k_residency_frames);
+        report.add("report_ns_per_sprite", reported > 0 ? report_seconds * 1e9 / reported : 0.0);
+        report.add("loads_per_frame", static_cast<double>(stats.loads) / k_residency_frames);
+        report.add("evictions_per_frame", static_cast<double>(stats.evictions) / k_residency_frames);
+        report.add("peak_budget_use", peak_use);
+    }
+
+}
@@ -0,0 +1,122 @@
+#include <Assets/AssetLoader.h>
+
+#include "BenchMicro.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_stream_file_count = 256;
+    static const uint32_t k_stream_visible_count = 32;
+    static const size_t k_stream_file_size = 256 * 1024;
+
+    /// One request's timing, handed to the loader as user data
+    struct StreamLoad {
+        Clock::time_point requested;
+        double latency_ms{-1.0};
+        bool visible{false};
+    };
+
+    /// Streams the same files through one loader backend while a fake frame
+    /// loop calls `update`, and reports how quickly each priority arrived.
+    static void run_stream(MicroReport& report, const std::string& directory, bool use_io_uring, const char* prefix) {
+        Paopu::AssetLoaderSettings settings;
+        settings.use_io_uring = use_io_uring;
+
+        Paopu::AssetLoader loader;
+        loader.init(settings);
+
+        std::vector<StreamLoad> loads(k_stream_file_count);
+        std::vector<Paopu::AssetRequestId> ids(k_stream_file_count);
+
+        Paopu::AssetLoadDesc desc;
+        desc.on_loaded = [](Paopu::AssetLoadResult& result) {
+            StreamLoad* load = static_cast<StreamLoad*>(result.user_data);
+            load->latency_ms = std::chrono::duration<double, std::milli>(Clock::now() - load->requested).count();
+        };
+
+        // Background streaming gets queued first, then what's on screen
+        Clock::time_point start = Clock::now();
+        for(uint32_t i = 0; i < k_stream_file_count; i++) {
+            StreamLoad& load = loads[i];
+            load.visible = i >= k_stream_file_count - k_stream_visible_count;
+            load.requested = Clock::now();
+
+            desc.priority = load.visible ? Paopu::AssetPriority::Visible : Paopu::AssetPriority::Background;
+            desc.user_data = &load;
+            ids[i] = loader.load_file(directory + "/stream_" + std::to_string(i) + ".bin", desc);
+        }
+
+        // The player turned around, every 8th background load isn't needed
+        uint32_t cancelled = 0;
+        for(uint32_t i = 0; i < k_stream_file_count - k_stream_visible_count; i += 8) {
+            cancelled += loader.cancel(ids[i]) ? 1 : 0;
+        }
+
+        double max_update_us = 0.0;
+        for(;;) {
+            Clock::time_point update_start = Clock::now();
+            loader.update();
+            max_update_us = std::max(max_update_us, std::chrono::duration<double, std::micro>(Clock::now() - update_start).count());
+
+            Paopu::AssetLoaderStats stats = loader.get_stats();
+            if(stats.loaded + stats.failed + stats.cancelled >= k_stream_file_count) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        double visible_ms = 0.0;
+        double background_ms = 0.0;
+        uint32_t background_count = 0;
+        for(const StreamLoad& load : loads) {
+            if(load.latency_ms < 0.0) continue;
+            if(load.visible) {
+                visible_ms += load.latency_ms;
+            } else {
+                background_ms += load.latency_ms;
+                background_count++;
+            }
+        }
+
+        Paopu::AssetLoaderStats stats = loader.get_stats();
+        std::string name = prefix;
+        report.add((name + "_mb_per_s").c_str(), static_cast<double>(stats.bytes_read) / seconds / (1024.0 * 1024.0));
+        report.add((name + "_visible_latency_ms").c_str(), visible_ms / k_stream_visible_count);
+        report.add((name + "_background_latency_ms").c_str(), background_count > 0 ? background_ms / background_count : 0.0);
+        report.add((name + "_max_update_us").c_str(), max_update_us);
+        report.add((name + "_cancelled").c_str(), static_cast<double>(cancelled));
+        report.add((name + "_failed").c_str(), static_cast<double>(stats.failed));
+
+        loader.shutdown();
+    }
+
+    /// AssetLoader throughput and priority ordering, through io_uring (where
+    /// the kernel has it) and the thread pool fallback
+    void run_streaming_benchmark(MicroReport& report) {
+        const std::string k_directory = "paopu_bench_stream";
+        std::filesystem::create_directories(k_directory);
+
+        std::vector<char> data(k_stream_file_size);
+        for(uint32_t i = 0; i < k_stream_file_count; i++) {
+            for(size_t byte = 0; byte < data.size(); byte++) {
+                data[byte] = static_cast<char>(byte * 7 + i);
+            }
+            std::ofstream file(k_directory + "/stream_" + std::to_string(i) + ".bin", std::ios::binary);
+            file.write(data.data(), data.size());
+        }
+
+        run_stream(report, k_directory, true, "io_uring");
+        run_stream(report, k_directory, false, "thread_pool");
+
+        std::filesystem::remove_all(k_directory);
+    }
+
+}
@@ -0,0 +1,143 @@
+#include <Assets/BlockCompression.h>
+#include <Assets/Ktx2.h>
+#include <Assets/TextureTranscoder.h>
+
+#include "BenchMicro.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t k_texture_size = 1024;
+    static const uint32_t k_texture_mips = 11;
+    static const uint32_t k_transcode_runs = 4;
+
+    /// Something sprite-like: smooth gradients, hard edges, a little noise,
+    /// and a soft alpha falloff where `alpha` is set
+    static void make_texture(bool alpha, std::vector<uint8_t>& mips) {
+        std::vector<uint8_t> level(k_texture_size * k_texture_size * 4);
+        uint32_t seed = 0x9E3779B9u;
+        for(uint32_t y = 0; y < k_texture_size; y++) {
+            for(uint32_t x = 0; x < k_texture_size; x++) {
+                seed = seed * 1664525u + 1013904223u;
+                int noise = static_cast<int>(seed >> 28) - 8;
+                bool stripe = ((x / 96) + (y / 64)) % 2 == 0;
+
+                uint8_t* texel = &level[(y * k_texture_size + x) * 4];
+                texel[0] = static_cast<uint8_t>(std::min(255, std::max(0, static_cast<int>(x / 4) + noise)));
+                texel[1] = static_cast<uint8_t>(std::min(255, std::max(0, static_cast<int>(y / 4) + noise)));
+                texel[2] = static_cast<uint8_t>(stripe ? 200 : 40);
+
+                float dx = (x - k_texture_size * 0.5f) / (k_texture_size * 0.5f);
+                float dy = (y - k_texture_size * 0.5f) / (k_texture_size * 0.5f);
+                float falloff = std::max(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy));
+                texel[3] = alpha ? static_cast<uint8_t>(std::min(255.0f, falloff * 400.0f)) : 255;
+            }
+        }
+
+        // Box filtered mip chain, back to back as write_ktx2 wants it
+        mips = level;
+        uint32_t size = k_texture_size;
+        for(uint32_t mip = 1; mip < k_texture_mips; mip++) {
+            uint32_t half = size / 2;
+            std::vector<uint8_t> next(half * half * 4);
+            for(uint32_t y = 0; y < half; y++) {
+                for(uint32_t x = 0; x < half; x++) {
+                    for(uint32_t c = 0; c < 4; c++) {
+                        uint32_t sum = level[((2 * y) * size + 2 * x) * 4 + c] + level[((2 * y) * size + 2 * x + 1) * 4 + c]
+                                    + level[((2 * y + 1) * size + 2 * x) * 4 + c] + level[((2 * y + 1) * size + 2 * x + 1) * 4 + c];
+                        next[(y * half + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                    }
+                }
+            }
+            mips.insert(mips.end(), next.begin(), next.end());
+            level.swap(next);
+            size = half;
+        }
+    }
+
+    static double measure_psnr(const uint8_t* reference, const uint8_t* decoded, size_t texel_count, uint32_t channel_begin, uint32_t channel_end) {
+        double error = 0.0;
+        for(size_t i = 0; i < texel_count; i++) {
+            for(uint32_t c = channel_begin; c < channel_end; c++) {
+                double delta = static_cast<double>(reference[i * 4 + c]) - decoded[i * 4 + c];
+                error += delta * delta;
+            }
+        }
+        double mse = error / (texel_count * (channel_end - channel_begin));
+        return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+    }
+
+    /// RGBA8 KTX2 sources transcoded for a BC-only device (BC1 for the opaque
+    /// one, BC3 for the one with alpha) and decoded back for one without BC
+    void run_texture_benchmark(MicroReport& report) {
+        Paopu::TextureTranscoder transcoder;
+
+        const char* names[] = {"opaque", "alpha"};
+        for(uint32_t variant = 0; variant < 2; variant++) {
+            std::vector<uint8_t> mips;
+            make_texture(variant == 1, mips);
+
+            std::vector<uint8_t> file;
+            Paopu::write_ktx2(Paopu::TextureFormat::RGBA8, true, k_texture_size, k_texture_size, k_texture_mips, mips.data(), file);
+            Paopu::Ktx2Image image;
+            if(!Paopu::parse_ktx2(file.data(), file.size(), image)) {
+                printf("[Bench][Textures]: Could not parse the generated KTX2 file!\n");
+                return;
+            }
+
+            transcoder.set_supported_formats(Paopu::get_texture_format_bit(Paopu::TextureFormat::RGBA8)
+                                            | Paopu::get_texture_format_bit(Paopu::TextureFormat::BC1)
+                                            | Paopu::get_texture_format_bit(Paopu::TextureFormat::BC3));
+            Paopu::TextureFormat format = Paopu::TextureFormat::RGBA8;
+            transcoder.select_format(image, format);
+
+            Paopu::TranscodedTexture encoded;
+            Clock::time_point start = Clock::now();
+            for(uint32_t run = 0; run < k_transcode_runs; run++) {
+                transcoder.transcode(image, format, encoded);
+            }
+            double encode_seconds = std::chrono::duration<double>(Clock::now() - start).count() / k_transcode_runs;
+
+            // Back to RGBA8, as a device without BC would get it
+            std::vector<uint8_t> encoded_file;
+            Paopu::write_ktx2(encoded.format, encoded.srgb, encoded.width, encoded.height, encoded.mip_count, encoded.data.data(), encoded_file);
+            Paopu::Ktx2Image encoded_image;
+            Paopu::parse_ktx2(encoded_file.data(), encoded_file.size(), encoded_image);
+
+            transcoder.set_supported_formats(Paopu::get_texture_format_bit(Paopu::TextureFormat::RGBA8));
+            Paopu::TranscodedTexture decoded;
+            start = Clock::now();
+            for(uint32_t run = 0; run < k_transcode_runs; run++) {
+                transcoder.transcode(encoded_image, Paopu::TextureFormat::RGBA8, decoded);
+            }
+            double decode_seconds = std::chrono::duration<double>(Clock::now() - start).count() / k_transcode_runs;
+
+            double megabytes = mips.size() / (1024.0 * 1024.0);
+            size_t texel_count = k_texture_size * k_texture_size;
+            char metric[64];
+
+            snprintf(metric, sizeof(metric), "%s_format", names[variant]);
+            report.add(metric, static_cast<double>(format));
+            snprintf(metric, sizeof(metric), "%s_encode_mb_per_s", names[variant]);
+            report.add(metric, megabytes / encode_seconds);
+            snprintf(metric, sizeof(metric), "%s_decode_mb_per_s", names[variant]);
+            report.add(metric, megabytes / decode_seconds);
+            snprintf(metric, sizeof(metric), "%s_rgb_psnr_db", names[variant]);
+            report.add(metric, measure_psnr(mips.data(), decoded.data.data(), texel_count, 0, 3));
+            if(variant == 1) {
+                snprintf(metric, sizeof(metric), "%s_alpha_psnr_db", names[variant]);
+                report.add(metric, measure_psnr(mips.data(), decoded.data.data(), texel_count, 3, 4));
+            }
+            snprintf(metric, sizeof(metric), "%s_size_ratio", names[variant]);
+            report.add(metric, static_cast<double>(encoded.data.size()) / mips.size());
+        }
+    }
+
+}
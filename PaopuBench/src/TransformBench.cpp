@@ -0,0 +1,93 @@
+#include <Scene/TransformHierarchy.h>
+
+#include "BenchMicro.h"
+
+#include <chrono>
+#include <vector>
+
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    /// 184k sprites in 1000 trees of depth 4 (1 root, 3 children, 18
+    /// grandchildren and 162 leaves each). Compares recomputing everything,
+    /// moving 1% of the trees, and a frame where nothing moved.
+    void run_transform_benchmark(MicroReport& report) {
+        const uint32_t k_tree_count = 1000;
+        const uint32_t k_fan_out = 3;
+        const uint32_t k_depth = 4;
+        const uint32_t k_iterations = 100;
+
+        Paopu::TransformHierarchy hierarchy;
+        std::vector<Paopu::TransformHandle> roots;
+        std::vector<Paopu::TransformHandle> nodes;
+
+        Paopu::Transform2D local;
+        local.position = glm::vec2(4.0f, 2.0f);
+        local.rotation = 0.1f;
+
+        for(uint32_t tree = 0; tree < k_tree_count; tree++) {
+            Paopu::TransformHandle root = hierarchy.create(local);
+            roots.push_back(root);
+            nodes.push_back(root);
+
+            std::vector<Paopu::TransformHandle> frontier{root};
+            for(uint32_t depth = 1; depth < k_depth; depth++) {
+                std::vector<Paopu::TransformHandle> next;
+                for(Paopu::TransformHandle parent : frontier) {
+                    for(uint32_t child = 0; child < k_fan_out * depth; child++) {
+                        Paopu::TransformHandle handle = hierarchy.create(local, parent);
+                        next.push_back(handle);
+                        nodes.push_back(handle);
+                    }
+                }
+                frontier = std::move(next);
+            }
+        }
+
+        std::vector<Paopu::SpriteInstance> instances(nodes.size());
+        hierarchy.set_instance_buffer(instances.data(), static_cast<uint32_t>(instances.size()));
+        for(uint32_t i = 0; i < nodes.size(); i++) {
+            hierarchy.bind_sprite(nodes[i], i, glm::vec2(16.0f));
+        }
+        hierarchy.update();
+
+        // Every root moves, so every node is recomputed
+        Clock::time_point start = Clock::now();
+        uint32_t updated = 0;
+        for(uint32_t iteration = 0; iteration < k_iterations; iteration++) {
+            local.rotation = 0.01f * iteration;
+            for(Paopu::TransformHandle root : roots) {
+                hierarchy.set_local(root, local);
+            }
+            updated = hierarchy.update();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count() / k_iterations;
+        report.add("full_update_us", seconds * 1e6);
+        report.add("full_ns_per_node", seconds * 1e9 / updated);
+
+        // 1% of the trees move
+        start = Clock::now();
+        for(uint32_t iteration = 0; iteration < k_iterations; iteration++) {
+            local.rotation = 0.01f * iteration;
+            for(uint32_t i = 0; i < k_tree_count / 100; i++) {
+                hierarchy.set_local(roots[(iteration * 7 + i * 100) % k_tree_count], local);
+            }
+            updated = hierarchy.update();
+        }
+        seconds = std::chrono::duration<double>(Clock::now() - start).count() / k_iterations;
+        report.add("sparse_update_us", seconds * 1e6);
+        report.add("sparse_nodes_updated", updated);
+
+        // Nothing moved
+        start = Clock::now();
+        for(uint32_t iteration = 0; iteration < k_iterations; iteration++) {
+            updated = hierarchy.update();
+        }
+        seconds = std::chrono::duration<double>(Clock::now() - start).count() / k_iterations;
+        report.add("static_update_us", seconds * 1e6);
+
+        report.add("nodes", hierarchy.get_node_count());
+    }
+
+}
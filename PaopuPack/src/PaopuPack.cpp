@@ -0,0 +1,79 @@
+#include <Assets/AssetArchive.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+// Packs files into an asset archive, see Assets/AssetArchive.h
+//
+//  paopu_pack --output assets.pak [--lz4] Shaders/SpriteShader.vert.spv=Paopu/src/Renderer/Shaders/SPVs/SpriteShader.vert.spv ...
+//  paopu_pack --list assets.pak
+
+static void print_usage() {
+    printf("usage: paopu_pack --output <archive> [--lz4] <name>=<file>...\n"
+           "       paopu_pack --list <archive>\n"
+           "  --output <archive>   Archive to write\n"
+           "  --lz4                Compress the files that follow, where it helps\n"
+           "  --raw                Store the files that follow uncompressed (default)\n"
+           "  --list <archive>     Print the entries of an archive\n");
+}
+
+static int list_archive(const std::string& path) {
+    Paopu::AssetArchive archive;
+    archive.open(path);
+
+    for(uint32_t i = 0; i < archive.get_entry_count(); i++) {
+        const Paopu::AssetArchiveEntry& entry = archive.get_entries()[i];
+        printf("%016llx  offset %10llu  size %10llu  stored %10llu  %s\n",
+            static_cast<unsigned long long>(entry.id),
+            static_cast<unsigned long long>(entry.offset),
+            static_cast<unsigned long long>(entry.size),
+            static_cast<unsigned long long>(entry.stored_size),
+            entry.compression == Paopu::AssetCompression::Lz4 ? "lz4" : "raw");
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv) {
+    std::string output_path;
+    bool compress = false;
+    Paopu::AssetArchiveWriter writer;
+
+    try {
+        for(int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if(arg == "--list" && has_value) return list_archive(argv[++i]);
+            else if(arg == "--output" && has_value) output_path = argv[++i];
+            else if(arg == "--lz4") compress = true;
+            else if(arg == "--raw") compress = false;
+            else if(arg.find('=') != std::string::npos && arg[0] != '-') {
+                size_t split = arg.find('=');
+                std::string name = arg.substr(0, split);
+                std::string file = arg.substr(split + 1);
+                if(!writer.add_file(name, file, compress)) {
+                    fprintf(stderr, "[Pack]: Failed to read %s\n", file.c_str());
+                    return EXIT_FAILURE;
+                }
+            } else {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+        }
+
+        if(output_path.empty() || writer.get_asset_count() == 0) {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+
+        writer.write(output_path);
+        printf("[Pack]: Wrote %zu assets to %s\n", writer.get_asset_count(), output_path.c_str());
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,3 +1,9 @@
-C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe ./Paopu/src/Renderer/Shaders/SpriteShader.vert -o ./Paopu/src/Renderer/Shaders/SPVs/SpriteShader.vert.spv
-C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe ./Paopu/src/Renderer/Shaders/SpriteShader.frag -o ./Paopu/src/Renderer/Shaders/SPVs/SpriteShader.frag.spv
+cmake -DCOMPILER=C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe -DSOURCE=./Paopu/src/Renderer/Shaders/SpriteShader.vert -DOUTPUT=./Paopu/src/Renderer/Shaders/SPVs/SpriteShader.vert.spv -P ./Paopu/cmake/CompileShader.cmake
+cmake -DCOMPILER=C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe -DSOURCE=./Paopu/src/Renderer/Shaders/SpriteShader.frag -DOUTPUT=./Paopu/src/Renderer/Shaders/SPVs/SpriteShader.frag.spv -P ./Paopu/cmake/CompileShader.cmake
+cmake -DCOMPILER=C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe -DSOURCE=./Paopu/src/Renderer/Shaders/LitSpriteShader.frag -DOUTPUT=./Paopu/src/Renderer/Shaders/SPVs/LitSpriteShader.frag.spv -P ./Paopu/cmake/CompileShader.cmake
+cmake -DCOMPILER=C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe -DSOURCE=./Paopu/src/Renderer/Shaders/LightCulling.comp -DOUTPUT=./Paopu/src/Renderer/Shaders/SPVs/LightCulling.comp.spv -P ./Paopu/cmake/CompileShader.cmake
+cmake -DCOMPILER=C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe -DSOURCE=./Paopu/src/Renderer/Shaders/BloomDownsample.comp -DOUTPUT=./Paopu/src/Renderer/Shaders/SPVs/BloomDownsample.comp.spv -P ./Paopu/cmake/CompileShader.cmake
+cmake -DCOMPILER=C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe -DSOURCE=./Paopu/src/Renderer/Shaders/BloomUpsample.comp -DOUTPUT=./Paopu/src/Renderer/Shaders/SPVs/BloomUpsample.comp.spv -P ./Paopu/cmake/CompileShader.cmake
+cmake -DCOMPILER=C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe -DSOURCE=./Paopu/src/Renderer/Shaders/PostComposite.comp -DOUTPUT=./Paopu/src/Renderer/Shaders/SPVs/PostComposite.comp.spv -P ./Paopu/cmake/CompileShader.cmake
+cmake -DCOMPILER=C:/VulkanSDK/1.2.162.1/Bin32/glslc.exe -DSOURCE=./Paopu/src/Renderer/Shaders/PostComposite.comp -DOUTPUT=./Paopu/src/Renderer/Shaders/SPVs/PostCompositeDirect.comp.spv -DDEFINES=WRITE_WITHOUT_FORMAT -P ./Paopu/cmake/CompileShader.cmake
 pause
\ No newline at end of file